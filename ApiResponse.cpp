@@ -0,0 +1,132 @@
+#include "ApiResponse.h"
+
+ApiResponse::Stats ApiResponse::stats = {};
+
+JsonDirectoryList::JsonDirectoryList(fs::FS& fs, const char* path, const char* key, HeadWriter head, EntryWriter entry) :
+    dir(fs.open(path)),
+    key(key),
+    head(head),
+    entry(entry),
+    started(false)
+{
+}
+
+bool JsonDirectoryList::next(JsonWriter& json) {
+    if (!started) {
+        started = true;
+        json.beginObject();
+        head(json);
+        json.beginArray(key);
+        return true;
+    }
+
+    if (dir && dir.isDirectory()) {
+        File file = dir.openNextFile();
+        if (file) {
+            entry(json, file);
+            return true;
+        }
+        dir.close();
+    }
+
+    json.endArray().endObject();
+    return false;
+}
+
+ApiResponse::ApiResponse(AsyncWebServerRequest* request, int code) :
+    request(request),
+    stream(request->beginResponseStream("application/json", API_STREAM_INITIAL)),
+    writer(*stream)
+{
+    stream->setCode(code);
+}
+
+ApiResponse::~ApiResponse() {
+    if (stream != nullptr) {
+        writer.clear();  // Destruktor writera nie może pisać do zwolnionego strumienia
+        delete stream;
+    }
+}
+
+void ApiResponse::send() {
+    if (stream == nullptr) {
+        return;
+    }
+    writer.flush();
+    record(writer.getLength(), false);
+
+    // Serwer zwalnia odpowiedź po wysłaniu
+    request->send(stream);
+    stream = nullptr;
+}
+
+void ApiResponse::sendChunked(AsyncWebServerRequest* request, std::shared_ptr<JsonChunkSource> source) {
+    struct ChunkState {
+        std::shared_ptr<JsonChunkSource> source;
+        JsonWriter json;
+        size_t position;
+        bool finished;
+    };
+    std::shared_ptr<ChunkState> state = std::make_shared<ChunkState>();
+    state->source = source;
+    state->position = 0;
+    state->finished = false;
+
+    request->send(request->beginChunkedResponse("application/json",
+        [state](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            size_t written = 0;
+
+            while (written < maxLen) {
+                if (state->position >= state->json.getBuffered()) {
+                    if (state->finished) {
+                        break;
+                    }
+                    // Bufor wysłany - kolejny fragment od źródła
+                    state->json.clear();
+                    state->position = 0;
+                    state->finished = !state->source->next(state->json);
+                    if (state->json.hasOverflowed()) {
+                        DEBUG_ERROR("API: fragment odpowiedzi wiekszy niz %u B", JSON_WRITER_BUFFER);
+                        stats.overflows++;
+                        state->finished = true;
+                    }
+                    if (state->finished) {
+                        record(state->json.getLength(), true);
+                    }
+                    continue;
+                }
+
+                size_t chunk = min(state->json.getBuffered() - state->position, maxLen - written);
+                memcpy(buffer + written, state->json.getData() + state->position, chunk);
+                written += chunk;
+                state->position += chunk;
+            }
+
+            return written;
+        }));
+}
+
+void ApiResponse::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+// Odpowiedź jest już w RAM - moment największej zajętości sterty przez to zapytanie
+void ApiResponse::record(size_t bytes, bool chunked) {
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t largestBlock = ESP.getMaxAllocHeap();
+
+    if (stats.responses == 0 || freeHeap < stats.minFreeHeap) {
+        stats.minFreeHeap = freeHeap;
+    }
+    if (stats.responses == 0 || largestBlock < stats.minLargestBlock) {
+        stats.minLargestBlock = largestBlock;
+    }
+    stats.responses++;
+    if (chunked) {
+        stats.chunked++;
+    }
+    stats.bytes += bytes;
+    if (bytes > stats.maxBytes) {
+        stats.maxBytes = bytes;
+    }
+}
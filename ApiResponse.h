@@ -0,0 +1,95 @@
+#ifndef API_RESPONSE_H
+#define API_RESPONSE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+#include <functional>
+#include <memory>
+#include "DebugUtils.h"
+#include "JsonWriter.h"
+
+// Odpowiedzi JSON REST API pisane wprost do strumienia odpowiedzi.
+//
+//   ApiResponse response(request);
+//   JsonWriter& json = response.json();
+//   json.beginObject().field("soc", data.soc).endObject();
+//   response.send();
+//
+// Treść trafia przez bufor JsonWriter do AsyncResponseStream - w RAM jest tylko
+// sama odpowiedź czekająca na wysłanie, bez dokumentu ArduinoJson i kopii w String.
+// Listy o nieznanej długości (pliki katalogu) idą przez sendChunked(): kolejne
+// pozycje są pisane do stałego bufora dopiero wtedy, gdy serwer ma miejsce w TCP.
+//
+// Statystyki (getStats()) pokazują najmniej wolnej sterty i najmniejszy
+// największy blok w chwili wysyłania odpowiedzi - przy serii równoległych
+// zapytań to szczyt zajętości pamięci przez API.
+
+#define API_STREAM_INITIAL 512     // Początkowa pojemność AsyncResponseStream (rośnie w razie potrzeby)
+
+// Źródło odpowiedzi porcjami: każde wywołanie dopisuje fragment mieszczący się
+// w JSON_WRITER_BUFFER; false po zamknięciu dokumentu
+class JsonChunkSource {
+public:
+    virtual ~JsonChunkSource() {}
+    virtual bool next(JsonWriter& json) = 0;
+};
+
+// Obiekt z polami od head() i tablicą key - jeden wpis entry() na plik katalogu
+// (entry() może plik pominąć, nic nie zapisując)
+class JsonDirectoryList : public JsonChunkSource {
+public:
+    typedef std::function<void(JsonWriter&)> HeadWriter;
+    typedef std::function<void(JsonWriter&, File&)> EntryWriter;
+
+    JsonDirectoryList(fs::FS& fs, const char* path, const char* key, HeadWriter head, EntryWriter entry);
+
+    bool next(JsonWriter& json) override;
+
+private:
+    File dir;
+    const char* key;
+    HeadWriter head;
+    EntryWriter entry;
+    bool started;
+};
+
+class ApiResponse {
+public:
+    struct Stats {
+        uint32_t responses;         // Wysłane odpowiedzi JSON
+        uint32_t chunked;           // W tym porcjami
+        uint32_t bytes;             // Suma treści
+        uint32_t maxBytes;          // Największa odpowiedź
+        uint32_t minFreeHeap;       // Najmniej wolnej sterty przy wysyłaniu
+        uint32_t minLargestBlock;   // Najmniejszy największy wolny blok przy wysyłaniu
+        uint32_t overflows;         // Fragmenty większe niż bufor porcji (ucięte)
+    };
+
+    explicit ApiResponse(AsyncWebServerRequest* request, int code = 200);
+    ~ApiResponse();
+
+    ApiResponse(const ApiResponse&) = delete;
+    ApiResponse& operator=(const ApiResponse&) = delete;
+
+    JsonWriter& json() { return writer; }
+
+    // Przekazuje odpowiedź serwerowi; bez send() jest zwalniana w destruktorze
+    void send();
+
+    static void sendChunked(AsyncWebServerRequest* request, std::shared_ptr<JsonChunkSource> source);
+
+    static const Stats& getStats() { return stats; }
+    static void resetStats();
+
+private:
+    AsyncWebServerRequest* request;
+    AsyncResponseStream* stream;
+    JsonWriter writer;
+
+    static Stats stats;
+
+    static void record(size_t bytes, bool chunked);
+};
+
+#endif // API_RESPONSE_H
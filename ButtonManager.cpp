@@ -0,0 +1,283 @@
+#include "ButtonManager.h"
+
+// Czy termin minął (znaczniki micros z przepełnieniem)
+static inline bool reached(uint32_t nowUs, uint32_t dueUs) {
+    return (int32_t)(nowUs - dueUs) >= 0;
+}
+
+ButtonManager::ButtonManager(const ButtonGesture* gestures, uint8_t count) :
+    gestures(gestures),
+    gestureCount(min(count, (uint8_t)BUTTON_MAX_GESTURES)),
+    timer(nullptr),
+    context(BUTTON_CONTEXT_NONE),
+    activity(false),
+    rawMask(0),
+    stableMask(0),
+    bouncing(false),
+    burstStartUs(0),
+    lastEdgeUs(0),
+    consumedMask(0),
+    pendingClickMask(0),
+    firedMask(0)
+{
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        pins[i] = 0;
+        pressUs[i] = 0;
+        releaseUs[i] = 0;
+    }
+    for (uint8_t i = 0; i < BUTTON_MAX_GESTURES; i++) {
+        repeatDueUs[i] = 0;
+    }
+    resetStats();
+}
+
+void ButtonManager::begin(const uint8_t buttonPins[BUTTON_COUNT]) {
+    uint8_t initial = 0;
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        pins[i] = buttonPins[i];
+        pinMode(pins[i], INPUT_PULLUP);
+        if (!digitalRead(pins[i])) initial |= (1 << i);
+    }
+
+    // Przycisk trzymany przy starcie (np. SET po wybudzeniu) nie wywoła gestu
+    rawMask = initial;
+    stableMask = initial;
+    consumedMask = initial;
+    uint32_t now = micros();
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        pressUs[i] = now;
+    }
+
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        attachInterruptArg(digitalPinToInterrupt(pins[i]), edgeIsr, this, CHANGE);
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = timerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "buttons";
+    if (esp_timer_create(&args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, BUTTON_TIMER_PERIOD_US) != ESP_OK) {
+        DEBUG_ERROR("Nie udalo sie uruchomic timera przyciskow");
+    }
+}
+
+void IRAM_ATTR ButtonManager::edgeIsr(void* arg) {
+    ButtonManager* self = static_cast<ButtonManager*>(arg);
+    uint8_t pressed = 0;
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        if (!digitalRead(self->pins[i])) pressed |= (1 << i);
+    }
+    self->activity = true;
+    self->onEdge(pressed, micros());
+}
+
+void IRAM_ATTR ButtonManager::onEdge(uint8_t pressedMask, uint32_t stampUs) {
+    Edge edge = { stampUs, pressedMask };
+    edges.push(edge);
+}
+
+void ButtonManager::timerCallback(void* arg) {
+    static_cast<ButtonManager*>(arg)->process(micros());
+}
+
+bool ButtonManager::takeActivity() {
+    if (!activity) return false;
+    activity = false;
+    return true;
+}
+
+bool ButtonManager::isActive(uint8_t index) const {
+    return (gestures[index].contexts & context) != 0;
+}
+
+int8_t ButtonManager::findGesture(ButtonGestureType type, uint8_t buttons) const {
+    for (uint8_t i = 0; i < gestureCount; i++) {
+        if (gestures[i].type == type && gestures[i].buttons == buttons && isActive(i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ButtonManager::emit(uint8_t index, uint32_t dueUs, uint32_t nowUs) {
+    ButtonEvent event = { index, dueUs, nowUs };
+    events.push(event);
+}
+
+void ButtonManager::consume(uint8_t buttons) {
+    consumedMask |= buttons;
+    pendingClickMask &= ~buttons;
+}
+
+void ButtonManager::process(uint32_t nowUs) {
+    Edge edge;
+    while (edges.pop(edge)) {
+        if (!bouncing) {
+            bouncing = true;
+            burstStartUs = edge.stampUs;
+        }
+        rawMask = edge.pressedMask;
+        lastEdgeUs = edge.stampUs;
+    }
+
+    // Stan przyjęty po BUTTON_DEBOUNCE_US bez zboczy; czas zmiany - pierwsze zbocze serii
+    if (bouncing && reached(nowUs, lastEdgeUs + BUTTON_DEBOUNCE_US)) {
+        bouncing = false;
+        if (rawMask != stableMask) {
+            uint8_t oldMask = stableMask;
+            stableMask = rawMask;
+            applyTransition(oldMask, stableMask, burstStartUs, nowUs);
+        }
+    }
+
+    checkTimers(nowUs);
+}
+
+void ButtonManager::applyTransition(uint8_t oldMask, uint8_t newMask, uint32_t atUs, uint32_t nowUs) {
+    uint8_t pressed = newMask & ~oldMask;
+    uint8_t released = oldMask & ~newMask;
+
+    for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+        if (pressed & (1 << b)) pressUs[b] = atUs;
+    }
+
+    // Kilka przycisków naraz - to już nie są pojedyncze kliknięcia
+    if (newMask & (newMask - 1)) {
+        consume(newMask);
+    }
+
+    for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+        uint8_t bit = 1 << b;
+        if (!(released & bit)) continue;
+
+        for (uint8_t i = 0; i < gestureCount; i++) {
+            if (gestures[i].type == GESTURE_RELEASE && gestures[i].buttons == bit && isActive(i)) {
+                emit(i, atUs, nowUs);
+            }
+        }
+
+        if (!(consumedMask & bit)) {
+            int8_t doubleClick = findGesture(GESTURE_DOUBLE_CLICK, bit);
+            if (doubleClick < 0) {
+                int8_t click = findGesture(GESTURE_CLICK, bit);
+                if (click >= 0) emit(click, atUs, nowUs);
+            } else if ((pendingClickMask & bit) &&
+                       atUs - releaseUs[b] <= gestures[doubleClick].timeMs * 1000UL) {
+                pendingClickMask &= ~bit;
+                emit(doubleClick, atUs, nowUs);
+            } else {
+                // Kliknięcie wstrzymane do upływu okna na drugie
+                pendingClickMask |= bit;
+                releaseUs[b] = atUs;
+            }
+        }
+
+        // Kolejne naciśnięcie zaczyna od nowa
+        consumedMask &= ~bit;
+        for (uint8_t i = 0; i < gestureCount; i++) {
+            if (gestures[i].buttons & bit) firedMask &= ~(1UL << i);
+        }
+    }
+}
+
+void ButtonManager::checkTimers(uint32_t nowUs) {
+    // Pojedyncze kliknięcie po upływie okna na drugie
+    for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+        uint8_t bit = 1 << b;
+        if (!(pendingClickMask & bit) || (stableMask & bit)) continue;
+
+        int8_t doubleClick = findGesture(GESTURE_DOUBLE_CLICK, bit);
+        uint32_t windowUs = (doubleClick >= 0) ? gestures[doubleClick].timeMs * 1000UL : 0;
+        if (reached(nowUs, releaseUs[b] + windowUs + 1)) {
+            pendingClickMask &= ~bit;
+            int8_t click = findGesture(GESTURE_CLICK, bit);
+            if (click >= 0) emit(click, releaseUs[b] + windowUs, nowUs);
+        }
+    }
+
+    if (bouncing || stableMask == 0) return;
+
+    for (uint8_t i = 0; i < gestureCount; i++) {
+        const ButtonGesture& gesture = gestures[i];
+        if (gesture.buttons != stableMask || !isActive(i)) continue;
+
+        uint32_t fired = firedMask & (1UL << i);
+
+        switch (gesture.type) {
+            case GESTURE_LONG_PRESS:
+            case GESTURE_HOLD_REPEAT: {
+                if (fired) {
+                    if (gesture.type == GESTURE_HOLD_REPEAT && gesture.repeatMs > 0 &&
+                        reached(nowUs, repeatDueUs[i])) {
+                        emit(i, repeatDueUs[i], nowUs);
+                        repeatDueUs[i] += gesture.repeatMs * 1000UL;
+                    }
+                    break;
+                }
+                if (consumedMask & gesture.buttons) break;
+
+                uint8_t b = __builtin_ctz(gesture.buttons);
+                uint32_t dueUs = pressUs[b] + gesture.timeMs * 1000UL;
+                if (reached(nowUs, dueUs)) {
+                    emit(i, dueUs, nowUs);
+                    firedMask |= (1UL << i);
+                    consume(gesture.buttons);
+                    repeatDueUs[i] = dueUs + gesture.repeatMs * 1000UL;
+                }
+                break;
+            }
+
+            case GESTURE_COMBO: {
+                if (fired) break;
+
+                // Odliczanie od naciśnięcia ostatniego z przycisków kombinacji
+                uint32_t startUs = 0;
+                bool first = true;
+                for (uint8_t b = 0; b < BUTTON_COUNT; b++) {
+                    if (!(gesture.buttons & (1 << b))) continue;
+                    if (first || (int32_t)(pressUs[b] - startUs) > 0) startUs = pressUs[b];
+                    first = false;
+                }
+                uint32_t dueUs = startUs + gesture.timeMs * 1000UL;
+                if (reached(nowUs, dueUs)) {
+                    emit(i, dueUs, nowUs);
+                    firedMask |= (1UL << i);
+                    consume(gesture.buttons);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+uint8_t ButtonManager::dispatch() {
+    uint8_t count = 0;
+    ButtonEvent event;
+
+    while (events.pop(event)) {
+        uint32_t startUs = micros();
+        uint32_t detectUs = event.detectedUs - event.dueUs;
+        uint32_t dispatchUs = startUs - event.dueUs;
+
+        eventCount++;
+        dispatchSumUs += dispatchUs;
+        if (detectUs > maxDetectUs) maxDetectUs = detectUs;
+        if (dispatchUs > maxDispatchUs) maxDispatchUs = dispatchUs;
+
+        gestures[event.gesture].handler();
+        count++;
+    }
+    return count;
+}
+
+void ButtonManager::resetStats() {
+    eventCount = 0;
+    maxDetectUs = 0;
+    maxDispatchUs = 0;
+    dispatchSumUs = 0;
+}
@@ -0,0 +1,159 @@
+#ifndef BUTTON_MANAGER_H
+#define BUTTON_MANAGER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "DebugUtils.h"
+#include "SpscRing.h"
+
+// Rozpoznawanie gestów przycisków UP / DOWN / SET.
+//
+// Przerwanie (CHANGE) zapisuje stan wszystkich przycisków ze znacznikiem micros() do
+// kolejki zboczy. Timer esp_timer co BUTTON_TIMER_PERIOD_US usuwa drgania styków (stan
+// stabilny przez BUTTON_DEBOUNCE_US; czas naciśnięcia = pierwsze zbocze serii) i
+// porównuje stan z tablicą gestów. Rozpoznane gesty trafiają do kolejki zdarzeń,
+// a dispatch() w pętli głównej wywołuje ich obsługę. Progi czasowe liczone są od
+// znaczników z przerwania, więc nie zależą od tego, jak długo trwało rysowanie ekranu.
+//
+// Gesty (ButtonGesture, tablica w main.ino):
+//  - CLICK          krótkie naciśnięcie; jeśli przycisk ma też DOUBLE_CLICK,
+//                   zgłaszane dopiero po upływie okna na drugie kliknięcie
+//  - DOUBLE_CLICK   dwa kliknięcia w ciągu timeMs
+//  - LONG_PRESS     przytrzymanie przez timeMs (raz na naciśnięcie)
+//  - HOLD_REPEAT    po timeMs powtarzane co repeatMs do puszczenia
+//  - RELEASE        puszczenie przycisku (zawsze, także po długim naciśnięciu)
+//  - COMBO          kilka przycisków trzymanych razem przez timeMs
+// Naciśnięcie, które nałożyło się na inny przycisk albo wywołało LONG_PRESS / COMBO,
+// nie daje już kliknięcia - zastępuje to blokadę czasową po kombinacjach.
+//
+// Opóźnienie: "detect" to czas od chwili, w której gest powinien zostać rozpoznany
+// (zbocze albo upływ progu), do rozpoznania w timerze; "dispatch" - do wywołania
+// obsługi w pętli głównej.
+
+#define BUTTON_DEBOUNCE_US 25000UL
+#define BUTTON_TIMER_PERIOD_US 5000UL
+#define BUTTON_EDGE_QUEUE_SIZE 32
+#define BUTTON_EVENT_QUEUE_SIZE 16
+#define BUTTON_MAX_GESTURES 24
+
+enum ButtonId : uint8_t {
+    BUTTON_UP,
+    BUTTON_DOWN,
+    BUTTON_SET,
+    BUTTON_COUNT
+};
+
+#define BUTTON_MASK_UP   (1 << BUTTON_UP)
+#define BUTTON_MASK_DOWN (1 << BUTTON_DOWN)
+#define BUTTON_MASK_SET  (1 << BUTTON_SET)
+
+// Konteksty - gest obowiązuje tylko w wybranych stanach urządzenia
+#define BUTTON_CONTEXT_NONE   0x00   // Wszystkie gesty wyłączone (np. animacja powitania)
+#define BUTTON_CONTEXT_OFF    0x01   // Wyświetlacz wyłączony
+#define BUTTON_CONTEXT_NORMAL 0x02   // Jazda
+#define BUTTON_CONTEXT_CONFIG 0x04   // Tryb konfiguracji (WWW)
+
+enum ButtonGestureType : uint8_t {
+    GESTURE_CLICK,
+    GESTURE_DOUBLE_CLICK,
+    GESTURE_LONG_PRESS,
+    GESTURE_HOLD_REPEAT,
+    GESTURE_RELEASE,
+    GESTURE_COMBO
+};
+
+struct ButtonGesture {
+    uint8_t contexts;        // Maska BUTTON_CONTEXT_*
+    uint8_t buttons;         // Maska BUTTON_MASK_* (COMBO - co najmniej dwa)
+    ButtonGestureType type;
+    uint16_t timeMs;         // Próg przytrzymania / okno podwójnego kliknięcia
+    uint16_t repeatMs;       // Okres HOLD_REPEAT
+    void (*handler)();
+};
+
+struct ButtonEvent {
+    uint8_t gesture;         // Indeks w tablicy gestów
+    uint32_t dueUs;          // Chwila, w której gest powinien zostać rozpoznany
+    uint32_t detectedUs;     // Rozpoznanie w timerze
+};
+
+class ButtonManager {
+public:
+    ButtonManager(const ButtonGesture* gestures, uint8_t count);
+
+    // Piny w kolejności ButtonId, aktywne stanem niskim (INPUT_PULLUP)
+    void begin(const uint8_t pins[BUTTON_COUNT]);
+
+    // Kontekst ustawiany przez pętlę główną przy zmianie stanu urządzenia
+    void setContext(uint8_t context) { this->context = context; }
+    uint8_t getContext() const { return context; }
+
+    // Wywołanie obsługi rozpoznanych gestów (pętla główna); zwraca liczbę zdarzeń
+    uint8_t dispatch();
+
+    // true, jeśli od ostatniego wywołania było jakiekolwiek zbocze
+    bool takeActivity();
+
+    uint8_t getPressedMask() const { return stableMask; }
+
+    // Wejścia automatu - publiczne, żeby dało się je zasilić sekwencją testową
+    void IRAM_ATTR onEdge(uint8_t pressedMask, uint32_t stampUs);
+    void process(uint32_t nowUs);
+    bool popEvent(ButtonEvent& event) { return events.pop(event); }
+
+    // Statystyki opóźnień [us]
+    uint32_t getEventCount() const { return eventCount; }
+    uint32_t getMaxDetectUs() const { return maxDetectUs; }
+    uint32_t getMaxDispatchUs() const { return maxDispatchUs; }
+    uint32_t getAvgDispatchUs() const { return eventCount ? dispatchSumUs / eventCount : 0; }
+    uint32_t getDroppedEvents() const { return events.getDropped() + edges.getDropped(); }
+    void resetStats();
+
+private:
+    struct Edge {
+        uint32_t stampUs;
+        uint8_t pressedMask;
+    };
+
+    const ButtonGesture* gestures;
+    uint8_t gestureCount;
+    uint8_t pins[BUTTON_COUNT];
+
+    SpscRing<Edge, BUTTON_EDGE_QUEUE_SIZE> edges;       // Przerwanie -> timer
+    SpscRing<ButtonEvent, BUTTON_EVENT_QUEUE_SIZE> events; // Timer -> pętla główna
+    esp_timer_handle_t timer;
+
+    volatile uint8_t context;
+    volatile bool activity;
+
+    // Stan automatu - tylko w kontekście timera (process)
+    uint8_t rawMask;
+    uint8_t stableMask;
+    bool bouncing;
+    uint32_t burstStartUs;       // Pierwsze zbocze bieżącej serii
+    uint32_t lastEdgeUs;
+    uint32_t pressUs[BUTTON_COUNT];
+    uint32_t releaseUs[BUTTON_COUNT]; // Puszczenie oczekujące na drugie kliknięcie
+    uint8_t consumedMask;        // Naciśnięcia, które nie dadzą już kliknięcia
+    uint8_t pendingClickMask;
+    uint32_t firedMask;          // Gesty LONG/COMBO/HOLD_REPEAT wykonane w tym naciśnięciu
+    uint32_t repeatDueUs[BUTTON_MAX_GESTURES];
+
+    // Statystyki - tylko w pętli głównej (dispatch)
+    uint32_t eventCount;
+    uint32_t maxDetectUs;
+    uint32_t maxDispatchUs;
+    uint64_t dispatchSumUs;
+
+    static void IRAM_ATTR edgeIsr(void* arg);
+    static void timerCallback(void* arg);
+
+    bool isActive(uint8_t index) const;
+    int8_t findGesture(ButtonGestureType type, uint8_t buttons) const;
+    void emit(uint8_t index, uint32_t dueUs, uint32_t nowUs);
+    void applyTransition(uint8_t oldMask, uint8_t newMask, uint32_t atUs, uint32_t nowUs);
+    void checkTimers(uint32_t nowUs);
+    void consume(uint8_t buttons);
+};
+
+#endif // BUTTON_MANAGER_H
@@ -0,0 +1,63 @@
+#ifndef CORE_SNAPSHOTS_H
+#define CORE_SNAPSHOTS_H
+
+#include <stdint.h>
+#include "Seqlock.h"
+
+// Migawki wymieniane między rdzeniami ESP32.
+//
+// Rdzeń 1 - pętla loop(): sterownik, kadencja, hamulec, przyciski, światła, wyświetlacz.
+// Publikuje RideSnapshot co SNAPSHOT_PERIOD_MS.
+// Rdzeń 0 - zadanie usług (obok stosów WiFi i BLE): WebSocket, zapytania BMS, TPMS,
+// rejestrator przejazdów, zapis ustawień. Publikuje ServiceSnapshot.
+// Stan energii i statystyki przejazdu rdzeń 1 publikuje w osobnych migawkach
+// (main.ino) - z nich korzysta zapis ustawień i WWW na rdzeniu 0.
+//
+// Każda migawka ma dokładnie jednego pisarza (Seqlock), czytelnik dostaje spójną kopię
+// bez blokad, a numer wersji mówi, czy od ostatniego odczytu są nowe dane. Wolne
+// zapytanie WWW albo łączenie BLE nie zatrzymuje więc wyświetlacza ani przycisków,
+// a żadna strona nie czyta struktury zapisywanej w tej chwili przez drugą.
+//
+// Nagłówek nie zależy od Arduino - buduje się i testuje także na PC.
+
+#define SNAPSHOT_PERIOD_MS 50
+
+// Stan jazdy: rdzeń 1 -> rdzeń 0
+struct RideSnapshot {
+    uint32_t stampMs;            // millis() publikacji
+    uint32_t epoch;              // Czas z RTC (unixtime) - odczytywany przez górny pasek
+    float speedKmh;
+    float distanceKm;            // Dystans przejazdu
+    float batteryVoltage;
+    float batteryCurrent;
+    float tempAir;               // TEMP_INVALID bez odczytu
+    float tempController;
+    float tempMotor;
+    uint32_t odometerMeters;
+    int16_t cadenceRpm;
+    int16_t powerW;
+    int8_t batteryPercent;
+    uint8_t assistLevel;
+    uint8_t lightMode;           // LightManager::LightMode
+    uint8_t lightDayConfig;      // Flagi LightManager::FRONT/DRL/REAR
+    uint8_t lightNightConfig;
+};
+
+struct TpmsWheelSnapshot {
+    float pressureBar;
+    float temperature;
+    uint8_t batteryPercent;
+    bool active;                 // Czujnik nadaje (bez przekroczenia czasu)
+};
+
+// Stan usług: rdzeń 0 -> rdzeń 1
+struct ServiceSnapshot {
+    uint32_t stampMs;
+    TpmsWheelSnapshot front;
+    TpmsWheelSnapshot rear;
+    uint32_t rtcEpoch;           // Ostatni odczyt RTC (unixtime) - rdzeń 1 nie czyta I2C zegara
+    uint32_t rtcStampMs;         // millis() tego odczytu
+    uint8_t webClients;          // Połączeni klienci WebSocket
+};
+
+#endif // CORE_SNAPSHOTS_H
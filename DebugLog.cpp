@@ -0,0 +1,379 @@
+#include "DebugLog.h"
+
+// Rozmiar pierścienia w bajtach - potęga dwójki
+#ifndef DEBUG_LOG_RING_BYTES
+#define DEBUG_LOG_RING_BYTES 8192
+#endif
+
+static_assert((DEBUG_LOG_RING_BYTES & (DEBUG_LOG_RING_BYTES - 1)) == 0, "DEBUG_LOG_RING_BYTES musi byc potega dwojki");
+
+// Wpis w pierścieniu, wyrównany do 4 B:
+//   [nagłówek][id formatu][czas us][wskaźnik formatu][argumenty...]
+// Nagłówek (długość argumentów, tag, bit COMMITTED) producent zapisuje na końcu,
+// konsument zeruje cały wpis przed przesunięciem ogona - niezerowy nagłówek pod
+// ogonem oznacza więc zawsze wpis gotowy do wysłania.
+static const uint32_t RECORD_FORMAT_OFFSET = 12;
+static const uint32_t RECORD_HEADER_BYTES = RECORD_FORMAT_OFFSET + sizeof(const char*);
+static const uint32_t RECORD_COMMITTED = 0x80000000UL;
+static const uint32_t RING_WORDS = DEBUG_LOG_RING_BYTES / 4;
+
+static uint32_t ring[RING_WORDS];
+static std::atomic<uint32_t> ringHead(0);  // Pozycje w bajtach, rosnące (modulo 2^32)
+static std::atomic<uint32_t> ringTail(0);
+static std::atomic<uint32_t> writtenCount(0);
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<uint32_t> maxUsedBytes(0);
+static uint32_t drainedCount = 0;
+static uint32_t reportedDropped = 0;
+static std::atomic_flag consumerBusy = ATOMIC_FLAG_INIT;
+static HardwareSerial* output = nullptr;
+
+// Ramka binarna: SYNC0 SYNC1 długość(1) tag(1) id(4) czas(4) argumenty suma(1)
+static const uint8_t FRAME_SYNC0 = 0xA5;
+static const uint8_t FRAME_SYNC1 = 0x5A;
+static const uint8_t FRAME_OVERHEAD = 2 + 1 + 1 + 4 + 4 + 1;
+
+// Najdłuższa linia tekstowa; dłuższe są obcinane
+static const uint16_t LINE_MAX = 200;
+
+// Kategoria i poziom każdego makra DEBUG_*
+const uint8_t DebugLog::TAG_CATEGORY[TAG_COUNT] = {
+    CATEGORY_SYSTEM, CATEGORY_SYSTEM, CATEGORY_SYSTEM,
+    CATEGORY_LIGHT, CATEGORY_TEMP, CATEGORY_BLE, CATEGORY_SYSTEM
+};
+const uint8_t DebugLog::TAG_LEVEL[TAG_COUNT] = {
+    LEVEL_ERROR, LEVEL_WARN, LEVEL_INFO,
+    LEVEL_INFO, LEVEL_INFO, LEVEL_INFO, LEVEL_DETAIL
+};
+static const char* const TAG_PREFIX[DebugLog::TAG_COUNT] = {
+    "[ERROR] ", "[WARN] ", "[INFO] ", "[LIGHT] ", "[TEMP] ", "[BLE] ", "[DETAIL] "
+};
+static const char* const CATEGORY_NAMES[DebugLog::CATEGORY_COUNT] = {
+    "system", "light", "temp", "ble"
+};
+
+// Domyślnie jak dawne przełączniki: światła wyłączone, reszta ze szczegółami
+uint8_t DebugLog::levels[CATEGORY_COUNT] = {
+    LEVEL_DETAIL, LEVEL_OFF, LEVEL_INFO, LEVEL_INFO
+};
+volatile DebugLog::Output DebugLog::outputMode = DebugLog::OUTPUT_TEXT;
+volatile bool DebugLog::deferredMode = false;
+
+static inline uint32_t recordBytes(uint8_t payloadLength) {
+    return RECORD_HEADER_BYTES + ((payloadLength + 3) & ~3U);
+}
+
+static inline uint32_t& wordAt(uint32_t pos) {
+    return ring[(pos / 4) & (RING_WORDS - 1)];
+}
+
+// Kopiowanie bajtów z zawinięciem na końcu pierścienia
+static void copyIn(uint32_t pos, const uint8_t* src, uint32_t length) {
+    uint8_t* bytes = (uint8_t*)ring;
+    uint32_t offset = pos & (DEBUG_LOG_RING_BYTES - 1);
+    uint32_t first = min(length, (uint32_t)DEBUG_LOG_RING_BYTES - offset);
+    memcpy(bytes + offset, src, first);
+    memcpy(bytes, src + first, length - first);
+}
+
+static void copyOut(uint32_t pos, uint8_t* dst, uint32_t length) {
+    const uint8_t* bytes = (const uint8_t*)ring;
+    uint32_t offset = pos & (DEBUG_LOG_RING_BYTES - 1);
+    uint32_t first = min(length, (uint32_t)DEBUG_LOG_RING_BYTES - offset);
+    memcpy(dst, bytes + offset, first);
+    memcpy(dst + first, bytes, length - first);
+}
+
+static void clearRecord(uint32_t pos, uint32_t length) {
+    for (uint32_t i = 0; i < length; i += 4) {
+        wordAt(pos + i) = 0;
+    }
+}
+
+void DebugLog::begin(HardwareSerial& serial) {
+    output = &serial;
+}
+
+void DebugLog::setLevel(Category category, Level level) {
+    if (category < CATEGORY_COUNT && level <= LEVEL_DETAIL) {
+        levels[category] = level;
+    }
+}
+
+const char* DebugLog::getCategoryName(Category category) {
+    return category < CATEGORY_COUNT ? CATEGORY_NAMES[category] : "?";
+}
+
+void DebugLog::commit(Tag tag, uint32_t id, const char* format, const uint8_t* payload, uint8_t length) {
+    uint32_t size = recordBytes(length);
+
+    // Rezerwacja miejsca - jedyny punkt styku producentów
+    uint32_t head = ringHead.load(std::memory_order_relaxed);
+    uint32_t used;
+    do {
+        used = head - ringTail.load(std::memory_order_acquire);
+        if (used + size > DEBUG_LOG_RING_BYTES) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!ringHead.compare_exchange_weak(head, head + size, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    wordAt(head + 4) = id;
+    wordAt(head + 8) = micros();
+    copyIn(head + RECORD_FORMAT_OFFSET, (const uint8_t*)&format, sizeof(format));
+    copyIn(head + RECORD_HEADER_BYTES, payload, length);
+
+    // Nagłówek na końcu - od tej chwili wpis widzi konsument
+    __atomic_store_n(&wordAt(head), RECORD_COMMITTED | ((uint32_t)tag << 8) | length, __ATOMIC_RELEASE);
+
+    writtenCount.fetch_add(1, std::memory_order_relaxed);
+    uint32_t max = maxUsedBytes.load(std::memory_order_relaxed);
+    while (used + size > max && !maxUsedBytes.compare_exchange_weak(max, used + size, std::memory_order_relaxed)) {
+    }
+
+    if (!deferredMode && !xPortInIsrContext()) {
+        flush();
+    }
+}
+
+// Formatowanie jednego specyfikatora printf z argumentem o zapisanym typie.
+// Modyfikatory długości (l, h, z...) są pomijane - rozmiar wynika z typu argumentu.
+static int formatArg(char* out, size_t size, const char* spec, size_t specLength, char conversion,
+                     const uint8_t*& arg, const uint8_t* end) {
+    char fmt[16];
+    size_t n = 0;
+    for (size_t i = 0; i < specLength && n < sizeof(fmt) - 4; i++) {
+        char c = spec[i];
+        if (c != 'l' && c != 'h' && c != 'z' && c != 'j' && c != 't' && c != 'L' && c != 'q') {
+            fmt[n++] = c;
+        }
+    }
+
+    if (arg >= end) {
+        return snprintf(out, size, "<?>");
+    }
+
+    uint8_t type = *arg++;
+    bool numeric = conversion != 's';
+    bool floating = conversion == 'f' || conversion == 'F' || conversion == 'e' || conversion == 'E' ||
+                    conversion == 'g' || conversion == 'G';
+
+    switch (type) {
+        case DebugLog::ARG_INT:
+        case DebugLog::ARG_UINT: {
+            uint32_t raw;
+            memcpy(&raw, arg, 4);
+            arg += 4;
+            if (!numeric || floating) {
+                return snprintf(out, size, type == DebugLog::ARG_INT ? "%d" : "%u", raw);
+            }
+            fmt[n++] = conversion;
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, raw);
+        }
+        case DebugLog::ARG_INT64:
+        case DebugLog::ARG_UINT64: {
+            uint64_t raw;
+            memcpy(&raw, arg, 8);
+            arg += 8;
+            if (!numeric || floating) {
+                return snprintf(out, size, type == DebugLog::ARG_INT64 ? "%lld" : "%llu", (long long)raw);
+            }
+            fmt[n++] = 'l';
+            fmt[n++] = 'l';
+            fmt[n++] = conversion;
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, (unsigned long long)raw);
+        }
+        case DebugLog::ARG_FLOAT:
+        case DebugLog::ARG_DOUBLE: {
+            double value;
+            if (type == DebugLog::ARG_FLOAT) {
+                float f;
+                memcpy(&f, arg, 4);
+                arg += 4;
+                value = f;
+            } else {
+                memcpy(&value, arg, 8);
+                arg += 8;
+            }
+            fmt[n++] = floating ? conversion : 'f';
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, value);
+        }
+        case DebugLog::ARG_STRING: {
+            uint8_t length = *arg++;
+            if (arg + length > end) {
+                length = end - arg;
+            }
+            char text[DebugLog::MAX_PAYLOAD + 1];
+            memcpy(text, arg, length);
+            text[length] = '\0';
+            arg += length;
+            fmt[n++] = 's';
+            fmt[n] = '\0';
+            return snprintf(out, size, fmt, text);
+        }
+        default:
+            arg = end;  // Nieznany typ - reszta argumentów nieczytelna
+            return snprintf(out, size, "<?>");
+    }
+}
+
+// Linia tekstowa jak dawne Serial.printf(prefiks + format) + println
+static uint16_t formatLine(char* line, uint8_t tag, const char* format, const uint8_t* payload, uint8_t length) {
+    const uint16_t limit = LINE_MAX - 2;  // Miejsce na "\r\n"
+    const uint8_t* arg = payload;
+    const uint8_t* end = payload + length;
+    uint16_t n = 0;
+
+    const char* prefix = tag < DebugLog::TAG_COUNT ? TAG_PREFIX[tag] : "[?] ";
+    while (*prefix && n < limit) {
+        line[n++] = *prefix++;
+    }
+
+    for (const char* p = format; *p && n < limit; ) {
+        if (*p != '%') {
+            line[n++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            line[n++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Specyfikator: flagi, szerokość, precyzja, długość, konwersja
+        const char* spec = p++;
+        while (*p && strchr("-+ #0123456789.lhzjtLq", *p)) {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        char conversion = *p++;
+
+        int written = formatArg(line + n, LINE_MAX - n, spec, p - 1 - spec, conversion, arg, end);
+        if (written > 0) {
+            n = min((uint16_t)(n + written), limit);
+        }
+    }
+
+    line[n++] = '\r';
+    line[n++] = '\n';
+    return n;
+}
+
+static uint16_t buildFrame(uint8_t* frame, uint8_t tag, uint32_t id, uint32_t stampUs, const uint8_t* payload, uint8_t length) {
+    uint16_t n = 0;
+    frame[n++] = FRAME_SYNC0;
+    frame[n++] = FRAME_SYNC1;
+    frame[n++] = length;
+    frame[n++] = tag;
+    memcpy(frame + n, &id, 4);
+    n += 4;
+    memcpy(frame + n, &stampUs, 4);
+    n += 4;
+    memcpy(frame + n, payload, length);
+    n += length;
+
+    uint8_t sum = 0;
+    for (uint16_t i = 2; i < n; i++) {
+        sum += frame[i];
+    }
+    frame[n++] = sum;
+    return n;
+}
+
+// Wysłanie linii albo ramki; bez czekania zwraca false, gdy bufor UART jest za mały
+static bool emit(uint8_t tag, uint32_t id, const char* format, uint32_t stampUs,
+                 const uint8_t* payload, uint8_t length, bool wait) {
+    static char buffer[LINE_MAX];
+    uint16_t size;
+
+    if (DebugLog::getOutput() == DebugLog::OUTPUT_BINARY) {
+        size = buildFrame((uint8_t*)buffer, tag, id, stampUs, payload, length);
+    } else {
+        size = formatLine(buffer, tag, format, payload, length);
+    }
+
+    if (!wait && output->availableForWrite() < size) {
+        return false;
+    }
+    output->write((const uint8_t*)buffer, size);
+    return true;
+}
+
+// Wspólna pętla konsumenta; wywoływana pod consumerBusy
+static bool drainRecords(bool wait, uint32_t deadlineMs) {
+    // Zgubione wpisy zgłaszane jednym wpisem zastępczym
+    uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped) {
+        uint8_t payload[5];
+        uint32_t lost = dropped - reportedDropped;
+        payload[0] = DebugLog::ARG_UINT;
+        memcpy(payload + 1, &lost, 4);
+        if (!emit(DebugLog::TAG_WARN, DebugLog::FORMAT_ID_DROPPED, "Log: pominieto %u wpisow", micros(),
+                  payload, sizeof(payload), wait)) {
+            return false;
+        }
+        reportedDropped = dropped;
+    }
+
+    uint8_t payload[DebugLog::MAX_PAYLOAD];
+    uint32_t tail = ringTail.load(std::memory_order_relaxed);
+    while (tail != ringHead.load(std::memory_order_acquire)) {
+        uint32_t header = __atomic_load_n(&wordAt(tail), __ATOMIC_ACQUIRE);
+        if (!(header & RECORD_COMMITTED)) {
+            break;  // Producent jeszcze pisze - dokończymy przy następnym drain()
+        }
+        if (wait && (int32_t)(millis() - deadlineMs) > 0) {
+            return false;
+        }
+
+        uint8_t length = header & 0xFF;
+        uint8_t tag = (header >> 8) & 0xFF;
+        uint32_t id = wordAt(tail + 4);
+        uint32_t stampUs = wordAt(tail + 8);
+        const char* format;
+        copyOut(tail + RECORD_FORMAT_OFFSET, (uint8_t*)&format, sizeof(format));
+        copyOut(tail + RECORD_HEADER_BYTES, payload, length);
+
+        if (!emit(tag, id, format, stampUs, payload, length, wait)) {
+            return false;
+        }
+
+        uint32_t size = recordBytes(length);
+        clearRecord(tail, size);
+        tail += size;
+        ringTail.store(tail, std::memory_order_release);
+        drainedCount++;
+    }
+    return true;
+}
+
+void DebugLog::drain() {
+    if (output == nullptr || consumerBusy.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+    drainRecords(false, 0);
+    consumerBusy.clear(std::memory_order_release);
+}
+
+void DebugLog::flush(uint32_t timeoutMs) {
+    if (output == nullptr || consumerBusy.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+    drainRecords(true, millis() + timeoutMs);
+    consumerBusy.clear(std::memory_order_release);
+}
+
+DebugLog::Stats DebugLog::getStats() {
+    Stats stats;
+    stats.written = writtenCount.load(std::memory_order_relaxed);
+    stats.dropped = droppedCount.load(std::memory_order_relaxed);
+    stats.drained = drainedCount;
+    stats.maxUsed = maxUsedBytes.load(std::memory_order_relaxed);
+    stats.capacity = DEBUG_LOG_RING_BYTES;
+    return stats;
+}
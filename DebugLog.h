@@ -0,0 +1,235 @@
+#ifndef DEBUG_LOG_H
+#define DEBUG_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+// Odroczone logowanie binarne dla makr DEBUG_* (DebugUtils.h).
+//
+// Wywołanie makra nie formatuje tekstu i nie czeka na UART: zapisuje do pierścienia
+// w RAM identyfikator formatu (FNV-1a z tekstu formatu, liczony przez kompilator),
+// znacznik czasu w us i surowe argumenty z jednobajtowym typem. Napisy są kopiowane
+// (najwyżej MAX_STRING bajtów), bo wskaźnik do String może nie przeżyć do wysłania.
+// Zapis do pierścienia to jedna pętla CAS na indeksie głowy, bez blokad - można
+// go wołać z przerwań, callbacków BLE i z obu rdzeni naraz.
+//
+// Pierścień opróżnia drain() w czasie bezczynności harmonogramów, tylko tyle,
+// ile zmieści się w buforze nadawczym UART. Wyjście tekstowe wygląda jak dawniej
+// ("[INFO] ..."), wyjście binarne dekoduje na PC tools/debuglog_decode.py ze
+// słownikiem formatów zbudowanym ze źródeł.
+//
+// Poziomy włącza się w czasie działania, osobno dla każdej kategorii
+// (setLevel, /api/log), zamiast przełącznikami DEBUG_*_ENABLED.
+class DebugLog {
+public:
+    // Kategorie filtrowane osobno
+    enum Category : uint8_t {
+        CATEGORY_SYSTEM = 0,
+        CATEGORY_LIGHT,
+        CATEGORY_TEMP,
+        CATEGORY_BLE,
+        CATEGORY_COUNT
+    };
+
+    // Wpis przechodzi, gdy jego poziom <= poziom kategorii
+    enum Level : uint8_t {
+        LEVEL_OFF = 0,
+        LEVEL_ERROR,
+        LEVEL_WARN,
+        LEVEL_INFO,
+        LEVEL_DETAIL
+    };
+
+    // Makra DEBUG_* - każde ma kategorię, poziom i prefiks tekstowy
+    enum Tag : uint8_t {
+        TAG_ERROR = 0,
+        TAG_WARN,
+        TAG_INFO,
+        TAG_LIGHT,
+        TAG_TEMP,
+        TAG_BLE,
+        TAG_DETAIL,
+        TAG_COUNT
+    };
+
+    // Typy argumentów zapisane przed wartością
+    enum ArgType : uint8_t {
+        ARG_INT = 'i',     // int32
+        ARG_UINT = 'u',    // uint32
+        ARG_INT64 = 'q',
+        ARG_UINT64 = 'Q',
+        ARG_FLOAT = 'f',   // float (4 B)
+        ARG_DOUBLE = 'd',  // double (8 B)
+        ARG_STRING = 's'   // Długość (1 B) i bajty bez zera
+    };
+
+    enum Output : uint8_t {
+        OUTPUT_TEXT = 0,   // Sformatowane linie jak dawne Serial.printf
+        OUTPUT_BINARY      // Ramki dla tools/debuglog_decode.py
+    };
+
+    static const uint8_t MAX_PAYLOAD = 112;  // Argumenty jednego wpisu
+    static const uint8_t MAX_STRING = 48;    // Najdłuższy kopiowany napis
+    static const uint32_t FORMAT_ID_DROPPED = 0;  // Wpis zastępczy: liczba zgubionych wpisów
+
+    // Identyfikator formatu: FNV-1a 32 bit po bajtach tekstu (ten sam w dekoderze)
+    static constexpr uint32_t formatId(const char* s, uint32_t hash = 2166136261u) {
+        return *s ? formatId(s + 1, (hash ^ (uint8_t)*s) * 16777619u) : hash;
+    }
+
+    struct Stats {
+        uint32_t written;    // Wpisy zapisane do pierścienia
+        uint32_t dropped;    // Wpisy odrzucone przy pełnym pierścieniu
+        uint32_t drained;    // Wpisy wysłane
+        uint32_t maxUsed;    // Największe zapełnienie pierścienia [B]
+        uint32_t capacity;
+    };
+
+    // Wyjście logów; do wywołania begin() wpisy czekają w pierścieniu
+    static void begin(HardwareSerial& serial);
+
+    static bool enabled(Tag tag) {
+        return TAG_LEVEL[tag] <= levels[TAG_CATEGORY[tag]];
+    }
+
+    static void setLevel(Category category, Level level);
+    static Level getLevel(Category category) { return (Level)levels[category]; }
+    static const char* getCategoryName(Category category);
+
+    static void setOutput(Output output) { outputMode = output; }
+    static Output getOutput() { return outputMode; }
+
+    // Bez odroczenia każdy wpis jest wysyłany od razu (setup, przed harmonogramem)
+    static void setDeferred(bool deferred) { deferredMode = deferred; }
+
+    // Wysyła wpisy, które mieszczą się w buforze UART; nie blokuje.
+    // Jeden konsument naraz - wywołanie z drugiego rdzenia wraca od razu.
+    static void drain();
+
+    // Wysyła wszystko, czekając na UART (przed uśpieniem, na końcu setup)
+    static void flush(uint32_t timeoutMs = 1000);
+
+    static Stats getStats();
+
+    // Zapis wpisu - wołany przez makra DEBUG_*
+    template <typename... Args>
+    static void write(Tag tag, uint32_t id, const char* format, const Args&... args) {
+        Encoder encoder;
+        encodeAll(encoder, args...);
+        commit(tag, id, format, encoder.data, encoder.length);
+    }
+
+private:
+    static const uint8_t TAG_CATEGORY[TAG_COUNT];
+    static const uint8_t TAG_LEVEL[TAG_COUNT];
+
+    static uint8_t levels[CATEGORY_COUNT];
+    static volatile Output outputMode;
+    static volatile bool deferredMode;
+
+    struct Encoder {
+        uint8_t data[MAX_PAYLOAD];
+        uint8_t length;
+
+        Encoder() : length(0) {}
+
+        void put(uint8_t type, const void* value, uint8_t size) {
+            if (length + 1 + size > MAX_PAYLOAD) {
+                length = MAX_PAYLOAD;  // Dalsze argumenty przepadają
+                return;
+            }
+            data[length++] = type;
+            memcpy(data + length, value, size);
+            length += size;
+        }
+
+        // maxLength - rozmiar tablicy, gdy znany (strnlen nie czyta poza nią)
+        void putString(const char* s, size_t maxLength = MAX_STRING) {
+            size_t n = s ? strnlen(s, maxLength) : 0;
+            if (length + 2 > MAX_PAYLOAD) {
+                length = MAX_PAYLOAD;
+                return;
+            }
+            if (n > (size_t)(MAX_PAYLOAD - length - 2)) {
+                n = MAX_PAYLOAD - length - 2;
+            }
+            data[length++] = ARG_STRING;
+            data[length++] = (uint8_t)n;
+            memcpy(data + length, s, n);
+            length += n;
+        }
+    };
+
+    static void encodeAll(Encoder&) {}
+
+    // Argumenty przez referencję (bez kopii String); tablice char mają własne encode() z limitem N
+    template <typename T, typename... Rest>
+    static void encodeAll(Encoder& encoder, const T& value, const Rest&... rest) {
+        encode(encoder, value);
+        encodeAll(encoder, rest...);
+    }
+
+    // Liczby całkowite, bool i enum - int32/uint32 albo 64 bit
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value>::type
+    encode(Encoder& encoder, T value) {
+        if (sizeof(T) > 4) {
+            if (std::is_signed<T>::value) {
+                int64_t v = (int64_t)value;
+                encoder.put(ARG_INT64, &v, sizeof(v));
+            } else {
+                uint64_t v = (uint64_t)value;
+                encoder.put(ARG_UINT64, &v, sizeof(v));
+            }
+        } else if (std::is_signed<T>::value) {
+            int32_t v = (int32_t)value;
+            encoder.put(ARG_INT, &v, sizeof(v));
+        } else {
+            uint32_t v = (uint32_t)value;
+            encoder.put(ARG_UINT, &v, sizeof(v));
+        }
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type
+    encode(Encoder& encoder, T value) {
+        int32_t v = (int32_t)value;
+        encoder.put(ARG_INT, &v, sizeof(v));
+    }
+
+    static void encode(Encoder& encoder, float value) {
+        encoder.put(ARG_FLOAT, &value, sizeof(value));
+    }
+
+    static void encode(Encoder& encoder, double value) {
+        encoder.put(ARG_DOUBLE, &value, sizeof(value));
+    }
+
+    // Napisy kopiowane; inne wskaźniki jako liczba (%p, %x)
+    template <typename T>
+    static typename std::enable_if<std::is_pointer<T>::value>::type
+    encode(Encoder& encoder, T value) {
+        typedef typename std::remove_cv<typename std::remove_pointer<T>::type>::type Pointee;
+        if (std::is_same<Pointee, char>::value) {
+            encoder.putString((const char*)value);
+        } else {
+            uint32_t v = (uint32_t)(uintptr_t)value;
+            encoder.put(ARG_UINT, &v, sizeof(v));
+        }
+    }
+
+    // Tablice char (bufory snprintf, literały) - limit z rozmiaru tablicy
+    template <size_t N>
+    static void encode(Encoder& encoder, const char (&value)[N]) {
+        encoder.putString(value, N < MAX_STRING ? N : MAX_STRING);
+    }
+
+    static void encode(Encoder& encoder, const String& value) {
+        encoder.putString(value.c_str());
+    }
+
+    static void commit(Tag tag, uint32_t id, const char* format, const uint8_t* payload, uint8_t length);
+};
+
+#endif // DEBUG_LOG_H
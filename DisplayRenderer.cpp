@@ -0,0 +1,336 @@
+#include "DisplayRenderer.h"
+#include "Profiler.h"
+
+DisplayRenderer::DisplayRenderer(U8G2& display) :
+    display(display),
+    widgetCount(0),
+    staticLayer(nullptr),
+    fullRedraw(true),
+    flushTask(nullptr),
+    idle(nullptr),
+    frameIntervalMs(0),
+    lastFrameMs(0),
+    widgetRedraws(0),
+    fullFrames(0),
+    deferredFrames(0),
+    stallFrames(0),
+    stallSumUs(0),
+    maxStallUs(0),
+    statsStartMs(0),
+    flushedBytes(0),
+    flushedFrames(0),
+    flushSumUs(0),
+    maxFlushUs(0),
+    lastFlushedBytes(0),
+    lastFlushedFrames(0),
+    lastFlushSumUs(0)
+{
+    memset(dirtyTiles, 0, sizeof(dirtyTiles));
+    memset(frameTiles, 0, sizeof(frameTiles));
+    memset(frame, 0, sizeof(frame));
+}
+
+bool DisplayRenderer::startFlushTask(uint8_t core, UBaseType_t priority) {
+    if (flushTask != nullptr) {
+        return true;
+    }
+
+    idle = xSemaphoreCreateBinary();
+    if (idle == nullptr) {
+        DEBUG_ERROR("Brak pamieci na semafor wyswietlacza");
+        return false;
+    }
+    xSemaphoreGive(idle);
+
+    if (xTaskCreatePinnedToCore(flushTaskEntry, "oledFlush", DISPLAY_FLUSH_TASK_STACK, this,
+                                priority, &flushTask, core) != pdPASS) {
+        flushTask = nullptr;
+        DEBUG_ERROR("Nie udalo sie uruchomic zadania zapisu OLED");
+        return false;
+    }
+    return true;
+}
+
+void DisplayRenderer::flushTaskEntry(void* arg) {
+    DisplayRenderer* self = static_cast<DisplayRenderer*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->flushFrame();
+        xSemaphoreGive(self->idle);
+    }
+}
+
+bool DisplayRenderer::addWidget(const char* name, Rect rect, SignatureFn signature, DrawFn draw) {
+    if (widgetCount >= MAX_WIDGETS) {
+        DEBUG_ERROR("Brak miejsca na widget %s", name);
+        return false;
+    }
+
+    Widget& w = widgets[widgetCount++];
+    w.name = name;
+    w.rect = rect;
+    w.signature = signature;
+    w.draw = draw;
+    w.lastSignature = 0;
+    fullRedraw = true;
+    return true;
+}
+
+void DisplayRenderer::setMaxFps(uint8_t fps) {
+    frameIntervalMs = fps > 0 ? 1000 / fps : 0;
+}
+
+bool DisplayRenderer::frameDue() {
+    unsigned long now = millis();
+    if (frameIntervalMs > 0 && now - lastFrameMs < frameIntervalMs) {
+        return false;
+    }
+    lastFrameMs = now;
+    return true;
+}
+
+bool DisplayRenderer::intersects(const Rect& a, const Rect& b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w &&
+           a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void DisplayRenderer::redrawRegion(const Rect& region) {
+    display.setClipWindow(region.x, region.y, region.x + region.w, region.y + region.h);
+
+    display.setDrawColor(0);
+    display.drawBox(region.x, region.y, region.w, region.h);
+    display.setDrawColor(1);
+
+    // Sąsiednie widżety mogą zachodzić na czyszczony obszar - dorysuj ich fragmenty
+    for (uint8_t i = 0; i < widgetCount; i++) {
+        if (intersects(widgets[i].rect, region)) {
+            widgets[i].draw();
+        }
+    }
+
+    // Linie na końcu, żeby tło czcionek ich nie zamazało
+    if (staticLayer) {
+        staticLayer();
+    }
+
+    display.setMaxClipWindow();
+    markTiles(region);
+}
+
+void DisplayRenderer::markTiles(const Rect& rect) {
+    uint8_t firstCol = rect.x / 8;
+    uint8_t lastCol = (rect.x + rect.w - 1) / 8;
+    uint8_t firstRow = rect.y / 8;
+    uint8_t lastRow = (rect.y + rect.h - 1) / 8;
+
+    if (lastCol >= TILE_COLS) lastCol = TILE_COLS - 1;
+    if (lastRow >= TILE_ROWS) lastRow = TILE_ROWS - 1;
+
+    uint16_t mask = (uint16_t)(((1UL << (lastCol + 1)) - 1) & ~((1UL << firstCol) - 1));
+    for (uint8_t row = firstRow; row <= lastRow; row++) {
+        dirtyTiles[row] |= mask;
+    }
+}
+
+void DisplayRenderer::markAllTiles() {
+    for (uint8_t row = 0; row < TILE_ROWS; row++) {
+        dirtyTiles[row] = (uint16_t)((1UL << TILE_COLS) - 1);
+    }
+}
+
+bool DisplayRenderer::submit(uint32_t waitMs) {
+    bool any = false;
+    for (uint8_t row = 0; row < TILE_ROWS; row++) {
+        if (dirtyTiles[row]) any = true;
+    }
+    if (!any) {
+        return false;
+    }
+
+    // Poprzednia klatka jeszcze w drodze - kafle zostają brudne do następnej
+    if (flushTask != nullptr && xSemaphoreTake(idle, pdMS_TO_TICKS(waitMs)) != pdTRUE) {
+        deferredFrames++;
+        return false;
+    }
+
+    // Kopiowane całe wiersze z brudnymi kaflami - 128 B na wiersz
+    const uint8_t* buffer = display.getBufferPtr();
+    const uint16_t rowBytes = TILE_COLS * 8;
+    for (uint8_t row = 0; row < TILE_ROWS; row++) {
+        frameTiles[row] = dirtyTiles[row];
+        if (dirtyTiles[row]) {
+            memcpy(frame + row * rowBytes, buffer + row * rowBytes, rowBytes);
+        }
+        dirtyTiles[row] = 0;
+    }
+
+    if (flushTask != nullptr) {
+        xTaskNotifyGive(flushTask);
+    } else {
+        flushFrame();
+    }
+    return true;
+}
+
+void DisplayRenderer::flushFrame() {
+    PROFILE_SCOPE(PERF_DISPLAY_FLUSH);
+    uint32_t startUs = micros();
+    uint32_t bytes = 0;
+    u8x8_t* u8x8 = display.getU8x8();
+
+    for (uint8_t row = 0; row < TILE_ROWS; row++) {
+        uint16_t mask = frameTiles[row];
+        if (!mask) continue;
+
+        uint8_t col = 0;
+        uint8_t* rowPtr = frame + row * TILE_COLS * 8;
+
+        // Blokada na wiersz - odczyt RTC nie czeka na całą klatkę
+        I2cBus::lock();
+        // Wysyłaj ciągłe odcinki kafli w wierszu jednym wywołaniem
+        while (mask) {
+            while (!(mask & 1)) {
+                mask >>= 1;
+                col++;
+            }
+            uint8_t start = col;
+            while (mask & 1) {
+                mask >>= 1;
+                col++;
+            }
+            u8x8_DrawTile(u8x8, start, row, col - start, rowPtr + start * 8);
+            bytes += (col - start) * 8;
+        }
+        I2cBus::unlock();
+        frameTiles[row] = 0;
+    }
+
+    uint32_t elapsedUs = micros() - startUs;
+    flushedBytes += bytes;
+    flushedFrames++;
+    flushSumUs += elapsedUs;
+    if (elapsedUs > maxFlushUs) maxFlushUs = elapsedUs;
+}
+
+void DisplayRenderer::recordStall(uint32_t startUs) {
+    uint32_t stallUs = micros() - startUs;
+    stallFrames++;
+    stallSumUs += stallUs;
+    if (stallUs > maxStallUs) maxStallUs = stallUs;
+}
+
+bool DisplayRenderer::render() {
+    if (!frameDue()) {
+        return false;
+    }
+
+    uint32_t startUs = micros();
+
+    if (fullRedraw) {
+        // Pełne przerysowanie: cały bufor od nowa, wszystkie sygnatury zapamiętane
+        display.clearBuffer();
+        for (uint8_t i = 0; i < widgetCount; i++) {
+            widgets[i].lastSignature = widgets[i].signature();
+            widgets[i].draw();
+        }
+        if (staticLayer) {
+            staticLayer();
+        }
+        markAllTiles();
+        fullFrames++;
+        widgetRedraws += widgetCount;
+        fullRedraw = false;
+    } else {
+        for (uint8_t i = 0; i < widgetCount; i++) {
+            uint32_t sig = widgets[i].signature();
+            if (sig != widgets[i].lastSignature) {
+                widgets[i].lastSignature = sig;
+                redrawRegion(widgets[i].rect);
+                widgetRedraws++;
+            }
+        }
+    }
+
+    bool sent = submit(0);
+    recordStall(startUs);
+    return sent;
+}
+
+bool DisplayRenderer::renderFullScreen(DrawFn draw) {
+    if (!frameDue()) {
+        return false;
+    }
+
+    uint32_t startUs = micros();
+
+    display.clearBuffer();
+    draw();
+    markAllTiles();
+    fullFrames++;
+
+    // Po powrocie do widżetów ekran trzeba zbudować od nowa
+    fullRedraw = true;
+
+    bool sent = submit(0);
+    recordStall(startUs);
+    return sent;
+}
+
+void DisplayRenderer::present() {
+    uint32_t startUs = micros();
+
+    markAllTiles();
+    fullFrames++;
+    submit(DISPLAY_FLUSH_WAIT_MS);
+    recordStall(startUs);
+}
+
+bool DisplayRenderer::waitIdle(uint32_t timeoutMs) {
+    if (flushTask == nullptr) {
+        return true;
+    }
+    if (xSemaphoreTake(idle, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) {
+        return false;
+    }
+    xSemaphoreGive(idle);
+    return true;
+}
+
+DisplayRenderer::Stats DisplayRenderer::collectStats() {
+    Stats stats;
+    unsigned long now = millis();
+
+    // Liczniki zadania zapisu czytane raz - mogą rosnąć w trakcie
+    uint32_t bytes = flushedBytes;
+    uint32_t frames = flushedFrames;
+    uint32_t flushUs = flushSumUs;
+    uint32_t windowBytes = bytes - lastFlushedBytes;
+    uint32_t windowFrames = frames - lastFlushedFrames;
+    uint32_t windowFlushUs = flushUs - lastFlushSumUs;
+
+    stats.windowMs = now - statsStartMs;
+    stats.bytesPerSec = stats.windowMs > 0 ? (uint32_t)((uint64_t)windowBytes * 1000 / stats.windowMs) : 0;
+    stats.flushesPerSec = stats.windowMs > 0 ? (uint32_t)((uint64_t)windowFrames * 1000 / stats.windowMs) : 0;
+    stats.widgetRedraws = widgetRedraws;
+    stats.fullFrames = fullFrames;
+    stats.deferredFrames = deferredFrames;
+    stats.avgStallUs = stallFrames > 0 ? (uint32_t)(stallSumUs / stallFrames) : 0;
+    stats.maxStallUs = maxStallUs;
+    stats.avgFlushUs = windowFrames > 0 ? windowFlushUs / windowFrames : 0;
+    stats.maxFlushUs = maxFlushUs;
+    stats.async = flushTask != nullptr;
+
+    lastFlushedBytes = bytes;
+    lastFlushedFrames = frames;
+    lastFlushSumUs = flushUs;
+    maxFlushUs = 0;  // Wyścig z zadaniem zapisu może zgubić jedno maksimum - tylko diagnostyka
+    widgetRedraws = 0;
+    fullFrames = 0;
+    deferredFrames = 0;
+    stallFrames = 0;
+    stallSumUs = 0;
+    maxStallUs = 0;
+    statsStartMs = now;
+
+    return stats;
+}
@@ -0,0 +1,175 @@
+#ifndef DISPLAY_RENDERER_H
+#define DISPLAY_RENDERER_H
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "DebugUtils.h"
+#include "I2cBus.h"
+
+// Potok renderowania OLED z odświeżaniem tylko zmienionych obszarów.
+// Każdy widżet ma prostokąt na ekranie, funkcję sygnatury (skrót wartości
+// wejściowych) i funkcję rysującą. Widżet jest przerysowywany tylko wtedy,
+// gdy zmieni się jego sygnatura, a przez I2C wysyłane są tylko brudne kafle 8x8.
+//
+// Podwójne buforowanie: pętla rysuje w buforze U8g2, a gotowe wiersze kafli
+// kopiuje do drugiego bufora (frame) i budzi zadanie zapisu, które wysyła je przez
+// u8x8_DrawTile. Pętla nie czeka więc na I2C (pełna klatka przy 400 kHz to ok.
+// 25 ms). Gdy zadanie jeszcze wysyła poprzednią klatkę, brudne kafle czekają
+// w buforze U8g2 do następnej klatki - nic nie ginie, najwyżej spada liczba klatek.
+// Bez zadania (DISPLAY_ASYNC_FLUSH 0 albo przed startFlushTask) zapis jest
+// synchroniczny, jak wcześniej - porównanie "stall" obu trybów to jedna flaga.
+
+#ifndef DISPLAY_ASYNC_FLUSH
+#define DISPLAY_ASYNC_FLUSH 1
+#endif
+
+#define DISPLAY_FLUSH_TASK_STACK 3072
+#define DISPLAY_FLUSH_WAIT_MS 100     // present(): najdłuższe czekanie na wolny bufor
+
+class DisplayRenderer {
+public:
+    static const uint8_t MAX_WIDGETS = 8;
+    static const uint8_t TILE_ROWS = 8;   // 64 px / 8
+    static const uint8_t TILE_COLS = 16;  // 128 px / 8
+    static const uint16_t FRAME_BYTES = TILE_ROWS * TILE_COLS * 8;
+
+    typedef uint32_t (*SignatureFn)();
+    typedef void (*DrawFn)();
+
+    struct Rect {
+        uint8_t x;
+        uint8_t y;
+        uint8_t w;
+        uint8_t h;
+    };
+
+    // Skrót FNV-1a do budowania sygnatur widżetów
+    class Signature {
+    public:
+        Signature() : hash(2166136261UL) {}
+        Signature& add(uint32_t value) {
+            for (uint8_t i = 0; i < 4; i++) {
+                hash = (hash ^ (value & 0xFF)) * 16777619UL;
+                value >>= 8;
+            }
+            return *this;
+        }
+        Signature& add(const char* str) {
+            while (*str) {
+                hash = (hash ^ (uint8_t)*str++) * 16777619UL;
+            }
+            hash = hash * 16777619UL;  // Separator między kolejnymi napisami
+            return *this;
+        }
+        uint32_t value() const { return hash; }
+    private:
+        uint32_t hash;
+    };
+
+    struct Stats {
+        uint32_t windowMs;        // Długość okna pomiarowego
+        uint32_t bytesPerSec;     // Bajty danych obrazu wysłane przez I2C na sekundę
+        uint32_t flushesPerSec;   // Wysłane klatki (częściowe lub pełne) na sekundę
+        uint32_t widgetRedraws;   // Przerysowania widżetów w oknie
+        uint32_t fullFrames;      // Pełne klatki w oknie
+        uint32_t deferredFrames;  // Klatki odłożone, bo zadanie zapisu było zajęte
+        uint32_t avgStallUs;      // Czas pętli w render()/present() na klatkę
+        uint32_t maxStallUs;
+        uint32_t avgFlushUs;      // Czas wysyłania klatki przez I2C
+        uint32_t maxFlushUs;
+        bool async;
+    };
+
+    DisplayRenderer(U8G2& display);
+
+    // Zadanie zapisu przez I2C; do tego czasu klatki wysyłane są synchronicznie
+    bool startFlushTask(uint8_t core, UBaseType_t priority);
+    TaskHandle_t getFlushTask() const { return flushTask; }
+
+    // Rejestracja widżetu; zwraca false gdy brak miejsca
+    bool addWidget(const char* name, Rect rect, SignatureFn signature, DrawFn draw);
+
+    // Elementy stałe (linie podziału) dorysowywane w każdym czyszczonym obszarze
+    void setStaticLayer(DrawFn draw) { staticLayer = draw; }
+
+    // Limit klatek na sekundę (0 = bez limitu)
+    void setMaxFps(uint8_t fps);
+
+    // Wymusza pełne przerysowanie przy następnej klatce - wołać po każdym
+    // komunikacie, który nadpisał cały ekran poza potokiem
+    void invalidate() { fullRedraw = true; }
+
+    // Przerysowuje zmienione widżety i wysyła brudne kafle.
+    // Zwraca true, gdy cokolwiek zostało wysłane.
+    bool render();
+
+    // Klatka pełnoekranowa poza układem widżetów (np. tryb prowadzenia roweru),
+    // z tym samym limitem klatek
+    bool renderFullScreen(DrawFn draw);
+
+    // Wysłanie całego bufora U8g2 narysowanego poza potokiem (zamiast sendBuffer);
+    // czeka najwyżej DISPLAY_FLUSH_WAIT_MS na zakończenie poprzedniej klatki
+    void present();
+
+    // Czekanie na wysłanie ostatniej klatki (przed uśpieniem OLED)
+    bool waitIdle(uint32_t timeoutMs);
+
+    // Statystyki bieżącego okna; rozpoczyna nowe okno
+    Stats collectStats();
+
+private:
+    struct Widget {
+        const char* name;
+        Rect rect;
+        SignatureFn signature;
+        DrawFn draw;
+        uint32_t lastSignature;
+    };
+
+    U8G2& display;
+    Widget widgets[MAX_WIDGETS];
+    uint8_t widgetCount;
+    DrawFn staticLayer;
+
+    uint16_t dirtyTiles[TILE_ROWS];  // Bit = kolumna kafla do wysłania
+    bool fullRedraw;
+
+    // Drugi bufor i kafle do wysłania - własność zadania zapisu od submit()
+    // do oddania semafora idle
+    uint8_t frame[FRAME_BYTES];
+    uint16_t frameTiles[TILE_ROWS];
+    TaskHandle_t flushTask;
+    SemaphoreHandle_t idle;
+
+    uint16_t frameIntervalMs;
+    unsigned long lastFrameMs;
+
+    uint32_t widgetRedraws;
+    uint32_t fullFrames;
+    uint32_t deferredFrames;
+    uint32_t stallFrames;
+    uint64_t stallSumUs;
+    uint32_t maxStallUs;
+    unsigned long statsStartMs;
+
+    // Liczniki zadania zapisu - tylko rosną; statystyki liczą różnice
+    volatile uint32_t flushedBytes;
+    volatile uint32_t flushedFrames;
+    volatile uint32_t flushSumUs;
+    volatile uint32_t maxFlushUs;
+    uint32_t lastFlushedBytes;
+    uint32_t lastFlushedFrames;
+    uint32_t lastFlushSumUs;
+
+    bool frameDue();
+    static bool intersects(const Rect& a, const Rect& b);
+    void redrawRegion(const Rect& region);
+    void markTiles(const Rect& rect);
+    void markAllTiles();
+    bool submit(uint32_t waitMs);
+    void flushFrame();
+    void recordStall(uint32_t startUs);
+    static void flushTaskEntry(void* arg);
+};
+
+#endif // DISPLAY_RENDERER_H
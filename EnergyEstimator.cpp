@@ -0,0 +1,97 @@
+#include "EnergyEstimator.h"
+
+EnergyEstimator::EnergyEstimator() :
+    state(defaultState()),
+    hasSample(false),
+    lastStampUs(0),
+    lastPowerW(0)
+{
+}
+
+EnergyState EnergyEstimator::defaultState() {
+    EnergyState defaults;
+    memset(&defaults, 0, sizeof(defaults));
+    return defaults;
+}
+
+void EnergyEstimator::addSample(uint32_t stampUs, float voltage, float current) {
+    float powerW = voltage * current;
+
+    if (hasSample) {
+        uint32_t dtUs = stampUs - lastStampUs;
+        if (dtUs > 0 && dtUs <= ENERGY_MAX_GAP_US) {
+            // Trapez między poprzednią a bieżącą próbką
+            addEnergy((lastPowerW + powerW) * 0.5f * dtUs / 3600000000.0f);
+        }
+    }
+
+    hasSample = true;
+    lastStampUs = stampUs;
+    lastPowerW = powerW;
+}
+
+void EnergyEstimator::addEnergy(float wh) {
+    state.tripWh += wh;
+    state.totalWh += wh;
+    state.currentWh += wh;
+}
+
+void EnergyEstimator::addDistance(float km) {
+    if (km <= 0) return;
+
+    state.tripKm += km;
+    state.currentKm += km;
+
+    // Zwykle najwyżej jeden pełny km na wywołanie; dłuższy odcinek (np. po przerwie
+    // w ramkach) rozkładany jest równo na kolejne kilometry
+    while (state.currentKm >= 1.0f) {
+        closeKilometer();
+    }
+}
+
+void EnergyEstimator::closeKilometer() {
+    // Energia ponad pełny km przechodzi proporcjonalnie do kolejnego
+    float overflowKm = state.currentKm - 1.0f;
+    float kmWh = state.currentWh / state.currentKm;
+    float overflowWh = kmWh * overflowKm;
+    float fullWh = state.currentWh - overflowWh;
+
+    uint8_t slot = state.bucketHead;
+    if (state.bucketCount == ENERGY_ROLLING_KM) {
+        state.rollingWh -= state.bucketWh[slot];
+    } else {
+        state.bucketCount++;
+    }
+    state.bucketWh[slot] = fullWh;
+    state.rollingWh += fullWh;
+    state.bucketHead = (slot + 1) % ENERGY_ROLLING_KM;
+
+    state.currentWh = overflowWh;
+    state.currentKm = overflowKm;
+}
+
+void EnergyEstimator::resetTrip() {
+    state.tripWh = 0;
+    state.tripKm = 0;
+}
+
+float EnergyEstimator::getTripWhPerKm() const {
+    return (state.tripKm > 0.05f) ? state.tripWh / state.tripKm : 0;
+}
+
+float EnergyEstimator::getRollingWhPerKm() const {
+    float km = state.bucketCount + state.currentKm;
+    return (km > 0.05f) ? (state.rollingWh + state.currentWh) / km : 0;
+}
+
+float EnergyEstimator::getWhPerKm() const {
+    float km = state.bucketCount + state.currentKm;
+    float priorKm = max(ENERGY_PRIOR_KM - km, 0.0f);
+    float wh = state.rollingWh + state.currentWh + ENERGY_DEFAULT_WH_PER_KM * priorKm;
+    return max(wh / (km + priorKm), ENERGY_MIN_WH_PER_KM);
+}
+
+float EnergyEstimator::estimateRangeKm(float remainingWh) const {
+    if (remainingWh <= 0) return 0;
+    return remainingWh / getWhPerKm();
+}
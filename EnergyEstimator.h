@@ -0,0 +1,73 @@
+#ifndef ENERGY_ESTIMATOR_H
+#define ENERGY_ESTIMATOR_H
+
+#include <Arduino.h>
+
+// Zużycie energii i zasięg.
+//
+// Moc (napięcie x prąd) całkowana jest metodą trapezów po znacznikach czasu próbek.
+// Energia przypisywana jest do przejechanych kilometrów: pełne kilometry trafiają do
+// bufora ENERGY_ROLLING_KM ostatnich, z sumą aktualizowaną w O(1). Zużycie Wh/km do
+// zasięgu to średnia z bufora i bieżącego kilometra. Bufor jest częścią stanu
+// (EnergyState - sekcja magazynu ustawień), więc po uśpieniu zasięg liczony jest od razu
+// z ostatnich przejechanych km. Przy pustym buforze (pierwsze uruchomienie) średnia
+// uzupełniana jest wartością domyślną z wagą malejącą do zera po ENERGY_PRIOR_KM.
+
+#define ENERGY_ROLLING_KM 10
+#define ENERGY_DEFAULT_WH_PER_KM 12.0f
+#define ENERGY_PRIOR_KM 2.0f
+#define ENERGY_MIN_WH_PER_KM 2.0f      // Dolna granica do zasięgu (zjazdy, rekuperacja)
+#define ENERGY_MAX_GAP_US 2000000UL    // Dłuższa przerwa między próbkami - bez całkowania
+
+struct EnergyState {
+    float tripWh;                        // Energia w bieżącym przejeździe
+    float tripKm;
+    float totalWh;                       // Energia od pierwszego uruchomienia
+    float bucketWh[ENERGY_ROLLING_KM];   // Energia kolejnych pełnych kilometrów
+    float rollingWh;                     // Suma bucketWh
+    float currentWh;                     // Bieżący, niepełny kilometr
+    float currentKm;
+    uint8_t bucketHead;
+    uint8_t bucketCount;
+};
+
+class EnergyEstimator {
+public:
+    EnergyEstimator();
+
+    // Stan jako struktura - rejestrowana w magazynie ustawień
+    EnergyState* getStateData() { return &state; }
+    static EnergyState defaultState();
+
+    // Próbka mocy; prąd dodatni = rozładowanie
+    void addSample(uint32_t stampUs, float voltage, float current);
+
+    // Przejechany odcinek (wołać razem z licznikiem przebiegu)
+    void addDistance(float km);
+
+    void resetTrip();
+
+    float getPowerW() const { return lastPowerW; }
+    float getTripWh() const { return state.tripWh; }
+    float getTripKm() const { return state.tripKm; }
+    float getTotalWh() const { return state.totalWh; }
+    float getTripWhPerKm() const;
+    float getRollingWhPerKm() const;   // Tylko bufor i bieżący km; 0 bez danych
+    float getWhPerKm() const;          // Z uwzględnieniem wartości domyślnej - do zasięgu
+    uint8_t getRollingKm() const { return state.bucketCount; }
+
+    // Zasięg dla pozostałej energii baterii
+    float estimateRangeKm(float remainingWh) const;
+
+private:
+    EnergyState state;
+
+    bool hasSample;
+    uint32_t lastStampUs;
+    float lastPowerW;
+
+    void addEnergy(float wh);
+    void closeKilometer();
+};
+
+#endif // ENERGY_ESTIMATOR_H
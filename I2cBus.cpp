@@ -0,0 +1,23 @@
+#include "I2cBus.h"
+
+SemaphoreHandle_t I2cBus::mutex = nullptr;
+
+void I2cBus::begin() {
+    if (mutex == nullptr) {
+        mutex = xSemaphoreCreateMutex();
+    }
+}
+
+bool I2cBus::lock(uint32_t timeoutMs) {
+    if (mutex == nullptr) {
+        return true;  // Przed begin() działa tylko setup
+    }
+    TickType_t ticks = (timeoutMs == WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    return xSemaphoreTake(mutex, ticks) == pdTRUE;
+}
+
+void I2cBus::unlock() {
+    if (mutex != nullptr) {
+        xSemaphoreGive(mutex);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <Arduino.h>
+
+// Wspólna magistrala I2C (OLED i RTC).
+// Obraz wysyła zadanie zapisu wyświetlacza, zegar czyta zadanie usług, a kontrast,
+// uśpienie OLED i ustawianie czasu wołane są z pętli i z serwera WWW - każda
+// transakcja Wire musi być objęta blokadą, żeby nie przeplotła się z inną.
+class I2cBus {
+public:
+    static const uint32_t WAIT_FOREVER = 0xFFFFFFFF;
+
+    // Przed pierwszym użyciem magistrali (setup, przed Wire.begin)
+    static void begin();
+
+    static bool lock(uint32_t timeoutMs = WAIT_FOREVER);
+    static void unlock();
+
+private:
+    static SemaphoreHandle_t mutex;
+};
+
+// Blokada na czas bloku: { I2cBusLock lock; rtc.adjust(...); }
+class I2cBusLock {
+public:
+    I2cBusLock() { I2cBus::lock(); }
+    ~I2cBusLock() { I2cBus::unlock(); }
+
+    I2cBusLock(const I2cBusLock&) = delete;
+    I2cBusLock& operator=(const I2cBusLock&) = delete;
+};
+
+#endif // I2C_BUS_H
@@ -0,0 +1,158 @@
+#include "JbdBms.h"
+
+JbdBms::JbdBms() :
+    state(WAIT_START),
+    command(0),
+    status(0),
+    length(0),
+    received(0),
+    sum(0),
+    checksum(0),
+    lastByteMs(0),
+    framesOk(0),
+    checksumErrors(0),
+    framingErrors(0),
+    bytesDropped(0)
+{
+    memset(&working, 0, sizeof(working));
+}
+
+void JbdBms::reset() {
+    if (state != WAIT_START) {
+        framingErrors++;
+    }
+    state = WAIT_START;
+}
+
+void JbdBms::feed(const uint8_t* data, size_t len) {
+    unsigned long now = millis();
+
+    // Reszta poprzedniej ramki już nie przyjdzie - zaczynamy od nowa
+    if (state != WAIT_START && now - lastByteMs > JBD_FRAME_TIMEOUT_MS) {
+        reset();
+    }
+    lastByteMs = now;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+
+        switch (state) {
+            case WAIT_START:
+                if (byte == JBD_FRAME_START) {
+                    state = WAIT_COMMAND;
+                } else {
+                    bytesDropped++;
+                }
+                break;
+
+            case WAIT_COMMAND:
+                command = byte;
+                state = WAIT_STATUS;
+                break;
+
+            case WAIT_STATUS:
+                status = byte;
+                sum = byte;
+                state = WAIT_LENGTH;
+                break;
+
+            case WAIT_LENGTH:
+                length = byte;
+                received = 0;
+                sum += byte;
+                state = (length > 0) ? READ_DATA : WAIT_CHECKSUM_HI;
+                break;
+
+            case READ_DATA:
+                payload[received++] = byte;
+                sum += byte;
+                if (received == length) {
+                    state = WAIT_CHECKSUM_HI;
+                }
+                break;
+
+            case WAIT_CHECKSUM_HI:
+                checksum = byte << 8;
+                state = WAIT_CHECKSUM_LO;
+                break;
+
+            case WAIT_CHECKSUM_LO:
+                checksum |= byte;
+                state = WAIT_END;
+                break;
+
+            case WAIT_END:
+                state = WAIT_START;
+                if (byte != JBD_FRAME_END) {
+                    framingErrors++;
+                } else if ((uint16_t)(sum + checksum) != 0) {
+                    checksumErrors++;
+                } else {
+                    processFrame();
+                }
+                break;
+        }
+    }
+}
+
+void JbdBms::processFrame() {
+    if (status != 0) {
+        // BMS odrzucił zapytanie
+        framingErrors++;
+        return;
+    }
+
+    switch (command) {
+        case JBD_CMD_BASIC_INFO:
+            if (length < 23) {
+                framingErrors++;
+                return;
+            }
+            decodeBasicInfo();
+            break;
+
+        case JBD_CMD_CELL_INFO:
+            decodeCellInfo();
+            break;
+
+        default:
+            return;  // Nieobsługiwana komenda - poprawna ramka, brak danych do publikacji
+    }
+
+    framesOk++;
+    snapshot.write(working);
+}
+
+// Odpowiedź 0x03 - jednostki według dokumentacji JBD:
+// napięcie 10 mV, prąd 10 mA (ze znakiem), pojemności 10 mAh, temperatury 0.1 K
+void JbdBms::decodeBasicInfo() {
+    working.voltage = payloadWord(0) / 100.0f;
+    working.current = (int16_t)payloadWord(2) / 100.0f;
+    working.remainingCapacity = payloadWord(4) / 100.0f;
+    working.totalCapacity = payloadWord(6) / 100.0f;
+    working.cycles = payloadWord(8);
+    working.soc = payload[19];
+
+    uint8_t fet = payload[20];
+    working.charging = fet & 0x01;
+    working.discharging = fet & 0x02;
+
+    uint8_t ntcCount = payload[22];
+    uint8_t available = (length - 23) / 2;
+    working.tempCount = min(min(ntcCount, available), (uint8_t)JBD_MAX_TEMPS);
+    for (uint8_t i = 0; i < working.tempCount; i++) {
+        working.temperatures[i] = ((int32_t)payloadWord(23 + i * 2) - 2731) / 10.0f;
+    }
+
+    working.basicUpdateMs = millis();
+}
+
+// Odpowiedź 0x04 - napięcia cel w mV, 2 bajty na celę
+void JbdBms::decodeCellInfo() {
+    working.cellCount = min(length / 2, JBD_MAX_CELLS);
+    for (uint8_t i = 0; i < working.cellCount; i++) {
+        working.cellVoltages[i] = payloadWord(i * 2) / 1000.0f;
+    }
+
+    working.cellUpdateMs = millis();
+}
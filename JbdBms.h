@@ -0,0 +1,101 @@
+#ifndef JBD_BMS_H
+#define JBD_BMS_H
+
+#include <Arduino.h>
+#include "DebugUtils.h"
+#include "Seqlock.h"
+
+// Odbiór odpowiedzi BMS JBD (protokół UART przez BLE, charakterystyka 0xFF01).
+//
+// Ramka odpowiedzi:
+//   0xDD | komenda | status | długość N | dane[N] | suma (2 B, big-endian) | 0x77
+// suma = 0x10000 - (status + N + suma bajtów danych)
+//
+// Przy MTU 20 B odpowiedź przychodzi w kilku powiadomieniach - składanie ramki
+// odbywa się bajt po bajcie, bez sterty, a gotowe dane trafiają do migawki Seqlock.
+
+#define JBD_FRAME_START 0xDD
+#define JBD_FRAME_END 0x77
+#define JBD_CMD_BASIC_INFO 0x03
+#define JBD_CMD_CELL_INFO 0x04
+#define JBD_MAX_CELLS 16
+#define JBD_MAX_TEMPS 4
+#define JBD_FRAME_TIMEOUT_MS 500   // Przerwa, po której niedokończona ramka jest porzucana
+
+struct BmsData {
+    float voltage;            // Napięcie całkowite [V]
+    float current;            // Prąd [A]
+    float remainingCapacity;  // Pozostała pojemność [Ah]
+    float totalCapacity;      // Całkowita pojemność [Ah]
+    uint8_t soc;              // Stan naładowania [%]
+    uint16_t cycles;          // Liczba cykli
+    uint8_t cellCount;        // Liczba cel w ostatniej odpowiedzi
+    uint8_t tempCount;        // Liczba czujników temperatury
+    float cellVoltages[JBD_MAX_CELLS];  // Napięcia cel [V]
+    float temperatures[JBD_MAX_TEMPS];  // Temperatury [°C]
+    bool charging;            // Status ładowania (MOSFET)
+    bool discharging;         // Status rozładowania (MOSFET)
+    unsigned long basicUpdateMs;  // Czas ostatniej odpowiedzi 0x03
+    unsigned long cellUpdateMs;   // Czas ostatniej odpowiedzi 0x04
+};
+
+class JbdBms {
+public:
+    JbdBms();
+
+    // Dane z powiadomienia BLE (wywoływane z zadania BLE); dowolny podział na fragmenty
+    void feed(const uint8_t* data, size_t length);
+
+    // Porzucenie niedokończonej ramki (np. po rozłączeniu)
+    void reset();
+
+    // Spójna kopia ostatnich danych; false, jeśli nie odebrano jeszcze żadnej ramki
+    bool read(BmsData& out) const { return snapshot.read(out); }
+    uint32_t getVersion() const { return snapshot.getVersion(); }
+
+    // Diagnostyka
+    uint32_t getFramesOk() const { return framesOk; }
+    uint32_t getChecksumErrors() const { return checksumErrors; }
+    uint32_t getFramingErrors() const { return framingErrors; }
+    uint32_t getBytesDropped() const { return bytesDropped; }
+
+private:
+    enum State : uint8_t {
+        WAIT_START,
+        WAIT_COMMAND,
+        WAIT_STATUS,
+        WAIT_LENGTH,
+        READ_DATA,
+        WAIT_CHECKSUM_HI,
+        WAIT_CHECKSUM_LO,
+        WAIT_END
+    };
+
+    State state;
+    uint8_t command;
+    uint8_t status;
+    uint8_t length;
+    uint8_t received;
+    uint16_t sum;
+    uint16_t checksum;
+    unsigned long lastByteMs;
+    uint8_t payload[255];
+
+    BmsData working;            // Stan pisarza - tylko zadanie BLE
+    Seqlock<BmsData> snapshot;  // Stan publikowany dla czytelników
+
+    uint32_t framesOk;
+    uint32_t checksumErrors;
+    uint32_t framingErrors;
+    uint32_t bytesDropped;
+
+    void processFrame();
+    void decodeBasicInfo();
+    void decodeCellInfo();
+
+    inline uint16_t payloadWord(uint8_t offset) const {
+        return (payload[offset] << 8) | payload[offset + 1];
+    }
+};
+
+#endif // JBD_BMS_H
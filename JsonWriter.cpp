@@ -0,0 +1,194 @@
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(Print& out) :
+    out(&out),
+    used(0),
+    length(0),
+    nonEmpty(0),
+    depth(0),
+    overflowed(false)
+{
+}
+
+JsonWriter::JsonWriter() :
+    out(nullptr),
+    used(0),
+    length(0),
+    nonEmpty(0),
+    depth(0),
+    overflowed(false)
+{
+}
+
+JsonWriter& JsonWriter::beginObject(const char* key) {
+    open(key, '{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    close('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(const char* key) {
+    open(key, '[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    close(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* key, const char* value) {
+    name(key);
+    if (value == nullptr) {
+        put("null", 4);
+    } else {
+        putString(value);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* key, bool value) {
+    name(key);
+    if (value) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* key, double value, uint8_t digits) {
+    name(key);
+    if (isnan(value) || isinf(value)) {
+        put("null", 4);
+        return *this;
+    }
+    // %g bez zbędnych zer: 41.7, 3, 1.5e+07 - wszystkie poprawne w JSON
+    char text[24];
+    int len = snprintf(text, sizeof(text), "%.*g", digits, value);
+    put(text, len > 0 ? min((size_t)len, sizeof(text) - 1) : 0);
+    return *this;
+}
+
+JsonWriter& JsonWriter::nullField(const char* key) {
+    name(key);
+    put("null", 4);
+    return *this;
+}
+
+void JsonWriter::flush() {
+    if (out != nullptr && used > 0) {
+        out->write((const uint8_t*)buffer, used);
+        used = 0;
+    }
+}
+
+// Przecinek przed kolejnym elementem poziomu i klucz pola
+void JsonWriter::name(const char* key) {
+    if (depth > 0 && depth <= JSON_WRITER_MAX_DEPTH) {
+        uint32_t bit = 1UL << (depth - 1);
+        if (nonEmpty & bit) {
+            put(',');
+        }
+        nonEmpty |= bit;
+    }
+    if (key != nullptr) {
+        putString(key);
+        put(':');
+    }
+}
+
+void JsonWriter::open(const char* key, char bracket) {
+    name(key);
+    put(bracket);
+    depth++;
+    if (depth <= JSON_WRITER_MAX_DEPTH) {
+        nonEmpty &= ~(1UL << (depth - 1));
+    }
+}
+
+void JsonWriter::close(char bracket) {
+    put(bracket);
+    if (depth > 0) {
+        depth--;
+    }
+}
+
+void JsonWriter::putInteger(uint64_t value, bool negative) {
+    char text[21];
+    char* p = text + sizeof(text);
+
+    // Dzielenie 64-bitowe tylko dla dużych wartości
+    if (value > UINT32_MAX) {
+        do {
+            *--p = '0' + value % 10;
+            value /= 10;
+        } while (value > UINT32_MAX);
+    }
+    uint32_t small = (uint32_t)value;
+    do {
+        *--p = '0' + small % 10;
+        small /= 10;
+    } while (small > 0);
+
+    if (negative) {
+        put('-');
+    }
+    put(p, text + sizeof(text) - p);
+}
+
+void JsonWriter::putString(const char* value) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    put('"');
+    const char* run = value;
+    for (const char* p = value; *p; p++) {
+        uint8_t c = (uint8_t)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;  // UTF-8 bez zmian
+        }
+
+        put(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"':  put("\\\"", 2); break;
+            case '\\': put("\\\\", 2); break;
+            case '\n': put("\\n", 2); break;
+            case '\r': put("\\r", 2); break;
+            case '\t': put("\\t", 2); break;
+            default: {
+                char escape[6] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F] };
+                put(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    put(run, strlen(run));
+    put('"');
+}
+
+void JsonWriter::put(char c) {
+    put(&c, 1);
+}
+
+void JsonWriter::put(const char* data, size_t len) {
+    while (len > 0) {
+        if (used == sizeof(buffer)) {
+            if (out == nullptr) {
+                overflowed = true;
+                return;
+            }
+            flush();
+        }
+
+        size_t chunk = min(len, sizeof(buffer) - used);
+        memcpy(buffer + used, data, chunk);
+        used += chunk;
+        length += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+// Zapis JSON bez dokumentu w pamięci: pola trafiają od razu do małego bufora
+// i dalej do Print (AsyncResponseStream, Serial, plik). Pamięć nie zależy od
+// rozmiaru odpowiedzi - w odróżnieniu od JsonDocument + String, gdzie całość
+// jest w RAM dwa razy.
+//
+//   json.beginObject();
+//   json.field("voltage", 41.7f).beginArray("cells");
+//   for (...) json.item(cell);
+//   json.endArray().endObject();
+//
+// Przecinki i zagnieżdżenie liczy writer; kolejność wywołań musi odpowiadać
+// strukturze dokumentu. Liczby niebędące liczbą (NaN, inf) są zapisywane jako null.
+//
+// Bez Print (JsonWriter()) dane zostają w buforze i odbiorca zabiera je sam
+// (getData(), clear()) - tak pracuje ApiResponse::sendChunked().
+
+#define JSON_WRITER_BUFFER 256
+#define JSON_WRITER_MAX_DEPTH 32
+#define JSON_FLOAT_DIGITS 7        // Cyfry znaczące liczb zmiennoprzecinkowych (dokładność float)
+
+class JsonWriter {
+public:
+    explicit JsonWriter(Print& out);
+    JsonWriter();
+    ~JsonWriter() { flush(); }
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    // key tylko wewnątrz obiektu; w tablicy i na najwyższym poziomie nullptr
+    JsonWriter& beginObject(const char* key = nullptr);
+    JsonWriter& endObject();
+    JsonWriter& beginArray(const char* key = nullptr);
+    JsonWriter& endArray();
+
+    // Pola obiektu
+    JsonWriter& field(const char* key, const char* value);
+    JsonWriter& field(const char* key, const String& value) { return field(key, value.c_str()); }
+    JsonWriter& field(const char* key, bool value);
+    JsonWriter& field(const char* key, double value, uint8_t digits = JSON_FLOAT_DIGITS);
+    JsonWriter& nullField(const char* key);
+
+    // Liczby całkowite dowolnego rozmiaru; enum wymaga rzutowania
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JsonWriter&>::type
+    field(const char* key, T value) {
+        name(key);
+        if (std::is_signed<T>::value && (int64_t)value < 0) {
+            putInteger(0 - (uint64_t)(int64_t)value, true);
+        } else {
+            putInteger((uint64_t)value, false);
+        }
+        return *this;
+    }
+
+    // Elementy tablicy
+    template <typename T>
+    JsonWriter& item(T value) { return field(nullptr, value); }
+    JsonWriter& item(double value, uint8_t digits) { return field(nullptr, value, digits); }
+
+    // Wysyła bufor do Print (bez Print nic nie robi)
+    void flush();
+
+    // Bajty zapisane od początku (z już wysłanymi)
+    size_t getLength() const { return length; }
+
+    // Tryb bez Print: zawartość bufora i jego opróżnienie przez odbiorcę
+    const char* getData() const { return buffer; }
+    size_t getBuffered() const { return used; }
+    void clear() { used = 0; }
+
+    // W trybie bez Print zabrakło miejsca w buforze - część danych przepadła
+    bool hasOverflowed() const { return overflowed; }
+
+private:
+    Print* out;
+    char buffer[JSON_WRITER_BUFFER];
+    size_t used;
+    size_t length;
+    uint32_t nonEmpty;      // Bit poziomu: był już element (potrzebny przecinek)
+    uint8_t depth;
+    bool overflowed;
+
+    void name(const char* key);
+    void open(const char* key, char bracket);
+    void close(char bracket);
+    void putInteger(uint64_t value, bool negative);
+    void putString(const char* value);
+    void put(char c);
+    void put(const char* data, size_t len);
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,109 @@
+#include "KtController.h"
+
+KtFrameDecoder::KtFrameDecoder() :
+    length(0),
+    checksumErrors(0),
+    discardedBytes(0)
+{
+    memset(buffer, 0, sizeof(buffer));
+}
+
+void KtFrameDecoder::reset() {
+    length = 0;
+}
+
+uint8_t KtFrameDecoder::checksum(const uint8_t* data) {
+    uint8_t crc = 0;
+    for (uint8_t i = 1; i < KT_FRAME_SIZE; i++) {
+        if (i != KT_CHECKSUM_INDEX) {
+            crc ^= data[i];
+        }
+    }
+    return crc;
+}
+
+bool KtFrameDecoder::feed(uint8_t byte) {
+    if (length == 0 && byte != KT_FRAME_HEADER) {
+        // Czekamy na poczatek ramki
+        discardedBytes++;
+        return false;
+    }
+
+    buffer[length++] = byte;
+    if (length < KT_FRAME_SIZE) {
+        return false;
+    }
+
+    if (checksum(buffer) == buffer[KT_CHECKSUM_INDEX]) {
+        length = 0;
+        return true;
+    }
+
+    checksumErrors++;
+    resync();
+    return false;
+}
+
+void KtFrameDecoder::resync() {
+    // Naglowek mogl wypasc w srodku odrzuconej ramki - szukamy go
+    // w juz odebranych bajtach zamiast tracic kolejna pelna ramke
+    uint8_t start = 1;
+    while (start < length && buffer[start] != KT_FRAME_HEADER) {
+        start++;
+    }
+
+    discardedBytes += start;
+    length -= start;
+    memmove(buffer, buffer + start, length);
+}
+
+KtController::KtController() :
+    lastFrameMs(0),
+    frameStartUs(0),
+    lastLatencyUs(0),
+    maxLatencyUs(0)
+{
+    memset(&telemetry, 0, sizeof(telemetry));
+}
+
+bool KtController::poll(Stream& port) {
+    bool published = false;
+    uint32_t pollUs = micros();
+
+    while (port.available() > 0) {
+        int value = port.read();
+        if (value < 0) break;
+
+        if (decoder.getLength() == 0) {
+            frameStartUs = pollUs;
+        }
+        if (decoder.feed((uint8_t)value)) {
+            publish(decoder.frame(), frameStartUs);
+            published = true;
+        }
+    }
+
+    return published;
+}
+
+void KtController::publish(const uint8_t* frame, uint32_t rxUs) {
+    telemetry.batteryLevel = frame[1];
+    telemetry.wheelPeriodMs = ((uint16_t)frame[3] << 8) | frame[4];
+    telemetry.errorCode = frame[5];
+    telemetry.movingMode = frame[7];
+    telemetry.current = frame[8] * KT_CURRENT_STEP_A;
+    telemetry.frameCount++;
+
+    uint32_t nowUs = micros();
+    telemetry.publishedUs = nowUs;
+    lastFrameMs = millis();
+
+    lastLatencyUs = nowUs - rxUs;
+    if (lastLatencyUs > maxLatencyUs) {
+        maxLatencyUs = lastLatencyUs;
+    }
+}
+
+bool KtController::isConnected(uint32_t timeoutMs) const {
+    return telemetry.frameCount > 0 && (millis() - lastFrameMs) < timeoutMs;
+}
@@ -0,0 +1,104 @@
+#ifndef KT_CONTROLLER_H
+#define KT_CONTROLLER_H
+
+#include <Arduino.h>
+#include "DebugUtils.h"
+
+// Ramka sterownik -> wyświetlacz (protokół KT-LCD, 12 bajtów):
+//  B0     nagłówek 0x41
+//  B1     poziom baterii (segmenty)
+//  B2     stała zależna od napięcia systemu
+//  B3-B4  czas obrotu koła [ms] (MSB, LSB)
+//  B5     kod błędu
+//  B6     suma kontrolna: XOR bajtów B1..B11 z pominięciem B6
+//  B7     flagi trybu jazdy
+//  B8     prąd baterii (kroki KT_CURRENT_STEP_A)
+//  B9-B11 zarezerwowane
+#define KT_FRAME_SIZE 12
+#define KT_FRAME_HEADER 0x41
+#define KT_CHECKSUM_INDEX 6
+
+// Czas obrotu koła, od którego sterownik zgłasza postój
+#define KT_WHEEL_PERIOD_STOPPED 3000
+
+// Flagi trybu jazdy (B7)
+#define KT_MODE_ASSIST   0x01  // Wspomaganie PAS aktywne
+#define KT_MODE_THROTTLE 0x02  // Jazda na manetce
+#define KT_MODE_CRUISE   0x08  // Tempomat
+#define KT_MODE_BRAKE    0x20  // Hamulec wciśnięty
+
+// Rozdzielczość pomiaru prądu w B8
+const float KT_CURRENT_STEP_A = 0.25f;
+
+// Ostatni zdekodowany stan sterownika
+struct KtTelemetry {
+    uint16_t wheelPeriodMs;   // Czas obrotu koła [ms]
+    float current;            // Prąd baterii [A]
+    uint8_t batteryLevel;     // Poziom baterii wg sterownika
+    uint8_t movingMode;       // Flagi KT_MODE_*
+    uint8_t errorCode;        // Kod błędu (0 = brak)
+    uint32_t frameCount;      // Licznik poprawnych ramek
+    uint32_t publishedUs;     // Znacznik czasu publikacji [us]
+};
+
+// Strumieniowy dekoder ramek KT - bajt po bajcie, bez alokacji na stercie
+class KtFrameDecoder {
+public:
+    KtFrameDecoder();
+
+    // Zwraca true, gdy bajt zamknął poprawną ramkę (dostępną przez frame())
+    bool feed(uint8_t byte);
+
+    const uint8_t* frame() const { return buffer; }
+
+    // Bajty bieżącej, niedokończonej ramki (0 - czeka na nagłówek)
+    uint8_t getLength() const { return length; }
+
+    uint32_t getChecksumErrors() const { return checksumErrors; }
+    uint32_t getDiscardedBytes() const { return discardedBytes; }
+
+    void reset();
+
+private:
+    uint8_t buffer[KT_FRAME_SIZE];
+    uint8_t length;
+    uint32_t checksumErrors;
+    uint32_t discardedBytes;
+
+    static uint8_t checksum(const uint8_t* data);
+    void resync();
+};
+
+// Odbiór danych ze sterownika przez UART
+class KtController {
+public:
+    KtController();
+
+    // Przetwarza wszystkie bajty oczekujące w porcie; zwraca true,
+    // gdy opublikowano co najmniej jedną nową ramkę
+    bool poll(Stream& port);
+
+    const KtTelemetry& getTelemetry() const { return telemetry; }
+    const KtFrameDecoder& getDecoder() const { return decoder; }
+
+    // Czas od odczytu pierwszego bajtu ramki do publikacji [us]. Bajty czekają
+    // w buforze UART do wywołania poll(), więc początkiem jest wejście do poll(),
+    // w którym pojawił się nagłówek - pomiar obejmuje też czekanie na zadanie.
+    uint32_t getLastLatencyUs() const { return lastLatencyUs; }
+    uint32_t getMaxLatencyUs() const { return maxLatencyUs; }
+
+    // Czy w zadanym czasie przyszła poprawna ramka
+    bool isConnected(uint32_t timeoutMs = 1000) const;
+
+private:
+    KtFrameDecoder decoder;
+    KtTelemetry telemetry;
+    unsigned long lastFrameMs;
+    uint32_t frameStartUs;      // Wejście do poll(), w którym odczytano nagłówek ramki
+    uint32_t lastLatencyUs;
+    uint32_t maxLatencyUs;
+
+    void publish(const uint8_t* frame, uint32_t rxUs);
+};
+
+#endif // KT_CONTROLLER_H
@@ -6,102 +6,80 @@ const uint8_t LightManager::FRONT;
 const uint8_t LightManager::DRL;
 const uint8_t LightManager::REAR;
 
+// Flagi konfiguracji odpowiadające kolejnym wyjściom (LightOutput)
+static const uint8_t OUTPUT_FLAGS[LIGHT_OUTPUT_COUNT] = {
+    LightManager::FRONT, LightManager::DRL, LightManager::REAR
+};
+
 // Konstruktor
 LightManager::LightManager() :
-    frontPin(0),
-    drlPin(0),
-    rearPin(0),
-    frontState(false),
-    drlState(false),
-    rearState(false),
-    currentMode(OFF),
-    dayConfig(NONE),
-    nightConfig(NONE),
-    dayBlink(false),
-    nightBlink(false),
-    blinkFrequency(500),
-    blinkState(false),
-    lastBlinkTime(0),
-    configMode(false)
+    LightManager(0, 0, 0)
 {
 }
 
-// Dodaj po istniejącym konstruktorze
+// Piny zapamiętywane tu, sprzęt (LEDC, timer) konfiguruje dopiero begin()
 LightManager::LightManager(uint8_t frontPin, uint8_t drlPin, uint8_t rearPin) :
     frontPin(frontPin),
     drlPin(drlPin),
     rearPin(rearPin),
-    frontState(false),
-    drlState(false),
-    rearState(false),
+    brakePin(LIGHT_NO_PIN),
     currentMode(OFF),
-    dayConfig(NONE),
-    nightConfig(NONE),
-    dayBlink(false),
-    nightBlink(false),
-    blinkFrequency(500),
-    blinkState(false),
-    lastBlinkTime(0),
-    configMode(false)
+    lightConfig(defaultConfig()),
+    patternConfig(defaultPatterns()),
+    configMode(false),
+    timer(nullptr),
+    appliedVersion(0),
+    brakeLevel(0),
+    brakeBoosted(false),
+    pwmWrites(0),
+    maxTickUs(0)
 {
-    // Ustaw piny jako wyjscia
-    pinMode(frontPin, OUTPUT);
-    pinMode(drlPin, OUTPUT);
-    pinMode(rearPin, OUTPUT);
-    
-    // Wylacz wszystkie swiatla na start
-    digitalWrite(frontPin, LOW);
-    digitalWrite(drlPin, LOW);
-    digitalWrite(rearPin, LOW);
-    
-    // Wczytaj konfiguracje
-    if (!loadConfig()) {
-        // Domyslna konfiguracja jesli nie udalo sie wczytac
-        dayConfig = DRL | REAR;
-        nightConfig = FRONT | REAR;
-        dayBlink = true;
-        nightBlink = false;
-        blinkFrequency = 500;
-        saveConfig();  // Zapisz domyslna konfiguracje
-    }
-    
-    DEBUG_LIGHT("Zainicjalizowano z pinami");
-    DEBUG_LIGHT("Konfiguracja dzienna: %s, miganie: %d", getConfigString(dayConfig).c_str(), dayBlink);
-    DEBUG_LIGHT("Konfiguracja nocna: %s, miganie: %d", getConfigString(nightConfig).c_str(), nightBlink);
+    memset(outputs, 0, sizeof(outputs));
 }
 
-// Inicjalizacja - przypisanie pinow GPIO
-void LightManager::begin(uint8_t frontPin, uint8_t drlPin, uint8_t rearPin) {
+// Inicjalizacja - przypisanie pinow GPIO, kanaly PWM i timer wzorow
+void LightManager::begin(uint8_t frontPin, uint8_t drlPin, uint8_t rearPin, uint8_t brakePin) {
     this->frontPin = frontPin;
     this->drlPin = drlPin;
     this->rearPin = rearPin;
-    
-    // Ustaw piny jako wyjscia
-    pinMode(frontPin, OUTPUT);
-    pinMode(drlPin, OUTPUT);
-    pinMode(rearPin, OUTPUT);
-    
-    // Wylacz wszystkie swiatla na start
-    digitalWrite(frontPin, LOW);
-    digitalWrite(drlPin, LOW);
-    digitalWrite(rearPin, LOW);
-    
-    // Wczytaj konfiguracje
-    if (!loadConfig()) {
-        // Domyslna konfiguracja jesli nie udalo sie wczytac
-        dayConfig = DRL | REAR;
-        nightConfig = FRONT | REAR;
-        dayBlink = true;
-        nightBlink = false;
-        blinkFrequency = 500;
-        saveConfig();  // Zapisz domyslna konfiguracje
+    this->brakePin = brakePin;
+
+    // Wszystkie swiatla wylaczone na start
+    const uint8_t pins[LIGHT_OUTPUT_COUNT] = { frontPin, drlPin, rearPin };
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        ledcSetup(LIGHT_LEDC_CHANNEL + i, LIGHT_PWM_FREQUENCY, LIGHT_PWM_BITS);
+        ledcAttachPin(pins[i], LIGHT_LEDC_CHANNEL + i);
+        ledcWrite(LIGHT_LEDC_CHANNEL + i, 0);
+        outputs[i].written = 0;
     }
-    
-    #ifdef DEBUG
+
+    if (timer == nullptr) {
+        esp_timer_create_args_t args = {};
+        args.callback = timerCallback;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "lights";
+        if (esp_timer_create(&args, &timer) != ESP_OK ||
+            esp_timer_start_periodic(timer, LIGHT_TICK_MS * 1000UL) != ESP_OK) {
+            DEBUG_ERROR("Nie udalo sie uruchomic timera swiatel");
+        }
+    }
+
+    updateLights();
+
     DEBUG_LIGHT("Zainicjalizowano");
-    DEBUG_LIGHT("Konfiguracja dzienna: %s, miganie: %d", getConfigString(dayConfig).c_str(), dayBlink);
-    DEBUG_LIGHT("Konfiguracja nocna: %s, miganie: %d", getConfigString(nightConfig).c_str(), nightBlink);
-    #endif
+    DEBUG_LIGHT("Konfiguracja dzienna: %s, miganie: %d", getConfigString(lightConfig.dayConfig).c_str(), lightConfig.dayBlink);
+    DEBUG_LIGHT("Konfiguracja nocna: %s, miganie: %d", getConfigString(lightConfig.nightConfig).c_str(), lightConfig.nightBlink);
+}
+
+void LightManager::shutdown() {
+    if (timer != nullptr) {
+        esp_timer_stop(timer);
+    }
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        ledcWrite(LIGHT_LEDC_CHANNEL + i, 0);
+        outputs[i].written = 0;
+    }
 }
 
 // Ustawianie trybu
@@ -116,13 +94,13 @@ void LightManager::setMode(LightMode mode) {
 
 // Settery
 void LightManager::setDayConfig(uint8_t config, bool blink) {
-    DEBUG_LIGHT("Ustawianie konfiguracji dziennej: przed=0x%02X, po=0x%02X, miganie: %d", dayConfig, config, blink);
+    DEBUG_LIGHT("Ustawianie konfiguracji dziennej: przed=0x%02X, po=0x%02X, miganie: %d", lightConfig.dayConfig, config, blink);
     DEBUG_LIGHT("REAR wlaczone? %s", (config & REAR) ? "TAK" : "NIE");
     
-    dayConfig = config;
-    dayBlink = blink;
+    lightConfig.dayConfig = config;
+    lightConfig.dayBlink = blink;
     
-    DEBUG_LIGHT("Ustawiono konfiguracje dzienna: %s, miganie: %d", getConfigString(dayConfig).c_str(), dayBlink);
+    DEBUG_LIGHT("Ustawiono konfiguracje dzienna: %s, miganie: %d", getConfigString(lightConfig.dayConfig).c_str(), lightConfig.dayBlink);
     
     if (currentMode == DAY) {
         updateLights();
@@ -130,13 +108,13 @@ void LightManager::setDayConfig(uint8_t config, bool blink) {
 }
 
 void LightManager::setNightConfig(uint8_t config, bool blink) {
-    DEBUG_LIGHT("Ustawianie konfiguracji nocnej: przed=0x%02X, po=0x%02X, miganie: %d", nightConfig, config, blink);
+    DEBUG_LIGHT("Ustawianie konfiguracji nocnej: przed=0x%02X, po=0x%02X, miganie: %d", lightConfig.nightConfig, config, blink);
     DEBUG_LIGHT("REAR wlaczone? %s", (config & REAR) ? "TAK" : "NIE");
         
-    nightConfig = config;
-    nightBlink = blink;
+    lightConfig.nightConfig = config;
+    lightConfig.nightBlink = blink;
     
-    DEBUG_LIGHT("Ustawiono konfiguracje nocna: %s, miganie: %d", getConfigString(nightConfig).c_str(), nightBlink);
+    DEBUG_LIGHT("Ustawiono konfiguracje nocna: %s, miganie: %d", getConfigString(lightConfig.nightConfig).c_str(), lightConfig.nightBlink);
     
     if (currentMode == NIGHT) {
         updateLights();
@@ -145,12 +123,23 @@ void LightManager::setNightConfig(uint8_t config, bool blink) {
 
 void LightManager::setBlinkFrequency(uint16_t frequency) {
     if (frequency >= 100 && frequency <= 2000) {
-        blinkFrequency = frequency;
+        lightConfig.blinkFrequency = frequency;
+        setBlinkPattern();
         
-        DEBUG_LIGHT("Ustawiono czestotliwosc migania: %d ms", blinkFrequency);
+        DEBUG_LIGHT("Ustawiono czestotliwosc migania: %d ms", lightConfig.blinkFrequency);
     }
 }
 
+// Wzor LIGHT_PATTERN_BLINK - polowa okresu wlaczone, polowa wylaczone
+void LightManager::setBlinkPattern() {
+    uint8_t ticks = lightConfig.blinkFrequency / LIGHT_TICK_MS;
+    LightPattern& blink = patternConfig.patterns[LIGHT_PATTERN_BLINK];
+    blink.stepCount = 2;
+    blink.steps[0] = { 255, ticks };
+    blink.steps[1] = { 0, ticks };
+    updateLights();
+}
+
 // Przelaczanie trybow
 void LightManager::cycleMode() {
     DEBUG_LIGHT("Przelaczanie trybu");
@@ -176,12 +165,13 @@ void LightManager::activateConfigMode() {
     DEBUG_LIGHT("Tryb konfiguracji aktywowany");
     
     // Wlacz wszystkie swiatla
-    digitalWrite(frontPin, HIGH);
-    digitalWrite(drlPin, HIGH);
-    digitalWrite(rearPin, HIGH);
-    frontState = true;
-    drlState = true;
-    rearState = true;
+    LightTargets next;
+    memset(&next, 0, sizeof(next));
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        next.outputs[i].stepCount = 1;
+        next.outputs[i].steps[0] = { 255, 1 };
+    }
+    publish(next);
 }
 
 void LightManager::deactivateConfigMode() {
@@ -193,218 +183,213 @@ void LightManager::deactivateConfigMode() {
     updateLights();
 }
 
-// Aktualizacja stanu swiatel
+// Aktualizacja stanu swiatel - wzory wyjsc dla biezacego trybu
 void LightManager::updateLights() {
     if (configMode) return; // W trybie konfiguracji nie aktualizujemy swiatel
     
-    uint8_t currentConfig = NONE;
-    bool shouldBlink = false;
-    
-    // Wybierz konfiguracje w zaleznosci od trybu
-    if (currentMode == DAY) {
-        currentConfig = dayConfig;
-        shouldBlink = dayBlink;
-    } else if (currentMode == NIGHT) {
-        currentConfig = nightConfig;
-        shouldBlink = nightBlink;
-    } else {
-        // W trybie OFF wylacz wszystko
-        frontState = false;
-        drlState = false;
-        rearState = false;
-    }
-    
-    // Ustaw stany swiatel na podstawie konfiguracji
-    if (currentMode != OFF) {
-        frontState = (currentConfig & FRONT) != 0;
-        drlState = (currentConfig & DRL) != 0;
-        rearState = (currentConfig & REAR) != 0;
-    }
-    
-    // Aktualizuj piny
-    digitalWrite(frontPin, frontState ? HIGH : LOW);
-    digitalWrite(drlPin, drlState ? HIGH : LOW);
-    //digitalWrite(rearPin, rearState ? HIGH : LOW);
-    
-    // Dla tylnego swiatla, jesli ma migac, stan bedzie aktualizowany w update()
-    if (!shouldBlink) {
-        digitalWrite(rearPin, rearState ? HIGH : LOW);
-    }
-    
+    LightTargets next;
+    memset(&next, 0, sizeof(next));
+
+    // W trybie OFF wszystkie wzory puste - wyjscia wylaczone, bez podbicia hamulca
     if (currentMode != OFF) {
-        DEBUG_LIGHT("Swiatla zaktualizowane: przednie=%d, swiatlo dzienne=%d, tylne=%d, miganie=%d", frontState, drlState, rearState, shouldBlink);
+        bool night = (currentMode == NIGHT);
+        uint8_t currentConfig = night ? lightConfig.nightConfig : lightConfig.dayConfig;
+        bool shouldBlink = night ? lightConfig.nightBlink : lightConfig.dayBlink;
+        const uint8_t* patternIds = night ? patternConfig.nightPattern : patternConfig.dayPattern;
+
+        for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+            if (!(currentConfig & OUTPUT_FLAGS[i])) continue;
+
+            uint8_t id = patternIds[i];
+            if ((i == LIGHT_OUTPUT_REAR && !shouldBlink) || id >= LIGHT_PATTERN_COUNT) {
+                id = LIGHT_PATTERN_STEADY;
+            }
+            next.outputs[i] = patternConfig.patterns[id];
+        }
+        next.brakeLevel = patternConfig.brakeLevel;
+
+        DEBUG_LIGHT("Swiatla zaktualizowane: konfiguracja=0x%02X, wzory=%d/%d/%d, miganie=%d",
+                    currentConfig, patternIds[0], patternIds[1], patternIds[2], shouldBlink);
     } else {
         DEBUG_LIGHT("Wszystkie swiatla wylaczone");
     }
+
+    publish(next);
 }
 
-// Przetworzyc stan - wywolaj w petli loop
-void LightManager::update() {
-    if (configMode) return; // W trybie konfiguracji nie przetwarzamy migania
-    
-    bool shouldBlink = false;
-    
-    // Sprawdz, czy powinnismy migac w zaleznosci od trybu
-    if (currentMode == DAY) {
-        shouldBlink = dayBlink;
-    } else if (currentMode == NIGHT) {
-        shouldBlink = nightBlink;
-    }
-    
-    // Jesli powinnismy migac i tylne swiatlo jest wlaczone
-    if (shouldBlink && rearState) {
-        unsigned long currentTime = millis();
-        
-        // Czas na zmiane stanu migania
-        if (currentTime - lastBlinkTime >= blinkFrequency) {
-            lastBlinkTime = currentTime;
-            blinkState = !blinkState;
-            digitalWrite(rearPin, blinkState ? HIGH : LOW);
-            
-            //DEBUG_LIGHT("Miganie tylnego swiatla: %d", blinkState);
+void LightManager::publish(const LightTargets& next) {
+    targets.write(next);
+}
+
+void LightManager::timerCallback(void* arg) {
+    static_cast<LightManager*>(arg)->tick();
+}
+
+// Krok silnika wzorow - kontekst timera esp_timer
+void LightManager::tick() {
+    uint32_t startUs = micros();
+
+    // Nowe wzory startuja od pierwszego kroku (wszystkie wyjscia w fazie)
+    uint32_t version = targets.getVersion();
+    if (version != appliedVersion) {
+        LightTargets next;
+        targets.read(next);
+        appliedVersion = version;
+
+        for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+            OutputPlayer& player = outputs[i];
+            player.pattern = next.outputs[i];
+            player.step = 0;
+            player.ticksLeft = max(player.pattern.steps[0].ticks, (uint8_t)1);
         }
-    } else if (rearState) {
-        // Jesli nie migamy, ale swiatlo ma byc wlaczone
-        digitalWrite(rearPin, HIGH);
+        brakeLevel = next.brakeLevel;
     } else {
-        // Swiatlo wylaczone
-        digitalWrite(rearPin, LOW);
+        for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+            OutputPlayer& player = outputs[i];
+            if (player.pattern.stepCount > 1 && --player.ticksLeft == 0) {
+                player.step = (player.step + 1) % player.pattern.stepCount;
+                player.ticksLeft = max(player.pattern.steps[player.step].ticks, (uint8_t)1);
+            }
+        }
     }
-}
 
-// Zapisz konfiguracje
-bool LightManager::saveConfig() {
-    DEBUG_LIGHT("Zapisywanie konfiguracji...");
-    DEBUG_LIGHT("Konfiguracja dzienna: 0x%02X (%s)", dayConfig, getConfigString(dayConfig).c_str());
-    DEBUG_LIGHT("Konfiguracja nocna: 0x%02X (%s)", nightConfig, getConfigString(nightConfig).c_str());
-    DEBUG_LIGHT("Miganie dzienne: %d, Miganie nocne: %d", dayBlink, nightBlink);
-    DEBUG_LIGHT("Czestotliwosc migania: %d", blinkFrequency);
-    
-    // Sprawdz poszczegolne bity
-    DEBUG_LIGHT("Konfiguracja dzienna - FRONT: %d, DRL: %d, REAR: %d", (dayConfig & FRONT) != 0, (dayConfig & DRL) != 0, (dayConfig & REAR) != 0);
-    DEBUG_LIGHT("Konfiguracja nocna - FRONT: %d, DRL: %d, REAR: %d", (nightConfig & FRONT) != 0, (nightConfig & DRL) != 0, (nightConfig & REAR) != 0);
-        
-    if (!LittleFS.begin(false)) {
-        DEBUG_LIGHT("Blad montowania LittleFS");
-        return false;
+    // Hamulec aktywny stanem niskim
+    bool brake = brakeLevel > 0 && brakePin != LIGHT_NO_PIN && digitalRead(brakePin) == LOW;
+    brakeBoosted = brake;
+
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        OutputPlayer& player = outputs[i];
+        uint8_t level = player.pattern.stepCount ? player.pattern.steps[player.step].level : 0;
+        if (i == LIGHT_OUTPUT_REAR && brake && brakeLevel > level) {
+            level = brakeLevel;
+        }
+
+        if (level != player.written) {
+            // 255 = pelne wypelnienie (1 << bity), nie 255/256
+            ledcWrite(LIGHT_LEDC_CHANNEL + i, (level == 255) ? (1UL << LIGHT_PWM_BITS) : level);
+            player.written = level;
+            pwmWrites = pwmWrites + 1;
+        }
     }
-    
-    // Dla bezpieczenstwa usun istniejacy plik
-    if (LittleFS.exists("/light_config.json")) {
-        if (!LittleFS.remove("/light_config.json")) {
-            DEBUG_LIGHT("Nie udalo sie usunac istniejacego pliku konfiguracyjnego");
-            // Kontynuujemy mimo to
+
+    uint32_t elapsedUs = micros() - startUs;
+    if (elapsedUs > maxTickUs) maxTickUs = elapsedUs;
+}
+
+// Konfiguracja domyslna
+LightConfig LightManager::defaultConfig() {
+    LightConfig config;
+    config.dayConfig = DRL | REAR;
+    config.nightConfig = FRONT | REAR;
+    config.dayBlink = true;
+    config.nightBlink = false;
+    config.blinkFrequency = 500;
+    return config;
+}
+
+// Wzory domyslne; kroki w LIGHT_TICK_MS (10 ms)
+LightPatternConfig LightManager::defaultPatterns() {
+    LightPatternConfig config;
+    memset(&config, 0, sizeof(config));
+
+    // Stala pelna jasnosc
+    config.patterns[LIGHT_PATTERN_STEADY] = { 1, { {255, 1} } };
+    // Miganie z blinkFrequency (domyslnie 500 ms)
+    config.patterns[LIGHT_PATTERN_BLINK] = { 2, { {255, 50}, {0, 50} } };
+    // Dwa krotkie blyski i przerwa
+    config.patterns[LIGHT_PATTERN_DOUBLE_FLASH] = { 4, { {255, 8}, {0, 12}, {255, 8}, {0, 72} } };
+    // Trzy blyski i przerwa
+    config.patterns[LIGHT_PATTERN_TRIPLE_FLASH] = { 6, { {255, 6}, {0, 8}, {255, 6}, {0, 8}, {255, 6}, {0, 66} } };
+    // Przyciemnione z blyskiem - widoczne, ale nie oslepia
+    config.patterns[LIGHT_PATTERN_PULSE] = { 2, { {64, 80}, {255, 10} } };
+    // Przyciemnione na stale
+    config.patterns[LIGHT_PATTERN_DIM] = { 1, { {64, 1} } };
+
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        config.dayPattern[i] = LIGHT_PATTERN_STEADY;
+        config.nightPattern[i] = LIGHT_PATTERN_STEADY;
+    }
+    config.dayPattern[LIGHT_OUTPUT_REAR] = LIGHT_PATTERN_BLINK;
+    config.nightPattern[LIGHT_OUTPUT_REAR] = LIGHT_PATTERN_BLINK;
+    config.brakeLevel = 255;
+    return config;
+}
+
+void LightManager::patternsToJson(JsonWriter& json) const {
+    json.beginArray("patterns");
+    for (uint8_t p = 0; p < LIGHT_PATTERN_COUNT; p++) {
+        const LightPattern& pattern = patternConfig.patterns[p];
+        json.beginArray();
+        for (uint8_t s = 0; s < pattern.stepCount && s < LIGHT_PATTERN_MAX_STEPS; s++) {
+            json.beginArray();
+            json.item(pattern.steps[s].level);
+            json.item(pattern.steps[s].ticks * LIGHT_TICK_MS);
+            json.endArray();
         }
+        json.endArray();
     }
-    
-    // Otworz plik do zapisu
-    File configFile = LittleFS.open("/light_config.json", "w");
-    if (!configFile) {
-        DEBUG_LIGHT("Nie mozna otworzyc pliku konfiguracyjnego do zapisu");
-        return false;
+    json.endArray();
+
+    json.beginArray("dayPatterns");
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        json.item(patternConfig.dayPattern[i]);
     }
-    
-    // Przygotuj dokument JSON
-    StaticJsonDocument<256> doc;
-    doc["dayConfig"] = dayConfig;
-    doc["nightConfig"] = nightConfig;
-    doc["dayBlink"] = dayBlink;
-    doc["nightBlink"] = nightBlink;
-    doc["blinkFrequency"] = blinkFrequency;
-    
-    // Serializuj do pliku
-    size_t bytes = serializeJson(doc, configFile);
-    configFile.close();
-    
-    if (bytes == 0) {
-        DEBUG_LIGHT("Nie udalo sie zapisac konfiguracji do pliku");
-        return false;
+    json.endArray();
+    json.beginArray("nightPatterns");
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        json.item(patternConfig.nightPattern[i]);
     }
-    
-    #ifdef DEBUG_LIGHT_ENABLED
-    DEBUG_LIGHT("Konfiguracja zapisana pomyslnie (%d bajtow)", bytes);
-    
-    // Dla pewnosci odczytaj zapisany plik i sprawdz jego zawartosc
-    File readFile = LittleFS.open("/light_config.json", "r");
-    if (readFile) {
-        String content = readFile.readString();
-        readFile.close();
-        DEBUG_LIGHT("Zapisana zawartosc pliku: %s", content.c_str());
+    json.endArray();
+    json.field("brakeLevel", patternConfig.brakeLevel);
+}
+
+// Indeksy wzorow dla wyjsc [przod, dzienne, tyl]
+static bool parsePatternIds(JsonVariantConst in, uint8_t ids[LIGHT_OUTPUT_COUNT]) {
+    JsonArrayConst array = in.as<JsonArrayConst>();
+    if (array.isNull() || array.size() != LIGHT_OUTPUT_COUNT) return false;
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        int id = array[i] | -1;
+        if (id < 0 || id >= LIGHT_PATTERN_COUNT) return false;
+        ids[i] = id;
     }
-    #endif
-    
     return true;
 }
 
-// Wczytaj konfiguracje
-bool LightManager::loadConfig() {
-    DEBUG_LIGHT("Wczytywanie konfiguracji...");
-        
-    if (!LittleFS.begin(false)) {
-        DEBUG_LIGHT("Blad montowania LittleFS");
-        return false;
-    }
-    
-    if (!LittleFS.exists("/light_config.json")) {
-        DEBUG_LIGHT("Nie znaleziono pliku konfiguracyjnego");
-        return false;
-    }
-    
-    File configFile = LittleFS.open("/light_config.json", "r");
-    if (!configFile) {
-        DEBUG_LIGHT("Nie mozna otworzyc pliku konfiguracyjnego do odczytu");
-        return false;
-    }
-    
-    StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, configFile);
-    configFile.close();
-    
-    if (error) {
-        DEBUG_LIGHT("Blad parsowania pliku konfiguracyjnego: %s", error.c_str());
-        return false;
-    }
-    
-    // UWAGA: Zmienione uzycie operatora | na sprawdzenie, czy wartosc istnieje
-    // Wczytaj konfiguracje tylko jesli istnieje, w przeciwnym razie uzyj wartosci domyslnych
-    if (doc.containsKey("dayConfig")) {
-        dayConfig = doc["dayConfig"];
-    } else {
-        dayConfig = DRL | REAR; // Wartosc domyslna
-    }
-    
-    if (doc.containsKey("nightConfig")) {
-        nightConfig = doc["nightConfig"];
-    } else {
-        nightConfig = FRONT | REAR; // Wartosc domyslna
-    }
-    
-    if (doc.containsKey("dayBlink")) {
-        dayBlink = doc["dayBlink"];
-    } else {
-        dayBlink = true; // Wartosc domyslna
-    }
-    
-    if (doc.containsKey("nightBlink")) {
-        nightBlink = doc["nightBlink"];
-    } else {
-        nightBlink = false; // Wartosc domyslna
+bool LightManager::patternsFromJson(JsonObjectConst in) {
+    LightPatternConfig next = patternConfig;
+
+    if (in.containsKey("patterns")) {
+        JsonArrayConst patterns = in["patterns"].as<JsonArrayConst>();
+        if (patterns.isNull() || patterns.size() > LIGHT_PATTERN_COUNT) return false;
+
+        uint8_t p = 0;
+        for (JsonVariantConst item : patterns) {
+            JsonArrayConst steps = item.as<JsonArrayConst>();
+            if (steps.isNull() || steps.size() > LIGHT_PATTERN_MAX_STEPS) return false;
+
+            LightPattern pattern;
+            memset(&pattern, 0, sizeof(pattern));
+            for (JsonVariantConst step : steps) {
+                int level = step[0] | -1;
+                int ms = step[1] | -1;
+                if (level < 0 || level > 255 || ms < LIGHT_TICK_MS || ms > 255 * LIGHT_TICK_MS) return false;
+                pattern.steps[pattern.stepCount++] = { (uint8_t)level, (uint8_t)((ms + LIGHT_TICK_MS / 2) / LIGHT_TICK_MS) };
+            }
+            next.patterns[p++] = pattern;
+        }
     }
-    
-    if (doc.containsKey("blinkFrequency")) {
-        blinkFrequency = doc["blinkFrequency"];
-    } else {
-        blinkFrequency = 500; // Wartosc domyslna
+
+    if (in.containsKey("dayPatterns") && !parsePatternIds(in["dayPatterns"], next.dayPattern)) return false;
+    if (in.containsKey("nightPatterns") && !parsePatternIds(in["nightPatterns"], next.nightPattern)) return false;
+
+    if (in.containsKey("brakeLevel")) {
+        int level = in["brakeLevel"] | -1;
+        if (level < 0 || level > 255) return false;
+        next.brakeLevel = level;
     }
-    
-    #ifdef DEBUG_LIGHT_ENABLED
-    DEBUG_LIGHT("Wczytana konfiguracja:");
-    DEBUG_LIGHT("Konfiguracja dzienna: 0x%02X (%s)", dayConfig, getConfigString(dayConfig).c_str());
-    DEBUG_LIGHT("Konfiguracja nocna: 0x%02X (%s)", nightConfig, getConfigString(nightConfig).c_str());
-    DEBUG_LIGHT("Miganie dzienne: %d, Miganie nocne: %d", dayBlink, nightBlink);
-    DEBUG_LIGHT("Czestotliwosc migania: %d", blinkFrequency);
-    #endif
-    
+
+    patternConfig = next;
+    updateLights();
     return true;
 }
 
@@ -446,6 +431,32 @@ String LightManager::getModeString() const {
     }
 }
 
+// Nazwy konfiguracji indeksowane flagami FRONT/DRL/REAR
+static const char* const CONFIG_NAMES[] = {
+    "NONE", "FRONT", "DRL", "FRONT+DRL", "REAR", "FRONT+REAR", "DRL+REAR", "FRONT+DRL+REAR"
+};
+
+const char* LightManager::getConfigName(uint8_t config) {
+    return CONFIG_NAMES[config & (FRONT | DRL | REAR)];
+}
+
+const char* LightManager::getModeName() const {
+    return getModeName(currentMode);
+}
+
+const char* LightManager::getModeName(LightMode mode) {
+    switch (mode) {
+        case OFF:
+            return "WYLACZONE";
+        case DAY:
+            return "DZIEN";
+        case NIGHT:
+            return "NOC";
+        default:
+            return "NIEZNANY";
+    }
+}
+
 // Konwersja string na config (uint8_t)
 uint8_t LightManager::parseConfigString(const char* configStr) {
     DEBUG_LIGHT("parseConfigString - wejsciowy string: '%s'", configStr);
@@ -3,14 +3,82 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <LittleFS.h>
+#include <esp_timer.h>
 #include "DebugUtils.h"
+#include "Seqlock.h"
+#include "JsonWriter.h"
 
 extern void applyBacklightSettings();
 
 // Odkomentuj, aby włączyć debugowanie
 #define DEBUG
 
+// Konfiguracja świateł - sekcja magazynu ustawień (SettingsStore)
+struct LightConfig {
+    uint8_t dayConfig;        // Kombinacja flag dla trybu dziennego
+    uint8_t nightConfig;      // Kombinacja flag dla trybu nocnego
+    bool dayBlink;            // Czy tylne światło ma migać w trybie dziennym
+    bool nightBlink;          // Czy tylne światło ma migać w trybie nocnym
+    uint16_t blinkFrequency;  // Częstotliwość migania w ms
+};
+
+// Silnik wzorów świateł.
+//
+// Każde wyjście (przednie, dzienne, tylne) odtwarza w kółko tablicę kroków
+// (jasność, czas). Jasność ustawia sprzętowy PWM (LEDC), a kroki przełącza timer
+// esp_timer co LIGHT_TICK_MS - miganie nie zależy od obciążenia pętli głównej,
+// a PWM zapisywany jest tylko przy zmianie jasności. Pętla główna publikuje jedynie
+// nowe wzory (Seqlock) przy zmianie trybu lub konfiguracji. Timer odczytuje też
+// czujnik hamulca i podbija jasność tylnego światła do brakeLevel.
+//
+// Tylne światło używa wzoru z dayPattern/nightPattern tylko przy włączonym miganiu
+// (dayBlink/nightBlink); bez migania świeci stale. Wzór LIGHT_PATTERN_BLINK
+// odtwarzany jest z blinkFrequency, pozostałe można zmieniać przez /api/lights/config.
+
+#define LIGHT_OUTPUT_COUNT 3
+#define LIGHT_PATTERN_COUNT 6
+#define LIGHT_PATTERN_MAX_STEPS 8
+#define LIGHT_TICK_MS 10
+#define LIGHT_PWM_FREQUENCY 2000
+#define LIGHT_PWM_BITS 8
+#define LIGHT_LEDC_CHANNEL 0       // Kanały LIGHT_LEDC_CHANNEL .. +LIGHT_OUTPUT_COUNT-1
+#define LIGHT_NO_PIN 0xFF
+
+// Wyjścia w kolejności kanałów LEDC
+enum LightOutput : uint8_t {
+    LIGHT_OUTPUT_FRONT,
+    LIGHT_OUTPUT_DRL,
+    LIGHT_OUTPUT_REAR
+};
+
+// Domyślne wzory (indeksy w LightPatternConfig::patterns)
+enum LightPatternId : uint8_t {
+    LIGHT_PATTERN_STEADY,
+    LIGHT_PATTERN_BLINK,
+    LIGHT_PATTERN_DOUBLE_FLASH,
+    LIGHT_PATTERN_TRIPLE_FLASH,
+    LIGHT_PATTERN_PULSE,
+    LIGHT_PATTERN_DIM
+};
+
+struct LightStep {
+    uint8_t level;            // Jasność 0-255
+    uint8_t ticks;            // Czas trwania w LIGHT_TICK_MS
+};
+
+struct LightPattern {
+    uint8_t stepCount;        // 0 - wyłączone, 1 - stała jasność
+    LightStep steps[LIGHT_PATTERN_MAX_STEPS];
+};
+
+// Wzory świateł - osobna sekcja magazynu ustawień
+struct LightPatternConfig {
+    LightPattern patterns[LIGHT_PATTERN_COUNT];
+    uint8_t dayPattern[LIGHT_OUTPUT_COUNT];    // Wzór każdego wyjścia w trybie dziennym
+    uint8_t nightPattern[LIGHT_OUTPUT_COUNT];  // i nocnym
+    uint8_t brakeLevel;                        // Jasność tylnego przy hamowaniu; 0 - bez podbicia
+};
+
 class LightManager {
 public:
     // Stałe dla konfiguracji świateł
@@ -35,8 +103,11 @@ public:
     LightManager();
     LightManager(uint8_t frontPin, uint8_t drlPin, uint8_t rearPin); // Nowy konstruktor z parametrami
     
-    // Inicjalizacja - przypisanie pinów GPIO
-    void begin(uint8_t frontPin, uint8_t drlPin, uint8_t rearPin);
+    // Inicjalizacja - przypisanie pinów GPIO, kanały LEDC i timer wzorów
+    void begin(uint8_t frontPin, uint8_t drlPin, uint8_t rearPin, uint8_t brakePin = LIGHT_NO_PIN);
+
+    // Natychmiastowe wyłączenie wszystkich wyjść (przed uśpieniem)
+    void shutdown();
     
     // Ustawianie trybu
     void setMode(LightMode mode);
@@ -45,11 +116,11 @@ public:
     void cycleMode(); // Przełącza między trybami OFF -> DAY -> NIGHT -> OFF
     
     // Gettery
-    uint8_t getDayConfig() const { return dayConfig; }
-    uint8_t getNightConfig() const { return nightConfig; }
-    bool getDayBlink() const { return dayBlink; }
-    bool getNightBlink() const { return nightBlink; }
-    uint16_t getBlinkFrequency() const { return blinkFrequency; }
+    uint8_t getDayConfig() const { return lightConfig.dayConfig; }
+    uint8_t getNightConfig() const { return lightConfig.nightConfig; }
+    bool getDayBlink() const { return lightConfig.dayBlink; }
+    bool getNightBlink() const { return lightConfig.nightBlink; }
+    uint16_t getBlinkFrequency() const { return lightConfig.blinkFrequency; }
     LightMode getMode() const { return currentMode; }  // Metoda do pobrania aktualnego trybu
     
     // Settery
@@ -61,18 +132,37 @@ public:
     void activateConfigMode();
     void deactivateConfigMode();
     
-    // Przetworzyć stan - wywołaj w pętli loop
-    void update();
-    
-    // Zapisz i wczytaj konfigurację
-    bool saveConfig();
-    bool loadConfig();
+    // Konfiguracja jako struktura - rejestrowana w magazynie ustawień
+    LightConfig* getConfigData() { return &lightConfig; }
+    static LightConfig defaultConfig();
+    LightPatternConfig* getPatternData() { return &patternConfig; }
+    static LightPatternConfig defaultPatterns();
+
+    // Wzory w JSON: patterns = [[[jasność, ms], ...], ...], dayPatterns/nightPatterns = [przód, dzienne, tył]
+    // (pola otwartego obiektu)
+    void patternsToJson(JsonWriter& json) const;
+    // Zmienia tylko pola obecne w obiekcie; false przy błędnych danych (konfiguracja bez zmian)
+    bool patternsFromJson(JsonObjectConst in);
+
+    // Zastosowanie zmienionej konfiguracji (np. po wczytaniu ustawień)
+    void refresh() { updateLights(); }
+
+    // Stan silnika wzorów
+    uint8_t getOutputLevel(uint8_t output) const { return output < LIGHT_OUTPUT_COUNT ? outputs[output].written : 0; }
+    bool isBrakeBoosted() const { return brakeBoosted; }
+    uint32_t getPwmWrites() const { return pwmWrites; }
+    uint32_t getMaxTickUs() const { return maxTickUs; }
     
     // Konwersja między uint8_t i string
     String getConfigString(uint8_t config) const;
     static uint8_t parseConfigString(const char* configStr);
 
     String getModeString() const; // Zwraca nazwę aktualnego trybu jako string
+
+    // Wersje bez alokacji - dla telemetrii wysyłanej wiele razy na sekundę
+    const char* getModeName() const;
+    static const char* getModeName(LightMode mode);
+    static const char* getConfigName(uint8_t config);
     
     // gettery i settery
     ControlMode getControlMode() const {
@@ -92,16 +182,26 @@ public:
     }
 
 private:
+    // Wzory publikowane dla timera
+    struct LightTargets {
+        LightPattern outputs[LIGHT_OUTPUT_COUNT];
+        uint8_t brakeLevel;
+    };
+
+    // Stan odtwarzania wyjścia - tylko w kontekście timera
+    struct OutputPlayer {
+        LightPattern pattern;
+        uint8_t step;
+        uint8_t ticksLeft;
+        uint8_t written;      // Ostatnio zapisana jasność PWM
+    };
+
     // Piny GPIO
     uint8_t frontPin;
     uint8_t drlPin;
     uint8_t rearPin;
-    
-    // Stan świateł
-    bool frontState;
-    bool drlState;
-    bool rearState;
-    
+    uint8_t brakePin;
+
     // Domyślnie sterowanie Smart
     ControlMode controlMode = SMART_CONTROL; 
 
@@ -109,19 +209,28 @@ private:
     LightMode currentMode;
     
     // Konfiguracja dla różnych trybów
-    uint8_t dayConfig;   // Kombinacja flag dla trybu dziennego
-    uint8_t nightConfig; // Kombinacja flag dla trybu nocnego
-    bool dayBlink;       // Czy tylne światło ma migać w trybie dziennym
-    bool nightBlink;     // Czy tylne światło ma migać w trybie nocnym
-    uint16_t blinkFrequency; // Częstotliwość migania w ms
-    
-    // Zmienne do migania
-    bool blinkState;
-    unsigned long lastBlinkTime;
+    LightConfig lightConfig;
+    LightPatternConfig patternConfig;
+
     bool configMode; // Tryb konfiguracji - wszystkie światła włączone
-    
-    // Aktualizacja stanu świateł
+
+    // Silnik wzorów
+    esp_timer_handle_t timer;
+    Seqlock<LightTargets> targets;    // Pętla główna -> timer
+    uint32_t appliedVersion;
+    OutputPlayer outputs[LIGHT_OUTPUT_COUNT];
+    uint8_t brakeLevel;
+    volatile bool brakeBoosted;
+    volatile uint32_t pwmWrites;
+    volatile uint32_t maxTickUs;
+
+    // Aktualizacja stanu świateł - publikacja wzorów dla timera
     void updateLights();
+    void publish(const LightTargets& next);
+    void setBlinkPattern();
+
+    static void timerCallback(void* arg);
+    void tick();
 };
 
 #endif // LIGHT_MANAGER_H
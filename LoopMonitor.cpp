@@ -0,0 +1,113 @@
+#include "LoopMonitor.h"
+
+// Przedzialy histogramu dobrane pod typowe czasy petli: od pojedynczych
+// odczytow przyciskow po pelne odswiezenie OLED przez I2C
+const uint32_t LoopMonitor::BUCKET_LIMITS_US[LoopMonitor::BUCKET_COUNT] = {
+    50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 0xFFFFFFFFUL
+};
+
+LoopMonitor::LoopMonitor() :
+    iterations(0),
+    minUs(0xFFFFFFFFUL),
+    maxUs(0),
+    heapDropCount(0),
+    heapDeltaSum(0),
+    lastTickUs(0),
+    lastFreeHeap(0),
+    windowStartMs(0),
+    started(false)
+{
+    memset(buckets, 0, sizeof(buckets));
+}
+
+void LoopMonitor::tick() {
+    uint32_t nowUs = micros();
+    uint32_t freeHeap = ESP.getFreeHeap();
+
+    if (!started) {
+        // Pierwsze wywolanie tylko ustala punkt odniesienia
+        started = true;
+        lastTickUs = nowUs;
+        lastFreeHeap = freeHeap;
+        windowStartMs = millis();
+        return;
+    }
+
+    uint32_t dt = nowUs - lastTickUs;
+    lastTickUs = nowUs;
+
+    uint8_t bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && dt > BUCKET_LIMITS_US[bucket]) {
+        bucket++;
+    }
+    buckets[bucket]++;
+
+    if (dt < minUs) minUs = dt;
+    if (dt > maxUs) maxUs = dt;
+
+    int32_t heapDelta = (int32_t)freeHeap - (int32_t)lastFreeHeap;
+    heapDeltaSum += heapDelta;
+    if (heapDelta < 0) {
+        heapDropCount++;
+    }
+    lastFreeHeap = freeHeap;
+
+    iterations++;
+}
+
+uint32_t LoopMonitor::percentile(uint8_t pct) const {
+    if (iterations == 0) return 0;
+
+    // Indeks probki odpowiadajacej percentylowi (zaokraglenie w gore)
+    uint32_t target = ((uint64_t)iterations * pct + 99) / 100;
+    uint32_t seen = 0;
+
+    for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            // Ostatni przedzial jest otwarty - zwroc zmierzone maksimum
+            return (i == BUCKET_COUNT - 1) ? maxUs : BUCKET_LIMITS_US[i];
+        }
+    }
+    return maxUs;
+}
+
+LoopMonitor::Report LoopMonitor::collect() {
+    Report report;
+    unsigned long nowMs = millis();
+
+    report.iterations = iterations;
+    report.windowMs = nowMs - windowStartMs;
+    report.iterationsPerSec = report.windowMs > 0 ? (uint32_t)((uint64_t)iterations * 1000 / report.windowMs) : 0;
+    report.minUs = iterations > 0 ? minUs : 0;
+    report.maxUs = maxUs;
+    report.p50Us = percentile(50);
+    report.p95Us = percentile(95);
+    report.p99Us = percentile(99);
+    report.heapDeltaPerIter = iterations > 0 ? heapDeltaSum / (int32_t)iterations : 0;
+    report.heapDropCount = heapDropCount;
+    report.minFreeHeap = ESP.getMinFreeHeap();
+
+    resetWindow();
+    windowStartMs = nowMs;
+
+    return report;
+}
+
+void LoopMonitor::printReport() {
+    Report r = collect();
+
+    DEBUG_INFO("Petla: %u it/s (%u it w %u ms), czas min/p50/p95/p99/max = %u/%u/%u/%u/%u us",
+        r.iterationsPerSec, r.iterations, r.windowMs, r.minUs, r.p50Us, r.p95Us, r.p99Us, r.maxUs);
+    DEBUG_INFO("Petla: sterta %d B/it, spadki sterty w %u it, min. wolna sterta %u B",
+        r.heapDeltaPerIter, r.heapDropCount, r.minFreeHeap);
+}
+
+void LoopMonitor::resetWindow() {
+    memset(buckets, 0, sizeof(buckets));
+    iterations = 0;
+    minUs = 0xFFFFFFFFUL;
+    maxUs = 0;
+    heapDropCount = 0;
+    heapDeltaSum = 0;
+}
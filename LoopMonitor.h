@@ -0,0 +1,59 @@
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#include <Arduino.h>
+#include "DebugUtils.h"
+
+// Pomiar przepustowości pętli loop() - punkt odniesienia dla zmian na gorącej ścieżce.
+// tick() wywoływane raz na początku każdej iteracji mierzy czas pełnego obiegu
+// (łącznie z narzutem rdzenia Arduino), bez alokacji i bez blokowania.
+class LoopMonitor {
+public:
+    // Górne granice przedziałów histogramu czasu iteracji [us]
+    static const uint8_t BUCKET_COUNT = 12;
+
+    struct Report {
+        uint32_t iterations;       // Liczba iteracji w oknie
+        uint32_t windowMs;         // Długość okna pomiarowego
+        uint32_t iterationsPerSec; // Iteracje na sekundę
+        uint32_t minUs;            // Najkrótsza iteracja
+        uint32_t maxUs;            // Najdłuższa iteracja
+        uint32_t p50Us;            // Mediana (górna granica przedziału)
+        uint32_t p95Us;            // 95. percentyl
+        uint32_t p99Us;            // 99. percentyl
+        int32_t heapDeltaPerIter;  // Średnia zmiana wolnej sterty na iterację [B]
+        uint32_t heapDropCount;    // Iteracje, w których ubyło sterty (przybliżenie alokacji)
+        uint32_t minFreeHeap;      // Najmniejsza wolna sterta od startu
+    };
+
+    LoopMonitor();
+
+    // Wywołaj na początku każdej iteracji loop()
+    void tick();
+
+    // Zwraca statystyki bieżącego okna i rozpoczyna nowe
+    Report collect();
+
+    // Wypisuje raport przez DEBUG_INFO i rozpoczyna nowe okno
+    void printReport();
+
+private:
+    static const uint32_t BUCKET_LIMITS_US[BUCKET_COUNT];
+
+    uint32_t buckets[BUCKET_COUNT];
+    uint32_t iterations;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t heapDropCount;
+    int32_t heapDeltaSum;
+
+    uint32_t lastTickUs;
+    uint32_t lastFreeHeap;
+    unsigned long windowStartMs;
+    bool started;
+
+    void resetWindow();
+    uint32_t percentile(uint8_t pct) const;
+};
+
+#endif // LOOP_MONITOR_H
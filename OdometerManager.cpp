@@ -0,0 +1,226 @@
+#include "OdometerManager.h"
+#include <ArduinoJson.h>
+#include <rom/crc.h>
+#include "Profiler.h"
+
+OdometerManager::OdometerManager() :
+    committedMeters(0),
+    pendingMeters(0),
+    sequence(0),
+    recordsInFile(0),
+    activeB(false),
+    lastCommitMs(0),
+    writeCount(0),
+    initialized(false)
+{
+}
+
+uint32_t OdometerManager::recordCrc(const OdometerRecord& record) {
+    return crc32_le(0, (const uint8_t*)&record, offsetof(OdometerRecord, crc));
+}
+
+bool OdometerManager::readLastRecord(const char* path, OdometerRecord& record, uint16_t& count, bool& torn) {
+    count = 0;
+    torn = false;
+    if (!LittleFS.exists(path)) {
+        return false;
+    }
+
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    // Niepełny rekord na końcu (przerwany zapis) jest pomijany
+    uint32_t records = file.size() / sizeof(OdometerRecord);
+    count = records > 0xFFFF ? 0xFFFF : records;
+    torn = file.size() % sizeof(OdometerRecord) != 0;
+
+    // Uszkodzony może być tylko ostatni rekord - sprawdzamy co najwyżej dwa
+    for (uint8_t back = 1; back <= 2 && back <= records; back++) {
+        file.seek((records - back) * sizeof(OdometerRecord));
+        if (file.read((uint8_t*)&record, sizeof(record)) == sizeof(record) &&
+            record.magic == ODOMETER_RECORD_MAGIC &&
+            record.crc == recordCrc(record)) {
+            file.close();
+            return true;
+        }
+    }
+
+    file.close();
+    return false;
+}
+
+bool OdometerManager::begin() {
+    if (!LittleFS.begin(false)) {
+        DEBUG_ERROR("Licznik: brak systemu plikow");
+        return false;
+    }
+
+    OdometerRecord recA, recB;
+    uint16_t countA, countB;
+    bool tornA, tornB;
+    bool validA = readLastRecord(ODOMETER_JOURNAL_A, recA, countA, tornA);
+    bool validB = readLastRecord(ODOMETER_JOURNAL_B, recB, countB, tornB);
+
+    if (validA || validB) {
+        // Nowszy rekord ma wyższy numer sekwencyjny
+        bool useA = validA && (!validB || (int32_t)(recA.sequence - recB.sequence) > 0);
+        const OdometerRecord& latest = useA ? recA : recB;
+
+        committedMeters = latest.totalMeters;
+        sequence = latest.sequence;
+        activeB = !useA;
+        recordsInFile = useA ? countA : countB;
+        initialized = true;
+
+        // Urwany ogon przesunąłby kolejne dopisane rekordy względem granic -
+        // następny zapis idzie do drugiego pliku, ten zostaje kopią
+        if (useA ? tornA : tornB) {
+            recordsInFile = ODOMETER_MAX_RECORDS;
+            DEBUG_WARN("Licznik: niepelny rekord na koncu %s", getActiveFile());
+        }
+
+        DEBUG_INFO("Licznik: %.3f km (rekord %u, %s)", committedMeters / 1000.0f, sequence, getActiveFile());
+    } else {
+        initialized = true;
+
+        // Urwany pierwszy rekord (lub zapis przeniesionego licznika) - dopisywanie za
+        // nim przesunęłoby wszystkie kolejne rekordy; bez poprawnych rekordów nie ma
+        // czego chronić, więc pierwszy zapis zaczyna drugi plik od nowa
+        if (tornA || tornB) {
+            recordsInFile = ODOMETER_MAX_RECORDS;
+            DEBUG_WARN("Licznik: niepelny rekord bez poprzednich (%s)", tornA ? ODOMETER_JOURNAL_A : ODOMETER_JOURNAL_B);
+        }
+
+        if (!migrateLegacy()) {
+            committedMeters = 0;
+            DEBUG_INFO("Licznik: brak dziennika, start od zera");
+        }
+    }
+
+    // pendingMeters zostaje - odcinek przejechany przed begin() (szybkie wybudzenie)
+    lastCommitMs = millis();
+    return true;
+}
+
+bool OdometerManager::migrateLegacy() {
+    if (!LittleFS.exists(ODOMETER_LEGACY_FILE)) {
+        return false;
+    }
+
+    File file = LittleFS.open(ODOMETER_LEGACY_FILE, "r");
+    if (!file) {
+        return false;
+    }
+
+    StaticJsonDocument<128> doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+
+    if (error) {
+        DEBUG_ERROR("Licznik: nie mozna odczytac %s", ODOMETER_LEGACY_FILE);
+        return false;
+    }
+
+    // Dwa stare formaty: {"total": km} i {"value": km}
+    float km = max(doc["total"] | 0.0f, doc["value"] | 0.0f);
+    if (!commit((uint32_t)lroundf(km * 1000.0f))) {
+        return false;
+    }
+
+    LittleFS.remove(ODOMETER_LEGACY_FILE);
+    DEBUG_INFO("Licznik: przeniesiono %.2f km ze starego pliku", km);
+    return true;
+}
+
+bool OdometerManager::commit(uint32_t totalMeters) {
+    PROFILE_SCOPE(PERF_ODOMETER_WRITE);
+    // Przełączenie pliku po zapełnieniu - drugi plik jest czyszczony,
+    // bieżący zostaje nietknięty jako kopia ostatniego stanu
+    const char* mode = "a";
+    if (recordsInFile >= ODOMETER_MAX_RECORDS) {
+        activeB = !activeB;
+        recordsInFile = 0;
+        mode = "w";
+    }
+
+    OdometerRecord record;
+    record.magic = ODOMETER_RECORD_MAGIC;
+    record.reserved = 0;
+    record.sequence = sequence + 1;
+    record.totalMeters = totalMeters;
+    record.crc = recordCrc(record);
+
+    File file = LittleFS.open(getActiveFile(), mode);
+    if (!file) {
+        DEBUG_ERROR("Licznik: nie mozna otworzyc %s", getActiveFile());
+        return false;
+    }
+
+    size_t written = file.write((const uint8_t*)&record, sizeof(record));
+    file.close();
+
+    if (written != sizeof(record)) {
+        DEBUG_ERROR("Licznik: blad zapisu rekordu");
+        return false;
+    }
+
+    sequence = record.sequence;
+    committedMeters = totalMeters;
+    recordsInFile++;
+    writeCount++;
+    lastCommitMs = millis();
+    return true;
+}
+
+float OdometerManager::getRawTotal() const {
+    return (committedMeters + pendingMeters) / 1000.0f;
+}
+
+bool OdometerManager::setInitialValue(float km) {
+    if (km < 0) {
+        DEBUG_ERROR("Bledna wartosc poczatkowa (ujemna)");
+        return false;
+    }
+
+    DEBUG_INFO("Ustawianie poczatkowej wartosci licznika: %.2f", km);
+
+    pendingMeters = 0;
+    return commit((uint32_t)lroundf(km * 1000.0f));
+}
+
+void OdometerManager::resume(uint32_t totalMeters) {
+    if (!initialized) {
+        committedMeters = totalMeters;
+    }
+}
+
+void OdometerManager::addDistance(float km) {
+    if (km <= 0) return;
+
+    pendingMeters += km * 1000.0f;
+    if (initialized && pendingMeters >= ODOMETER_COMMIT_METERS) {
+        flush();
+    }
+}
+
+void OdometerManager::update() {
+    if (initialized && pendingMeters >= 1.0f && millis() - lastCommitMs >= ODOMETER_COMMIT_INTERVAL_MS) {
+        flush();
+    }
+}
+
+bool OdometerManager::flush() {
+    if (!initialized) return false;
+
+    // Ułamek metra zostaje w pamięci do kolejnego zapisu
+    uint32_t whole = (uint32_t)pendingMeters;
+    if (whole == 0) return true;
+
+    if (!commit(committedMeters + whole)) {
+        return false;
+    }
+    pendingMeters -= whole;
+    return true;
+}
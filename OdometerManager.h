@@ -1,115 +1,82 @@
-class OdometerManager {
-private:
-    Preferences preferences;
-    const char* NAMESPACE = "odometer";
-    const char* TOTAL_KEY = "total";
-    float currentTotal = 0.0f;
-    bool initialized = false;
+#ifndef ODOMETER_MANAGER_H
+#define ODOMETER_MANAGER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "DebugUtils.h"
+
+// Licznik całkowity zapisywany jako dziennik rekordów stałej długości.
+// Rekordy z numerem sekwencyjnym i CRC są dopisywane na koniec jednego z dwóch
+// plików; po zapełnieniu pliku zapis przechodzi do drugiego (poprzedni zostaje
+// jako kopia). Przy starcie wystarczy odczytać ostatni rekord każdego pliku.
+// Zapisy są grupowane - co ODOMETER_COMMIT_METERS albo ODOMETER_COMMIT_INTERVAL_MS.
+
+#define ODOMETER_JOURNAL_A "/odo_a.bin"
+#define ODOMETER_JOURNAL_B "/odo_b.bin"
+#define ODOMETER_LEGACY_FILE "/odometer.json"
+
+#define ODOMETER_RECORD_MAGIC 0x4F44        // "OD"
+#define ODOMETER_MAX_RECORDS 256            // Rekordów w pliku przed przełączeniem (4 KB)
+#define ODOMETER_COMMIT_METERS 100          // Zapis po przejechaniu 100 m
+#define ODOMETER_COMMIT_INTERVAL_MS 60000UL // lub po minucie od ostatniego zapisu
+
+struct __attribute__((packed)) OdometerRecord {
+    uint16_t magic;
+    uint16_t reserved;
+    uint32_t sequence;     // Rośnie z każdym zapisem
+    uint32_t totalMeters;  // Przebieg całkowity [m]
+    uint32_t crc;          // CRC32 poprzednich pól
+};
 
+class OdometerManager {
 public:
-    OdometerManager() {
-        loadFromPreferences();
-    }
-
-    ~OdometerManager() {
-        // Upewnij sie, ze Preferences sa zamkniete
-        if (preferences.isOpen()) {
-            preferences.end();
-        }
-    }
-
-    void loadFromPreferences() {
-        DEBUG_INFO("Wczytywanie licznika z preferencji...");
-
-        if (!preferences.begin(NAMESPACE, false)) {
-            DEBUG_ERROR("Nie mozna otworzyc przestrzeni nazw Preferences");
-            currentTotal = 0.0f;
-            initialized = false;
-            return;
-        }
-
-        currentTotal = preferences.getFloat(TOTAL_KEY, 0.0f);
-        initialized = true;
-        preferences.end();
-
-        DEBUG_INFO("Wczytano licznik: %.2f", currentTotal);
-    }
-
-    bool saveToPreferences() {
-        DEBUG_INFO("Zapisywanie licznika do preferencji...");
-
-        if (!preferences.begin(NAMESPACE, false)) {
-            DEBUG_ERROR("Nie mozna otworzyc przestrzeni nazw Preferences");
-            return false;
-        }
-
-        preferences.putFloat(TOTAL_KEY, currentTotal);
-        bool success = preferences.isKey(TOTAL_KEY); // Sprawdz czy zapis sie powiodl
-        preferences.end();
-
-        if (success) {
-            DEBUG_INFO("Zapisano licznik: %.2f", currentTotal);
-            initialized = true;
-        } else {
-            DEBUG_ERROR("Blad zapisu licznika");
-        }
-
-        return success;
-    }
-
-    float getRawTotal() const {
-        return currentTotal;
-    }
-
-    bool setInitialValue(float value) {
-        if (value < 0.0f) {
-            DEBUG_ERROR("Blad: ujemna wartosc licznika");
-            return false;
-        }
-
-        DEBUG_INFO("Ustawianie poczatkowej wartosci licznika: %.2f", value);
-
-        currentTotal = value;
-        return saveToPreferences();
-    }
-
-    void updateTotal(float newValue) {
-        if (newValue > currentTotal) {
-            DEBUG_INFO("Aktualizacja licznika z %.2f na %.2f", currentTotal, newValue);
-            
-            currentTotal = newValue;
-            saveToPreferences();
-        }
-    }
-
-    bool isValid() const {
-        return initialized;
-    }
-
-    // Metoda do recznej inicjalizacji (jesli konstruktor nie zadziala)
-    bool initialize() {
-        loadFromPreferences();
-        return initialized;
-    }
-
-    // Metoda do resetowania licznika
-    bool resetOdometer() {
-        currentTotal = 0.0f;
-        return saveToPreferences();
-    }
-
-    // Metoda do debugowania stanu Preferences
-    void debugPreferences() {
-        DEBUG_DETAIL("=== Diagnostyka OdometerManager ===");
-        
-        if (!preferences.begin(NAMESPACE, true)) { // Tryb tylko do odczytu
-            DEBUG_ERROR("Nie mozna otworzyc przestrzeni nazw Preferences");
-            return;
-        }
-        
-        DEBUG_DETAIL("Klucze w przestrzeni nazw %s:", NAMESPACE);
-        DEBUG_DETAIL("- Licznik (total): %.2f", preferences.getFloat(TOTAL_KEY, -1.0f));
-        
-        preferences.end();
-    }
+    OdometerManager();
+
+    // Odtworzenie stanu z dziennika (wymaga zamontowanego LittleFS)
+    bool begin();
+
+    // Przebieg z kopii w pamięci RTC (szybkie wybudzenie) - tylko do wyświetlania,
+    // do czasu begin(), który odczytuje dziennik; zapisy są możliwe dopiero po begin()
+    void resume(uint32_t totalMeters);
+
+    // Przebieg w km (z niezapisaną jeszcze częścią)
+    float getRawTotal() const;
+    uint32_t getTotalMeters() const { return committedMeters + (uint32_t)pendingMeters; }
+
+    // Ustawienie przebiegu (np. przeniesienie z innego licznika) - zapis natychmiastowy
+    bool setInitialValue(float km);
+
+    // Dodanie przejechanego odcinka; zapis, gdy uzbiera się ODOMETER_COMMIT_METERS
+    void addDistance(float km);
+
+    // Zapis po upływie ODOMETER_COMMIT_INTERVAL_MS (wołać okresowo)
+    void update();
+
+    // Natychmiastowy zapis niezapisanej części (np. przed uśpieniem)
+    bool flush();
+
+    bool isValid() const { return initialized; }
+
+    // Diagnostyka
+    uint32_t getSequence() const { return sequence; }
+    uint32_t getWriteCount() const { return writeCount; }
+    uint16_t getRecordsInFile() const { return recordsInFile; }
+    const char* getActiveFile() const { return activeB ? ODOMETER_JOURNAL_B : ODOMETER_JOURNAL_A; }
+
+private:
+    uint32_t committedMeters;   // Ostatnia zapisana wartość
+    float pendingMeters;        // Przejechane od ostatniego zapisu
+    uint32_t sequence;
+    uint16_t recordsInFile;
+    bool activeB;               // Bieżący plik: A albo B
+    unsigned long lastCommitMs;
+    uint32_t writeCount;
+    bool initialized;
+
+    static uint32_t recordCrc(const OdometerRecord& record);
+    static bool readLastRecord(const char* path, OdometerRecord& record, uint16_t& count, bool& torn);
+    bool migrateLegacy();
+    bool commit(uint32_t totalMeters);
 };
+
+#endif // ODOMETER_MANAGER_H
@@ -0,0 +1,41 @@
+#include "Profiler.h"
+
+static const char* const SECTION_NAMES[PERF_SECTION_COUNT] = {
+    "controller", "buttons", "cadence", "lights", "display", "drawMain", "displayFlush",
+    "temperature", "bms", "tpms", "websocket", "rideWrite", "settingsWrite", "odometerWrite"
+};
+
+Profiler::Section Profiler::sections[PERF_SECTION_COUNT];
+Profiler::TaskInfo Profiler::tasks[Profiler::MAX_TASKS];
+uint8_t Profiler::taskCount = 0;
+unsigned long Profiler::statsStartMs = 0;
+
+const char* Profiler::getName(PerfSection section) {
+    return section < PERF_SECTION_COUNT ? SECTION_NAMES[section] : "?";
+}
+
+void Profiler::read(PerfSection section, Section& out) {
+    memcpy(&out, &sections[section], sizeof(out));
+}
+
+void Profiler::reset() {
+    memset(sections, 0, sizeof(sections));
+    statsStartMs = millis();
+}
+
+void Profiler::watchTask(const char* name, TaskHandle_t handle) {
+    if (handle == nullptr) {
+        return;
+    }
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (strcmp(tasks[i].name, name) == 0) {
+            tasks[i].handle = handle;  // Zadanie uruchomione ponownie
+            return;
+        }
+    }
+    if (taskCount < MAX_TASKS) {
+        tasks[taskCount].name = name;
+        tasks[taskCount].handle = handle;
+        taskCount++;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Profiler gorącej ścieżki: PROFILE_SCOPE(PERF_x) na początku bloku mierzy czas
+// do końca bloku licznikiem cykli CPU (CCOUNT) i dopisuje go do histogramu sekcji.
+// Przedział i histogramu to [2^i, 2^(i+1)) cykli; do tego liczba wywołań, suma i maksimum.
+// Pomiar to dwa odczyty rejestru i kilka dodawań, bez blokad i alokacji.
+// Z PROFILING 0 makro znika całkowicie.
+//
+// Licznik cykli jest osobny dla każdego rdzenia - sekcje mierzone są w zadaniach
+// przypiętych do rdzenia (loop, zadanie usług, zadanie zapisu OLED). Sekcję
+// aktualizuje jedno zadanie; reset z WWW może zgubić pojedynczy pomiar - tylko diagnostyka.
+
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+// Sekcje pomiarowe - nazwy w Profiler.cpp
+enum PerfSection : uint8_t {
+    PERF_CONTROLLER = 0,   // Ramki sterownika KT
+    PERF_BUTTONS,          // Gesty przycisków i akcje
+    PERF_CADENCE,          // Przeliczenie kadencji z impulsów
+    PERF_LIGHTS,           // Zmiana trybu świateł i podświetlenia
+    PERF_DISPLAY,          // Zadanie wyświetlacza: sygnatury, rysowanie, przekazanie klatki
+    PERF_DRAW_MAIN,        // drawMainDisplay()
+    PERF_DISPLAY_FLUSH,    // Wysłanie klatki przez I2C (zadanie zapisu OLED)
+    PERF_TEMPERATURE,      // Odczyt i konwersja temperatur
+    PERF_BMS,              // Zapytania BMS
+    PERF_TPMS,             // Odczyty TPMS i harmonogram skanowania
+    PERF_WEBSOCKET,        // Budowa i wysyłka telemetrii
+    PERF_RIDE_WRITE,       // Zapis bloku przejazdu na LittleFS
+    PERF_SETTINGS_WRITE,   // Zapis ustawień na LittleFS
+    PERF_ODOMETER_WRITE,   // Dopisanie rekordu licznika
+    PERF_SECTION_COUNT
+};
+
+class Profiler {
+public:
+    static const uint8_t BUCKET_COUNT = 32;
+    static const uint8_t MAX_TASKS = 6;
+
+    struct Section {
+        uint32_t count;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint32_t buckets[BUCKET_COUNT];
+    };
+
+    struct TaskInfo {
+        const char* name;
+        TaskHandle_t handle;
+    };
+
+    static inline void record(PerfSection section, uint32_t cycles) {
+        Section& s = sections[section];
+        s.count++;
+        s.totalCycles += cycles;
+        if (cycles > s.maxCycles) s.maxCycles = cycles;
+        s.buckets[31 - __builtin_clz(cycles | 1)]++;
+    }
+
+    static const char* getName(PerfSection section);
+
+    // Kopia sekcji do odpowiedzi WWW (dane mogą rosnąć w trakcie)
+    static void read(PerfSection section, Section& out);
+
+    static void reset();
+    static unsigned long getStatsStartMs() { return statsStartMs; }
+
+    // Zadania, których zapas stosu pokazuje /api/perf
+    static void watchTask(const char* name, TaskHandle_t handle);
+    static uint8_t getTaskCount() { return taskCount; }
+    static const TaskInfo& getTask(uint8_t index) { return tasks[index]; }
+
+private:
+    static Section sections[PERF_SECTION_COUNT];
+    static TaskInfo tasks[MAX_TASKS];
+    static uint8_t taskCount;
+    static unsigned long statsStartMs;
+};
+
+// Pomiar od konstrukcji do końca bloku
+class ProfileScope {
+public:
+    explicit ProfileScope(PerfSection section) : section(section), startCycles(ESP.getCycleCount()) {}
+    ~ProfileScope() { Profiler::record(section, ESP.getCycleCount() - startCycles); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    PerfSection section;
+    uint32_t startCycles;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILING
+    #define PROFILE_SCOPE(section) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(section)
+#else
+    #define PROFILE_SCOPE(section) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,164 @@
+#include "PulseRateFilter.h"
+
+PulseRateFilter::PulseRateFilter(uint32_t timeoutUs) :
+    timeoutUs(timeoutUs),
+    pulsesPerRev(1),
+    head(0),
+    count(0),
+    hasLast(false),
+    lastStampUs(0),
+    splitStreak(0),
+    instant(0),
+    smoothed(0),
+    maximum(0),
+    tripActiveUs(0),
+    tripIntervals(0),
+    rejected(0),
+    recovered(0)
+{
+}
+
+void PulseRateFilter::setPulsesPerRevolution(uint8_t pulses) {
+    if (pulses == 0) pulses = 1;
+    if (pulses != pulsesPerRev) {
+        pulsesPerRev = pulses;
+        reset();
+    }
+}
+
+void PulseRateFilter::reset() {
+    count = 0;
+    hasLast = false;
+    splitStreak = 0;
+    instant = 0;
+    smoothed = 0;
+    resetTrip();
+}
+
+void PulseRateFilter::resetTrip() {
+    maximum = 0;
+    tripActiveUs = 0;
+    tripIntervals = 0;
+}
+
+void PulseRateFilter::pushInterval(uint32_t intervalUs) {
+    head = (head + 1) & (PULSE_FILTER_HISTORY - 1);
+    intervals[head] = intervalUs;
+    if (count < PULSE_FILTER_HISTORY) count++;
+
+    tripActiveUs += intervalUs;
+    tripIntervals++;
+}
+
+// Mediana z najnowszych (do 5) odstępów - sortowanie przez wstawianie na kopii
+uint32_t PulseRateFilter::medianInterval() const {
+    uint8_t n = min(count, (uint8_t)PULSE_FILTER_MEDIAN);
+    uint32_t sorted[PULSE_FILTER_MEDIAN];
+
+    for (uint8_t i = 0; i < n; i++) {
+        uint32_t value = intervals[(head - i) & (PULSE_FILTER_HISTORY - 1)];
+        int8_t j = i - 1;
+        while (j >= 0 && sorted[j] > value) {
+            sorted[j + 1] = sorted[j];
+            j--;
+        }
+        sorted[j + 1] = value;
+    }
+    return sorted[n / 2];
+}
+
+uint32_t PulseRateFilter::toMilliRpm(uint64_t spanUs, uint32_t intervalCount) const {
+    if (spanUs == 0) return 0;
+    // obroty/min * 1000 = odstępy * 60e6 us * 1000 / (czas * impulsy na obrót)
+    return (uint32_t)((uint64_t)intervalCount * 60000000000ULL / (spanUs * pulsesPerRev));
+}
+
+void PulseRateFilter::addPulse(uint32_t stampUs) {
+    if (!hasLast) {
+        hasLast = true;
+        lastStampUs = stampUs;
+        return;
+    }
+
+    uint32_t interval = stampUs - lastStampUs;
+    if (interval >= timeoutUs) {
+        // Początek nowej serii - stare odstępy nie opisują już ruchu
+        count = 0;
+        splitStreak = 0;
+        lastStampUs = stampUs;
+        return;
+    }
+
+    if (count >= 3) {
+        uint32_t median = medianInterval();
+
+        if (interval * 5 < median * 2) {
+            // Drgania styku lub zakłócenie - impuls pomijany, odstęp liczony od poprzedniego
+            rejected++;
+            return;
+        }
+
+        // Zgubione impulsy: odstęp bliski k-krotności mediany
+        uint32_t k = (interval + median / 2) / median;
+        if (k >= 2 && k <= PULSE_FILTER_MAX_SPLIT) {
+            uint32_t expected = median * k;
+            uint32_t error = (interval > expected) ? interval - expected : expected - interval;
+            if (error * 4 < median) {
+                if (splitStreak < PULSE_FILTER_SPLIT_STREAK) {
+                    splitStreak++;
+                    for (uint32_t i = 0; i < k; i++) {
+                        pushInterval(interval / k);
+                    }
+                    recovered += k - 1;
+                    lastStampUs = stampUs;
+                    return;
+                }
+
+                // Mediana sama jest z podzielonych odstępów - to wolniejsze tempo
+                // (np. kadencja spadła o połowę), nie kolejne zgubione impulsy
+                count = 0;
+            }
+        }
+    }
+
+    splitStreak = 0;
+    pushInterval(interval);
+    lastStampUs = stampUs;
+}
+
+void PulseRateFilter::update(uint32_t nowUs) {
+    uint32_t sinceLast = nowUs - lastStampUs;
+
+    if (!hasLast || count == 0 || sinceLast >= timeoutUs) {
+        count = 0;
+        instant = 0;
+        smoothed = 0;
+        return;
+    }
+
+    uint32_t median = medianInterval();
+    instant = toMilliRpm(median, 1);
+
+    // Okno adaptacyjne: najnowsze odstępy aż do ok. 1 s (co najmniej 2, jeśli są)
+    uint64_t span = 0;
+    uint8_t used = 0;
+    while (used < count && (used < 2 || span < PULSE_FILTER_WINDOW_US)) {
+        span += intervals[(head - used) & (PULSE_FILTER_HISTORY - 1)];
+        used++;
+    }
+    smoothed = toMilliRpm(span, used);
+
+    // Po ustaniu impulsów wartość nie może być wyższa niż wynikająca z czasu od ostatniego;
+    // próg powyżej PULSE_FILTER_MAX_SPLIT median, żeby zgubione impulsy nie powodowały spadku
+    if (sinceLast * 2 > median * (2 * PULSE_FILTER_MAX_SPLIT + 1)) {
+        uint32_t bound = toMilliRpm(sinceLast, 1);
+        if (instant > bound) instant = bound;
+        if (smoothed > bound) smoothed = bound;
+    }
+
+    if (smoothed > maximum) maximum = smoothed;
+}
+
+uint32_t PulseRateFilter::getAverageMilliRpm() const {
+    return toMilliRpm(tripActiveUs, tripIntervals);
+}
@@ -0,0 +1,90 @@
+#ifndef PULSE_RATE_FILTER_H
+#define PULSE_RATE_FILTER_H
+
+#include <Arduino.h>
+
+// Częstotliwość obrotów z impulsów czujnika (kadencja, kontaktron koła), tylko na liczbach
+// całkowitych. Wynik w tysięcznych obrotu na minutę (mRPM), żeby ten sam filtr nadawał
+// się do prędkości koła, gdzie potrzebna jest lepsza rozdzielczość niż 1 RPM.
+//
+// Etapy:
+//  - odrzucanie zakłóceń: odstęp krótszy niż 40% mediany z 5 ostatnich to drgania styku
+//    (impuls pomijany), odstęp bliski wielokrotności mediany to zgubione impulsy
+//    (dzielony na równe części); po PULSE_FILTER_SPLIT_STREAK kolejnych podziałach
+//    długi odstęp to już wolniejsze tempo, a nie zgubione impulsy - nowa seria
+//  - chwilowa: z mediany 5 ostatnich odstępów
+//  - wygładzona: okno adaptacyjne - tyle ostatnich odstępów, by objęły ok. 1 s
+//    (przy wolnym pedałowaniu 2-3 impulsy, przy szybkim do PULSE_FILTER_HISTORY)
+//  - brak impulsu przez timeoutUs = 0; wcześniej wartość opada zgodnie z czasem od
+//    ostatniego impulsu zamiast trzymać ostatni odczyt
+//  - średnia przejazdu: obroty / czas aktywny (bez postojów), maksimum z wartości wygładzonej
+
+#define PULSE_FILTER_HISTORY 16          // Potęga dwójki
+#define PULSE_FILTER_MEDIAN 5
+#define PULSE_FILTER_WINDOW_US 1000000UL // Docelowa długość okna wygładzania
+#define PULSE_FILTER_MAX_SPLIT 4         // Najwięcej zgubionych impulsów w jednym odstępie
+#define PULSE_FILTER_SPLIT_STREAK 2      // Najwięcej kolejnych odstępów dzielonych z rzędu
+
+class PulseRateFilter {
+public:
+    explicit PulseRateFilter(uint32_t timeoutUs);
+
+    // Liczba impulsów na obrót (np. magnesy na tarczy korby)
+    void setPulsesPerRevolution(uint8_t pulses);
+
+    // Znacznik micros() impulsu, w kolejności odbioru
+    void addPulse(uint32_t stampUs);
+
+    // Przeliczenie wartości - wołać okresowo, także gdy nie ma impulsów
+    void update(uint32_t nowUs);
+
+    uint32_t getInstantMilliRpm() const { return instant; }
+    uint32_t getSmoothedMilliRpm() const { return smoothed; }
+    uint32_t getAverageMilliRpm() const;
+    uint32_t getMaxMilliRpm() const { return maximum; }
+
+    // Zaokrąglone do pełnych RPM
+    uint16_t getRpm() const { return (smoothed + 500) / 1000; }
+    uint16_t getAverageRpm() const { return (getAverageMilliRpm() + 500) / 1000; }
+    uint16_t getMaxRpm() const { return (maximum + 500) / 1000; }
+
+    bool isActive() const { return count > 0; }
+    uint32_t getLastPulseUs() const { return lastStampUs; }
+
+    // Diagnostyka filtra
+    uint32_t getRejectedPulses() const { return rejected; }
+    uint32_t getRecoveredPulses() const { return recovered; }
+
+    // Zerowanie średniej i maksimum (nowy przejazd)
+    void resetTrip();
+
+    // Pełne zerowanie (np. zmiana liczby impulsów na obrót)
+    void reset();
+
+private:
+    uint32_t timeoutUs;
+    uint8_t pulsesPerRev;
+
+    uint32_t intervals[PULSE_FILTER_HISTORY];  // Odstępy [us], head = najnowszy
+    uint8_t head;
+    uint8_t count;
+    bool hasLast;
+    uint32_t lastStampUs;
+    uint8_t splitStreak;     // Kolejne odstępy podzielone jako zgubione impulsy
+
+    uint32_t instant;
+    uint32_t smoothed;
+    uint32_t maximum;
+
+    uint64_t tripActiveUs;   // Suma zaakceptowanych odstępów
+    uint32_t tripIntervals;  // Liczba zaakceptowanych odstępów
+
+    uint32_t rejected;
+    uint32_t recovered;
+
+    void pushInterval(uint32_t intervalUs);
+    uint32_t medianInterval() const;
+    uint32_t toMilliRpm(uint64_t spanUs, uint32_t intervalCount) const;
+};
+
+#endif // PULSE_RATE_FILTER_H
@@ -0,0 +1,78 @@
+#include "RideComputer.h"
+#include <limits.h>
+
+RideComputer::RideComputer(KtController& controller, const JbdBms& bms, OdometerManager& odometer,
+                           EnergyEstimator& energy, TripMetrics& tripMetrics) :
+    controller(controller),
+    bms(bms),
+    odometer(odometer),
+    energy(energy),
+    tripMetrics(tripMetrics),
+    speedKmh(0.0f),
+    batteryCurrent(0.0f),
+    batteryVoltage(0.0f),
+    powerW(0),
+    lastFrameUs(0)
+{
+}
+
+bool RideComputer::update(Stream& port, float wheelCircumferenceM) {
+    if (!controller.poll(port)) {
+        // Sterownik milczy - nie pokazujemy ostatnich wartości jako bieżących
+        if (lastFrameUs != 0 && !controller.isConnected(RIDE_KT_LINK_TIMEOUT_MS)) {
+            onLinkLost();
+        }
+        return false;
+    }
+
+    onFrame(controller.getTelemetry(), wheelCircumferenceM);
+    return true;
+}
+
+void RideComputer::onLinkLost() {
+    speedKmh = 0.0f;
+    batteryCurrent = 0.0f;
+    powerW = 0;
+    lastFrameUs = 0;
+    tripMetrics.pause(TRIP_SPEED);
+    tripMetrics.pause(TRIP_POWER);
+}
+
+void RideComputer::onFrame(const KtTelemetry& kt, float wheelCircumferenceM) {
+    float newSpeed = 0.0f;
+    if (kt.wheelPeriodMs > 0 && kt.wheelPeriodMs < KT_WHEEL_PERIOD_STOPPED) {
+        newSpeed = wheelCircumferenceM * 3600.0f / kt.wheelPeriodMs;
+    }
+
+    // Całkowanie dystansu metodą trapezów między kolejnymi ramkami;
+    // po dłuższej przerwie prędkość między ramkami jest nieznana - bez całkowania
+    if (lastFrameUs != 0 && kt.publishedUs - lastFrameUs <= RIDE_MAX_FRAME_GAP_US) {
+        float dtHours = (kt.publishedUs - lastFrameUs) / 3600000000.0f;
+        float deltaKm = (speedKmh + newSpeed) * 0.5f * dtHours;
+        odometer.addDistance(deltaKm);
+        energy.addDistance(deltaKm);
+    }
+    lastFrameUs = kt.publishedUs;
+
+    speedKmh = newSpeed;
+    batteryCurrent = kt.current;
+
+    // Energia: pomiar BMS, jeśli świeży (prąd JBD ujemny przy rozładowaniu), inaczej prąd
+    // sterownika z ostatnim napięciem BMS, o ile nie jest zbyt stare
+    BmsData bmsData;
+    bool hasBasic = bms.read(bmsData) && bmsData.basicUpdateMs != 0;
+    unsigned long bmsAgeMs = hasBasic ? millis() - bmsData.basicUpdateMs : ULONG_MAX;
+    if (hasBasic && bmsAgeMs < RIDE_BMS_ENERGY_TIMEOUT_MS) {
+        batteryVoltage = bmsData.voltage;
+        energy.addSample(kt.publishedUs, bmsData.voltage, -bmsData.current);
+    } else if (hasBasic && bmsAgeMs < RIDE_BMS_VOLTAGE_TIMEOUT_MS) {
+        batteryVoltage = bmsData.voltage;
+        energy.addSample(kt.publishedUs, bmsData.voltage, batteryCurrent);
+    }
+
+    powerW = (int)(batteryVoltage * batteryCurrent);
+
+    uint32_t nowMs = millis();
+    tripMetrics.add(TRIP_SPEED, speedKmh, nowMs);
+    tripMetrics.add(TRIP_POWER, powerW, nowMs);
+}
@@ -0,0 +1,56 @@
+#ifndef RIDE_COMPUTER_H
+#define RIDE_COMPUTER_H
+
+#include <Arduino.h>
+#include "EnergyEstimator.h"
+#include "JbdBms.h"
+#include "KtController.h"
+#include "OdometerManager.h"
+#include "TripMetrics.h"
+
+// Prędkość, moc, dystans i energia z ramek sterownika KT (rdzeń 1).
+//
+// Jedna ścieżka dla firmware i symulatora na PC: odbiór ramek, wyzerowanie
+// wartości bieżących po utracie łącza, całkowanie dystansu metodą trapezów
+// między ramkami (licznik, energia na km) i próbki energii z napięciem BMS.
+// Ramki KT nie niosą napięcia - bez świeżego pomiaru BMS próbka energii jest
+// pomijana zamiast liczyć energię z 0 V.
+
+#define RIDE_KT_LINK_TIMEOUT_MS 1000        // Bez ramek dłużej - prędkość i moc zerowane
+#define RIDE_MAX_FRAME_GAP_US 500000UL      // Dłuższa przerwa między ramkami - bez całkowania dystansu
+#define RIDE_BMS_ENERGY_TIMEOUT_MS 3000     // Starszy pomiar BMS - energia z prądu sterownika
+#define RIDE_BMS_VOLTAGE_TIMEOUT_MS 60000   // Starsze napięcie BMS - energia nie jest liczona
+
+class RideComputer {
+public:
+    RideComputer(KtController& controller, const JbdBms& bms, OdometerManager& odometer,
+                 EnergyEstimator& energy, TripMetrics& tripMetrics);
+
+    // Odbiór ramek z UART sterownika; true, gdy przetworzono nową ramkę
+    bool update(Stream& port, float wheelCircumferenceM);
+
+    float getSpeedKmh() const { return speedKmh; }
+    float getBatteryCurrent() const { return batteryCurrent; }
+    float getBatteryVoltage() const { return batteryVoltage; }  // Ostatnie napięcie BMS użyte do mocy (0 - brak)
+    int getPowerW() const { return powerW; }
+    float getDistanceKm() const { return energy.getTripKm(); }  // Dystans przejazdu
+    bool isLinkActive() const { return lastFrameUs != 0; }
+
+private:
+    KtController& controller;
+    const JbdBms& bms;
+    OdometerManager& odometer;
+    EnergyEstimator& energy;
+    TripMetrics& tripMetrics;
+
+    float speedKmh;
+    float batteryCurrent;
+    float batteryVoltage;
+    int powerW;
+    uint32_t lastFrameUs;       // publishedUs poprzedniej ramki; 0 - brak łącza
+
+    void onLinkLost();
+    void onFrame(const KtTelemetry& kt, float wheelCircumferenceM);
+};
+
+#endif // RIDE_COMPUTER_H
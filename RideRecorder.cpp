@@ -0,0 +1,391 @@
+#include "RideRecorder.h"
+#include <rom/crc.h>
+#include "Profiler.h"
+
+const char* const RideRecorder::COLUMN_NAMES[RIDE_COLUMN_COUNT] = {
+    "time_s", "speed_kmh", "cadence_rpm", "power_w", "voltage_v",
+    "current_a", "battery_pct", "temp_air_c", "temp_motor_c", "distance_km"
+};
+
+const uint16_t RideRecorder::COLUMN_DIVISORS[RIDE_COLUMN_COUNT] = {
+    1000, 10, 1, 1, 10, 10, 1, 10, 10, 1000
+};
+
+// --- Kodowanie zigzag + varint ---
+
+static inline uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static inline uint8_t* putVarint(uint8_t* p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return p;
+        }
+    }
+    return nullptr;  // Uszkodzone dane
+}
+
+static uint32_t blockCrc(const RideBlockHeader& header, const uint8_t* data, uint16_t len) {
+    uint32_t crc = crc32_le(0, (const uint8_t*)&header, offsetof(RideBlockHeader, crc));
+    return crc32_le(crc, data, len);
+}
+
+// --- RideRecorder ---
+
+RideRecorder::RideRecorder() :
+    sampleRateHz(2),
+    active(false),
+    currentId(0),
+    nextId(1),
+    blocksWritten(0),
+    bytesWritten(0)
+{
+}
+
+void RideRecorder::buildPath(uint16_t id, char* path, size_t len) {
+    snprintf(path, len, RIDES_DIR "/%05u.bin", id);
+}
+
+bool RideRecorder::begin() {
+    if (!LittleFS.begin(false)) {
+        DEBUG_ERROR("Rejestrator: brak systemu plikow");
+        return false;
+    }
+
+    if (!LittleFS.exists(RIDES_DIR)) {
+        LittleFS.mkdir(RIDES_DIR);
+    }
+
+    // Kolejny numer przejazdu za najwyższym istniejącym
+    uint16_t maxId = 0;
+    File dir = LittleFS.open(RIDES_DIR);
+    if (dir && dir.isDirectory()) {
+        File entry = dir.openNextFile();
+        while (entry) {
+            uint16_t id = (uint16_t)atoi(entry.name());
+            if (id > maxId) maxId = id;
+            entry = dir.openNextFile();
+        }
+    }
+    nextId = maxId + 1;
+
+    DEBUG_INFO("Rejestrator: kolejny przejazd %u, %u Hz", nextId, sampleRateHz);
+    return true;
+}
+
+void RideRecorder::setSampleRate(uint8_t hz) {
+    if (hz < RIDE_MIN_RATE_HZ) hz = RIDE_MIN_RATE_HZ;
+    if (hz > RIDE_MAX_RATE_HZ) hz = RIDE_MAX_RATE_HZ;
+    sampleRateHz = hz;
+}
+
+bool RideRecorder::startRide(uint32_t startEpoch) {
+    if (active) {
+        finishRide();
+    }
+
+    if (!LittleFS.begin(false)) {
+        return false;
+    }
+
+    pruneOldRides();
+
+    char path[24];
+    buildPath(nextId, path, sizeof(path));
+    File file = LittleFS.open(path, "w");
+    if (!file) {
+        DEBUG_ERROR("Rejestrator: nie mozna utworzyc %s", path);
+        return false;
+    }
+
+    RideFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = RIDE_FILE_MAGIC;
+    header.version = RIDE_FORMAT_VERSION;
+    header.columnCount = RIDE_COLUMN_COUNT;
+    header.sampleRateHz = sampleRateHz;
+    header.startEpoch = startEpoch;
+    file.write((const uint8_t*)&header, sizeof(header));
+    file.close();
+
+    currentId = nextId++;
+    active = true;
+
+    // Próbki z poprzedniego przejazdu nie trafią do nowego pliku
+    RideSample discard;
+    while (ring.pop(discard)) {}
+
+    DEBUG_INFO("Rejestrator: start przejazdu %u", currentId);
+    return true;
+}
+
+void RideRecorder::finishRide() {
+    if (!active) return;
+
+    flush(true);
+    active = false;
+    DEBUG_INFO("Rejestrator: koniec przejazdu %u (%u blokow, %u B)", currentId, blocksWritten, bytesWritten);
+}
+
+void RideRecorder::record(const RideSample& sample) {
+    if (active) {
+        ring.push(sample);
+    }
+}
+
+void RideRecorder::flush(bool force) {
+    if (!active) return;
+
+    while (ring.available() >= RIDE_BLOCK_SAMPLES || (force && !ring.isEmpty())) {
+        uint16_t count = 0;
+        while (count < RIDE_BLOCK_SAMPLES && ring.pop(block[count])) {
+            count++;
+        }
+        if (!writeBlock(count)) {
+            break;
+        }
+    }
+}
+
+bool RideRecorder::writeBlock(uint16_t count) {
+    PROFILE_SCOPE(PERF_RIDE_WRITE);
+    RideBlockHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = RIDE_BLOCK_MAGIC;
+    header.sampleCount = count;
+
+    // Kodowanie kolumnowe: pierwsza wartość, potem różnice
+    uint8_t* p = payload;
+    for (uint8_t col = 0; col < RIDE_COLUMN_COUNT; col++) {
+        int32_t prev = 0;
+        int32_t minValue = INT32_MAX;
+        int32_t maxValue = INT32_MIN;
+
+        for (uint16_t i = 0; i < count; i++) {
+            int32_t value = block[i].values[col];
+            p = putVarint(p, zigzagEncode(value - prev));
+            prev = value;
+            if (value < minValue) minValue = value;
+            if (value > maxValue) maxValue = value;
+        }
+
+        header.minValues[col] = minValue;
+        header.maxValues[col] = maxValue;
+    }
+
+    header.payloadLength = (uint16_t)(p - payload);
+    header.crc = blockCrc(header, payload, header.payloadLength);
+
+    char path[24];
+    buildPath(currentId, path, sizeof(path));
+    File file = LittleFS.open(path, "a");
+    if (!file) {
+        DEBUG_ERROR("Rejestrator: nie mozna dopisac do %s", path);
+        return false;
+    }
+
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+    written += file.write(payload, header.payloadLength);
+    file.close();
+
+    if (written != sizeof(header) + header.payloadLength) {
+        DEBUG_ERROR("Rejestrator: niepelny zapis bloku (%u B)", written);
+        return false;
+    }
+
+    blocksWritten++;
+    bytesWritten += written;
+    return true;
+}
+
+void RideRecorder::pruneOldRides() {
+    while (LittleFS.totalBytes() - LittleFS.usedBytes() < RIDE_MIN_FREE_BYTES) {
+        uint16_t oldestId = 0xFFFF;
+
+        File dir = LittleFS.open(RIDES_DIR);
+        if (!dir || !dir.isDirectory()) return;
+
+        File entry = dir.openNextFile();
+        while (entry) {
+            uint16_t id = (uint16_t)atoi(entry.name());
+            if (id > 0 && id < oldestId && !(active && id == currentId)) {
+                oldestId = id;
+            }
+            entry = dir.openNextFile();
+        }
+        dir.close();
+
+        if (oldestId == 0xFFFF) return;
+
+        char path[24];
+        buildPath(oldestId, path, sizeof(path));
+        LittleFS.remove(path);
+        DEBUG_INFO("Rejestrator: usunieto najstarszy przejazd %u", oldestId);
+    }
+}
+
+// --- RideReader ---
+
+RideReader::RideReader() : crcErrors(0) {
+    memset(&fileHeader, 0, sizeof(fileHeader));
+}
+
+RideReader::~RideReader() {
+    close();
+}
+
+bool RideReader::open(uint16_t id) {
+    char path[24];
+    RideRecorder::buildPath(id, path, sizeof(path));
+
+    file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    if (file.read((uint8_t*)&fileHeader, sizeof(fileHeader)) != sizeof(fileHeader) ||
+        fileHeader.magic != RIDE_FILE_MAGIC ||
+        fileHeader.columnCount != RIDE_COLUMN_COUNT) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void RideReader::close() {
+    if (file) {
+        file.close();
+    }
+}
+
+bool RideReader::readBlock(RideBlock& out) {
+    if (!file) return false;
+
+    RideBlockHeader& header = out.header;
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+        return false;  // Koniec pliku
+    }
+
+    if (header.magic != RIDE_BLOCK_MAGIC ||
+        header.sampleCount > RIDE_BLOCK_SAMPLES ||
+        header.payloadLength > RIDE_MAX_PAYLOAD) {
+        crcErrors++;
+        return false;
+    }
+
+    if (file.read(payload, header.payloadLength) != header.payloadLength ||
+        blockCrc(header, payload, header.payloadLength) != header.crc) {
+        crcErrors++;
+        return false;
+    }
+
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + header.payloadLength;
+    for (uint8_t col = 0; col < RIDE_COLUMN_COUNT; col++) {
+        int32_t value = 0;
+        for (uint16_t i = 0; i < header.sampleCount; i++) {
+            uint32_t raw;
+            p = getVarint(p, end, raw);
+            if (!p) {
+                crcErrors++;
+                return false;
+            }
+            value += zigzagDecode(raw);
+            out.columns[col][i] = value;
+        }
+    }
+
+    return true;
+}
+
+// --- RideCsvExporter ---
+
+RideCsvExporter::RideCsvExporter() :
+    row(0),
+    headerSent(false),
+    finished(false),
+    lineLen(0),
+    linePos(0)
+{
+    block.header.sampleCount = 0;
+}
+
+// Wartość całkowita podzielona przez 1/10/100/1000 bez arytmetyki zmiennoprzecinkowej
+static int appendScaled(char* out, size_t len, int32_t value, uint16_t divisor) {
+    if (divisor <= 1) {
+        return snprintf(out, len, "%ld", (long)value);
+    }
+
+    uint8_t decimals = divisor >= 1000 ? 3 : (divisor >= 100 ? 2 : 1);
+    uint32_t magnitude = value < 0 ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+    return snprintf(out, len, "%s%lu.%0*lu", value < 0 ? "-" : "",
+        (unsigned long)(magnitude / divisor), decimals, (unsigned long)(magnitude % divisor));
+}
+
+bool RideCsvExporter::nextLine() {
+    lineLen = 0;
+    linePos = 0;
+
+    if (!headerSent) {
+        for (uint8_t col = 0; col < RIDE_COLUMN_COUNT; col++) {
+            lineLen += snprintf(line + lineLen, sizeof(line) - lineLen, "%s%s",
+                col ? "," : "", RideRecorder::COLUMN_NAMES[col]);
+        }
+        lineLen += snprintf(line + lineLen, sizeof(line) - lineLen, "\n");
+        headerSent = true;
+        return true;
+    }
+
+    if (row >= block.header.sampleCount) {
+        if (!reader.readBlock(block)) {
+            return false;
+        }
+        row = 0;
+    }
+
+    for (uint8_t col = 0; col < RIDE_COLUMN_COUNT; col++) {
+        if (col) line[lineLen++] = ',';
+        lineLen += appendScaled(line + lineLen, sizeof(line) - lineLen,
+            block.columns[col][row], RideRecorder::COLUMN_DIVISORS[col]);
+    }
+    line[lineLen++] = '\n';
+    row++;
+    return true;
+}
+
+size_t RideCsvExporter::read(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+
+    while (written < maxLen && !finished) {
+        if (linePos >= lineLen && !nextLine()) {
+            finished = true;
+            reader.close();
+            break;
+        }
+
+        size_t chunk = min(lineLen - linePos, maxLen - written);
+        memcpy(buffer + written, line + linePos, chunk);
+        written += chunk;
+        linePos += chunk;
+    }
+
+    return written;
+}
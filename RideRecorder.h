@@ -0,0 +1,179 @@
+#ifndef RIDE_RECORDER_H
+#define RIDE_RECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "DebugUtils.h"
+#include "SpscRing.h"
+
+// Rejestrator przejazdów - zapis telemetrii do /rides/NNNNN.bin.
+//
+// Format pliku (little-endian):
+//   RideFileHeader
+//   blok 0: RideBlockHeader + dane kolumnowe
+//   blok 1: ...
+// Dane bloku to kolejne kolumny; w każdej pierwsza wartość i dalej różnice
+// do poprzedniej próbki, zakodowane zigzag + varint. Nagłówek bloku zawiera
+// min/max każdej kolumny (indeks do filtrowania bez dekodowania) i CRC32
+// nagłówka oraz danych.
+
+#define RIDES_DIR "/rides"
+#define RIDE_FILE_MAGIC 0x45444952UL  // "RIDE"
+#define RIDE_BLOCK_MAGIC 0xB10C
+#define RIDE_FORMAT_VERSION 1
+
+#define RIDE_BLOCK_SAMPLES 32         // Próbek w bloku
+#define RIDE_RING_SIZE 64             // Bufor RAM między próbkowaniem a zapisem (potęga 2)
+#define RIDE_MIN_FREE_BYTES 65536     // Poniżej tej wolnej przestrzeni usuwane są najstarsze przejazdy
+#define RIDE_MIN_RATE_HZ 1
+#define RIDE_MAX_RATE_HZ 10
+
+// Kolumny zapisu (wartości całkowite w podanych jednostkach)
+enum RideColumn : uint8_t {
+    RIDE_COL_TIME,        // ms od początku przejazdu
+    RIDE_COL_SPEED,       // 0.1 km/h
+    RIDE_COL_CADENCE,     // RPM
+    RIDE_COL_POWER,       // W
+    RIDE_COL_VOLTAGE,     // 0.1 V
+    RIDE_COL_CURRENT,     // 0.1 A
+    RIDE_COL_BATTERY,     // %
+    RIDE_COL_TEMP_AIR,    // 0.1 °C
+    RIDE_COL_TEMP_MOTOR,  // 0.1 °C
+    RIDE_COL_DISTANCE,    // m
+    RIDE_COLUMN_COUNT
+};
+
+// Maksymalny rozmiar danych bloku: 5 bajtów varint na wartość
+#define RIDE_MAX_PAYLOAD (RIDE_BLOCK_SAMPLES * RIDE_COLUMN_COUNT * 5)
+
+struct RideSample {
+    int32_t values[RIDE_COLUMN_COUNT];
+};
+
+struct __attribute__((packed)) RideFileHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t columnCount;
+    uint8_t sampleRateHz;
+    uint8_t reserved;
+    uint32_t startEpoch;   // Czas rozpoczęcia z RTC (unixtime)
+    uint32_t reserved2;
+};
+
+struct __attribute__((packed)) RideBlockHeader {
+    uint16_t magic;
+    uint16_t sampleCount;
+    uint16_t payloadLength;
+    uint16_t reserved;
+    int32_t minValues[RIDE_COLUMN_COUNT];
+    int32_t maxValues[RIDE_COLUMN_COUNT];
+    uint32_t crc;          // CRC32 nagłówka (bez tego pola) i danych
+};
+
+// Zdekodowany blok
+struct RideBlock {
+    RideBlockHeader header;
+    int32_t columns[RIDE_COLUMN_COUNT][RIDE_BLOCK_SAMPLES];
+};
+
+class RideRecorder {
+public:
+    // Nazwy i dzielniki kolumn do eksportu w jednostkach fizycznych
+    static const char* const COLUMN_NAMES[RIDE_COLUMN_COUNT];
+    static const uint16_t COLUMN_DIVISORS[RIDE_COLUMN_COUNT];
+
+    RideRecorder();
+
+    // Przygotowanie katalogu i ustalenie numeru kolejnego przejazdu
+    bool begin();
+
+    void setSampleRate(uint8_t hz);
+    uint8_t getSampleRate() const { return sampleRateHz; }
+    uint32_t getSamplePeriodMs() const { return 1000 / sampleRateHz; }
+
+    // Rozpoczęcie nowego pliku przejazdu
+    bool startRide(uint32_t startEpoch);
+
+    // Zapis zaległych próbek i zamknięcie przejazdu
+    void finishRide();
+
+    bool isActive() const { return active; }
+    uint16_t getCurrentId() const { return currentId; }
+
+    // Dodanie próbki do bufora RAM (wywoływane z zadania próbkującego)
+    void record(const RideSample& sample);
+
+    // Zapis pełnych bloków z bufora; force zapisuje też niepełny blok
+    void flush(bool force = false);
+
+    // Statystyki
+    uint32_t getBlocksWritten() const { return blocksWritten; }
+    uint32_t getBytesWritten() const { return bytesWritten; }
+    uint32_t getDroppedSamples() const { return ring.getDropped(); }
+
+    static void buildPath(uint16_t id, char* path, size_t len);
+
+private:
+    SpscRing<RideSample, RIDE_RING_SIZE> ring;
+    RideSample block[RIDE_BLOCK_SAMPLES];
+    uint8_t payload[RIDE_MAX_PAYLOAD];
+
+    uint8_t sampleRateHz;
+    bool active;
+    uint16_t currentId;
+    uint16_t nextId;
+    uint32_t blocksWritten;
+    uint32_t bytesWritten;
+
+    bool writeBlock(uint16_t count);
+    void pruneOldRides();
+};
+
+// Sekwencyjny odczyt pliku przejazdu blok po bloku
+class RideReader {
+public:
+    RideReader();
+    ~RideReader();
+
+    bool open(uint16_t id);
+    void close();
+
+    const RideFileHeader& getHeader() const { return fileHeader; }
+
+    // Wczytuje i dekoduje kolejny blok; false na końcu pliku lub przy błędzie
+    bool readBlock(RideBlock& out);
+
+    uint32_t getCrcErrors() const { return crcErrors; }
+
+private:
+    File file;
+    RideFileHeader fileHeader;
+    uint8_t payload[RIDE_MAX_PAYLOAD];
+    uint32_t crcErrors;
+};
+
+// Eksport przejazdu do CSV porcjami - do odpowiedzi HTTP wysyłanych kawałkami.
+// W pamięci jest tylko jeden zdekodowany blok i jedna linia tekstu.
+class RideCsvExporter {
+public:
+    RideCsvExporter();
+
+    bool open(uint16_t id) { return reader.open(id); }
+
+    // Wypełnia bufor kolejnymi liniami CSV; 0 oznacza koniec danych
+    size_t read(uint8_t* buffer, size_t maxLen);
+
+private:
+    RideReader reader;
+    RideBlock block;
+    uint16_t row;
+    bool headerSent;
+    bool finished;
+    char line[160];
+    size_t lineLen;
+    size_t linePos;
+
+    bool nextLine();
+};
+
+#endif // RIDE_RECORDER_H
@@ -0,0 +1,177 @@
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <Arduino.h>
+#include <math.h>
+
+// Statystyki strumieniowe, O(1) na próbkę, bez przechowywania próbek.
+//
+// RunningStats<T> - cały przejazd:
+//  - liczba próbek, min, max
+//  - średnia i wariancja metodą Welforda (w double - bez utraty precyzji przy
+//    długich jazdach, jak przy sumowaniu w float)
+//  - średnia ważona czasem: każda wartość obowiązuje do następnej próbki, więc
+//    nieregularne próbkowanie nie przesuwa wyniku w stronę częściej mierzonych chwil;
+//    odstęp dłuższy niż RUNNING_STATS_MAX_GAP_MS (uśpienie, brak danych) jest pomijany
+//
+// Obiekt nie ma wskaźników ani metod wirtualnych - można go zapisać jako blok bajtów
+// (magazyn ustawień) i odczytać po restarcie.
+//
+// WindowedStats<T, N> - ostatnie N próbek: średnia i wariancja przesuwnym wariantem
+// Welforda, min/max kolejkami monotonicznymi (O(1) zamortyzowane).
+
+#define RUNNING_STATS_MAX_GAP_MS 5000
+
+template <typename T>
+class RunningStats {
+public:
+    RunningStats() { reset(); }
+
+    void reset() {
+        count = 0;
+        minimum = 0;
+        maximum = 0;
+        mean = 0;
+        m2 = 0;
+        timeSum = 0;
+        durationMs = 0;
+        lastValue = 0;
+        lastMs = 0;
+        hasLast = false;
+    }
+
+    // Próbka bez czasu - tylko statystyki z próbek
+    void add(T value) {
+        count++;
+        if (count == 1) {
+            minimum = value;
+            maximum = value;
+        } else {
+            if (value < minimum) minimum = value;
+            if (value > maximum) maximum = value;
+        }
+
+        double delta = (double)value - mean;
+        mean += delta / count;
+        m2 += delta * ((double)value - mean);
+    }
+
+    // Próbka z czasem (millis) - dodatkowo średnia ważona czasem
+    void add(T value, uint32_t nowMs) {
+        if (hasLast) {
+            uint32_t dt = nowMs - lastMs;
+            if (dt <= RUNNING_STATS_MAX_GAP_MS) {
+                timeSum += (double)lastValue * dt;
+                durationMs += dt;
+            }
+        }
+        lastValue = value;
+        lastMs = nowMs;
+        hasLast = true;
+
+        add(value);
+    }
+
+    // Przerwa w pomiarze (np. koniec pedałowania) - czas do następnej próbki nie jest liczony
+    void pause() { hasLast = false; }
+
+    uint32_t getCount() const { return count; }
+    T getMin() const { return minimum; }
+    T getMax() const { return maximum; }
+    float getMean() const { return mean; }
+    float getVariance() const { return (count > 1) ? m2 / (count - 1) : 0; }
+    float getStdDev() const { return sqrt(getVariance()); }
+
+    // Średnia ważona czasem; przed pierwszym odcinkiem czasu - średnia z próbek
+    float getTimeMean() const { return (durationMs > 0) ? timeSum / durationMs : mean; }
+    uint32_t getDurationMs() const { return durationMs; }
+
+private:
+    uint32_t count;
+    T minimum;
+    T maximum;
+    double mean;
+    double m2;
+    double timeSum;      // Suma wartość x czas [jedn. x ms]
+    uint32_t durationMs;
+    T lastValue;
+    uint32_t lastMs;
+    bool hasLast;
+};
+
+template <typename T, uint16_t N>
+class WindowedStats {
+    static_assert(N >= 2, "Okno WindowedStats musi miec co najmniej 2 probki");
+
+public:
+    WindowedStats() { reset(); }
+
+    void reset() {
+        seq = 0;
+        mean = 0;
+        m2 = 0;
+        minHead = minSize = 0;
+        maxHead = maxSize = 0;
+    }
+
+    void add(T value) {
+        uint16_t slot = seq % N;
+
+        if (seq >= N) {
+            // Pełne okno: najstarsza próbka zastępowana nową, liczność stała
+            T old = values[slot];
+            double oldMean = mean;
+            mean += ((double)value - old) / N;
+            m2 += ((double)value - old) * ((double)value - mean + old - oldMean);
+            if (m2 < 0) m2 = 0;  // Błąd zaokrągleń przy stałych wartościach
+        } else {
+            double delta = (double)value - mean;
+            mean += delta / (seq + 1);
+            m2 += delta * ((double)value - mean);
+        }
+        values[slot] = value;
+
+        // Próbki spoza okna opuszczają kolejki od przodu
+        if (minSize > 0 && minQueue[minHead] + N <= seq) {
+            minHead = (minHead + 1) % N;
+            minSize--;
+        }
+        if (maxSize > 0 && maxQueue[maxHead] + N <= seq) {
+            maxHead = (maxHead + 1) % N;
+            maxSize--;
+        }
+
+        // Z tyłu usuwane próbki, które nie mogą już być minimum / maksimum
+        while (minSize > 0 && values[minQueue[(minHead + minSize - 1) % N] % N] >= value) minSize--;
+        minQueue[(minHead + minSize) % N] = seq;
+        minSize++;
+
+        while (maxSize > 0 && values[maxQueue[(maxHead + maxSize - 1) % N] % N] <= value) maxSize--;
+        maxQueue[(maxHead + maxSize) % N] = seq;
+        maxSize++;
+
+        seq++;
+    }
+
+    uint16_t getCount() const { return (seq < N) ? seq : N; }
+    T getMin() const { return minSize ? values[minQueue[minHead] % N] : 0; }
+    T getMax() const { return maxSize ? values[maxQueue[maxHead] % N] : 0; }
+    float getMean() const { return mean; }
+    float getVariance() const {
+        uint16_t n = getCount();
+        return (n > 1) ? m2 / (n - 1) : 0;
+    }
+    float getStdDev() const { return sqrt(getVariance()); }
+
+private:
+    T values[N];
+    uint32_t seq;             // Numer kolejnej próbki
+    double mean;
+    double m2;
+    uint32_t minQueue[N];     // Numery próbek, wartości rosnąco
+    uint32_t maxQueue[N];     // Numery próbek, wartości malejąco
+    uint16_t minHead, minSize;
+    uint16_t maxHead, maxSize;
+};
+
+#endif // RUNNING_STATS_H
@@ -0,0 +1,53 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Migawka danych jeden pisarz / wielu czytelników, bez blokad.
+// Pisarz (np. zadanie BLE) zwiększa licznik przed i po kopiowaniu - nieparzysta
+// wartość oznacza zapis w toku. Czytelnik kopiuje dane i powtarza odczyt, jeśli
+// licznik się zmienił, więc nigdy nie widzi połowicznie zaktualizowanej struktury.
+// T musi być trywialnie kopiowalne. Nagłówek nie zależy od Arduino (testy na PC).
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock wymaga typu trywialnie kopiowalnego");
+
+public:
+    Seqlock() : sequence(0) {
+        memset(&value, 0, sizeof(value));
+    }
+
+    // Strona pisarza - tylko jeden wątek
+    void write(const T& data) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &data, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Strona czytelnika; zwraca false, jeśli nic jeszcze nie zapisano
+    bool read(T& out) const {
+        uint32_t before, after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            if (before & 1) continue;  // Zapis w toku
+            memcpy(&out, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return before != 0;
+    }
+
+    // Liczba zakończonych zapisów (np. do wykrycia nowych danych)
+    uint32_t getVersion() const { return sequence.load(std::memory_order_acquire) >> 1; }
+
+private:
+    T value;
+    std::atomic<uint32_t> sequence;
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,306 @@
+#include "SettingsStore.h"
+#include <rom/crc.h>
+#include "Profiler.h"
+
+SettingsStore::SettingsStore() :
+    sectionCount(0),
+    shadowUsed(0),
+    imageStale(false),
+    dirtyMask(0),
+    firstDirtyMs(0),
+    lastDirtyMs(0),
+    generation(0),
+    loadUs(0),
+    flashWrites(0),
+    bytesWritten(0),
+    dirtyMarks(0),
+    skippedWrites(0),
+    lastWriteUs(0),
+    statsStartMs(0)
+{
+}
+
+bool SettingsStore::registerSection(uint8_t id, uint8_t schemaVersion, void* data, uint16_t size,
+                                    SettingsReadFn read) {
+    if (sectionCount >= SETTINGS_MAX_SECTIONS || shadowUsed + size > SETTINGS_SHADOW_SIZE || findSection(id) >= 0 ||
+        (read != nullptr && size > SETTINGS_MAX_SNAPSHOT_SIZE)) {
+        DEBUG_ERROR("Ustawienia: nie mozna zarejestrowac sekcji %u", id);
+        return false;
+    }
+
+    Section& section = sections[sectionCount++];
+    section.id = id;
+    section.schemaVersion = schemaVersion;
+    section.size = size;
+    section.shadowOffset = shadowUsed;
+    section.loaded = false;
+    section.data = data;
+    section.read = read;
+
+    memcpy(shadow + shadowUsed, data, size);
+    shadowUsed += size;
+    return true;
+}
+
+int8_t SettingsStore::findSection(uint8_t id) const {
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        if (sections[i].id == id) return i;
+    }
+    return -1;
+}
+
+// Bieżący stan sekcji - z migawki właściciela, a przed pierwszą publikacją ze struktury
+void SettingsStore::readSection(const Section& section, void* out) const {
+    if (section.read == nullptr || !section.read(out)) {
+        memcpy(out, section.data, section.size);
+    }
+}
+
+bool SettingsStore::isLoaded(uint8_t id) const {
+    int8_t index = findSection(id);
+    return index >= 0 && sections[index].loaded;
+}
+
+bool SettingsStore::begin() {
+    uint32_t startUs = micros();
+    statsStartMs = millis();
+
+    File file = LittleFS.open(SETTINGS_FILE, "r");
+    if (!file) {
+        loadUs = micros() - startUs;
+        DEBUG_INFO("Ustawienia: brak %s", SETTINGS_FILE);
+        return false;
+    }
+
+    SettingsFileHeader header;
+    if (file.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != SETTINGS_FILE_MAGIC ||
+        header.version != SETTINGS_FORMAT_VERSION) {
+        file.close();
+        loadUs = micros() - startUs;
+        DEBUG_ERROR("Ustawienia: bledny naglowek %s", SETTINGS_FILE);
+        return false;
+    }
+
+    generation = header.generation;
+
+    // Dane sekcji trafiają najpierw do kopii, a po sprawdzeniu CRC do struktury
+    uint8_t loadedCount = 0;
+    for (uint8_t n = 0; n < header.sectionCount; n++) {
+        SettingsSectionHeader sectionHeader;
+        if (file.read((uint8_t*)&sectionHeader, sizeof(sectionHeader)) != sizeof(sectionHeader)) {
+            break;
+        }
+
+        int8_t index = findSection(sectionHeader.id);
+        if (index < 0 ||
+            sections[index].schemaVersion != sectionHeader.schemaVersion ||
+            sections[index].size != sectionHeader.size) {
+            // Nieznana lub starsza sekcja - pomijamy jej dane
+            file.seek(file.position() + sectionHeader.size);
+            continue;
+        }
+
+        Section& section = sections[index];
+        uint8_t* target = shadow + section.shadowOffset;
+        if (file.read(target, section.size) != section.size ||
+            crc32_le(0, target, section.size) != sectionHeader.crc) {
+            // Przywróć wartości domyślne w kopii
+            memcpy(target, section.data, section.size);
+            DEBUG_ERROR("Ustawienia: uszkodzona sekcja %u", section.id);
+            continue;
+        }
+
+        memcpy(section.data, target, section.size);
+        section.loaded = true;
+        loadedCount++;
+    }
+    file.close();
+
+    // Sekcje bez poprawnych danych zostaną zapisane z wartościami domyślnymi
+    uint32_t missing = 0;
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        if (!sections[i].loaded) missing |= 1UL << i;
+    }
+    if (missing) {
+        dirtyMask.fetch_or(missing);
+        firstDirtyMs = lastDirtyMs = millis();
+    }
+
+    loadUs = micros() - startUs;
+    DEBUG_INFO("Ustawienia: wczytano %u/%u sekcji w %u us", loadedCount, sectionCount, loadUs);
+    return true;
+}
+
+void SettingsStore::markDirty(uint8_t id) {
+    int8_t index = findSection(id);
+    if (index < 0) return;
+
+    unsigned long now = millis();
+    if (dirtyMask.fetch_or(1UL << index) == 0) {
+        firstDirtyMs = now;
+    }
+    lastDirtyMs = now;
+    dirtyMarks++;
+}
+
+void SettingsStore::update() {
+    if (dirtyMask.load() == 0) return;
+
+    unsigned long now = millis();
+    if (now - lastDirtyMs >= SETTINGS_WRITE_DELAY_MS || now - firstDirtyMs >= SETTINGS_MAX_DELAY_MS) {
+        flush();
+    }
+}
+
+bool SettingsStore::flush() {
+    uint32_t mask = dirtyMask.exchange(0);
+    if (mask == 0) return true;
+
+    // Zapis tylko gdy któraś sekcja faktycznie różni się od zapisanej
+    bool changed = imageStale;
+    for (uint8_t i = 0; i < sectionCount && !changed; i++) {
+        const Section& section = sections[i];
+        if (!(mask & (1UL << i))) continue;
+        if (!section.loaded) {
+            changed = true;
+        } else if (section.read != nullptr) {
+            uint8_t current[SETTINGS_MAX_SNAPSHOT_SIZE];
+            readSection(section, current);
+            changed = memcmp(shadow + section.shadowOffset, current, section.size) != 0;
+        } else {
+            changed = memcmp(shadow + section.shadowOffset, section.data, section.size) != 0;
+        }
+    }
+
+    if (!changed) {
+        skippedWrites++;
+        return true;
+    }
+
+    if (!writeImage()) {
+        // Kopia mogła już zostać nadpisana - kolejna próba zapisze plik bez porównania
+        imageStale = true;
+        dirtyMask.fetch_or(mask);
+        return false;
+    }
+
+    imageStale = false;
+    return true;
+}
+
+uint32_t SettingsStore::getLayoutId() const {
+    uint32_t crc = 0;
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        const uint8_t layout[4] = {
+            sections[i].id, sections[i].schemaVersion,
+            (uint8_t)(sections[i].size & 0xFF), (uint8_t)(sections[i].size >> 8)
+        };
+        crc = crc32_le(crc, layout, sizeof(layout));
+    }
+    return crc;
+}
+
+bool SettingsStore::exportImage(uint8_t* out, uint16_t capacity) const {
+    if (dirtyMask.load() != 0 || imageStale || capacity < shadowUsed) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        if (!sections[i].loaded) return false;
+    }
+
+    // Kopia odpowiada plikowi, więc po wybudzeniu nie trzeba go czytać
+    memcpy(out, shadow, shadowUsed);
+    return true;
+}
+
+bool SettingsStore::importImage(const uint8_t* image, uint16_t size, uint32_t imageGeneration) {
+    uint32_t startUs = micros();
+    statsStartMs = millis();
+
+    if (size != shadowUsed) {
+        return false;
+    }
+
+    memcpy(shadow, image, shadowUsed);
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        memcpy(sections[i].data, shadow + sections[i].shadowOffset, sections[i].size);
+        sections[i].loaded = true;
+    }
+    generation = imageGeneration;
+
+    loadUs = micros() - startUs;
+    return true;
+}
+
+bool SettingsStore::writeImage() {
+    PROFILE_SCOPE(PERF_SETTINGS_WRITE);
+    uint32_t startUs = micros();
+
+    File file = LittleFS.open(SETTINGS_TEMP_FILE, "w");
+    if (!file) {
+        DEBUG_ERROR("Ustawienia: nie mozna otworzyc %s", SETTINGS_TEMP_FILE);
+        return false;
+    }
+
+    SettingsFileHeader header;
+    header.magic = SETTINGS_FILE_MAGIC;
+    header.version = SETTINGS_FORMAT_VERSION;
+    header.sectionCount = sectionCount;
+    header.reserved = 0;
+    header.generation = generation + 1;
+
+    size_t expected = sizeof(header);
+    size_t written = file.write((const uint8_t*)&header, sizeof(header));
+
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        Section& section = sections[i];
+        uint8_t* copy = shadow + section.shadowOffset;
+
+        // Migawka struktury - CRC i zapis z tej samej kopii
+        readSection(section, copy);
+
+        SettingsSectionHeader sectionHeader;
+        sectionHeader.id = section.id;
+        sectionHeader.schemaVersion = section.schemaVersion;
+        sectionHeader.size = section.size;
+        sectionHeader.crc = crc32_le(0, copy, section.size);
+
+        written += file.write((const uint8_t*)&sectionHeader, sizeof(sectionHeader));
+        written += file.write(copy, section.size);
+        expected += sizeof(sectionHeader) + section.size;
+    }
+    file.close();
+
+    if (written != expected) {
+        DEBUG_ERROR("Ustawienia: niepelny zapis (%u/%u B)", written, expected);
+        LittleFS.remove(SETTINGS_TEMP_FILE);
+        return false;
+    }
+
+    // Podmiana pliku w jednym kroku - przerwany zapis zostawia poprzednią wersję
+    if (!LittleFS.rename(SETTINGS_TEMP_FILE, SETTINGS_FILE)) {
+        DEBUG_ERROR("Ustawienia: nie mozna podmienic %s", SETTINGS_FILE);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < sectionCount; i++) {
+        sections[i].loaded = true;
+    }
+
+    generation = header.generation;
+    flashWrites++;
+    bytesWritten += written;
+    lastWriteUs = micros() - startUs;
+
+    DEBUG_INFO("Ustawienia: zapis %u B (nr %u) w %u us", written, generation, lastWriteUs);
+    return true;
+}
+
+void SettingsStore::resetStats() {
+    flashWrites = 0;
+    bytesWritten = 0;
+    dirtyMarks = 0;
+    skippedWrites = 0;
+    statsStartMs = millis();
+}
@@ -0,0 +1,152 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <atomic>
+#include "DebugUtils.h"
+
+// Wspólny magazyn ustawień - jeden plik binarny /settings.bin.
+//
+// Format pliku (little-endian):
+//   SettingsFileHeader
+//   SettingsSectionHeader + dane sekcji (struktura POD skopiowana 1:1)
+//   ...
+// Każda sekcja ma własną wersję schematu i CRC32. Sekcja z inną wersją,
+// rozmiarem lub błędnym CRC jest pomijana i zostaje z wartościami domyślnymi.
+//
+// Sekcje wskazują na struktury w RAM, z których korzysta program. Magazyn
+// trzyma kopię ostatnio zapisanego stanu; zmiany zgłaszane przez markDirty()
+// są zapisywane z opóźnieniem, więc seria zmian z interfejsu WWW kończy się
+// jednym zapisem do pamięci flash.
+//
+// Zapis działa na rdzeniu usług. Sekcja, którą na bieżąco zmienia drugi rdzeń
+// (energia, statystyki przejazdu), podaje funkcję odczytu spójnej kopii - np.
+// z Seqlock publikowanej przez właściciela. Struktura w RAM służy wtedy tylko
+// do wczytania wartości przy starcie, zanim ruszy drugi rdzeń.
+
+#define SETTINGS_FILE "/settings.bin"
+#define SETTINGS_TEMP_FILE "/settings.tmp"
+#define SETTINGS_FILE_MAGIC 0x53544553UL  // "SETS"
+#define SETTINGS_FORMAT_VERSION 1
+
+#define SETTINGS_MAX_SECTIONS 12
+#define SETTINGS_SHADOW_SIZE 1024          // Suma rozmiarów wszystkich sekcji
+#define SETTINGS_WRITE_DELAY_MS 1500       // Zapis po tylu ms bez kolejnych zmian
+#define SETTINGS_MAX_DELAY_MS 10000        // ale nie później niż po tylu od pierwszej zmiany
+#define SETTINGS_MAX_SNAPSHOT_SIZE 384     // Największa sekcja z funkcją odczytu (kopia na stosie)
+
+// Identyfikatory sekcji - część formatu pliku, nie zmieniać istniejących
+enum SettingsSection : uint8_t {
+    SETTINGS_GENERAL = 1,
+    SETTINGS_BACKLIGHT = 2,
+    SETTINGS_BLUETOOTH = 3,
+    SETTINGS_LIGHTS = 4,
+    SETTINGS_CONTROLLER = 5,
+    SETTINGS_WIFI = 6,
+    SETTINGS_ENERGY = 7,
+    SETTINGS_TRIP = 8,
+    SETTINGS_LIGHT_PATTERNS = 9
+};
+
+// Spójna kopia sekcji do out; false gdy nic jeszcze nie opublikowano
+typedef bool (*SettingsReadFn)(void* out);
+
+struct __attribute__((packed)) SettingsFileHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t sectionCount;
+    uint16_t reserved;
+    uint32_t generation;   // Numer zapisu
+};
+
+struct __attribute__((packed)) SettingsSectionHeader {
+    uint8_t id;
+    uint8_t schemaVersion;
+    uint16_t size;
+    uint32_t crc;          // CRC32 danych sekcji
+};
+
+class SettingsStore {
+public:
+    SettingsStore();
+
+    // Rejestracja struktury jako sekcji; bieżąca zawartość to wartości domyślne.
+    // read - odczyt migawki sekcji pisanej przez inny rdzeń (nullptr = kopia data)
+    bool registerSection(uint8_t id, uint8_t schemaVersion, void* data, uint16_t size,
+                         SettingsReadFn read = nullptr);
+
+    // Wczytanie pliku do zarejestrowanych struktur; false gdy pliku nie ma
+    bool begin();
+
+    // Sekcja ma poprawną kopię w pliku (wczytaną lub już zapisaną)
+    bool isLoaded(uint8_t id) const;
+
+    // Zgłoszenie zmiany - zapis nastąpi w update() po SETTINGS_WRITE_DELAY_MS
+    void markDirty(uint8_t id);
+    bool isDirty() const { return dirtyMask.load() != 0; }
+
+    // Zapis odłożonych zmian (wołać okresowo)
+    void update();
+
+    // Natychmiastowy zapis odłożonych zmian (np. przed uśpieniem)
+    bool flush();
+
+    // Kopia sekcji w pamięci RTC na czas uśpienia (SleepSnapshot).
+    // Identyfikator układu zmienia się z każdą zmianą listy, wersji lub rozmiaru sekcji.
+    uint32_t getLayoutId() const;
+    uint16_t getImageSize() const { return shadowUsed; }
+
+    // Obraz sekcji zgodny z plikiem; false gdy są niezapisane zmiany
+    bool exportImage(uint8_t* out, uint16_t capacity) const;
+
+    // Wczytanie sekcji z kopii zamiast z pliku - stan jak po udanym begin()
+    bool importImage(const uint8_t* image, uint16_t size, uint32_t imageGeneration);
+
+    // Statystyki
+    uint32_t getLoadUs() const { return loadUs; }
+    uint32_t getFlashWrites() const { return flashWrites; }
+    uint32_t getBytesWritten() const { return bytesWritten; }
+    uint32_t getDirtyMarks() const { return dirtyMarks; }
+    uint32_t getSkippedWrites() const { return skippedWrites; }
+    uint32_t getLastWriteUs() const { return lastWriteUs; }
+    uint32_t getGeneration() const { return generation; }
+    uint32_t getStatsAgeMs() const { return millis() - statsStartMs; }
+    void resetStats();
+
+private:
+    struct Section {
+        uint8_t id;
+        uint8_t schemaVersion;
+        uint16_t size;
+        uint16_t shadowOffset;
+        bool loaded;
+        void* data;
+        SettingsReadFn read;
+    };
+
+    Section sections[SETTINGS_MAX_SECTIONS];
+    uint8_t sectionCount;
+    uint8_t shadow[SETTINGS_SHADOW_SIZE];   // Stan zapisany w pliku
+    uint16_t shadowUsed;
+    bool imageStale;                        // Ostatni zapis się nie udał - plik nieaktualny
+
+    std::atomic<uint32_t> dirtyMask;        // Bit = indeks sekcji
+    volatile unsigned long firstDirtyMs;
+    volatile unsigned long lastDirtyMs;
+
+    uint32_t generation;
+    uint32_t loadUs;
+    uint32_t flashWrites;
+    uint32_t bytesWritten;
+    uint32_t dirtyMarks;
+    uint32_t skippedWrites;
+    uint32_t lastWriteUs;
+    unsigned long statsStartMs;
+
+    int8_t findSection(uint8_t id) const;
+    void readSection(const Section& section, void* out) const;
+    bool writeImage();
+};
+
+#endif // SETTINGS_STORE_H
@@ -0,0 +1,72 @@
+#include "SleepSnapshot.h"
+#include <rom/crc.h>
+
+struct SleepImage {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t settingsSize;
+    uint32_t crc;                // CRC32 od settingsLayout do końca użytych ustawień
+    uint32_t settingsLayout;     // SettingsStore::getLayoutId() przy zapisie
+    uint32_t settingsGeneration;
+    SleepState state;
+    uint8_t settings[SETTINGS_SHADOW_SIZE];
+};
+
+// Przetrwa głębokie uśpienie; po włączeniu zasilania wyzerowana
+static RTC_DATA_ATTR SleepImage image;
+
+uint32_t SleepSnapshot::restoreUs = 0;
+
+static uint32_t imageCrc() {
+    const uint8_t* start = (const uint8_t*)&image.settingsLayout;
+    size_t length = offsetof(SleepImage, settings) - offsetof(SleepImage, settingsLayout) + image.settingsSize;
+    return crc32_le(0, start, length);
+}
+
+bool SleepSnapshot::save(const SleepState& state, const SettingsStore& settings) {
+    image.magic = 0;  // Kopia ważna dopiero po zapisaniu całości
+
+    uint16_t size = settings.getImageSize();
+    if (!settings.exportImage(image.settings, sizeof(image.settings))) {
+        DEBUG_INFO("Kopia RTC: ustawienia niezapisane - wybudzenie z pliku");
+        return false;
+    }
+
+    image.version = SLEEP_SNAPSHOT_VERSION;
+    image.settingsSize = size;
+    image.settingsLayout = settings.getLayoutId();
+    image.settingsGeneration = settings.getGeneration();
+    image.state = state;
+    image.crc = imageCrc();
+    image.magic = SLEEP_SNAPSHOT_MAGIC;
+
+    DEBUG_INFO("Kopia RTC: zapisano %u B", (unsigned)(offsetof(SleepImage, settings) + size));
+    return true;
+}
+
+bool SleepSnapshot::restore(SleepState& state, SettingsStore& settings) {
+    uint32_t startUs = micros();
+
+    bool valid = image.magic == SLEEP_SNAPSHOT_MAGIC &&
+                 image.version == SLEEP_SNAPSHOT_VERSION &&
+                 image.settingsSize == settings.getImageSize() &&
+                 image.settingsLayout == settings.getLayoutId() &&
+                 image.crc == imageCrc();
+
+    if (valid) {
+        valid = settings.importImage(image.settings, image.settingsSize, image.settingsGeneration);
+    }
+    if (valid) {
+        state = image.state;
+    }
+
+    // Jednorazowa - kolejne wybudzenie tylko z kopii zapisanej przy następnym uśpieniu
+    invalidate();
+
+    restoreUs = micros() - startUs;
+    return valid;
+}
+
+void SleepSnapshot::invalidate() {
+    image.magic = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef SLEEP_SNAPSHOT_H
+#define SLEEP_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "SettingsStore.h"
+
+// Stan systemu w pamięci RTC (RTC slow memory) na czas głębokiego uśpienia.
+//
+// goToSleep() zapisuje tu obraz ustawień (z przebiegiem i statystykami przejazdu,
+// bo to też sekcje magazynu ustawień), przebieg licznika i stan ekranu. Po wybudzeniu
+// przyciskiem setup() odtwarza go kopiowaniem pamięci zamiast montowania LittleFS
+// i czytania /settings.bin. Pamięć RTC przetrwa tylko głębokie uśpienie - po włączeniu
+// zasilania lub resecie kopii nie ma (zła sygnatura lub CRC) i ustawienia są czytane z pliku.
+//
+// Kopia jest jednorazowa: restore() ją unieważnia, a zapisuje się tylko wtedy,
+// gdy plik ustawień jest aktualny - kopia nigdy nie wyprzedza pliku.
+
+#define SLEEP_SNAPSHOT_MAGIC 0x50534C53UL  // "SLSP"
+#define SLEEP_SNAPSHOT_VERSION 1
+
+// Stan interfejsu i jazdy spoza magazynu ustawień
+struct SleepState {
+    uint32_t odometerMeters;
+    uint8_t mainScreen;
+    uint8_t subScreen;
+    uint8_t assistLevel;
+    uint8_t lightMode;
+    bool inSubScreen;
+    bool legalMode;
+};
+
+class SleepSnapshot {
+public:
+    // Zapis przed esp_deep_sleep_start(); false (i brak kopii) przy niezapisanych ustawieniach
+    static bool save(const SleepState& state, const SettingsStore& settings);
+
+    // Odtworzenie po wybudzeniu; sekcje muszą być już zarejestrowane w magazynie
+    static bool restore(SleepState& state, SettingsStore& settings);
+
+    static void invalidate();
+
+    // Czas ostatniego restore() [us]
+    static uint32_t getRestoreUs() { return restoreUs; }
+
+private:
+    static uint32_t restoreUs;
+};
+
+#endif // SLEEP_SNAPSHOT_H
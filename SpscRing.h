@@ -0,0 +1,60 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Bufor pierścieniowy jeden producent / jeden konsument, bez blokad.
+// Producent (np. przerwanie) woła tylko push(), konsument (loop) tylko pop().
+// Każda strona zapisuje wyłącznie swój indeks, więc nie są potrzebne sekcje
+// krytyczne. N musi być potęgą dwójki; mieści się N - 1 elementów.
+template <typename T, uint16_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Rozmiar SpscRing musi byc potega dwojki");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    // Strona producenta - O(1), bezpieczne w IRAM
+    inline bool IRAM_ATTR push(const T& item) {
+        uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t next = (h + 1) & (N - 1);
+        if (next == tail.load(std::memory_order_acquire)) {
+            dropped++;  // Pełny - element przepada, licznik dla diagnostyki
+            return false;
+        }
+        items[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Strona konsumenta
+    inline bool pop(T& item) {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t];
+        tail.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    inline uint16_t available() const {
+        return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed)) & (N - 1);
+    }
+
+    inline bool isEmpty() const { return available() == 0; }
+
+    // Liczba elementów odrzuconych z powodu przepełnienia
+    inline uint32_t getDropped() const { return dropped; }
+
+    static constexpr uint16_t capacity() { return N - 1; }
+
+private:
+    T items[N];
+    std::atomic<uint16_t> head;
+    std::atomic<uint16_t> tail;
+    volatile uint32_t dropped;
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,135 @@
+#include "TaskScheduler.h"
+#include "DebugLog.h"
+
+TaskScheduler::TaskScheduler() :
+    taskCount(0),
+    idleMs(0),
+    statsStartMs(0)
+{
+}
+
+int8_t TaskScheduler::addTask(const char* name, uint32_t periodMs, Priority priority, TaskFn fn) {
+    if (taskCount >= MAX_TASKS) {
+        DEBUG_ERROR("Brak miejsca na zadanie %s", name);
+        return -1;
+    }
+
+    Task& task = tasks[taskCount];
+    memset(&task, 0, sizeof(task));
+    task.name = name;
+    task.fn = fn;
+    task.periodUs = periodMs * 1000UL;
+    task.nextDueUs = micros();
+    task.priority = priority;
+    task.enabled = true;
+
+    return taskCount++;
+}
+
+void TaskScheduler::setEnabled(int8_t id, bool enabled) {
+    if (id < 0 || id >= taskCount) return;
+
+    if (enabled && !tasks[id].enabled) {
+        // Po wznowieniu zadanie startuje od razu, bez naliczania spóźnienia
+        tasks[id].nextDueUs = micros();
+    }
+    tasks[id].enabled = enabled;
+}
+
+void TaskScheduler::setPeriod(int8_t id, uint32_t periodMs) {
+    if (id < 0 || id >= taskCount) return;
+    tasks[id].periodUs = periodMs * 1000UL;
+}
+
+bool TaskScheduler::isDue(const Task& task, uint32_t nowUs) {
+    return task.enabled && (int32_t)(nowUs - task.nextDueUs) >= 0;
+}
+
+void TaskScheduler::execute(Task& task, uint32_t nowUs) {
+    uint32_t lateness = nowUs - task.nextDueUs;
+    if (lateness > task.maxLatenessUs) {
+        task.maxLatenessUs = lateness;
+    }
+    if (task.periodUs > 0 && lateness >= task.periodUs) {
+        task.misses++;
+    }
+
+    task.fn();
+
+    uint32_t runUs = micros() - nowUs;
+    task.lastRunUs = runUs;
+    if (runUs > task.maxRunUs) {
+        task.maxRunUs = runUs;
+    }
+    if (task.periodUs > 0 && runUs > task.periodUs) {
+        task.overruns++;
+    }
+    task.runs++;
+
+    // Stała siatka czasu; po przekroczonym terminie bez nadrabiania zaległych wywołań
+    task.nextDueUs += task.periodUs;
+    if ((int32_t)(micros() - task.nextDueUs) >= 0) {
+        task.nextDueUs = micros() + task.periodUs;
+    }
+}
+
+uint32_t TaskScheduler::run() {
+    bool executed[MAX_TASKS] = {false};
+
+    for (;;) {
+        uint32_t nowUs = micros();
+        int8_t next = -1;
+
+        // Najwyższy priorytet, a przy równym - najdawniej zaległy termin
+        for (uint8_t i = 0; i < taskCount; i++) {
+            if (executed[i] || !isDue(tasks[i], nowUs)) continue;
+            if (next < 0 ||
+                tasks[i].priority < tasks[next].priority ||
+                (tasks[i].priority == tasks[next].priority &&
+                 (int32_t)(tasks[i].nextDueUs - tasks[next].nextDueUs) < 0)) {
+                next = i;
+            }
+        }
+
+        if (next < 0) break;
+
+        executed[next] = true;
+        execute(tasks[next], nowUs);
+    }
+
+    // Czas do najbliższego terminu
+    uint32_t nowUs = micros();
+    uint32_t untilNext = 0xFFFFFFFFUL;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (!tasks[i].enabled) continue;
+        int32_t diff = (int32_t)(tasks[i].nextDueUs - nowUs);
+        if (diff <= 0) return 0;
+        if ((uint32_t)diff < untilNext) untilNext = diff;
+    }
+    return untilNext;
+}
+
+void TaskScheduler::idle(uint32_t untilNextUs) {
+    // delay() oddaje rdzeń FreeRTOS z rozdzielczością 1 ms
+    uint32_t ms = untilNextUs / 1000;
+    if (ms == 0) return;
+
+    // Logi z pierścienia - tylko tyle, ile przyjmie bufor UART
+    DebugLog::drain();
+
+    delay(ms);
+    idleMs += ms;
+}
+
+void TaskScheduler::resetStats() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].runs = 0;
+        tasks[i].lastRunUs = 0;
+        tasks[i].maxRunUs = 0;
+        tasks[i].maxLatenessUs = 0;
+        tasks[i].misses = 0;
+        tasks[i].overruns = 0;
+    }
+    idleMs = 0;
+    statsStartMs = millis();
+}
@@ -0,0 +1,75 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include "DebugUtils.h"
+
+// Kooperacyjny harmonogram zadań okresowych o stałej pojemności.
+// Zastępuje ręczne liczniki "lastX" w loop(): każde zadanie ma okres,
+// priorytet i liczniki czasu wykonania oraz przekroczonych terminów.
+// Wszystkie zadania wykonują się w kontekście loop(), bez wywłaszczania.
+class TaskScheduler {
+public:
+    static const uint8_t MAX_TASKS = 24;
+
+    typedef void (*TaskFn)();
+
+    // Przy kilku zadaniach gotowych jednocześnie pierwsze idzie zadanie o wyższym priorytecie
+    enum Priority : uint8_t {
+        PRIORITY_HIGH = 0,    // Wejścia i pomiary wrażliwe na opóźnienie
+        PRIORITY_NORMAL = 1,  // Wyświetlacz, światła, komunikacja
+        PRIORITY_LOW = 2      // Diagnostyka, zapis, zadania w tle
+    };
+
+    struct Task {
+        const char* name;
+        TaskFn fn;
+        uint32_t periodUs;
+        uint32_t nextDueUs;     // Termin kolejnego wywołania (micros)
+        Priority priority;
+        bool enabled;
+
+        uint32_t runs;          // Liczba wykonań
+        uint32_t lastRunUs;     // Czas ostatniego wykonania
+        uint32_t maxRunUs;      // Najdłuższe wykonanie
+        uint32_t maxLatenessUs; // Największe spóźnienie względem terminu (jitter)
+        uint32_t misses;        // Spóźnienia dłuższe niż okres (pominięte wywołanie)
+        uint32_t overruns;      // Wykonania dłuższe niż okres
+    };
+
+    TaskScheduler();
+
+    // Rejestracja zadania; zwraca identyfikator lub -1 gdy brak miejsca
+    int8_t addTask(const char* name, uint32_t periodMs, Priority priority, TaskFn fn);
+
+    void setEnabled(int8_t id, bool enabled);
+    void setPeriod(int8_t id, uint32_t periodMs);
+
+    // Wykonuje wszystkie zadania, których termin minął (każde co najwyżej raz).
+    // Zwraca czas do najbliższego terminu [us].
+    uint32_t run();
+
+    // Usypia pętlę do najbliższego terminu (oddaje czas innym zadaniom FreeRTOS)
+    void idle(uint32_t untilNextUs);
+
+    uint8_t getTaskCount() const { return taskCount; }
+    const Task& getTask(uint8_t index) const { return tasks[index]; }
+
+    // Łączny czas uśpienia w idle() od ostatniego resetu [ms]
+    uint32_t getIdleMs() const { return idleMs; }
+    unsigned long getStatsStartMs() const { return statsStartMs; }
+
+    // Zeruje liczniki czasu i spóźnień
+    void resetStats();
+
+private:
+    Task tasks[MAX_TASKS];
+    uint8_t taskCount;
+    uint32_t idleMs;
+    unsigned long statsStartMs;
+
+    static bool isDue(const Task& task, uint32_t nowUs);
+    void execute(Task& task, uint32_t nowUs);
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,192 @@
+#include "TelemetryChannel.h"
+#include <ArduinoJson.h>
+
+static inline uint8_t* putZigzagVarint(uint8_t* p, int32_t value) {
+    uint32_t v = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+TelemetryChannel::TelemetryChannel(AsyncWebSocket& socket) :
+    ws(socket),
+    jsonFormatter(nullptr),
+    framesSent(0),
+    bytesSent(0),
+    framesSkipped(0)
+{
+    portMUX_INITIALIZE(&lock);
+    memset(clients, 0, sizeof(clients));
+}
+
+TelemetryChannel::Client* TelemetryChannel::findClient(uint32_t clientId) {
+    for (uint8_t i = 0; i < TELEMETRY_MAX_CLIENTS; i++) {
+        if (clients[i].used && clients[i].id == clientId) {
+            return &clients[i];
+        }
+    }
+    return nullptr;
+}
+
+void TelemetryChannel::onConnect(uint32_t clientId) {
+    portENTER_CRITICAL(&lock);
+    Client* client = findClient(clientId);
+    for (uint8_t i = 0; i < TELEMETRY_MAX_CLIENTS && !client; i++) {
+        if (!clients[i].used) client = &clients[i];
+    }
+    if (client) {
+        // Domyślnie JSON raz na sekundę, dopóki klient nie wynegocjuje innego trybu
+        client->id = clientId;
+        client->used = true;
+        client->format = FORMAT_JSON;
+        client->periodMs = 1000;
+        client->fieldMask = TELEMETRY_ALL_FIELDS;
+        client->keyDue = true;
+        client->lastSendMs = 0;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (!client) {
+        DEBUG_ERROR("Telemetria: brak miejsca dla klienta #%u", clientId);
+    }
+}
+
+void TelemetryChannel::onDisconnect(uint32_t clientId) {
+    portENTER_CRITICAL(&lock);
+    Client* client = findClient(clientId);
+    if (client) {
+        client->used = false;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+void TelemetryChannel::onMessage(uint32_t clientId, const uint8_t* data, size_t len) {
+    StaticJsonDocument<192> doc;
+    if (deserializeJson(doc, data, len)) {
+        return;
+    }
+
+    JsonVariant request = doc["telemetry"];
+    if (request.isNull()) {
+        return;
+    }
+
+    const char* format = request["format"] | "json";
+    int rate = constrain(request["rate"] | 1, TELEMETRY_MIN_RATE_HZ, TELEMETRY_MAX_RATE_HZ);
+    uint16_t fields = (request["fields"] | (int)TELEMETRY_ALL_FIELDS) & TELEMETRY_ALL_FIELDS;
+
+    Client snapshot;
+    portENTER_CRITICAL(&lock);
+    Client* client = findClient(clientId);
+    if (client) {
+        client->format = strcmp(format, "binary") == 0 ? FORMAT_BINARY : FORMAT_JSON;
+        client->periodMs = 1000 / rate;
+        client->fieldMask = fields;
+        client->keyDue = true;
+        snapshot = *client;
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (client) {
+        DEBUG_INFO("Telemetria: klient #%u - %s, %d Hz, pola 0x%04X", clientId, format, rate, fields);
+        sendAck(clientId, snapshot);
+    }
+}
+
+void TelemetryChannel::sendAck(uint32_t clientId, const Client& client) {
+    AsyncWebSocketClient* socketClient = ws.client(clientId);
+    if (!socketClient) return;
+
+    char ack[128];
+    int len = snprintf(ack, sizeof(ack),
+        "{\"telemetry\":{\"version\":%d,\"format\":\"%s\",\"rate\":%u,\"fields\":%u}}",
+        TELEMETRY_PROTOCOL_VERSION, client.format == FORMAT_BINARY ? "binary" : "json",
+        1000 / client.periodMs, client.fieldMask);
+    socketClient->text(ack, len);
+}
+
+size_t TelemetryChannel::encodeFrame(Client& client, const TelemetrySnapshot& snapshot, bool key) {
+    uint16_t bitmap = 0;
+    uint8_t* p = frame + 4;
+
+    for (uint8_t field = 0; field < TELEMETRY_FIELD_COUNT; field++) {
+        uint16_t bit = 1 << field;
+        if (!(client.fieldMask & bit)) continue;
+
+        int32_t value = snapshot.values[field];
+        if (key) {
+            p = putZigzagVarint(p, value);
+        } else if (value != client.lastSent[field]) {
+            p = putZigzagVarint(p, value - client.lastSent[field]);
+        } else {
+            continue;
+        }
+
+        bitmap |= bit;
+        client.lastSent[field] = value;
+    }
+
+    if (!key && bitmap == 0) {
+        return 0;  // Nic się nie zmieniło
+    }
+
+    frame[0] = key ? TELEMETRY_FRAME_KEY : TELEMETRY_FRAME_DELTA;
+    frame[1] = client.sequence++;
+    frame[2] = bitmap & 0xFF;
+    frame[3] = bitmap >> 8;
+    return p - frame;
+}
+
+void TelemetryChannel::publish(const TelemetrySnapshot& snapshot) {
+    unsigned long now = millis();
+    size_t jsonLen = 0;
+
+    for (uint8_t i = 0; i < TELEMETRY_MAX_CLIENTS; i++) {
+        Client& client = clients[i];
+
+        // Konfiguracja klienta zmieniana jest z zadania serwera
+        portENTER_CRITICAL(&lock);
+        bool used = client.used;
+        bool due = used && (client.keyDue || now - client.lastSendMs >= client.periodMs);
+        bool key = client.keyDue || now - client.lastKeyMs >= TELEMETRY_KEYFRAME_MS;
+        uint32_t clientId = client.id;
+        Format format = client.format;
+        portEXIT_CRITICAL(&lock);
+
+        if (!due) continue;
+
+        AsyncWebSocketClient* socketClient = ws.client(clientId);
+        if (!socketClient || !socketClient->canSend()) {
+            framesSkipped++;
+            continue;
+        }
+
+        client.lastSendMs = now;
+
+        if (format == FORMAT_BINARY) {
+            portENTER_CRITICAL(&lock);
+            client.keyDue = false;
+            portEXIT_CRITICAL(&lock);
+
+            size_t len = encodeFrame(client, snapshot, key);
+            if (key) client.lastKeyMs = now;
+            if (len == 0) continue;
+
+            socketClient->binary(frame, len);
+            bytesSent += len;
+        } else {
+            if (!jsonFormatter) continue;
+
+            // JSON budowany raz na cykl, wspólny dla wszystkich klientów JSON
+            if (jsonLen == 0) {
+                jsonLen = jsonFormatter(json, sizeof(json));
+            }
+            socketClient->text(json, jsonLen);
+            bytesSent += jsonLen;
+        }
+        framesSent++;
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef TELEMETRY_CHANNEL_H
+#define TELEMETRY_CHANNEL_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "DebugUtils.h"
+
+// Kanał telemetrii na WebSocket /ws.
+//
+// Ramka binarna (little-endian):
+//   bajt 0     typ: TELEMETRY_FRAME_KEY (wartości bezwzględne) lub TELEMETRY_FRAME_DELTA
+//   bajt 1     numer kolejny ramki
+//   bajty 2-3  mapa bitowa pól zawartych w ramce (bit = TelemetryField)
+//   dalej      dla każdego ustawionego bitu, od najmłodszego: varint zigzag
+//              z wartością (ramka kluczowa) lub różnicą do poprzednio wysłanej
+// Ramka delta zawiera tylko pola, które się zmieniły; bez zmian nic nie jest wysyłane.
+//
+// Klient wybiera format, częstotliwość i zestaw pól wiadomością tekstową:
+//   {"telemetry":{"format":"binary","rate":10,"fields":32767}}
+// Klient, który nic nie wynegocjuje, dostaje JSON raz na sekundę (zgodność wstecz).
+
+#define TELEMETRY_PROTOCOL_VERSION 1
+#define TELEMETRY_MAX_CLIENTS 8
+#define TELEMETRY_MIN_RATE_HZ 1
+#define TELEMETRY_MAX_RATE_HZ 20
+#define TELEMETRY_KEYFRAME_MS 5000      // Ramka kluczowa co 5 s - odświeżenie stanu klienta
+#define TELEMETRY_FRAME_KEY 0x01
+#define TELEMETRY_FRAME_DELTA 0x02
+
+// Pola telemetrii - kolejność jest częścią protokołu (patrz script.js)
+enum TelemetryField : uint8_t {
+    TELEMETRY_SPEED,            // 0.1 km/h
+    TELEMETRY_CADENCE,          // RPM
+    TELEMETRY_POWER,            // W
+    TELEMETRY_VOLTAGE,          // 0.1 V
+    TELEMETRY_CURRENT,          // 0.1 A
+    TELEMETRY_BATTERY,          // %
+    TELEMETRY_TEMP_AIR,         // 0.1 °C
+    TELEMETRY_TEMP_CONTROLLER,  // 0.1 °C
+    TELEMETRY_TEMP_MOTOR,       // 0.1 °C
+    TELEMETRY_ASSIST,           // poziom wspomagania
+    TELEMETRY_LIGHT_MODE,       // LightManager::LightMode
+    TELEMETRY_LIGHT_DAY,        // flagi LightManager::FRONT/DRL/REAR
+    TELEMETRY_LIGHT_NIGHT,      // flagi LightManager::FRONT/DRL/REAR
+    TELEMETRY_TRIP_DISTANCE,    // m
+    TELEMETRY_ODOMETER,         // m
+    TELEMETRY_FIELD_COUNT
+};
+
+#define TELEMETRY_ALL_FIELDS ((uint16_t)((1UL << TELEMETRY_FIELD_COUNT) - 1))
+
+// Wartość pola bez pomiaru (np. czujnik temperatury bez odczytu); w JSON - null
+#define TELEMETRY_NO_VALUE (-32768)
+
+// Maksymalna ramka: nagłówek + 5 bajtów varint na pole
+#define TELEMETRY_MAX_FRAME (4 + TELEMETRY_FIELD_COUNT * 5)
+#define TELEMETRY_MAX_JSON 384
+
+struct TelemetrySnapshot {
+    int32_t values[TELEMETRY_FIELD_COUNT];
+};
+
+class TelemetryChannel {
+public:
+    // Formatowanie ramki JSON do bufora; zwraca długość
+    typedef size_t (*JsonFormatter)(char* buffer, size_t len);
+
+    explicit TelemetryChannel(AsyncWebSocket& socket);
+
+    void setJsonFormatter(JsonFormatter formatter) { jsonFormatter = formatter; }
+
+    // Zdarzenia WebSocket (wywoływane z zadania serwera)
+    void onConnect(uint32_t clientId);
+    void onDisconnect(uint32_t clientId);
+    void onMessage(uint32_t clientId, const uint8_t* data, size_t len);
+
+    // Wysyłka do klientów, którym minął okres (wywoływać z częstotliwością TELEMETRY_MAX_RATE_HZ)
+    void publish(const TelemetrySnapshot& snapshot);
+
+    // Statystyki
+    uint32_t getFramesSent() const { return framesSent; }
+    uint32_t getBytesSent() const { return bytesSent; }
+    uint32_t getFramesSkipped() const { return framesSkipped; }
+
+private:
+    enum Format : uint8_t {
+        FORMAT_JSON,
+        FORMAT_BINARY
+    };
+
+    struct Client {
+        uint32_t id;
+        bool used;
+        Format format;
+        uint16_t periodMs;
+        uint16_t fieldMask;
+        bool keyDue;
+        uint8_t sequence;
+        unsigned long lastSendMs;
+        unsigned long lastKeyMs;
+        int32_t lastSent[TELEMETRY_FIELD_COUNT];
+    };
+
+    AsyncWebSocket& ws;
+    Client clients[TELEMETRY_MAX_CLIENTS];
+    portMUX_TYPE lock;
+    JsonFormatter jsonFormatter;
+
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    char json[TELEMETRY_MAX_JSON];
+
+    uint32_t framesSent;
+    uint32_t bytesSent;
+    uint32_t framesSkipped;
+
+    Client* findClient(uint32_t clientId);
+    size_t encodeFrame(Client& client, const TelemetrySnapshot& snapshot, bool key);
+    void sendAck(uint32_t clientId, const Client& client);
+};
+
+#endif // TELEMETRY_CHANNEL_H
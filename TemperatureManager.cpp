@@ -0,0 +1,234 @@
+#include "TemperatureManager.h"
+
+// Temperatura [0.1 °C] dla napięcia dzielnika i * 32 mV (NTC10k B3950, 10k do 3.3 V),
+// ograniczona do -40..150 °C
+static const int16_t NTC_TABLE_STEP_SHIFT = 5;
+static const int16_t NTC_TABLE[] = {
+     1500,  1500,  1500,  1324,  1203,  1114,  1043,   985,   935,   892,   854,   820,
+      789,   760,   734,   710,   687,   666,   646,   627,   609,   592,   576,   560,
+      545,   531,   517,   503,   490,   477,   465,   453,   441,   430,   419,   408,
+      397,   387,   376,   366,   356,   347,   337,   327,   318,   309,   300,   290,
+      281,   273,   264,   255,   246,   238,   229,   220,   212,   203,   195,   186,
+      177,   169,   160,   152,   143,   135,   126,   117,   108,   100,    91,    82,
+       72,    63,    54,    44,    35,    25,    15,     5,    -5,   -16,   -27,   -38,
+      -50,   -61,   -74,   -87,  -100,  -114,  -128,  -144,  -160,  -178,  -196,  -217,
+     -239,  -264,  -293,  -327,  -368,  -400,  -400,  -400,  -400
+};
+static const uint16_t NTC_TABLE_SIZE = sizeof(NTC_TABLE) / sizeof(NTC_TABLE[0]);
+
+static const char* const STEP_NAMES[TEMP_STEP_COUNT] = {
+    "request", "read", "rescan", "ntc"
+};
+
+TemperatureManager::TemperatureManager(DallasTemperature& air, DallasTemperature& controller, int8_t ntcPin) :
+    ntcPin(ntcPin),
+    ntcSum(0),
+    ntcCount(0),
+    ntcMilliVolts(0),
+    state(STATE_IDLE),
+    busIndex(0),
+    lastRequestMs(0),
+    conversionStartMs(0),
+    lastRescanMs(0),
+    conversionMs(750),
+    maxCallUs(0)
+{
+    buses[TEMP_CHANNEL_AIR] = &air;
+    buses[TEMP_CHANNEL_CONTROLLER] = &controller;
+    for (uint8_t i = 0; i < DS_COUNT; i++) {
+        present[i] = false;
+        failures[i] = 0;
+    }
+    for (uint8_t i = 0; i < TEMP_CHANNEL_COUNT; i++) {
+        values[i] = TEMP_INVALID;
+        errors[i] = 0;
+    }
+    resetTiming();
+}
+
+void TemperatureManager::begin() {
+    for (uint8_t i = 0; i < DS_COUNT; i++) {
+        buses[i]->begin();
+        buses[i]->setWaitForConversion(false);
+        resolve(i);
+    }
+    conversionMs = buses[0]->millisToWaitForConversion(TEMP_DS18B20_RESOLUTION);
+    lastRescanMs = millis();
+
+    if (ntcPin >= 0) {
+        analogReadResolution(12);
+        analogSetPinAttenuation(ntcPin, ADC_11db);
+    }
+}
+
+// Wyszukanie pierwszego czujnika na magistrali i zapamiętanie adresu
+bool TemperatureManager::resolve(uint8_t index) {
+    present[index] = buses[index]->getAddress(addresses[index], 0);
+    failures[index] = 0;
+
+    if (present[index]) {
+        buses[index]->setResolution(addresses[index], TEMP_DS18B20_RESOLUTION);
+        char text[24];
+        formatAddress((TemperatureChannel)index, text, sizeof(text));
+        DEBUG_INFO("Czujnik temperatury %d: %s", index, text);
+    } else {
+        DEBUG_ERROR("Brak czujnika DS18B20 na magistrali %d", index);
+    }
+    return present[index];
+}
+
+bool TemperatureManager::isPresent(TemperatureChannel channel) const {
+    if (channel == TEMP_CHANNEL_MOTOR) {
+        return ntcPin >= 0 && values[TEMP_CHANNEL_MOTOR] != TEMP_INVALID;
+    }
+    return present[channel];
+}
+
+void TemperatureManager::formatAddress(TemperatureChannel channel, char* buffer, size_t size) const {
+    if (size == 0) return;
+    buffer[0] = '\0';
+    if (channel >= DS_COUNT || !present[channel]) return;
+
+    const uint8_t* a = addresses[channel];
+    snprintf(buffer, size, "%02X%02X%02X%02X%02X%02X%02X%02X",
+             a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+}
+
+void TemperatureManager::update() {
+    uint32_t callStart = micros();
+    unsigned long now = millis();
+
+    stepDallas(now);
+
+    if (ntcPin >= 0) {
+        uint32_t start = micros();
+        sampleNtc();
+        recordStep(TEMP_STEP_NTC, start);
+    }
+
+    uint32_t elapsed = micros() - callStart;
+    if (elapsed > maxCallUs) maxCallUs = elapsed;
+}
+
+void TemperatureManager::stepDallas(unsigned long now) {
+    uint32_t start = micros();
+
+    switch (state) {
+        case STATE_IDLE:
+            if (now - lastRescanMs >= TEMP_RESCAN_INTERVAL_MS) {
+                // Brakujące czujniki - jedna magistrala na wywołanie
+                lastRescanMs = now;
+                for (uint8_t i = 0; i < DS_COUNT; i++) {
+                    if (!present[i]) {
+                        resolve(i);
+                        recordStep(TEMP_STEP_RESCAN, start);
+                        break;
+                    }
+                }
+            } else if (now - lastRequestMs >= TEMP_REQUEST_INTERVAL_MS) {
+                lastRequestMs = now;
+                busIndex = 0;
+                state = STATE_REQUEST;
+            }
+            break;
+
+        case STATE_REQUEST:
+            // Konwersja na wszystkich czujnikach magistrali (Skip ROM), bez czekania
+            if (present[busIndex]) {
+                buses[busIndex]->requestTemperatures();
+                recordStep(TEMP_STEP_REQUEST, start);
+            }
+            if (++busIndex >= DS_COUNT) {
+                conversionStartMs = now;
+                state = STATE_CONVERTING;
+            }
+            break;
+
+        case STATE_CONVERTING:
+            if (now - conversionStartMs >= conversionMs) {
+                busIndex = 0;
+                state = STATE_READ;
+            }
+            break;
+
+        case STATE_READ:
+            if (present[busIndex]) {
+                readSensor(busIndex);
+                recordStep(TEMP_STEP_READ, start);
+            }
+            if (++busIndex >= DS_COUNT) {
+                state = STATE_IDLE;
+            }
+            break;
+    }
+}
+
+void TemperatureManager::readSensor(uint8_t index) {
+    float temp = buses[index]->getTempC(addresses[index]);
+
+    // 85 °C to wartość po włączeniu zasilania czujnika - bez wcześniejszego odczytu niewiarygodna
+    bool powerOnValue = (temp == 85.0f && values[index] == TEMP_INVALID);
+
+    if (temp == DEVICE_DISCONNECTED_C || temp < TEMP_MIN_VALID || temp > TEMP_MAX_VALID || powerOnValue) {
+        errors[index]++;
+        if (++failures[index] >= TEMP_MAX_FAILURES) {
+            // Ostatnia wartość przestaje obowiązywać; adres do ponownego wyszukania
+            values[index] = TEMP_INVALID;
+            present[index] = false;
+            DEBUG_ERROR("Czujnik temperatury %d nie odpowiada", index);
+        }
+        return;
+    }
+
+    failures[index] = 0;
+    values[index] = temp;
+}
+
+void TemperatureManager::sampleNtc() {
+    for (uint8_t i = 0; i < NTC_SAMPLES_PER_CALL; i++) {
+        ntcSum += analogReadMilliVolts(ntcPin);
+    }
+    ntcCount += NTC_SAMPLES_PER_CALL;
+    if (ntcCount < NTC_OVERSAMPLE) return;
+
+    ntcMilliVolts = (ntcSum + ntcCount / 2) / ntcCount;
+    ntcSum = 0;
+    ntcCount = 0;
+
+    if (ntcMilliVolts < NTC_MIN_MV || ntcMilliVolts > NTC_MAX_MV) {
+        if (values[TEMP_CHANNEL_MOTOR] != TEMP_INVALID) {
+            DEBUG_ERROR("NTC silnika poza zakresem: %u mV", ntcMilliVolts);
+        }
+        errors[TEMP_CHANNEL_MOTOR]++;
+        values[TEMP_CHANNEL_MOTOR] = TEMP_INVALID;
+        return;
+    }
+    values[TEMP_CHANNEL_MOTOR] = ntcToDeciCelsius(ntcMilliVolts) / 10.0f;
+}
+
+int16_t TemperatureManager::ntcToDeciCelsius(uint16_t milliVolts) {
+    uint16_t index = milliVolts >> NTC_TABLE_STEP_SHIFT;
+    if (index >= NTC_TABLE_SIZE - 1) {
+        return NTC_TABLE[NTC_TABLE_SIZE - 1];
+    }
+    int32_t fraction = milliVolts & ((1 << NTC_TABLE_STEP_SHIFT) - 1);
+    int32_t low = NTC_TABLE[index];
+    int32_t high = NTC_TABLE[index + 1];
+    return low + (((high - low) * fraction) >> NTC_TABLE_STEP_SHIFT);
+}
+
+void TemperatureManager::recordStep(TemperatureStep step, uint32_t startUs) {
+    uint32_t elapsed = micros() - startUs;
+    if (elapsed > maxStepUs[step]) maxStepUs[step] = elapsed;
+}
+
+void TemperatureManager::resetTiming() {
+    maxCallUs = 0;
+    for (uint8_t i = 0; i < TEMP_STEP_COUNT; i++) {
+        maxStepUs[i] = 0;
+    }
+}
+
+const char* TemperatureManager::getStepName(TemperatureStep step) {
+    return (step < TEMP_STEP_COUNT) ? STEP_NAMES[step] : "?";
+}
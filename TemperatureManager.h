@@ -0,0 +1,121 @@
+#ifndef TEMPERATURE_MANAGER_H
+#define TEMPERATURE_MANAGER_H
+
+#include <Arduino.h>
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include "DebugUtils.h"
+
+// Pomiar temperatur: dwa DS18B20 (każdy na osobnej magistrali OneWire) i NTC10k silnika.
+//
+// Adresy ROM czujników DS18B20 wyszukiwane są raz przy starcie (brakujący czujnik -
+// ponownie co TEMP_RESCAN_INTERVAL_MS), odczyt zawsze po adresie, bez przeszukiwania
+// magistrali jak w getTempCByIndex(). Konwersja uruchamiana jest asynchronicznie, a
+// update() wykonuje co wywołanie najwyżej jeden krok automatu (żądanie na jednej
+// magistrali albo odczyt jednego czujnika), żeby żadne wywołanie nie blokowało pętli.
+//
+// NTC: dzielnik 10k (do 3.3 V) / NTC10k B3950 (do masy) na wejściu ADC1.
+// Napięcie z kalibracją ADC (analogReadMilliVolts), uśrednione z NTC_OVERSAMPLE próbek
+// pobieranych po NTC_SAMPLES_PER_CALL na wywołanie, przeliczane tablicą co 32 mV
+// (0.1 °C, interpolacja liniowa, błąd < 0.3 °C w zakresie -20..120 °C).
+
+#define TEMP_INVALID -999.0f
+#define TEMP_REQUEST_INTERVAL_MS 1000
+#define TEMP_DS18B20_RESOLUTION 12
+#define TEMP_RESCAN_INTERVAL_MS 30000
+#define TEMP_MAX_FAILURES 3          // Kolejne błędne odczyty, po których czujnik uznany za odłączony
+#define TEMP_MIN_VALID -50.0f
+#define TEMP_MAX_VALID 150.0f
+
+#define NTC_OVERSAMPLE 16
+#define NTC_SAMPLES_PER_CALL 4
+#define NTC_MIN_MV 50                // Poniżej - zwarcie
+#define NTC_MAX_MV 3250              // Powyżej - brak czujnika
+
+// Kanały DS18B20 mają numery magistral (air = 0, controller = 1), NTC jest ostatni
+enum TemperatureChannel : uint8_t {
+    TEMP_CHANNEL_AIR,
+    TEMP_CHANNEL_CONTROLLER,
+    TEMP_CHANNEL_MOTOR,
+    TEMP_CHANNEL_COUNT
+};
+
+// Kroki update() - osobny czas maksymalny dla każdego
+enum TemperatureStep : uint8_t {
+    TEMP_STEP_REQUEST,
+    TEMP_STEP_READ,
+    TEMP_STEP_RESCAN,
+    TEMP_STEP_NTC,
+    TEMP_STEP_COUNT
+};
+
+class TemperatureManager {
+public:
+    TemperatureManager(DallasTemperature& air, DallasTemperature& controller, int8_t ntcPin);
+
+    // Wyszukanie adresów i konfiguracja czujników (setup)
+    void begin();
+
+    // Jeden krok pomiaru - wołać okresowo z pętli
+    void update();
+
+    // TEMP_INVALID, jeśli brak aktualnego odczytu
+    float get(TemperatureChannel channel) const { return values[channel]; }
+    bool isPresent(TemperatureChannel channel) const;
+
+    // Adres ROM czujnika DS18B20 jako tekst (pusty dla NTC i brakującego czujnika)
+    void formatAddress(TemperatureChannel channel, char* buffer, size_t size) const;
+    uint32_t getErrors(TemperatureChannel channel) const { return errors[channel]; }
+    uint16_t getNtcMilliVolts() const { return ntcMilliVolts; }
+
+    // Najdłuższy czas jednego wywołania update() i poszczególnych kroków [us]
+    uint32_t getMaxCallUs() const { return maxCallUs; }
+    uint32_t getMaxStepUs(TemperatureStep step) const { return maxStepUs[step]; }
+    void resetTiming();
+
+    static const char* getStepName(TemperatureStep step);
+
+    // Przeliczenie napięcia dzielnika na temperaturę [0.1 °C]
+    static int16_t ntcToDeciCelsius(uint16_t milliVolts);
+
+private:
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_REQUEST,     // Żądanie konwersji, po jednej magistrali
+        STATE_CONVERTING,
+        STATE_READ         // Odczyt po jednym czujniku
+    };
+
+    static const uint8_t DS_COUNT = 2;
+
+    DallasTemperature* buses[DS_COUNT];
+    DeviceAddress addresses[DS_COUNT];
+    bool present[DS_COUNT];
+    uint8_t failures[DS_COUNT];
+
+    int8_t ntcPin;
+    uint32_t ntcSum;
+    uint8_t ntcCount;
+    uint16_t ntcMilliVolts;
+
+    float values[TEMP_CHANNEL_COUNT];
+    uint32_t errors[TEMP_CHANNEL_COUNT];
+
+    State state;
+    uint8_t busIndex;
+    unsigned long lastRequestMs;
+    unsigned long conversionStartMs;  // Żądanie na ostatniej magistrali
+    unsigned long lastRescanMs;
+    uint16_t conversionMs;
+
+    uint32_t maxCallUs;
+    uint32_t maxStepUs[TEMP_STEP_COUNT];
+
+    bool resolve(uint8_t index);
+    void readSensor(uint8_t index);
+    void sampleNtc();
+    void stepDallas(unsigned long now);
+    void recordStep(TemperatureStep step, uint32_t startUs);
+};
+
+#endif // TEMPERATURE_MANAGER_H
@@ -0,0 +1,108 @@
+#include "TpmsReceiver.h"
+
+TpmsReceiver::TpmsReceiver() :
+    advertsSeen(0),
+    advertsAccepted(0)
+{
+    memset(sensorMacs, 0, sizeof(sensorMacs));
+    sensorEnabled[TPMS_FRONT] = false;
+    sensorEnabled[TPMS_REAR] = false;
+}
+
+static inline int8_t hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool TpmsReceiver::parseMac(const char* text, uint8_t mac[6]) {
+    if (!text) return false;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        int8_t hi = hexValue(text[0]);
+        int8_t lo = (hi >= 0) ? hexValue(text[1]) : -1;
+        if (lo < 0) return false;
+        mac[i] = (hi << 4) | lo;
+
+        char separator = text[2];
+        if (i < 5 && separator != ':' && separator != '-') return false;
+        if (i == 5 && separator != '\0') return false;
+        text += 3;
+    }
+    return true;
+}
+
+void TpmsReceiver::setSensors(const char* frontMac, const char* rearMac) {
+    sensorEnabled[TPMS_FRONT] = parseMac(frontMac, sensorMacs[TPMS_FRONT]);
+    sensorEnabled[TPMS_REAR] = parseMac(rearMac, sensorMacs[TPMS_REAR]);
+
+    if (frontMac && frontMac[0] && !sensorEnabled[TPMS_FRONT]) {
+        DEBUG_WARN("TPMS: bledny adres przedniego czujnika '%s'", frontMac);
+    }
+    if (rearMac && rearMac[0] && !sensorEnabled[TPMS_REAR]) {
+        DEBUG_WARN("TPMS: bledny adres tylnego czujnika '%s'", rearMac);
+    }
+}
+
+static inline uint32_t readLe32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool TpmsReceiver::decodePayload(const uint8_t* payload, size_t length, TpmsReading& reading) {
+    // Przegląd struktur AD: [długość][typ][dane...]
+    size_t pos = 0;
+    while (pos + 1 < length) {
+        uint8_t fieldLength = payload[pos];
+        if (fieldLength == 0 || pos + 1 + fieldLength > length) {
+            return false;
+        }
+
+        const uint8_t* data = payload + pos + 2;
+        size_t dataLength = fieldLength - 1;
+
+        if (payload[pos + 1] == 0xFF) {
+            if (dataLength < TPMS_PAYLOAD_LENGTH || data[0] != 0x00 || data[1] != 0x01) {
+                return false;
+            }
+
+            reading.sensorNumber = data[2];
+            memcpy(reading.address, data + 3, sizeof(reading.address));
+            reading.pressurePa = readLe32(data + 8);
+            reading.temperatureCenti = (int32_t)readLe32(data + 12);
+            reading.batteryPercent = data[16];
+            reading.alarm = data[17] != 0;
+            return true;
+        }
+
+        pos += 1 + fieldLength;
+    }
+    return false;
+}
+
+void TpmsReceiver::onResult(BLEAdvertisedDevice advertisedDevice) {
+    advertsSeen++;
+
+    // Najtańszy test najpierw - obce urządzenia odpadają po porównaniu 6 bajtów
+    BLEAddress address = advertisedDevice.getAddress();
+    const uint8_t* mac = *address.getNative();
+    TpmsPosition position;
+    if (sensorEnabled[TPMS_FRONT] && memcmp(mac, sensorMacs[TPMS_FRONT], 6) == 0) {
+        position = TPMS_FRONT;
+    } else if (sensorEnabled[TPMS_REAR] && memcmp(mac, sensorMacs[TPMS_REAR], 6) == 0) {
+        position = TPMS_REAR;
+    } else {
+        return;
+    }
+
+    TpmsReading reading;
+    if (!decodePayload(advertisedDevice.getPayload(), advertisedDevice.getPayloadLength(), reading)) {
+        return;
+    }
+
+    reading.position = position;
+    reading.receivedMs = millis();
+    if (queue.push(reading)) {
+        advertsAccepted++;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef TPMS_RECEIVER_H
+#define TPMS_RECEIVER_H
+
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include "DebugUtils.h"
+#include "SpscRing.h"
+
+// Odbiór rozgłoszeń czujników TPMS (skanowanie pasywne BLE).
+//
+// onResult() wołane jest z zadania BLE dla każdego rozgłoszenia w zasięgu - w mieście
+// setki na sekundę. Najpierw porównywany jest binarny adres MAC z dwoma skonfigurowanymi
+// czujnikami, dopiero dopasowane pakiety są dekodowane wprost z bufora rozgłoszenia
+// (bez String i sprintf) i przekazywane do pętli głównej przez kolejkę SpscRing.
+//
+// Dane producenta (AD 0xFF), 18 bajtów:
+//   0-1   identyfikator producenta 0x00 0x01
+//   2     numer czujnika
+//   3-7   adres czujnika
+//   8-11  ciśnienie [Pa], little-endian
+//   12-15 temperatura [0.01 °C], little-endian
+//   16    bateria [%]
+//   17    alarm
+
+#define TPMS_PAYLOAD_LENGTH 18
+#define TPMS_QUEUE_SIZE 8
+
+enum TpmsPosition : uint8_t {
+    TPMS_FRONT,
+    TPMS_REAR
+};
+
+struct TpmsReading {
+    TpmsPosition position;
+    unsigned long receivedMs;   // Czas odbioru (millis) - do szacowania okresu rozgłoszeń
+    uint8_t sensorNumber;
+    uint8_t address[5];
+    uint32_t pressurePa;
+    int32_t temperatureCenti;
+    uint8_t batteryPercent;
+    bool alarm;
+};
+
+class TpmsReceiver : public BLEAdvertisedDeviceCallbacks {
+public:
+    TpmsReceiver();
+
+    // Adresy czujników w formacie "AA:BB:CC:DD:EE:FF"; pusty lub błędny wyłącza pozycję.
+    // Wołać tylko przy zatrzymanym skanowaniu.
+    void setSensors(const char* frontMac, const char* rearMac);
+
+    // Zadanie BLE
+    void onResult(BLEAdvertisedDevice advertisedDevice) override;
+
+    // Pętla główna
+    bool pop(TpmsReading& reading) { return queue.pop(reading); }
+    bool isSensorEnabled(TpmsPosition position) const { return sensorEnabled[position]; }
+
+    // Diagnostyka
+    uint32_t getAdvertsSeen() const { return advertsSeen; }
+    uint32_t getAdvertsAccepted() const { return advertsAccepted; }
+    uint32_t getDropped() const { return queue.getDropped(); }
+
+    static bool parseMac(const char* text, uint8_t mac[6]);
+
+    // Dekodowanie danych producenta z surowego bufora rozgłoszenia
+    static bool decodePayload(const uint8_t* payload, size_t length, TpmsReading& reading);
+
+private:
+    uint8_t sensorMacs[2][6];
+    bool sensorEnabled[2];
+
+    SpscRing<TpmsReading, TPMS_QUEUE_SIZE> queue;
+
+    volatile uint32_t advertsSeen;
+    volatile uint32_t advertsAccepted;
+};
+
+#endif // TPMS_RECEIVER_H
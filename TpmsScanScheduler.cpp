@@ -0,0 +1,240 @@
+#include "TpmsScanScheduler.h"
+
+TpmsScanScheduler::TpmsScanScheduler() :
+    parked(false),
+    scanning(false),
+    searchMode(false),
+    scanStartMs(0),
+    scanUntilMs(0),
+    lastScanEndMs(0),
+    nextSearchMs(0),
+    searchBackoffMs(TPMS_SEARCH_BACKOFF_MIN_MS),
+    searchHit(false),
+    scanMs(0),
+    statsStartMs(0),
+    windows(0),
+    searches(0),
+    misses(0)
+{
+    memset(sensors, 0, sizeof(sensors));
+}
+
+void TpmsScanScheduler::begin(unsigned long now) {
+    scanning = false;
+    lastScanEndMs = now;
+    nextSearchMs = now;
+    searchBackoffMs = TPMS_SEARCH_BACKOFF_MIN_MS;
+    resetStats(now);
+}
+
+void TpmsScanScheduler::setSensorEnabled(uint8_t sensor, bool enabled) {
+    if (sensor >= TPMS_SENSOR_COUNT) return;
+    if (sensors[sensor].enabled != enabled) {
+        memset(&sensors[sensor], 0, sizeof(Sensor));
+        sensors[sensor].enabled = enabled;
+    }
+}
+
+void TpmsScanScheduler::setParked(bool value) {
+    parked = value;
+}
+
+bool TpmsScanScheduler::needsSearch(const Sensor& sensor) const {
+    return !sensor.seen || sensor.periodMs == 0 || sensor.missStreak >= TPMS_MAX_MISSES;
+}
+
+uint32_t TpmsScanScheduler::guardFor(const Sensor& sensor) {
+    return max((uint32_t)TPMS_WINDOW_GUARD_MS, sensor.periodMs / 10);
+}
+
+// Najbliższe spodziewane rozgłoszenie, którego okno jeszcze się nie skończyło
+unsigned long TpmsScanScheduler::nextExpected(const Sensor& sensor, unsigned long now) const {
+    unsigned long expected = sensor.lastSeenMs + sensor.periodMs;
+    uint32_t guard = guardFor(sensor);
+    if ((long)(now - (expected + guard)) > 0) {
+        // Okna pominięte (np. podczas wyszukiwania drugiego czujnika) - nie liczą się jako chybione
+        uint32_t skipped = (now - (expected + guard)) / sensor.periodMs + 1;
+        expected += skipped * sensor.periodMs;
+    }
+    return expected;
+}
+
+void TpmsScanScheduler::onReading(uint8_t sensor, unsigned long now) {
+    if (sensor >= TPMS_SENSOR_COUNT) return;
+    Sensor& s = sensors[sensor];
+
+    if (s.seen) {
+        uint32_t interval = now - s.lastSeenMs;
+        if (interval >= TPMS_MIN_PERIOD_MS) {
+            if (s.periodMs == 0 || interval < s.periodMs * 3 / 4) {
+                // Pierwszy pomiar lub krótszy odstęp - poprzedni był wielokrotnością okresu
+                s.periodMs = interval;
+            } else {
+                // Odstęp może obejmować kilka pominiętych rozgłoszeń
+                uint32_t count = (interval + s.periodMs / 2) / s.periodMs;
+                s.periodMs = (3 * s.periodMs + interval / count) / 4;
+            }
+            s.periodMs = constrain(s.periodMs, (uint32_t)TPMS_MIN_PERIOD_MS, (uint32_t)TPMS_MAX_PERIOD_MS);
+        }
+    }
+
+    s.seen = true;
+    s.pending = false;
+    s.missStreak = 0;
+    s.lastSeenMs = now;
+
+    if (scanning && searchMode) {
+        searchHit = true;
+    }
+}
+
+void TpmsScanScheduler::markLost(uint8_t sensor) {
+    if (sensor >= TPMS_SENSOR_COUNT) return;
+    sensors[sensor].missStreak = TPMS_MAX_MISSES;
+
+    // Utrata czujnika - wyszukiwanie bez czekania na przerwę
+    searchBackoffMs = TPMS_SEARCH_BACKOFF_MIN_MS;
+    nextSearchMs = lastScanEndMs;
+}
+
+void TpmsScanScheduler::startScan(unsigned long now, unsigned long until, bool search) {
+    scanning = true;
+    searchMode = search;
+    searchHit = false;
+    scanStartMs = now;
+    scanUntilMs = until;
+
+    if (search) {
+        searches++;
+    } else {
+        windows++;
+    }
+}
+
+TpmsScanScheduler::Action TpmsScanScheduler::update(unsigned long now) {
+    if (scanning) {
+        bool anyPending = false;
+        for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+            if (sensors[i].enabled && sensors[i].pending) anyPending = true;
+        }
+
+        // Koniec okna lub wszystkie oczekiwane czujniki już się zgłosiły
+        if ((long)(now - scanUntilMs) < 0 && anyPending) {
+            return NONE;
+        }
+
+        scanning = false;
+        lastScanEndMs = now;
+        scanMs += now - max(scanStartMs, statsStartMs);
+
+        for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+            Sensor& s = sensors[i];
+            if (!s.pending) continue;
+            s.pending = false;
+            if (!searchMode && s.missStreak < TPMS_MAX_MISSES) {
+                s.missStreak++;
+                misses++;
+            }
+        }
+
+        if (searchMode) {
+            if (searchHit) {
+                searchBackoffMs = TPMS_SEARCH_BACKOFF_MIN_MS;
+                nextSearchMs = now;
+            } else {
+                nextSearchMs = now + searchBackoffMs;
+                searchBackoffMs = min(searchBackoffMs * 2, (uint32_t)TPMS_SEARCH_BACKOFF_MAX_MS);
+            }
+        }
+        return STOP_SCAN;
+    }
+
+    bool anyEnabled = false;
+    for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+        if (sensors[i].enabled) anyEnabled = true;
+    }
+    if (!anyEnabled) {
+        return NONE;
+    }
+
+    // Postój - rzadkie wyszukiwanie wszystkich czujników
+    if (parked) {
+        if (now - lastScanEndMs < TPMS_PARKED_INTERVAL_MS) {
+            return NONE;
+        }
+        for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+            sensors[i].pending = sensors[i].enabled;
+        }
+        startScan(now, now + TPMS_SEARCH_WINDOW_MS, true);
+        return START_SCAN;
+    }
+
+    // Wyszukiwanie czujników bez znanego okresu lub zgubionych
+    bool search = false;
+    for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+        Sensor& s = sensors[i];
+        s.pending = s.enabled && needsSearch(s);
+        if (s.pending) search = true;
+    }
+    if (search && (long)(now - nextSearchMs) >= 0) {
+        startScan(now, now + TPMS_SEARCH_WINDOW_MS, true);
+        return START_SCAN;
+    }
+
+    // Krótkie okna wokół spodziewanych rozgłoszeń; okna zachodzące na siebie łączone są w jedno
+    bool open = false;
+    unsigned long windowEnd = now;
+    for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+        sensors[i].pending = false;
+    }
+    for (uint8_t pass = 0; pass < TPMS_SENSOR_COUNT; pass++) {
+        bool added = false;
+        for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+            Sensor& s = sensors[i];
+            if (s.pending || !s.enabled || needsSearch(s)) continue;
+
+            unsigned long expected = nextExpected(s, now);
+            uint32_t guard = guardFor(s);
+            unsigned long opensAt = open ? windowEnd : now;
+            if ((long)(opensAt - (expected - guard)) >= 0) {
+                s.pending = true;
+                open = true;
+                added = true;
+                if ((long)(expected + guard - windowEnd) > 0) {
+                    windowEnd = expected + guard;
+                }
+            }
+        }
+        if (!added) break;
+    }
+    if (open) {
+        startScan(now, windowEnd, false);
+        return START_SCAN;
+    }
+
+    return NONE;
+}
+
+uint16_t TpmsScanScheduler::getDutyCyclePermille(unsigned long now) const {
+    uint32_t elapsed = now - statsStartMs;
+    if (elapsed == 0) return 0;
+
+    uint64_t active = scanMs;
+    if (scanning) {
+        active += now - max(scanStartMs, statsStartMs);
+    }
+    return (uint16_t)min(active * 1000 / elapsed, (uint64_t)1000);
+}
+
+uint32_t TpmsScanScheduler::getFreshnessMs(uint8_t sensor, unsigned long now) const {
+    if (sensor >= TPMS_SENSOR_COUNT || !sensors[sensor].seen) return UINT32_MAX;
+    return now - sensors[sensor].lastSeenMs;
+}
+
+void TpmsScanScheduler::resetStats(unsigned long now) {
+    scanMs = 0;
+    statsStartMs = now;
+    windows = 0;
+    searches = 0;
+    misses = 0;
+}
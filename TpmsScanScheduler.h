@@ -0,0 +1,99 @@
+#ifndef TPMS_SCAN_SCHEDULER_H
+#define TPMS_SCAN_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Planowanie okien skanowania BLE dla czujników TPMS.
+//
+// Dla każdego czujnika szacowany jest okres rozgłoszeń (na podstawie odstępów między
+// odczytami). Gdy okres jest znany, radio włączane jest tylko na krótkie okno wokół
+// spodziewanego rozgłoszenia i wyłączane, gdy wszystkie oczekiwane czujniki się zgłoszą.
+// Czujnik nieznany, zgubiony lub po kilku nieudanych oknach wymusza szerokie
+// wyszukiwanie z rosnącą przerwą. Na postoju skanowanie odbywa się rzadko.
+//
+// Klasa nie dotyka radia ani millis() - czas przekazywany jest jawnie, a update()
+// zwraca akcję do wykonania przez wołającego.
+
+#define TPMS_SENSOR_COUNT 2                // Indeksy jak TpmsPosition (przód, tył)
+#define TPMS_MIN_PERIOD_MS 1000
+#define TPMS_MAX_PERIOD_MS 120000
+#define TPMS_WINDOW_GUARD_MS 400           // Minimalny margines okna po obu stronach
+#define TPMS_MAX_MISSES 3                  // Nieudane okna do przejścia w wyszukiwanie
+#define TPMS_SEARCH_WINDOW_MS 5000         // Długość okna wyszukiwania
+#define TPMS_SEARCH_BACKOFF_MIN_MS 5000    // Przerwa po nieudanym wyszukiwaniu (podwajana)
+#define TPMS_SEARCH_BACKOFF_MAX_MS 60000
+#define TPMS_PARKED_INTERVAL_MS 60000      // Odstęp skanów na postoju
+
+class TpmsScanScheduler {
+public:
+    enum Action : uint8_t {
+        NONE,
+        START_SCAN,
+        STOP_SCAN
+    };
+
+    TpmsScanScheduler();
+
+    void begin(unsigned long now);
+
+    void setSensorEnabled(uint8_t sensor, bool enabled);
+    void setParked(bool parked);
+    bool isParked() const { return parked; }
+
+    // Odczyt czujnika (z pętli głównej, po zdjęciu z kolejki)
+    void onReading(uint8_t sensor, unsigned long now);
+
+    // Czujnik uznany za utracony (checkTpmsTimeout) - wraca do wyszukiwania
+    void markLost(uint8_t sensor);
+
+    // Wywoływać okresowo (np. co 100 ms); wołający włącza/wyłącza skanowanie
+    Action update(unsigned long now);
+
+    bool isScanning() const { return scanning; }
+    bool isSearching() const { return scanning && searchMode; }
+
+    // Metryki
+    uint16_t getDutyCyclePermille(unsigned long now) const;  // Udział czasu z włączonym radiem
+    uint32_t getFreshnessMs(uint8_t sensor, unsigned long now) const;  // Wiek ostatniego odczytu
+    uint32_t getPeriodMs(uint8_t sensor) const { return sensors[sensor].periodMs; }
+    uint8_t getMissStreak(uint8_t sensor) const { return sensors[sensor].missStreak; }
+    uint32_t getWindows() const { return windows; }
+    uint32_t getSearches() const { return searches; }
+    uint32_t getMisses() const { return misses; }
+    void resetStats(unsigned long now);
+
+private:
+    struct Sensor {
+        bool enabled;
+        bool seen;               // Czy był choć jeden odczyt
+        bool pending;            // Oczekiwany w bieżącym oknie
+        uint8_t missStreak;
+        unsigned long lastSeenMs;
+        uint32_t periodMs;       // 0 = nieznany
+    };
+
+    Sensor sensors[TPMS_SENSOR_COUNT];
+
+    bool parked;
+    bool scanning;
+    bool searchMode;
+    unsigned long scanStartMs;
+    unsigned long scanUntilMs;
+    unsigned long lastScanEndMs;
+    unsigned long nextSearchMs;
+    uint32_t searchBackoffMs;
+    bool searchHit;              // Odczyt w trakcie bieżącego wyszukiwania
+
+    uint32_t scanMs;             // Suma czasu skanowania w oknie statystyk
+    unsigned long statsStartMs;
+    uint32_t windows;
+    uint32_t searches;
+    uint32_t misses;
+
+    bool needsSearch(const Sensor& sensor) const;
+    static uint32_t guardFor(const Sensor& sensor);
+    unsigned long nextExpected(const Sensor& sensor, unsigned long now) const;
+    void startScan(unsigned long now, unsigned long until, bool search);
+};
+
+#endif // TPMS_SCAN_SCHEDULER_H
@@ -0,0 +1,32 @@
+#include "TripMetrics.h"
+
+static const TripMetricInfo TRIP_METRIC_INFO[TRIP_METRIC_COUNT] = {
+    { "speed",   "km/h" },
+    { "power",   "W" },
+    { "cadence", "RPM" }
+};
+
+const TripMetricInfo& TripMetrics::getInfo(TripMetric metric) {
+    return TRIP_METRIC_INFO[metric];
+}
+
+void TripMetrics::reset() {
+    for (uint8_t i = 0; i < TRIP_METRIC_COUNT; i++) {
+        stats[i].reset();
+    }
+}
+
+void TripMetrics::toJson(JsonWriter& json) const {
+    for (uint8_t i = 0; i < TRIP_METRIC_COUNT; i++) {
+        const RunningStats<float>& metric = stats[i];
+        json.beginObject(TRIP_METRIC_INFO[i].name);
+        json.field("unit", TRIP_METRIC_INFO[i].unit);
+        json.field("avg", metric.getTimeMean());
+        json.field("max", metric.getMax());
+        json.field("min", metric.getMin());
+        json.field("stdDev", metric.getStdDev());
+        json.field("samples", metric.getCount());
+        json.field("durationS", metric.getDurationMs() / 1000);
+        json.endObject();
+    }
+}
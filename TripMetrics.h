@@ -0,0 +1,48 @@
+#ifndef TRIP_METRICS_H
+#define TRIP_METRICS_H
+
+#include <Arduino.h>
+#include "JsonWriter.h"
+#include "RunningStats.h"
+
+// Rejestr statystyk przejazdu (średnie i maksima na wyświetlaczu, eksport WWW).
+// Zerowanie, zapis w magazynie ustawień i eksport JSON to jedna pętla po metrykach -
+// nowa metryka wymaga tylko wpisu w TripMetric i TRIP_METRIC_INFO.
+
+enum TripMetric : uint8_t {
+    TRIP_SPEED,     // km/h, cały czas przejazdu (z postojami)
+    TRIP_POWER,     // W
+    TRIP_CADENCE,   // RPM, tylko czas pedałowania
+    TRIP_METRIC_COUNT
+};
+
+struct TripMetricInfo {
+    const char* name;   // Klucz w JSON
+    const char* unit;
+};
+
+class TripMetrics {
+public:
+    void add(TripMetric metric, float value, uint32_t nowMs) { stats[metric].add(value, nowMs); }
+    void pause(TripMetric metric) { stats[metric].pause(); }
+
+    const RunningStats<float>& get(TripMetric metric) const { return stats[metric]; }
+    float getAverage(TripMetric metric) const { return stats[metric].getTimeMean(); }
+    float getMax(TripMetric metric) const { return stats[metric].getMax(); }
+
+    void reset();
+
+    // Blok danych do rejestracji w magazynie ustawień
+    void* getData() { return stats; }
+    static uint16_t getDataSize() { return sizeof(stats); }
+
+    // "speed": {"unit", "avg", "max", "min", "stdDev", "samples", "durationS"}, ... - pola otwartego obiektu
+    void toJson(JsonWriter& json) const;
+
+    static const TripMetricInfo& getInfo(TripMetric metric);
+
+private:
+    RunningStats<float> stats[TRIP_METRIC_COUNT];
+};
+
+#endif // TRIP_METRICS_H
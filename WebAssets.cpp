@@ -0,0 +1,90 @@
+#include "WebAssets.h"
+#include <ArduinoJson.h>
+
+WebAssets::WebAssets() :
+    fs(nullptr),
+    count(0)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool WebAssets::begin(fs::FS& fs) {
+    this->fs = &fs;
+    count = 0;
+    resetStats();
+
+    File file = fs.open(WEB_ASSETS_MANIFEST, "r");
+    if (!file) {
+        DEBUG_ERROR("WWW: brak %s - uruchom tools/build_web.py", WEB_ASSETS_MANIFEST);
+        return false;
+    }
+
+    DynamicJsonDocument doc(2048);
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+        DEBUG_ERROR("WWW: blad %s: %s", WEB_ASSETS_MANIFEST, error.c_str());
+        return false;
+    }
+
+    for (JsonObjectConst item : doc["assets"].as<JsonArrayConst>()) {
+        if (count >= WEB_ASSETS_MAX) {
+            DEBUG_ERROR("WWW: wiecej niz %u plikow w %s", WEB_ASSETS_MAX, WEB_ASSETS_MANIFEST);
+            break;
+        }
+        Asset& asset = assets[count++];
+        strlcpy(asset.path, item["path"] | "", sizeof(asset.path));
+        strlcpy(asset.type, item["type"] | "application/octet-stream", sizeof(asset.type));
+        snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", (const char*)(item["etag"] | ""));
+        asset.size = item["size"] | 0;
+        asset.immutable = item["immutable"] | false;
+    }
+
+    DEBUG_INFO("WWW: %u plikow z %s", count, WEB_ASSETS_MANIFEST);
+    return count > 0;
+}
+
+int8_t WebAssets::find(const String& url) const {
+    const char* path = url == "/" ? "/index.html" : url.c_str();
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(assets[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+bool WebAssets::canHandle(AsyncWebServerRequest* request) {
+    return fs != nullptr && request->method() == HTTP_GET && find(request->url()) >= 0;
+}
+
+void WebAssets::handleRequest(AsyncWebServerRequest* request) {
+    int8_t index = find(request->url());
+    if (index < 0) {
+        request->send(404);
+        return;
+    }
+
+    const Asset& asset = assets[index];
+    const char* cacheControl = asset.immutable ? WEB_ASSETS_CACHE_IMMUTABLE : WEB_ASSETS_CACHE_REVALIDATE;
+    stats.requests++;
+
+    // Przeglądarka ma aktualną kopię - sam nagłówek
+    AsyncWebHeader* ifNoneMatch = request->getHeader("If-None-Match");
+    if (ifNoneMatch != nullptr && ifNoneMatch->value().indexOf(asset.etag) >= 0) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", asset.etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        stats.notModified++;
+        return;
+    }
+
+    // Tylko wersja .gz - przeglądarki bez gzip nie są obsługiwane
+    String gzPath = String(asset.path) + ".gz";
+    AsyncWebServerResponse* response = request->beginResponse(*fs, gzPath, asset.type);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", cacheControl);
+    response->addHeader("Vary", "Accept-Encoding");
+    request->send(response);
+    stats.bytesSent += asset.size;
+}
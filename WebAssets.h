@@ -0,0 +1,62 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+#include "DebugUtils.h"
+
+// Pliki interfejsu WWW przygotowane przez tools/build_web.py (web/ -> data/).
+//
+// Każdy plik leży na LittleFS jako <ścieżka>.gz i jest wysyłany bez rozpakowania
+// z Content-Encoding: gzip. /assets.json podaje typ MIME i ETag z treści pliku:
+// zapytanie z pasującym If-None-Match dostaje 304 bez treści. index.html ma
+// Cache-Control: no-cache (zawsze sprawdzany), pozostałe pliki są wskazywane
+// z ?v=<hash>, więc przeglądarka trzyma je bez pytania serwera.
+//
+// Bez /assets.json (nie uruchomiono build_web.py) begin() zwraca false,
+// a serwer wraca do zwykłego serveStatic.
+
+#define WEB_ASSETS_MANIFEST "/assets.json"
+#define WEB_ASSETS_MAX 12
+#define WEB_ASSETS_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define WEB_ASSETS_CACHE_REVALIDATE "no-cache"
+
+class WebAssets : public AsyncWebHandler {
+public:
+    struct Stats {
+        uint32_t requests;      // Zapytania o pliki interfejsu
+        uint32_t notModified;   // Odpowiedzi 304
+        uint32_t bytesSent;     // Wysłane bajty treści (skompresowane)
+    };
+
+    WebAssets();
+
+    // Wczytanie /assets.json; false gdy go nie ma lub jest błędny
+    bool begin(fs::FS& fs);
+
+    uint8_t getCount() const { return count; }
+    const Stats& getStats() const { return stats; }
+    void resetStats() { memset(&stats, 0, sizeof(stats)); }
+
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+
+private:
+    struct Asset {
+        char path[24];
+        char type[28];
+        char etag[20];          // Z cudzysłowami, jak w nagłówku
+        uint32_t size;
+        bool immutable;
+    };
+
+    fs::FS* fs;
+    Asset assets[WEB_ASSETS_MAX];
+    uint8_t count;
+    Stats stats;
+
+    int8_t find(const String& url) const;
+};
+
+#endif // WEB_ASSETS_H
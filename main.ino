@@ -59,18 +59,79 @@
 #include <LittleFS.h>           // System plików dla ESP32
 #include <ArduinoJson.h>        // Biblioteka do obsługi formatu JSON
 #include <map>                  // Biblioteka do obsługi map (kontenerów)
+#include <memory>               // Wskaźniki współdzielone (odpowiedzi HTTP wysyłane porcjami)
 
 // --- Biblioteki systemowe ESP32 ---
 #include <esp_partition.h>    // Biblioteka do obsługi partycji ESP32
-#include <Preferences.h>      // Biblioteka do stałej pamięci ESP32
 #include <nvs_flash.h>
 
 // --- Komunikaty ---
 #include "DebugUtils.h"
+#include "DebugLog.h"
 
 // --- Oświetlenie ---
 #include "LightManager.h"
 
+// --- Diagnostyka pętli ---
+#include "LoopMonitor.h"
+#include "Profiler.h"
+#include "SpscRing.h"
+
+// --- Sterownik silnika ---
+#include "KtController.h"
+#include "RideComputer.h"
+
+// --- Wyświetlacz ---
+#include "I2cBus.h"
+#include "DisplayRenderer.h"
+
+// --- Harmonogram zadań ---
+#include "TaskScheduler.h"
+
+// --- Wymiana danych między rdzeniami ---
+#include "CoreSnapshots.h"
+
+// --- Rejestrator przejazdów ---
+#include "RideRecorder.h"
+
+// --- Licznik całkowity ---
+#include "OdometerManager.h"
+
+// --- Ustawienia ---
+#include "SettingsStore.h"
+#include "SleepSnapshot.h"
+
+// --- Telemetria WebSocket ---
+#include "TelemetryChannel.h"
+
+// --- Pliki interfejsu WWW ---
+#include "WebAssets.h"
+
+// --- Odpowiedzi JSON REST API ---
+#include "ApiResponse.h"
+
+// --- BMS JBD ---
+#include "JbdBms.h"
+
+// --- Filtr impulsów kadencji ---
+#include "PulseRateFilter.h"
+
+// --- Czujniki ciśnienia TPMS ---
+#include "TpmsReceiver.h"
+#include "TpmsScanScheduler.h"
+
+// --- Zużycie energii i zasięg ---
+#include "EnergyEstimator.h"
+
+// --- Statystyki przejazdu ---
+#include "TripMetrics.h"
+
+// --- Czujniki temperatury ---
+#include "TemperatureManager.h"
+
+// --- Przyciski ---
+#include "ButtonManager.h"
+
 /********************************************************************
  * DEFINICJE I STAŁE GLOBALNE
  ********************************************************************/
@@ -78,9 +139,11 @@
 // Wersja oprogramowania
 const char* VERSION = "11.6.25-B";
 
-// Nazwy plików konfiguracyjnych
-const char* CONFIG_FILE = "/display_config.json";
-const char* LIGHT_CONFIG_FILE = "/light_config.json";
+// Stare pliki konfiguracyjne JSON - tylko do migracji do /settings.bin
+const char* const LEGACY_SETTINGS_FILES[] = {
+    "/display_config.json", "/general_config.json", "/auto_off.json", "/bluetooth_config.json",
+    "/light_config.json", "/lights.json", "/config.json", "/tpms_config.json"
+};
 
 // Definicje pinów
 // przyciski
@@ -96,7 +159,7 @@ const char* LIGHT_CONFIG_FILE = "/light_config.json";
 // czujniki temperatury
 #define TEMP_AIR_PIN 15        // temperatutra powietrza (DS18B20)
 #define TEMP_CONTROLLER_PIN 4  // temperatura sterownika (DS18B20)
-//#define TEMP_MOTOR_PIN         // temperatura silnika (NTC10k)
+#define TEMP_MOTOR_PIN 34      // temperatura silnika (NTC10k, wejście ADC1)
 // kadencja
 #define CADENCE_SENSOR_PIN 27
 // hamulec
@@ -121,16 +184,13 @@ const char* LIGHT_CONFIG_FILE = "/light_config.json";
 #define KT_PARAM_L 3
 
 // Stałe czasowe
-const unsigned long DEBOUNCE_DELAY = 25;
 const unsigned long BUTTON_DELAY = 200;
 const unsigned long LONG_PRESS_TIME = 1000;
 const unsigned long DOUBLE_CLICK_TIME = 300;
 const unsigned long GOODBYE_DELAY = 3000;
 const unsigned long SET_LONG_PRESS = 2000;
-const unsigned long TEMP_REQUEST_INTERVAL = 1000;
-const unsigned long DS18B20_CONVERSION_DELAY_MS = 750;
-
-#define TEMP_ERROR -999.0
+const unsigned long COMBO_HOLD_TIME = 500;    // Kombinacje dwóch przycisków
+const unsigned long CONFIG_EXIT_PRESS = 50;   // Wyjście z trybu konfiguracji przez SET
 
 /********************************************************************
  * STRUKTURY I TYPY WYLICZENIOWE
@@ -175,16 +235,23 @@ struct WiFiSettings {
 };
 
 struct ControllerSettings {
-    String type;         // "kt-lcd" lub "s866"
+    char type[8];        // "kt-lcd" lub "s866"
     int ktParams[23];    // P1-P5, C1-C15, L1-L3
     int s866Params[20];  // P1-P20
+
+    ControllerSettings() : ktParams(), s866Params() {
+        strcpy(type, "kt-lcd");
+    }
 };
 
 struct GeneralSettings {
     uint8_t wheelSize;  // Wielkość koła w calach (lub 0 dla 700C)
+    uint8_t rideSampleRate;  // Częstotliwość zapisu przejazdu w Hz (1-10)
+    uint8_t autoOffTime;     // Czas do automatycznego wyłączenia w minutach (0 = funkcja wyłączona)
+    uint8_t cadencePulses;   // Liczba impulsów czujnika kadencji na obrót korby (1-36)
     
     // Konstruktor z wartościami domyślnymi
-    GeneralSettings() : wheelSize(26) {} // Domyślnie 26 cali
+    GeneralSettings() : wheelSize(26), rideSampleRate(2), autoOffTime(0), cadencePulses(1) {} // Domyślnie 26 cali, zapis 2 Hz
 };
 
 struct BluetoothConfig {
@@ -201,19 +268,6 @@ struct BluetoothConfig {
     }
 };
 
-struct BmsData {
-    float voltage;            // Napięcie całkowite [V]
-    float current;            // Prąd [A]
-    float remainingCapacity;  // Pozostała pojemność [Ah]
-    float totalCapacity;      // Całkowita pojemność [Ah]
-    uint8_t soc;              // Stan naładowania [%]
-    uint8_t cycles;           // Liczba cykli
-    float cellVoltages[16];   // Napięcia cel [V]
-    float temperatures[4];    // Temperatury [°C]
-    bool charging;            // Status ładowania
-    bool discharging;         // Status rozładowania
-};
-
 struct TpmsData {
     float pressure;       // Ciśnienie w bar
     float temperature;    // Temperatura w °C
@@ -225,98 +279,6 @@ struct TpmsData {
     char address[20];     // Adres czujnika jako string
 };
 
-// Klasa obsługująca licznik kilometrów
-class OdometerManager {
-private:
-    const char* filename = "/odometer.json";
-    float currentTotal = 0;
-
-    void saveToFile() {
-        // Upewnij się, że system plików jest zamontowany
-        if (!LittleFS.begin(false)) {
-            DEBUG_ERROR("Blad montowania LittleFS przed zapisem licznika");
-            return;
-        }
-
-        File file = LittleFS.open(filename, "w");
-        if (!file) {
-            DEBUG_ERROR("Blad otwarcia pliku licznika do zapisu");
-            return;
-        }
-
-        StaticJsonDocument<128> doc;
-        doc["total"] = currentTotal;
-        
-        if (serializeJson(doc, file) == 0) {
-            DEBUG_ERROR("Blad zapisu do pliku licznika");
-        } else {
-            DEBUG_INFO("Zapisano licznik: %.2f", currentTotal);
-        }
-        
-        file.close();
-    }
-
-    void loadFromFile() {
-        DEBUG_INFO("Wczytywanie licznika z pliku...");
-
-        File file = LittleFS.open(filename, "r");
-        if (!file) {
-            DEBUG_INFO("Brak pliku licznika - tworze nowy");
-            currentTotal = 0;
-            saveToFile();
-            return;
-        }
-
-        StaticJsonDocument<128> doc;
-        DeserializationError error = deserializeJson(doc, file);
-        
-        if (!error) {
-            currentTotal = doc["total"] | 0.0f;
-            DEBUG_INFO("Wczytano licznik: %.2f", currentTotal);
-        } else {
-            DEBUG_ERROR("Blad odczytu pliku licznika");
-            currentTotal = 0;
-        }
-        
-        file.close();
-    }
-
-public:
-    OdometerManager() {
-        loadFromFile();
-    }
-
-    float getRawTotal() const {
-        return currentTotal;
-    }
-
-    bool setInitialValue(float value) {
-        if (value < 0) {
-            DEBUG_ERROR("Bledna wartosc poczatkowa (ujemna)");
-            return false;
-        }
-        
-        DEBUG_INFO("Ustawianie poczatkowej wartosci licznika: %.2f", value);
-
-        currentTotal = value;
-        saveToFile();
-        return true;
-    }
-
-    void updateTotal(float newValue) {
-        if (newValue > currentTotal) {
-            //DEBUG_INFO("Aktualizacja licznika z %.2f na %.2f", currentTotal, newValue);
-
-            currentTotal = newValue;
-            saveToFile();
-        }
-    }
-
-    bool isValid() const {
-        return true; // Zawsze zwraca true, bo nie ma już inicjalizacji Preferences
-    }
-};
-
 /********************************************************************
  * TYPY WYLICZENIOWE
  ********************************************************************/
@@ -386,15 +348,24 @@ enum PressureSubScreen {
     PRESSURE_SUB_COUNT  // Liczba ekranów
 };
 
+// Tekst dolnej części ekranu (wartość, jednostka, opis)
+struct MainDisplayText {
+    char value[16];
+    const char* unit;
+    const char* desc;
+};
+
 /********************************************************************
  * ZMIENNE GLOBALNE
  ********************************************************************/
 
 // Obiekty główne
 OdometerManager odometer;
-Preferences preferences;
+SettingsStore settingsStore;
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
+TelemetryChannel telemetry(ws);
+WebAssets webAssets;  // Pliki z tools/build_web.py: gzip, ETag, 304
 
 // Zmienne stanu systemu
 bool configModeActive = false;
@@ -411,7 +382,6 @@ bool inSubScreen = false;
 uint8_t displayBrightness = 16;  // Wartość od 0 do 255 (jasność wyświetlacza)
 
 // Zmienne dla automatycznego wyłączania
-int autoOffTime = 0;            // Czas do automatycznego wyłączenia w minutach (0 = funkcja wyłączona)
 unsigned long lastActivityTime = 0;  // Czas ostatniej aktywności
 bool autoOffEnabled = false;    // Czy funkcja auto-off jest włączona
 bool webConfigActive = false;
@@ -427,31 +397,24 @@ float battery_voltage;
 float battery_current;
 float battery_capacity_wh;
 float battery_capacity_ah;
-float speed_sum = 0;
-int speed_count = 0;
 int battery_capacity_percent;
 int power_w;
-int power_avg_w;
-int power_max_w;
-float speed_avg_kmh;
-float speed_max_kmh;
 // kadencja
-#define CADENCE_SAMPLES_WINDOW 4
 #define CADENCE_OPTIMAL_MIN 75
 #define CADENCE_OPTIMAL_MAX 95
 #define CADENCE_HYSTERESIS 2
 enum CadenceArrow { ARROW_NONE, ARROW_UP, ARROW_DOWN };
 CadenceArrow cadence_arrow_state = ARROW_NONE;
-volatile unsigned long cadence_pulse_times[CADENCE_SAMPLES_WINDOW] = {0};
-volatile unsigned long cadence_last_pulse_time = 0;
+#define CADENCE_MAX_PULSES_PER_REV 36
+#define CADENCE_RING_SIZE 64         // Zapas na >100 ms przy 36 impulsach i 200 RPM
+#define CADENCE_TIMEOUT_US 2000000UL // Brak impulsów przez 2s = brak pedałowania
+SpscRing<uint32_t, CADENCE_RING_SIZE> cadencePulses;  // Znaczniki micros() z przerwania
+PulseRateFilter cadenceFilter(CADENCE_TIMEOUT_US);
+volatile uint32_t cadence_last_isr_us = 0;            // Używane tylko w przerwaniu
+volatile uint32_t cadence_debounce_us = 150000;       // Wyliczane z liczby impulsów na obrót
+unsigned long cadence_last_pulse_time = 0;            // Ostatni impuls [ms], aktualizowane w loop()
 int cadence_rpm = 0;
-int cadence_avg_rpm = 0;
-int cadence_max_rpm = 0;
-uint8_t cadence_pulses_per_revolution = 1;  // Zakres 1-24
-uint32_t cadence_sum = 0;
-uint32_t cadence_samples = 0;
-unsigned long last_avg_max_update = 0;
-const unsigned long AVG_MAX_UPDATE_INTERVAL = 5000; // 5s
+uint8_t cadence_pulses_per_revolution = 1;  // Zakres 1-36
 const unsigned long cadenceArrowTimeout = 1000; // czas wyświetlania strzałek w milisekundach (1 sekunda)
 
 // Zmienne dla czujników ciśnienia kół
@@ -461,32 +424,24 @@ float pressure_voltage;       // napięcie przedniego czujnika
 float pressure_rear_voltage;  // napięcie tylnego czujnika
 float pressure_temp;          // temperatura przedniego czujnika
 float pressure_rear_temp;     // temperatura tylnego czujnika
+bool pressure_active;         // przedni czujnik nadaje
+bool pressure_rear_active;    // tylny czujnik nadaje
+// Zmienne pressure_* to kopie z migawki usług (rdzeń 0) - zapisuje je tylko pętla główna
 
-TpmsData frontTpms;
+
+TpmsData frontTpms;  // Stan czujników po stronie usług (zadanie TPMS, rdzeń 0)
 TpmsData rearTpms;
-bool tpmsScanning = false;
-unsigned long lastTpmsScanTime = 0;
-const unsigned long TPMS_SCAN_INTERVAL = 5000; // 5 sekund
+volatile bool tpmsScanning = false;  // Zerowane też przez stos BLE (onTpmsScanComplete)
+bool tpmsAddressesChanged = true;  // Adresy czujników do ponownego wczytania przed skanem
+const unsigned long TPMS_PARKED_AFTER_MS = 120000; // Postój po 2 minutach bez ruchu
 const char* FRONT_TPMS_ADDRESS = "XX:XX:XX:XX:XX:XX"; // Adres przedniej opony
 const char* REAR_TPMS_ADDRESS = "YY:YY:YY:YY:YY:YY";  // Adres tylnej opony
 
 // Zmienne dla czujnika temperatury
-float currentTemp = DEVICE_DISCONNECTED_C;
-bool conversionRequested = false;
-unsigned long lastTempRequest = 0;
-unsigned long ds18b20RequestTime;
-
-// Zmienne dla przycisków
-unsigned long lastDebounceTime = 0;
-unsigned long upPressStartTime = 0;
-unsigned long downPressStartTime = 0;
-unsigned long setPressStartTime = 0;
+float currentTemp = TEMP_INVALID;
+
+// Komunikat powitalny/pożegnalny na ekranie
 unsigned long messageStartTime = 0;
-bool upLongPressExecuted = false;
-bool downLongPressExecuted = false;
-bool setLongPressExecuted = false;
-unsigned long lastSpecialComboTime = 0; // Czas ostatniej obsługi specjalnej kombinacji
-const unsigned long SPECIAL_COMBO_LOCKOUT = 500; // Czas blokady po kombinacji (500ms)
 
 // Zmienne konfiguracyjne
 int assistLevel = 3;
@@ -505,10 +460,29 @@ const uint8_t* czcionka_mala = u8g2_font_profont11_mf;      // opis ekranów
 const uint8_t* czcionka_srednia = u8g2_font_pxplusibmvga9_mf; // górna belka
 const uint8_t* czcionka_duza = u8g2_font_fub20_tr;
 
+// Limit odświeżania ekranu głównego
+#define DISPLAY_MAX_FPS 20
+
+// Bufor nadawczy UART dla logów (DebugLog::drain nie czeka na UART)
+#define DEBUG_LOG_TX_BUFFER 1024
+
+// Zadanie zapisu OLED obok pętli (rdzeń 1), nad nią priorytetem - czeka głównie na I2C
+#define DISPLAY_FLUSH_CORE 1
+#define DISPLAY_FLUSH_PRIORITY 2
+
+// Odczyt RTC przez I2C raz na sekundę (rdzeń usług), między odczytami millis()
+#define RTC_READ_INTERVAL_MS 1000
+
+// Wybudzenie z kopii w pamięci RTC: ekran główny od razu, bez animacji powitania
+#define RESUME_SKIP_WELCOME 1
+
+// Odłożony start (pliki, licznik, NVS, BLE) po pierwszej klatce ekranu,
+// a gdy ekran nie ruszy - najpóźniej po tylu ms od końca setup()
+#define DEFERRED_START_TIMEOUT_MS 3000
+
 // Stałe BMS
 const uint8_t BMS_BASIC_INFO[] = {0xDD, 0xA5, 0x03, 0x00, 0xFF, 0xFD, 0x77};
 const uint8_t BMS_CELL_INFO[] = {0xDD, 0xA5, 0x04, 0x00, 0xFF, 0xFC, 0x77};
-const uint8_t BMS_TEMP_INFO[] = {0xDD, 0xA5, 0x08, 0x00, 0xFF, 0xF8, 0x77};
 
 // Instancje obiektów globalnych
 U8G2_SSD1306_128X64_NONAME_F_HW_I2C display(U8G2_R0, U8X8_PIN_NONE);
@@ -517,6 +491,7 @@ OneWire oneWireAir(TEMP_AIR_PIN);
 OneWire oneWireController(TEMP_CONTROLLER_PIN);
 DallasTemperature sensorsAir(&oneWireAir);
 DallasTemperature sensorsController(&oneWireController);
+TemperatureManager temperatures(sensorsAir, sensorsController, TEMP_MOTOR_PIN);
 
 // Obiekty BLE
 BLEClient* bleClient;
@@ -533,8 +508,78 @@ BacklightSettings backlightSettings;
 WiFiSettings wifiSettings;
 GeneralSettings generalSettings;
 BluetoothConfig bluetoothConfig;
-BmsData bmsData;
+JbdBms bms;  // Zapis z zadania BLE, odczyt przez bms.read()
+TpmsReceiver tpmsReceiver;  // Callback skanowania - jeden obiekt na cały czas działania
+TpmsScanScheduler tpmsScheduler;
+EnergyEstimator energy;  // Stan w magazynie ustawień (sekcja SETTINGS_ENERGY)
+TripMetrics tripMetrics; // Średnie i maksima przejazdu (sekcja SETTINGS_TRIP)
 LightManager lightManager(FrontPin, FrontDayPin, RearPin);
+LoopMonitor loopMonitor;
+KtController ktController;
+RideComputer rideComputer(ktController, bms, odometer, energy, tripMetrics);
+DisplayRenderer displayRenderer(display);
+TaskScheduler scheduler;         // Rdzeń 1 (loop): pomiary, przyciski, światła, wyświetlacz
+TaskScheduler serviceScheduler;  // Rdzeń 0 (zadanie usług): WWW, BLE, zapis plików
+RideRecorder rideRecorder;
+int8_t rideSampleTaskId = -1;    // Zadanie w serviceScheduler
+
+// Zadania rdzenia usług korzystające z plików i BLE - włączane przez deferredStartTask()
+#define DEFERRED_TASKS_MAX 6
+int8_t deferredTaskIds[DEFERRED_TASKS_MAX];
+uint8_t deferredTaskCount = 0;
+int8_t deferredStartTaskId = -1;
+
+// Etapy startu
+bool settingsReady = false;             // Ustawienia w RAM (z pliku albo z kopii RTC)
+volatile bool storageReady = false;     // LittleFS zamontowany, licznik i rejestrator po begin()
+volatile bool firstFrameShown = false;  // Pierwsza klatka ekranu głównego (rdzeń 1)
+unsigned long setupDoneMs = 0;
+
+// Czasy startu od uruchomienia programu [us] (esp_timer) - log i /api/perf
+struct BootTiming {
+    bool resumed;            // Ustawienia i stan z kopii RTC
+    uint32_t restoreUs;      // Samo odtworzenie kopii RTC
+    uint32_t settingsUs;     // Ustawienia gotowe
+    uint32_t holdUs;         // Czekanie na przytrzymanie SET (czas rowerzysty, nie systemu)
+    uint32_t setupUs;        // Koniec setup()
+    uint32_t firstFrameUs;   // Pierwsza klatka ekranu głównego
+    uint32_t deferredUs;     // Koniec odłożonego startu
+};
+BootTiming bootTiming = {};
+
+// Zadanie usług przypięte do rdzenia 0 (WiFi i BLE działają na tym samym rdzeniu)
+#define SERVICE_TASK_CORE 0
+#define SERVICE_TASK_STACK 8192
+#define SERVICE_TASK_PRIORITY 1
+#define SERVICE_STOP_TIMEOUT_MS 1000
+TaskHandle_t serviceTaskHandle = nullptr;
+volatile bool serviceStopRequested = false;
+volatile bool serviceStopped = false;
+
+// Ostatni odczyt RTC po stronie usług (pisze clockTask, rdzeń 0)
+uint32_t rtcEpoch = 0;
+uint32_t rtcStampMs = 0;
+
+// Migawki między rdzeniami - jeden pisarz każda
+Seqlock<RideSnapshot> rideSnapshot;        // Pisze rdzeń 1
+Seqlock<ServiceSnapshot> serviceSnapshot;  // Pisze rdzeń 0
+Seqlock<EnergyState> energySnapshot;       // Pisze rdzeń 1 - kopie dla zapisu ustawień i WWW
+Seqlock<TripMetrics> tripSnapshot;         // Pisze rdzeń 1
+
+// Odczyt migawek przez kopię lokalną - miejsce w kopii magazynu nie musi być wyrównane
+static bool readEnergySnapshot(void* out) {
+    EnergyState state;
+    if (!energySnapshot.read(state)) return false;
+    memcpy(out, &state, sizeof(state));
+    return true;
+}
+
+static bool readTripSnapshot(void* out) {
+    TripMetrics trip;
+    if (!tripSnapshot.read(trip)) return false;
+    memcpy(out, trip.getData(), TripMetrics::getDataSize());
+    return true;
+}
 
 /********************************************************************
  * KLASY POMOCNICZE
@@ -574,57 +619,6 @@ class TimeoutHandler {
       }
 };
 
-// Klasa obsługująca czujnik temperatury
-class TemperatureSensor {
-    private:
-        static constexpr float INVALID_TEMP = -999.0f;
-        static constexpr float MIN_VALID_TEMP = -50.0f;
-        static constexpr float MAX_VALID_TEMP = 100.0f;
-        bool conversionRequested = false;
-        unsigned long lastRequestTime = 0;
-        DallasTemperature* airSensor;
-        DallasTemperature* controllerSensor;
-
-    public:
-        TemperatureSensor(DallasTemperature* air, DallasTemperature* controller) 
-            : airSensor(air), controllerSensor(controller) {}
-
-        void requestTemperature() {
-            if (millis() - lastRequestTime >= TEMP_REQUEST_INTERVAL) {
-                airSensor->requestTemperatures();
-                controllerSensor->requestTemperatures();
-                conversionRequested = true;
-                lastRequestTime = millis();
-            }
-        }
-
-        bool isValidTemperature(float temp) {
-            return temp >= MIN_VALID_TEMP && temp <= MAX_VALID_TEMP;
-        }
-
-        float readAirTemperature() {
-            if (!conversionRequested) return INVALID_TEMP;
-
-            if (millis() - lastRequestTime < DS18B20_CONVERSION_DELAY_MS) {
-                return INVALID_TEMP;  // Konwersja jeszcze trwa
-            }
-
-            float temp = airSensor->getTempCByIndex(0);
-            return isValidTemperature(temp) ? temp : INVALID_TEMP;
-        }
-
-        float readControllerTemperature() {
-            if (!conversionRequested) return INVALID_TEMP;
-
-            if (millis() - lastRequestTime < DS18B20_CONVERSION_DELAY_MS) {
-                return INVALID_TEMP;  // Konwersja jeszcze trwa
-            }
-
-            float temp = controllerSensor->getTempCByIndex(0);
-            return isValidTemperature(temp) ? temp : INVALID_TEMP;
-        }
-};
-
 
 
 /********************************************************************
@@ -636,7 +630,6 @@ void setLights();
 void saveLightSettings();
 void loadLightSettings();
 void applyBacklightSettings();
-void printLightConfigFile();
 
 // --- Deklaracje funkcji obsługi ekranu ---
 void drawHorizontalLine();
@@ -656,8 +649,6 @@ void showWelcomeMessage();
 void clearTripData();
 
 // --- Deklaracje funkcji obsługi przycisków ---
-void handleButtons();
-void checkConfigMode();
 void activateConfigMode();
 void deactivateConfigMode();
 void toggleLegalMode();
@@ -668,36 +659,27 @@ int getSubScreenCount(MainScreen screen);
 void resetTripData();
 void setCadencePulsesPerRevolution(uint8_t pulses);
 void goToSleep();
-bool isValidTemperature(float temp);
-void handleTemperature();
+void stopServiceTask();
+void publishPersistSnapshots();
+void startStorage();
+void saveSleepSnapshot();
+void markFirstFrame();
 void saveLightMode();
 void loadLightMode();
 void updateActivityTime();
 
 // --- Deklaracje funkcji konfiguracyjnych ---
-void loadSettings();
-void saveSettings();
 int getParamIndex(const String& param);
 void updateControllerParam(const String& param, int value);
 const char* getLightModeString(LightSettings::LightMode mode);
 void setupWebServer();
 bool initLittleFS();
 void listFiles();
-bool loadConfig();
 void initializeDefaultSettings();
 void setDisplayBrightness(uint8_t brightness);
-void saveBacklightSettingsToFile();
-void loadBacklightSettingsFromFile();
-void saveGeneralSettingsToFile();
-void saveBluetoothConfigToFile();
-void loadBluetoothConfigFromFile();
-void loadGeneralSettingsFromFile();
-void saveAutoOffSettings(); // Dodaj te dwie linijki
-void loadAutoOffSettings(); //
 
 // --- Deklaracje funkcji TPMS ---
-void updateTpmsData(const char* address, uint8_t sensorNumber, float pressure, float temperature, uint8_t batteryPercent, bool alarm);
-void saveTpmsAddresses();
+void updateTpmsData(const TpmsReading& reading);
 void startTpmsScan();
 void stopTpmsScan();
 void loadTpmsAddresses();
@@ -708,25 +690,51 @@ void requestBmsData(const uint8_t* command, size_t length);
 void updateBmsData();
 void connectToBms();       
 
-float getOdometerValue();
-bool saveOdometerValue(float value);
 
 // --- UART kontroler
 
+// Przerwanie tylko zapisuje znacznik czasu - obliczenia w updateCadence()
 void IRAM_ATTR cadence_ISR() {
-    unsigned long now = millis();
-    unsigned long minDelay = max(8, 200 / cadence_pulses_per_revolution); // Minimum 8ms
-    
-    if (now - cadence_last_pulse_time > minDelay) {
-        for (int i = CADENCE_SAMPLES_WINDOW - 1; i > 0; i--) {
-            cadence_pulse_times[i] = cadence_pulse_times[i - 1];
-        }
-        cadence_pulse_times[0] = now;
-        cadence_last_pulse_time = now;
+    uint32_t now = micros();
+
+    if (now - cadence_last_isr_us >= cadence_debounce_us) {
+        cadence_last_isr_us = now;
+        cadencePulses.push(now);
+    }
+}
+
+// Odstęp antyodbiciowy: połowa okresu impulsu przy 200 RPM
+void updateCadenceDebounce() {
+    cadence_debounce_us = 150000UL / cadence_pulses_per_revolution;
+}
+
+// Odbiór impulsów z przerwania i obliczenie kadencji
+void updateCadence() {
+    uint32_t stamp;
+    bool gotPulse = false;
+    while (cadencePulses.pop(stamp)) {
+        cadenceFilter.addPulse(stamp);
+        gotPulse = true;
+    }
+
+    uint32_t nowUs = micros();
 
+    if (gotPulse) {
+        cadence_last_pulse_time = millis() - (nowUs - cadenceFilter.getLastPulseUs()) / 1000;
         // Resetuj timer aktywności przy wykryciu pedałowania
         updateActivityTime();
     }
+
+    // Strzałki kadencji wyznacza updateCadenceLogic()
+    cadenceFilter.update(nowUs);
+    cadence_rpm = cadenceFilter.getRpm();
+
+    // Średnia kadencji tylko z czasu pedałowania
+    if (cadenceFilter.isActive()) {
+        tripMetrics.add(TRIP_CADENCE, cadenceFilter.getSmoothedMilliRpm() / 1000.0f, millis());
+    } else {
+        tripMetrics.pause(TRIP_CADENCE);
+    }
 }
 
 // Funkcja wysyłająca komendę włączenia/wyłączenia świateł do sterownika KT
@@ -745,150 +753,36 @@ void sendLightCommandToKT(bool lightsOn) {
     }
 }
 
-// --- Funkcje BLE ---
-
-// callback dla BLE
-void notificationCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
-    if (length < 2) return;  // Sprawdzenie minimalnej długości pakietu
-
-    switch (pData[1]) {  // Sprawdź typ pakietu
-        case 0x03:  // Basic info
-            if (length >= 34) {
-                // Napięcie całkowite (0.1V)
-                bmsData.voltage = (float)((pData[4] << 8) | pData[5]) / 10.0;
-                
-                // Prąd (0.1A, wartość ze znakiem)
-                int16_t current = (pData[6] << 8) | pData[7];
-                bmsData.current = (float)current / 10.0;
-                
-                // Pozostała pojemność (0.1Ah)
-                bmsData.remainingCapacity = (float)((pData[8] << 8) | pData[9]) / 10.0;
-                
-                // SOC (%) - dodane zabezpieczenie przed indeksem out-of-bounds
-                if (length > 23) {
-                    bmsData.soc = pData[23];
-                
-                    // Status ładowania/rozładowania - dodane zabezpieczenie
-                    if (length > 22) {
-                        uint8_t status = pData[22];
-                        bmsData.charging = (status & 0x01);
-                        bmsData.discharging = (status & 0x02);
-                    }
-                }
-            }
-            break;
+// Obwód koła w metrach na podstawie ustawionego rozmiaru
+float getWheelCircumference() {
+    if (generalSettings.wheelSize == 0) {
+        return 2.136f;  // 700C
+    }
+    return generalSettings.wheelSize * 0.0254f * PI;
+}
 
-        case 0x04:  // Cell info
-            if (length >= 34) {  // Sprawdź czy mamy kompletny pakiet
-                const int maxCells = std::min(16, (int)((length - 4) / 2));
-                for (int i = 0; i < maxCells; i++) {
-                    bmsData.cellVoltages[i] = (float)((pData[4 + i*2] << 8) | pData[5 + i*2]) / 1000.0;
-                }
-            }
-            break;
+// Odbiór ramek ze sterownika - prędkość, moc i dystans liczy RideComputer
+void updateControllerData() {
+    bool wasActive = rideComputer.isLinkActive();
+    if (!rideComputer.update(Serial2, getWheelCircumference()) && rideComputer.isLinkActive() == wasActive) {
+        return;
+    }
 
-        case 0x08:  // Temperature info
-            if (length >= 12) {
-                const int maxTemps = std::min(4, (int)((length - 4) / 2));
-                for (int i = 0; i < maxTemps; i++) {
-                    // Konwersja z K na °C
-                    int16_t temp = ((pData[4 + i*2] << 8) | pData[5 + i*2]) - 2731;
-                    bmsData.temperatures[i] = (float)temp / 10.0;
-                }
-            }
-            break;
+    speed_kmh = rideComputer.getSpeedKmh();
+    battery_current = rideComputer.getBatteryCurrent();
+    power_w = rideComputer.getPowerW();
+    distance_km = rideComputer.getDistanceKm();
+    if (rideComputer.getBatteryVoltage() > 0) {
+        battery_voltage = rideComputer.getBatteryVoltage();
     }
 }
 
-// Dodaj po callbacku dla BMS
-class TpmsAdvertisedDeviceCallbacks: public BLEAdvertisedDeviceCallbacks {
-    void onResult(BLEAdvertisedDevice advertisedDevice) {
-        // Jeśli TPMS nie jest włączone, nie rób nic
-        if (!bluetoothConfig.tpmsEnabled) {
-            return;
-        }
-        
-        // Pobierz adres urządzenia
-        String deviceAddress = advertisedDevice.getAddress().toString().c_str();
-        
-        // Sprawdź czy to jeden z naszych czujników
-        bool isFrontSensor = (strcmp(deviceAddress.c_str(), bluetoothConfig.frontTpmsMac) == 0);
-        bool isRearSensor = (strcmp(deviceAddress.c_str(), bluetoothConfig.rearTpmsMac) == 0);
-        
-        // Jeśli to nie jest żaden z naszych czujników, ignorujemy
-        if (!isFrontSensor && !isRearSensor) {
-            return;
-        }
-        
-        if (advertisedDevice.haveManufacturerData()) {
-            // Tutaj jest problem - zamienimy na użycie String zamiast std::string
-            String manufacturerData = advertisedDevice.getManufacturerData();
-            
-            // Sprawdź czy dane mają właściwy format (przynajmniej 18 bajtów)
-            if (manufacturerData.length() >= 18) {
-                // Sprawdź czy pierwsze dwa bajty to 0001 (ID producenta)
-                uint8_t id1 = manufacturerData[0];
-                uint8_t id2 = manufacturerData[1];
-                
-                if (id1 == 0x00 && id2 == 0x01) {
-                    // Czytamy numer czujnika z trzeciego bajtu
-                    uint8_t sensorNumber = manufacturerData[2];
-                    
-                    // Adres czujnika (bajty 5-7)
-                    char sensorAddressStr[20] = "";
-                    for (int i = 5; i <= 7; i++) {
-                        char hexStr[3];
-                        sprintf(hexStr, "%02X", (uint8_t)manufacturerData[i]);
-                        strcat(sensorAddressStr, hexStr);
-                    }
-                    
-                    // Obliczamy ciśnienie (bajty 8-11)
-                    uint32_t pressureValue = 
-                        (uint8_t)manufacturerData[8] | 
-                        ((uint8_t)manufacturerData[9] << 8) | 
-                        ((uint8_t)manufacturerData[10] << 16) | 
-                        ((uint8_t)manufacturerData[11] << 24);
-                    float pressureBar = pressureValue / 100000.0; // Konwersja na bar
-                    
-                    // Obliczamy temperaturę (bajty 12-15)
-                    uint32_t tempValue = 
-                        (uint8_t)manufacturerData[12] | 
-                        ((uint8_t)manufacturerData[13] << 8) | 
-                        ((uint8_t)manufacturerData[14] << 16) | 
-                        ((uint8_t)manufacturerData[15] << 24);
-                    float temperatureC = tempValue / 100.0; // Konwersja na stopnie Celsjusza
-                    
-                    // Poziom baterii (bajt 16)
-                    uint8_t batteryPercentage = (uint8_t)manufacturerData[16];
-                    
-                    // Status alarmu (bajt 17)
-                    bool alarmActive = ((uint8_t)manufacturerData[17] != 0);
-                    
-                    // Utwórz pełny adres czujnika łącząc prefiks (bajty 3-4) i adres (bajty 5-7)
-                    char fullAddress[20] = "";
-                    for (int i = 3; i <= 7; i++) {
-                        char hexStr[3];
-                        sprintf(hexStr, "%02X", (uint8_t)manufacturerData[i]);
-                        strcat(fullAddress, hexStr);
-                        if (i < 7 && i != 4) strcat(fullAddress, ":");
-                    }
-                    
-                    // Dodaj informację o rodzaju czujnika
-                    if (isFrontSensor) {
-                        DEBUG_BLE("Znaleziono dane z przedniego czujnika");
-                        sensorNumber = 0x80; // Wymuszamy przedni czujnik
-                    } else if (isRearSensor) {
-                        DEBUG_BLE("Znaleziono dane z tylnego czujnika");
-                        sensorNumber = 0x81; // Wymuszamy tylny czujnik
-                    }
-                    
-                    // Aktualizuj dane
-                    updateTpmsData(fullAddress, sensorNumber, pressureBar, temperatureC, batteryPercentage, alarmActive);
-                }
-            }
-        }
-    }
-};
+// --- Funkcje BLE ---
+
+// callback dla BLE - odpowiedź BMS może być podzielona na wiele powiadomień
+void notificationCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
+    bms.feed(pData, length);
+}
 
 // wysyłanie zapytania do BMS
 void requestBmsData(const uint8_t* command, size_t length) {
@@ -916,11 +810,8 @@ void updateBmsData() {
                 requestState = 1;
                 break;
             case 1:
+                // Temperatury przychodzą w odpowiedzi 0x03
                 requestBmsData(BMS_CELL_INFO, sizeof(BMS_CELL_INFO));
-                requestState = 2;
-                break;
-            case 2:
-                requestBmsData(BMS_TEMP_INFO, sizeof(BMS_TEMP_INFO));
                 requestState = 0;
                 lastBmsUpdate = currentTime; // Reset głównego timera tylko po pełnej sekwencji
                 break;
@@ -936,6 +827,7 @@ void connectToBms() {
 
         if (bleClient->connect(bmsMacAddress)) {
             DEBUG_BLE("Połączono z BMS");
+            bms.reset();
 
             bleService = bleClient->getService("0000ff00-0000-1000-8000-00805f9b34fb");
         
@@ -978,133 +870,81 @@ void connectToBms() {
     }
 }
 
-void saveTpmsAddresses() {
-
-    if (!LittleFS.begin(false)) {
-        DEBUG_BLE("Błąd montowania LittleFS przy zapisie adresów TPMS");
-        return;
-    }
-
-    StaticJsonDocument<256> doc;
-
-    // Zapisz adresy czujników
-    if (frontTpms.isActive && frontTpms.address[0] != '\0') {
-        doc["front_tpms"] = frontTpms.address;
-    }
-
-    if (rearTpms.isActive && rearTpms.address[0] != '\0') {
-        doc["rear_tpms"] = rearTpms.address;
-    }
-
-    File file = LittleFS.open("/tpms_config.json", "w");
-
-    if (!file) {
-        DEBUG_BLE("Nie można otworzyć pliku konfiguracji TPMS do zapisu");
-        return;
-    }
-
-    serializeJson(doc, file);
-    file.close();
-    DEBUG_BLE("Zapisano konfigurację TPMS");
+// Odczyt TPMS odebrany z kolejki (zadanie usług)
+void updateTpmsData(const TpmsReading& reading) {
+    float pressure = reading.pressurePa / 100000.0; // Konwersja na bar
+    float temperature = reading.temperatureCenti / 100.0;
+    TpmsData& sensor = (reading.position == TPMS_FRONT) ? frontTpms : rearTpms;
+
+    sensor.pressure = pressure;
+    sensor.temperature = temperature;
+    sensor.batteryPercent = reading.batteryPercent;
+    sensor.alarm = reading.alarm;
+    sensor.sensorNumber = reading.sensorNumber;
+    sensor.lastUpdate = millis();
+    sensor.isActive = true;
+    snprintf(sensor.address, sizeof(sensor.address), "%02X%02X:%02X:%02X:%02X",
+        reading.address[0], reading.address[1], reading.address[2], reading.address[3], reading.address[4]);
+
+    DEBUG_BLE("TPMS %s: %s %.2f bar, %.1f C, bateria %d%%, alarm %s",
+        reading.position == TPMS_FRONT ? "przod" : "tyl", sensor.address,
+        pressure, temperature, reading.batteryPercent, reading.alarm ? "TAK" : "NIE");
 }
 
-// Dodaj do sekcji funkcji
-void updateTpmsData(const char* address, uint8_t sensorNumber, float pressure, float temperature, uint8_t batteryPercent, bool alarm) {
-
-    DEBUG_BLE("Odebrano dane TPMS: ");
-    DEBUG_BLE("Adres=%s", address);
-    DEBUG_BLE("Czujnik=%d", sensorNumber);
-    DEBUG_BLE("Ciśnienie=%.2f", pressure);
-    DEBUG_BLE("Temperatura=%.2f", temperature);
-    DEBUG_BLE("Bateria=%d", batteryPercent);
-    DEBUG_BLE("Alarm=%s", alarm ? "TAK" : "NIE");
-    
-    // Sprawdź, czy to przedni czy tylny czujnik na podstawie numeru czujnika lub adresu
-    bool isFrontSensor = false;
-    bool isRearSensor = false;
-    
-    // Sprawdź numer czujnika (0x80 = 1, 0x81 = 2, itd.)
-    if (sensorNumber == 0x80) {
-        isFrontSensor = true;
-    } else if (sensorNumber == 0x81) {
-        isRearSensor = true;
-    } else {
-        // Jeśli nie mamy jeszcze żadnego aktywnego czujnika
-        if (!frontTpms.isActive && !rearTpms.isActive) {
-            // Pierwszy wykryty czujnik to przedni
-            isFrontSensor = true;
-        }
-        // Jeśli mamy aktywny przedni ale nie tylny
-        else if (frontTpms.isActive && !rearTpms.isActive) {
-            // To nowy czujnik jest tylny
-            isRearSensor = true;
-        }
-    }
-    
-    if (isFrontSensor) {
-        frontTpms.pressure = pressure;
-        frontTpms.temperature = temperature;
-        frontTpms.batteryPercent = batteryPercent;
-        frontTpms.alarm = alarm;
-        frontTpms.sensorNumber = sensorNumber;
-        frontTpms.lastUpdate = millis();
-        frontTpms.isActive = true;
-
-        // Aktualizacja zmiennych globalnych używanych przez interfejs
-        pressure_bar = pressure;
-        pressure_temp = temperature;
-        pressure_voltage = batteryPercent / 100.0; // Konwersja % na napięcie 0-1
-        
-        DEBUG_BLE("Zaktualizowano przedni czujnik");
-    } else if (isRearSensor) {
-        rearTpms.pressure = pressure;
-        rearTpms.temperature = temperature;
-        rearTpms.batteryPercent = batteryPercent;
-        rearTpms.alarm = alarm;
-        rearTpms.sensorNumber = sensorNumber;
-        rearTpms.lastUpdate = millis();
-        rearTpms.isActive = true;
-        
-        // Aktualizacja zmiennych globalnych używanych przez interfejs
-        pressure_rear_bar = pressure;
-        pressure_rear_temp = temperature;
-        pressure_rear_voltage = batteryPercent / 100.0; // Konwersja % na napięcie 0-1
-        
-        DEBUG_BLE("Zaktualizowano tylny czujnik");
-    }
+// Skan zakończony przez stos BLE, a nie przez harmonogram (np. błąd kontrolera) -
+// wołane z zadania BLE; stopTpmsScan() i tak posprząta wyniki przy końcu okna
+void onTpmsScanComplete(BLEScanResults results) {
+    (void)results;
+    tpmsScanning = false;
+    DEBUG_WARN("Skanowanie TPMS zakonczone przez stos BLE");
 }
 
 void startTpmsScan() {
     if (tpmsScanning || !bluetoothConfig.tpmsEnabled) return;
     
-    DEBUG_BLE("Rozpoczynam nasluchiwanie TPMS...");
-    DEBUG_BLE("Przedni czujnik MAC: %s", bluetoothConfig.frontTpmsMac);
-    DEBUG_BLE("Tylny czujnik MAC: %s", bluetoothConfig.rearTpmsMac);
+    DEBUG_DETAIL("Skanowanie TPMS (%s)", tpmsScheduler.isSearching() ? "wyszukiwanie" : "okno");
     
+    if (tpmsAddressesChanged) {
+        loadTpmsAddresses(); // Zmiana adresów tylko przy zatrzymanym skanowaniu
+    }
+
     BLEScan* pBLEScan = BLEDevice::getScan();
-    pBLEScan->setAdvertisedDeviceCallbacks(new TpmsAdvertisedDeviceCallbacks());
+    pBLEScan->setAdvertisedDeviceCallbacks(&tpmsReceiver);
     pBLEScan->setActiveScan(false); // Pasywne skanowanie (mniej energii)
     pBLEScan->setInterval(100);
     pBLEScan->setWindow(99);
-    pBLEScan->start(0, true); // Skanowanie ciągłe w trybie pasywnym
+    // Wersja z funkcją zwrotną nie blokuje - zadanie wraca do harmonogramu,
+    // a skan (czas 0 = bez limitu) trwa do stopTpmsScan()
     tpmsScanning = true;
-    lastTpmsScanTime = millis();
+    if (!pBLEScan->start(0, onTpmsScanComplete, true)) {
+        tpmsScanning = false;
+        DEBUG_WARN("Nie udalo sie uruchomic skanowania TPMS");
+    }
 }
 
 void stopTpmsScan() {
-    if (!tpmsScanning) return;
-    
+    if (!tpmsScanning && !bluetoothConfig.tpmsEnabled) return;
+
     BLEScan* pBLEScan = BLEDevice::getScan();
-    pBLEScan->stop();
-    tpmsScanning = false;
+    if (tpmsScanning) {
+        pBLEScan->stop();
+        tpmsScanning = false;
+    }
+    pBLEScan->clearResults(); // Lista urządzeń ze skanu rośnie z każdym nowym adresem
     
-    DEBUG_BLE("Zatrzymano skanowanie TPMS");
+    DEBUG_DETAIL("Zatrzymano skanowanie TPMS (rozgloszenia: %u, przyjete: %u, odrzucone z kolejki: %u)",
+        tpmsReceiver.getAdvertsSeen(), tpmsReceiver.getAdvertsAccepted(), tpmsReceiver.getDropped());
 }
 
+// Adresy czujników z konfiguracji Bluetooth - zamiana na postać binarną dla szybkiego porównania
 void loadTpmsAddresses() {
-    DEBUG_BLE("Funkcja loadTpmsAddresses() jeszcze nie jest zaimplementowana");
-    // Na razie pusta implementacja
-    // Docelowo będzie wczytywać adresy czujników z pliku konfiguracyjnego
+    DEBUG_BLE("Przedni czujnik MAC: %s", bluetoothConfig.frontTpmsMac);
+    DEBUG_BLE("Tylny czujnik MAC: %s", bluetoothConfig.rearTpmsMac);
+
+    tpmsReceiver.setSensors(bluetoothConfig.frontTpmsMac, bluetoothConfig.rearTpmsMac);
+    tpmsScheduler.setSensorEnabled(TPMS_FRONT, tpmsReceiver.isSensorEnabled(TPMS_FRONT));
+    tpmsScheduler.setSensorEnabled(TPMS_REAR, tpmsReceiver.isSensorEnabled(TPMS_REAR));
+    tpmsAddressesChanged = false;
 }
 
 void checkTpmsTimeout() {
@@ -1116,11 +956,13 @@ void checkTpmsTimeout() {
     if (frontTpms.isActive && (currentTime - frontTpms.lastUpdate > TPMS_TIMEOUT)) {
         DEBUG_BLE("Przedni czujnik nie odpowiada - oznaczam jako nieaktywny");
         frontTpms.isActive = false;
+        tpmsScheduler.markLost(TPMS_FRONT);
     }
     
     if (rearTpms.isActive && (currentTime - rearTpms.lastUpdate > TPMS_TIMEOUT)) {
         DEBUG_BLE("Tylny czujnik nie odpowiada - oznaczam jako nieaktywny");
         rearTpms.isActive = false;
+        tpmsScheduler.markLost(TPMS_REAR);
     }
 }
 
@@ -1151,7 +993,7 @@ void checkAutoOff() {
     // 1. Auto-off jest wyłączone (autoOffTime <= 0)
     // 2. Jesteśmy w trybie konfiguracji (configModeActive)
     // 3. Aktywna jest konfiguracja przez WWW (webConfigActive)
-    if (autoOffTime <= 0 || configModeActive || webConfigActive) {
+    if (generalSettings.autoOffTime <= 0 || configModeActive || webConfigActive) {
         return;
     }
     
@@ -1168,25 +1010,25 @@ void checkAutoOff() {
     }
     
     // Oblicz próg wyłączenia (autoOffTime w minutach * 60000 ms)
-    uint32_t threshold = (uint32_t)autoOffTime * 60000UL;
+    uint32_t threshold = (uint32_t)generalSettings.autoOffTime * 60000UL;
     
     // Debugowanie co 10 sekund
     static unsigned long lastCheckTime = 0;
     if (currentTime - lastCheckTime > 10000) {
         lastCheckTime = currentTime;
-        DEBUG_INFO("Auto-off: nieaktywnosc = %u s, prog = %u s, auto-off = %d min", inactiveTime/1000, threshold/1000, autoOffTime);
+        DEBUG_INFO("Auto-off: nieaktywnosc = %u s, prog = %u s, auto-off = %d min", inactiveTime/1000, threshold/1000, generalSettings.autoOffTime);
     }
     
     // Sprawdź czy przekroczono próg
     if (inactiveTime >= threshold) {
-        DEBUG_INFO("Auto-off: wyłaczanie po %d min nieaktywnosci (%u s)", autoOffTime, inactiveTime/1000);
+        DEBUG_INFO("Auto-off: wyłaczanie po %d min nieaktywnosci (%u s)", generalSettings.autoOffTime, inactiveTime/1000);
         
         // Powiadom użytkownika przed wyłączeniem (opcjonalnie)
         display.clearBuffer();
         //display.setFont(czcionka_srednia);
         drawCenteredText("Automatyczne", 25, czcionka_srednia);
         drawCenteredText("wylaczenie", 45, czcionka_srednia);
-        display.sendBuffer();
+        displayRenderer.present();
         
         // Krótkie opóźnienie aby komunikat został wysłany i wyświetlony
         delay(2500);
@@ -1196,276 +1038,62 @@ void checkAutoOff() {
     }
 }
 
-void printLightConfig() {
-
-    if (!LittleFS.begin(false)) {
-        DEBUG_ERROR("Blad montowania systemu plikow");
-        return;
-    }
-    
-    if (LittleFS.exists("/light_config.json")) {
-
-        File file = LittleFS.open("/light_config.json", "r");
-
-        if (file) {
-            DEBUG_LIGHT("Zawartosc pliku konfiguracyjnego swiatel:");
-            
-            // Wczytanie całego pliku do bufora
-            String fileContent = "";
-            while (file.available()) {
-                fileContent += (char)file.read();
-            }
-            DEBUG_LIGHT("%s", fileContent.c_str());
-            
-            file.close();
-        } else {
-            DEBUG_ERROR("Nie mozna otworzyc pliku konfiguracyjnego");
-        }
-
-    } else {
-
-        DEBUG_INFO("Plik konfiguracyjny nie istnieje");
-    }
-}
-
 // ustawianie jasności wyświetlacza
 void setDisplayBrightness(uint8_t brightness) {
     displayBrightness = brightness;
+    I2cBusLock lock;
     display.setContrast(displayBrightness);
 }
 
-// zapis ustawień podświetlenia
-void saveBacklightSettingsToFile() {
-    // Nie montujemy systemu plików ponownie - zakładamy, że jest już zamontowany
-    // Jeśli nie jest, to inne operacje i tak by nie działały
-    
-    File file = LittleFS.open(CONFIG_FILE, "w");
-    if (!file) {
-        DEBUG_LIGHT("Nie można otworzyć pliku do zapisu");
-        return;
-    }
-
-    StaticJsonDocument<200> doc;
-    doc["brightness"] = backlightSettings.Brightness;
-    doc["dayBrightness"] = backlightSettings.dayBrightness;
-    doc["nightBrightness"] = backlightSettings.nightBrightness;
-    doc["autoMode"] = backlightSettings.autoMode;
+// --- Funkcje wyświetlacza ---
 
-    // Zapisz JSON do pliku
-    if (serializeJson(doc, file)) {
-        DEBUG_LIGHT("Zapisano ustawienia do pliku");
-    } else {
-        DEBUG_LIGHT("Błąd podczas zapisu do pliku");
-    }
-    
-    file.close(); // Zawsze zamykaj plik po operacjach
-    
-    // Zastosuj nowe ustawienia
-    applyBacklightSettings();
+// rysowanie linii poziomej
+void drawHorizontalLine() {
+    display.drawHLine(4, 12, 122);
+    display.drawHLine(4, 48, 122);
 }
 
-// wczytywanie ustawień podświetlenia
+// rysowanie linii pionowej
+void drawVerticalLine() {
+    display.drawVLine(24, 16, 28);
+    display.drawVLine(68, 16, 28);
+}
 
+// Ostatni odczyt RTC po stronie pętli (z migawki usług) i jego chwila w millis()
+uint32_t clockEpoch = 0;
+uint32_t clockStampMs = 0;
 
-// zapis ustawień ogólnych
-void saveGeneralSettingsToFile() {
-    File file = LittleFS.open("/general_config.json", "w");
-    if (!file) {
-        DEBUG_INFO("Nie można otworzyć pliku ustawień ogólnych do zapisu");
-        return;
-    }
+// Stan górnego paska - czas ekstrapolowany z ostatniego odczytu RTC
+DateTime topBarTime;
+bool topBarColonVisible = true;
 
-    StaticJsonDocument<64> doc;
-    doc["wheelSize"] = generalSettings.wheelSize;
+// Przełączenie dwukropka co pół sekundy; pasek nie czyta RTC przez I2C
+void updateTopBarClock() {
+    static unsigned long lastColonToggle = 0;
+    const unsigned long COLON_TOGGLE_INTERVAL = 500;  // Miganie co 500ms (pół sekundy)
 
-    if (serializeJson(doc, file) == 0) {
-        DEBUG_INFO("Błąd podczas zapisu ustawień ogólnych");
+    if (millis() - lastColonToggle >= COLON_TOGGLE_INTERVAL) {
+        topBarColonVisible = !topBarColonVisible;
+        topBarTime = DateTime(clockEpoch + (millis() - clockStampMs) / 1000);
+        lastColonToggle = millis();
     }
-
-    file.close();
-}
-
-// zapis konfiguracji Bluetooth
-void saveBluetoothConfigToFile() {
-    File file = LittleFS.open("/bluetooth_config.json", "w");
-    if (!file) {
-        DEBUG_BLE("Nie można otworzyć pliku konfiguracji Bluetooth");
-        return;
-    }
-
-    StaticJsonDocument<256> doc; // Zwiększ rozmiar dokumentu
-    doc["bmsEnabled"] = bluetoothConfig.bmsEnabled;
-    doc["tpmsEnabled"] = bluetoothConfig.tpmsEnabled;
-    doc["bmsMac"] = bluetoothConfig.bmsMac;
-    doc["frontTpmsMac"] = bluetoothConfig.frontTpmsMac; // Dodaj to
-    doc["rearTpmsMac"] = bluetoothConfig.rearTpmsMac;   // Dodaj to
-
-    serializeJson(doc, file);
-    file.close();
-}
-
-// wczytywanie konfiguracji Bluetooth
-void loadBluetoothConfigFromFile() {
-    File file = LittleFS.open("/bluetooth_config.json", "r");
-    if (!file) {
-        DEBUG_BLE("Nie znaleziono pliku konfiguracji Bluetooth, używam domyślnych");
-        return;
-    }
-
-    StaticJsonDocument<256> doc; // Zwiększ rozmiar dokumentu
-    DeserializationError error = deserializeJson(doc, file);
-    
-    if (!error) {
-        bluetoothConfig.bmsEnabled = doc["bmsEnabled"] | false;
-        bluetoothConfig.tpmsEnabled = doc["tpmsEnabled"] | false;
-        
-        // Dodaj obsługę MAC adresów
-        if (doc.containsKey("bmsMac")) {
-            strlcpy(bluetoothConfig.bmsMac, doc["bmsMac"], sizeof(bluetoothConfig.bmsMac));
-        }
-        
-        if (doc.containsKey("frontTpmsMac")) {
-            strlcpy(bluetoothConfig.frontTpmsMac, doc["frontTpmsMac"], sizeof(bluetoothConfig.frontTpmsMac));
-        }
-        
-        if (doc.containsKey("rearTpmsMac")) {
-            strlcpy(bluetoothConfig.rearTpmsMac, doc["rearTpmsMac"], sizeof(bluetoothConfig.rearTpmsMac));
-        }
-    }
-    
-    file.close();
-}
-
-// wczytywanie ustawień ogólnych
-void loadGeneralSettingsFromFile() {
-    File file = LittleFS.open("/general_config.json", "r");
-    if (!file) {
-        DEBUG_INFO("Nie znaleziono pliku ustawień ogólnych, używam domyślnych");
-        generalSettings.wheelSize = 26; // Wartość domyślna
-        saveGeneralSettingsToFile(); // Zapisz domyślne ustawienia
-        return;
-    }
-
-    StaticJsonDocument<64> doc;
-    DeserializationError error = deserializeJson(doc, file);
-    file.close();
-
-    if (error) {
-        DEBUG_INFO("Błąd podczas parsowania JSON ustawień ogólnych");
-        generalSettings.wheelSize = 26; // Wartość domyślna
-        saveGeneralSettingsToFile(); // Zapisz domyślne ustawienia
-        return;
-    }
-
-    generalSettings.wheelSize = doc["wheelSize"] | 26; // Domyślnie 26 cali jeśli nie znaleziono
-
-    DEBUG_INFO("Loaded wheel size: %d", generalSettings.wheelSize);
-}
-
-// Funkcja zapisująca ustawienia automatycznego wyłączania
-void saveAutoOffSettings() {
-    if (!LittleFS.begin()) {
-        DEBUG_ERROR("Nie mozna zamontowac systemu plikow!");
-        return;
-    }
-
-    StaticJsonDocument<256> doc;
-    doc["autoOffTime"] = autoOffTime;
-
-    File file = LittleFS.open("/auto_off.json", "w");
-    if (!file) {
-        DEBUG_ERROR("Nie mozna otworzyc pliku auto_off.json do zapisu!");
-        return;
-    }
-
-    if (serializeJson(doc, file) == 0) {
-        DEBUG_ERROR("Blad podczas zapisu do pliku auto_off.json!");
-    } else {
-        DEBUG_INFO("Zapisano ustawienia auto-off: %d minut", autoOffTime);
-    }
-    file.close();
-    
-    // Sprawdź, czy plik został poprawnie zapisany
-    File testFile = LittleFS.open("/auto_off.json", "r");
-    if (testFile) {
-        String content = testFile.readString();
-        DEBUG_INFO("Zawartosc pliku auto_off.json: %s", content.c_str());
-        testFile.close();
-    } else {
-        DEBUG_ERROR("Nie mozna odczytac zapisanego pliku auto_off.json!");
-    }
-}
-
-void loadAutoOffSettings() {
-    if (!LittleFS.begin()) {
-        DEBUG_ERROR("Nie można zamontować systemu plików!");
-        return;
-    }
-
-    File file = LittleFS.open("/auto_off.json", "r");
-    if (!file) {
-        DEBUG_INFO("Brak pliku auto_off.json, używam domyślnych ustawień");
-        autoOffTime = 0; // Domyślnie wyłączone
-        return;
-    }
-
-    String content = file.readString();
-    DEBUG_INFO("Wczytany plik auto_off.json: %s", content.c_str());
-    
-    file.seek(0);
-    StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, file);
-    file.close();
-
-    if (error) {
-        DEBUG_ERROR("Błąd parsowania auto_off.json: %s", error.c_str());
-        return;
-    }
-
-    autoOffTime = doc["autoOffTime"] | 0;
-    DEBUG_INFO("Wczytano ustawienia auto-off: %d minut", autoOffTime);
-}
-
-// --- Funkcje wyświetlacza ---
-
-// rysowanie linii poziomej
-void drawHorizontalLine() {
-    display.drawHLine(4, 12, 122);
-    display.drawHLine(4, 48, 122);
-}
-
-// rysowanie linii pionowej
-void drawVerticalLine() {
-    display.drawVLine(24, 16, 28);
-    display.drawVLine(68, 16, 28);
-}
+}
 
 // rysowanie górnego paska
 void drawTopBar() {
-    static bool colonVisible = true;
-    static unsigned long lastColonToggle = 0;
-    const unsigned long COLON_TOGGLE_INTERVAL = 500;  // Miganie co 500ms (pół sekundy)
+    updateTopBarClock();
 
     display.setFont(czcionka_srednia);
 
-    // Pobierz aktualny czas z RTC
-    DateTime now = rtc.now();
-
     // Czas z migającym dwukropkiem
     char timeStr[6];
-    if (colonVisible) {
-        sprintf(timeStr, "%02d:%02d", now.hour(), now.minute());
+    if (topBarColonVisible) {
+        sprintf(timeStr, "%02d:%02d", topBarTime.hour(), topBarTime.minute());
     } else {
-        sprintf(timeStr, "%02d %02d", now.hour(), now.minute());
+        sprintf(timeStr, "%02d %02d", topBarTime.hour(), topBarTime.minute());
     }
     display.drawStr(0, 10, timeStr);
 
-    // Przełącz stan dwukropka co COLON_TOGGLE_INTERVAL
-    if (millis() - lastColonToggle >= COLON_TOGGLE_INTERVAL) {
-        colonVisible = !colonVisible;
-        lastColonToggle = millis();
-    }
-
     // Bateria
     char battStr[5];
     sprintf(battStr, "%d%%", battery_capacity_percent);
@@ -1477,6 +1105,24 @@ void drawTopBar() {
     display.drawStr(100, 10, voltStr);
 }
 
+// Wszystkie wartości wyświetlane w górnym pasku
+uint32_t topBarSignature() {
+    updateTopBarClock();
+    return DisplayRenderer::Signature()
+        .add(topBarTime.hour())
+        .add(topBarTime.minute())
+        .add(topBarColonVisible)
+        .add(battery_capacity_percent)
+        .add((uint32_t)lroundf(battery_voltage))
+        .value();
+}
+
+// linie podziału ekranu
+void drawStaticLines() {
+    drawHorizontalLine();
+    drawVerticalLine();
+}
+
 // wyświetlanie statusu świateł
 void drawLightStatus() {
     display.setFont(czcionka_mala);
@@ -1499,6 +1145,13 @@ void drawLightStatus() {
     }
 }
 
+uint32_t lightStatusSignature() {
+    return DisplayRenderer::Signature()
+        .add(lightManager.getControlMode())
+        .add(lightManager.getMode())
+        .value();
+}
+
 // wyświetlanie poziomu wspomagania
 void drawAssistLevel() {
     display.setFont(czcionka_duza);
@@ -1544,12 +1197,8 @@ void drawAssistLevel() {
     const char* modeText = "";  // Domyślna wartość
     const char* modeText2 = ""; // Domyślna wartość
     
-    // Sprawdź czy jest aktywna kadencja (pedałowanie)
-    unsigned long now = millis();
-    bool isPedaling = (now - cadence_last_pulse_time < 2000) && (cadence_rpm > 0);
-    
     // Ustawienie trybu PAS gdy jest kadencja
-    if (isPedaling) {
+    if (isPedaling()) {
         modeText = "PAS";
     }
     
@@ -1562,6 +1211,21 @@ void drawAssistLevel() {
     display.drawStr(28, 34, modeText2);  // wyświetl STOP przy aktywnym hamulcu
 }
 
+// Sprawdź czy jest aktywna kadencja (pedałowanie)
+bool isPedaling() {
+    return (millis() - cadence_last_pulse_time < 2000) && (cadence_rpm > 0);
+}
+
+uint32_t assistLevelSignature() {
+    return DisplayRenderer::Signature()
+        .add(cruiseControlActive)
+        .add(legalMode)
+        .add(assistLevel)
+        .add(isPedaling())
+        .add(brakeActive)
+        .value();
+}
+
 // wyświetlanie wartości i jednostki
 void drawValueAndUnit(const char* valueStr, const char* unitStr) {
     // Najpierw oblicz szerokość jednostki małą czcionką
@@ -1660,31 +1324,30 @@ void updateCadenceLogic() {
     }
 }
 
-// Implementacja głównego ekranu
-void drawMainDisplay() {
-    display.setFont(czcionka_mala);
-    char valueStr[10];
-    const char* unitStr;
-    const char* descText;
+// Tekst dolnej części ekranu dla bieżącego ekranu i podekranu
+void formatMainDisplay(MainDisplayText& text) {
+    text.value[0] = '\0';
+    text.unit = "";
+    text.desc = "";
 
     if (inSubScreen) {
         switch (currentMainScreen) {
             case RANGE_SCREEN: // Teraz pierwszy ekran
                 switch (currentSubScreen) {
                     case ODOMETER_KM: // Nowa kolejność
-                        sprintf(valueStr, "%4.0f", odometer.getRawTotal());
-                        unitStr = "km";
-                        descText = ">Przebieg";
+                        sprintf(text.value, "%4.0f", odometer.getRawTotal());
+                        text.unit = "km";
+                        text.desc = ">Przebieg";
                         break;
                     case DISTANCE_KM:
-                        sprintf(valueStr, "%4.1f", distance_km);
-                        unitStr = "km";
-                        descText = ">Dystans";
+                        sprintf(text.value, "%4.1f", distance_km);
+                        text.unit = "km";
+                        text.desc = ">Dystans";
                         break;
                     case RANGE_KM:
-                        sprintf(valueStr, "%4.1f", range_km);
-                        unitStr = "km";
-                        descText = ">Zasieg";
+                        sprintf(text.value, "%4.1f", range_km);
+                        text.unit = "km";
+                        text.desc = ">Zasieg";
                         break;
                 }
                 break;
@@ -1692,19 +1355,19 @@ void drawMainDisplay() {
             case CADENCE_SCREEN: // Teraz drugi ekran
                 switch (currentSubScreen) {
                     case CADENCE_RPM:
-                        sprintf(valueStr, "%4d", cadence_rpm);
-                        unitStr = "RPM";
-                        descText = ">Kadencja";
+                        sprintf(text.value, "%4d", cadence_rpm);
+                        text.unit = "RPM";
+                        text.desc = ">Kadencja";
                         break;
                     case CADENCE_AVG_RPM:
-                        sprintf(valueStr, "%4d", cadence_avg_rpm);
-                        unitStr = "RPM";
-                        descText = ">Kadencja AVG";
+                        sprintf(text.value, "%4d", (int)(tripMetrics.getAverage(TRIP_CADENCE) + 0.5f));
+                        text.unit = "RPM";
+                        text.desc = ">Kadencja AVG";
                         break;
                     case CADENCE_MAX_RPM: 
-                        sprintf(valueStr, "%4d", cadence_max_rpm);
-                        unitStr = "RPM";
-                        descText = ">Kadencja MAX";
+                        sprintf(text.value, "%4d", (int)(tripMetrics.getMax(TRIP_CADENCE) + 0.5f));
+                        text.unit = "RPM";
+                        text.desc = ">Kadencja MAX";
                         break;
                 }
                 break;
@@ -1712,19 +1375,19 @@ void drawMainDisplay() {
             case SPEED_SCREEN: // Teraz trzeci ekran
                 switch (currentSubScreen) {
                     case SPEED_KMH:
-                        sprintf(valueStr, "%4.1f", speed_kmh);
-                        unitStr = "km/h";
-                        descText = ">Predkosc";
+                        sprintf(text.value, "%4.1f", speed_kmh);
+                        text.unit = "km/h";
+                        text.desc = ">Predkosc";
                         break;
                     case SPEED_AVG_KMH:
-                        sprintf(valueStr, "%4.1f", speed_avg_kmh);
-                        unitStr = "km/h";
-                        descText = ">Pred. AVG";
+                        sprintf(text.value, "%4.1f", tripMetrics.getAverage(TRIP_SPEED));
+                        text.unit = "km/h";
+                        text.desc = ">Pred. AVG";
                         break;
                     case SPEED_MAX_KMH:
-                        sprintf(valueStr, "%4.1f", speed_max_kmh);
-                        unitStr = "km/h";
-                        descText = ">Pred. MAX";
+                        sprintf(text.value, "%4.1f", tripMetrics.getMax(TRIP_SPEED));
+                        text.unit = "km/h";
+                        text.desc = ">Pred. MAX";
                         break;
                 }
                 break;
@@ -1732,19 +1395,19 @@ void drawMainDisplay() {
             case POWER_SCREEN: // Teraz czwarty ekran
                 switch (currentSubScreen) {
                     case POWER_W:
-                        sprintf(valueStr, "%4d", power_w);
-                        unitStr = "W";
-                        descText = ">Moc";
+                        sprintf(text.value, "%4d", power_w);
+                        text.unit = "W";
+                        text.desc = ">Moc";
                         break;
                     case POWER_AVG_W:
-                        sprintf(valueStr, "%4d", power_avg_w);
-                        unitStr = "W";
-                        descText = ">Moc AVG";
+                        sprintf(text.value, "%4d", (int)tripMetrics.getAverage(TRIP_POWER));
+                        text.unit = "W";
+                        text.desc = ">Moc AVG";
                         break;
                     case POWER_MAX_W:
-                        sprintf(valueStr, "%4d", power_max_w);
-                        unitStr = "W";
-                        descText = ">Moc MAX";
+                        sprintf(text.value, "%4d", (int)tripMetrics.getMax(TRIP_POWER));
+                        text.unit = "W";
+                        text.desc = ">Moc MAX";
                         break;
                 }
                 break;
@@ -1752,29 +1415,29 @@ void drawMainDisplay() {
             case BATTERY_SCREEN: // Teraz piąty ekran z nową kolejnością podekranów
                 switch (currentSubScreen) {
                     case BATTERY_CAPACITY_AH:
-                        sprintf(valueStr, "%4.1f", battery_capacity_ah);
-                        unitStr = "Ah";
-                        descText = ">Pojemnosc";
+                        sprintf(text.value, "%4.1f", battery_capacity_ah);
+                        text.unit = "Ah";
+                        text.desc = ">Pojemnosc";
                         break;
                     case BATTERY_CAPACITY_WH:
-                        sprintf(valueStr, "%4.0f", battery_capacity_wh);
-                        unitStr = "Wh";
-                        descText = ">Energia";
+                        sprintf(text.value, "%4.0f", battery_capacity_wh);
+                        text.unit = "Wh";
+                        text.desc = ">Energia";
                         break;
                     case BATTERY_CAPACITY_PERCENT:
-                        sprintf(valueStr, "%3d", battery_capacity_percent);
-                        unitStr = "%";
-                        descText = ">Bateria";
+                        sprintf(text.value, "%3d", battery_capacity_percent);
+                        text.unit = "%";
+                        text.desc = ">Bateria";
                         break;
                     case BATTERY_VOLTAGE:
-                        sprintf(valueStr, "%4.1f", battery_voltage);
-                        unitStr = "V";
-                        descText = ">Napiecie";
+                        sprintf(text.value, "%4.1f", battery_voltage);
+                        text.unit = "V";
+                        text.desc = ">Napiecie";
                         break;
                     case BATTERY_CURRENT:
-                        sprintf(valueStr, "%4.1f", battery_current);
-                        unitStr = "A";
-                        descText = ">Natezenie";
+                        sprintf(text.value, "%4.1f", battery_current);
+                        text.unit = "A";
+                        text.desc = ">Natezenie";
                         break;
                 }
                 break;
@@ -1782,23 +1445,31 @@ void drawMainDisplay() {
             case TEMP_SCREEN: // Teraz szósty ekran
                 switch (currentSubScreen) {
                     case TEMP_AIR:
-                        if (currentTemp != TEMP_ERROR && currentTemp != DEVICE_DISCONNECTED_C) {
-                            sprintf(valueStr, "%4.1f", currentTemp);
+                        if (currentTemp != TEMP_INVALID) {
+                            sprintf(text.value, "%4.1f", currentTemp);
                         } else {
-                            strcpy(valueStr, "---");
+                            strcpy(text.value, "---");
                         }
-                        unitStr = "C";
-                        descText = ">Powietrze";
+                        text.unit = "C";
+                        text.desc = ">Powietrze";
                         break;
                     case TEMP_CONTROLLER:
-                        sprintf(valueStr, "%4.1f", temp_controller);
-                        unitStr = "C";
-                        descText = ">Sterownik";
+                        if (temp_controller != TEMP_INVALID) {
+                            sprintf(text.value, "%4.1f", temp_controller);
+                        } else {
+                            strcpy(text.value, "---");
+                        }
+                        text.unit = "C";
+                        text.desc = ">Sterownik";
                         break;
                     case TEMP_MOTOR:
-                        sprintf(valueStr, "%4.1f", temp_motor);
-                        unitStr = "C";
-                        descText = ">Silnik";
+                        if (temp_motor != TEMP_INVALID) {
+                            sprintf(text.value, "%4.1f", temp_motor);
+                        } else {
+                            strcpy(text.value, "---");
+                        }
+                        text.unit = "C";
+                        text.desc = ">Silnik";
                         break;
                 }
                 break;
@@ -1807,30 +1478,30 @@ void drawMainDisplay() {
                 char combinedStr[16];
                 switch (currentSubScreen) {
                     case PRESSURE_BAR:
-                        if (frontTpms.isActive && rearTpms.isActive) {
+                        if (pressure_active && pressure_rear_active) {
                             sprintf(combinedStr, "%.2f|%.2f", pressure_bar, pressure_rear_bar);
-                        } else if (frontTpms.isActive) {
+                        } else if (pressure_active) {
                             sprintf(combinedStr, "%.2f|---", pressure_bar);
-                        } else if (rearTpms.isActive) {
+                        } else if (pressure_rear_active) {
                             sprintf(combinedStr, "---|%.2f", pressure_rear_bar);
                         } else {
                             strcpy(combinedStr, "---|---");
                         }
-                        strcpy(valueStr, combinedStr);
-                        unitStr = "bar";
-                        descText = ">Cis";
+                        strcpy(text.value, combinedStr);
+                        text.unit = "bar";
+                        text.desc = ">Cis";
                         break;
                     case PRESSURE_VOLTAGE:
                         sprintf(combinedStr, "%.2f|%.2f", pressure_voltage, pressure_rear_voltage);
-                        strcpy(valueStr, combinedStr);
-                        unitStr = "V";
-                        descText = ">Bat";
+                        strcpy(text.value, combinedStr);
+                        text.unit = "V";
+                        text.desc = ">Bat";
                         break;
                     case PRESSURE_TEMP:
                         sprintf(combinedStr, "%.1f|%.1f", pressure_temp, pressure_rear_temp);
-                        strcpy(valueStr, combinedStr);
-                        unitStr = "C";
-                        descText = ">Temp";
+                        strcpy(text.value, combinedStr);
+                        text.unit = "C";
+                        text.desc = ">Temp";
                         break;
                 }
                 break;
@@ -1840,59 +1511,92 @@ void drawMainDisplay() {
         // Wyświetlanie głównych ekranów
         switch (currentMainScreen) {
             case RANGE_SCREEN: // Teraz pierwszy ekran
-                sprintf(valueStr, "%4.0f", odometer.getRawTotal());
-                unitStr = "km";
-                descText = " Przebieg";
+                sprintf(text.value, "%4.0f", odometer.getRawTotal());
+                text.unit = "km";
+                text.desc = " Przebieg";
                 break;
 
             case CADENCE_SCREEN: // Teraz drugi ekran
-                sprintf(valueStr, "%4d", cadence_rpm);
-                unitStr = "RPM";
-                descText = " Kadencja";
+                sprintf(text.value, "%4d", cadence_rpm);
+                text.unit = "RPM";
+                text.desc = " Kadencja";
                 break;  
 
             case SPEED_SCREEN: // Teraz trzeci ekran
-                sprintf(valueStr, "%4.1f", speed_kmh);
-                unitStr = "km/h";
-                descText = " Predkosc";
+                sprintf(text.value, "%4.1f", speed_kmh);
+                text.unit = "km/h";
+                text.desc = " Predkosc";
                 break;
 
             case POWER_SCREEN: // Teraz czwarty ekran
-                sprintf(valueStr, "%4d", power_w);
-                unitStr = "W";
-                descText = " Moc";
+                sprintf(text.value, "%4d", power_w);
+                text.unit = "W";
+                text.desc = " Moc";
                 break;
 
             case BATTERY_SCREEN: // Teraz piąty ekran
-                sprintf(valueStr, "%4.1f", battery_capacity_ah);
-                unitStr = "Ah";
-                descText = " Bateria";
+                sprintf(text.value, "%4.1f", battery_capacity_ah);
+                text.unit = "Ah";
+                text.desc = " Bateria";
                 break;
 
             case TEMP_SCREEN: // Teraz szósty ekran
-                if (currentTemp != TEMP_ERROR && currentTemp != DEVICE_DISCONNECTED_C) {
-                    sprintf(valueStr, "%4.1f", currentTemp);
+                if (currentTemp != TEMP_INVALID) {
+                    sprintf(text.value, "%4.1f", currentTemp);
                 } else {
-                    strcpy(valueStr, "---");
+                    strcpy(text.value, "---");
                 }
-                unitStr = "C";
-                descText = " Temperatura";
+                text.unit = "C";
+                text.desc = " Temperatura";
                 break;
 
             case PRESSURE_SCREEN: // Teraz siódmy ekran
-                sprintf(valueStr, "%.1f/%.1f", pressure_bar, pressure_rear_bar);
-                unitStr = "bar";
-                descText = " Kola";
+                sprintf(text.value, "%.1f/%.1f", pressure_bar, pressure_rear_bar);
+                text.unit = "bar";
+                text.desc = " Kola";
                 break;
 
             case USB_SCREEN: // Teraz ósmy ekran
-                display.setFont(czcionka_srednia);
-                display.drawStr(48, 61, usbEnabled ? "Wlaczone" : "Wylaczone");
-                descText = " USB";
+                strcpy(text.value, usbEnabled ? "Wlaczone" : "Wylaczone");
+                text.desc = " USB";
                 break;
         }
     }
-   
+}
+
+// Implementacja głównego ekranu
+void drawMainDisplay() {
+    PROFILE_SCOPE(PERF_DRAW_MAIN);
+    MainDisplayText text;
+    formatMainDisplay(text);
+
+    if (currentMainScreen == USB_SCREEN) {
+        display.setFont(czcionka_srednia);
+        display.drawStr(48, 61, text.value);
+    } else {
+        // Wyświetl wartości tylko jeśli nie jesteśmy na ekranie USB
+        drawValueAndUnit(text.value, text.unit);
+    }
+
+    display.setFont(czcionka_mala);
+    display.drawStr(0, 62, text.desc);
+}
+
+uint32_t mainDisplaySignature() {
+    MainDisplayText text;
+    formatMainDisplay(text);
+    return DisplayRenderer::Signature()
+        .add(currentMainScreen)
+        .add(currentSubScreen)
+        .add(inSubScreen)
+        .add(text.value)
+        .add(text.unit)
+        .add(text.desc)
+        .value();
+}
+
+// wyświetlanie prędkości
+void drawSpeed() {
     char speedStr[10]; // Bufor na sformatowaną prędkość
     if (speed_kmh < 10.0) {
         sprintf(speedStr, "  %2.1f", speed_kmh);  // Dodaj spację przed liczbą
@@ -1907,18 +1611,15 @@ void drawMainDisplay() {
     // Wyświetl jednostkę małą czcionką pod prędkością
     display.setFont(czcionka_mala);
     display.drawStr(105, 45, "km/h");
+}
 
-    // Wyświetl wartości tylko jeśli nie jesteśmy na ekranie USB
-    if (currentMainScreen != USB_SCREEN) {
-        drawValueAndUnit(valueStr, unitStr);
-    }
-
-    display.setFont(czcionka_mala);
-    display.drawStr(0, 62, descText);
+uint32_t speedSignature() {
+    // Rozdzielczość wyświetlania: 0.1 km/h
+    return DisplayRenderer::Signature().add((uint32_t)lroundf(speed_kmh * 10.0f)).value();
 }
 
-// rysowanie strzałek
-void drawCadenceArrowsAndCircle() {
+// strzałka kadencji widoczna na ekranie
+CadenceArrow getVisibleCadenceArrow() {
     unsigned long now = millis();
     
     // Statyczna zmienna przechowująca czas ostatniego wykrycia kadencji
@@ -1936,14 +1637,33 @@ void drawCadenceArrowsAndCircle() {
     if (showArrows) {
         // ZMIANA: Strzałka w dół - pokazuj przy niskiej kadencji (sugerując niższy bieg)
         if (cadence_rpm > 0 && cadence_rpm < CADENCE_OPTIMAL_MIN) {
-            drawDownArrow();
+            return ARROW_DOWN;
         }
         
         // ZMIANA: Strzałka w górę - pokazuj przy wysokiej kadencji (sugerując wyższy bieg)
         else if (cadence_rpm > CADENCE_OPTIMAL_MAX) {
-            drawUpArrow();
+            return ARROW_UP;
         }
     }
+    return ARROW_NONE;
+}
+
+// rysowanie strzałek
+void drawCadenceArrowsAndCircle() {
+    switch (getVisibleCadenceArrow()) {
+        case ARROW_DOWN:
+            drawDownArrow();
+            break;
+        case ARROW_UP:
+            drawUpArrow();
+            break;
+        default:
+            break;
+    }
+}
+
+uint32_t cadenceArrowSignature() {
+    return DisplayRenderer::Signature().add(getVisibleCadenceArrow()).value();
 }
 
 // wyświetlanie wycentrowanego tekstu
@@ -1982,10 +1702,28 @@ void showWalkAssistMode(bool sendBuffer = false) {
     
     // Wysyłamy bufor tylko jeśli funkcja została wywołana samodzielnie
     if (sendBuffer) {
-        display.sendBuffer();
+        displayRenderer.present();
+        displayRenderer.invalidate();
     }
 }
 
+// Rejestracja widżetów ekranu głównego (obszary nie mogą wychodzić poza rysowaną treść)
+void setupDisplayRenderer() {
+    displayRenderer.addWidget("top",     {0, 0, 128, 12},  topBarSignature,       drawTopBar);
+    displayRenderer.addWidget("assist",  {0, 13, 56, 31},  assistLevelSignature,  drawAssistLevel);
+    displayRenderer.addWidget("light",   {25, 36, 33, 12}, lightStatusSignature,  drawLightStatus);
+    displayRenderer.addWidget("cadence", {55, 13, 13, 31}, cadenceArrowSignature, drawCadenceArrowsAndCircle);
+    displayRenderer.addWidget("speed",   {69, 13, 59, 35}, speedSignature,        drawSpeed);
+    displayRenderer.addWidget("main",    {0, 49, 128, 15}, mainDisplaySignature,  drawMainDisplay);
+    displayRenderer.setStaticLayer(drawStaticLines);
+    displayRenderer.setMaxFps(DISPLAY_MAX_FPS);
+}
+
+// Ekran trybu prowadzenia roweru rysowany przez potok wyświetlacza
+void drawWalkAssistScreen() {
+    showWalkAssistMode(false);
+}
+
 // wyświetlanie wiadomości powitalnej
 void showWelcomeMessage() {
     display.clearBuffer();
@@ -2025,7 +1763,7 @@ void showWelcomeMessage() {
             int versionX = (128 - versionWidth) / 2;
             display.drawStr(versionX, 60, versionText.c_str());
             
-            display.sendBuffer();
+            displayRenderer.present();
             
             //x--; // jeden px na krok
             x -= 2; // dwa px na krok
@@ -2034,6 +1772,7 @@ void showWelcomeMessage() {
     }
 
     welcomeAnimationDone = true;
+    displayRenderer.invalidate();
 }
 
 // wyświetlanie komunikatu kasowania danych
@@ -2043,314 +1782,142 @@ void clearTripData() {
     drawCenteredText("Reset danych", 25, czcionka_srednia);
     drawCenteredText("przejazdu", 40, czcionka_srednia);
 
-    display.sendBuffer();
+    displayRenderer.present();
     delay(1500);
 
     display.clearBuffer();
-    display.sendBuffer();
+    displayRenderer.present();
+    displayRenderer.invalidate();
 }
 
 // --- Funkcje obsługi przycisków ---
 
-// obsługa przycisków
-void handleButtons() {
-
-    if (configModeActive) {
-        return; // W trybie konfiguracji nie obsługuj normalnych funkcji przycisków
+// Długi SET przy wyłączonym wyświetlaczu - powitanie
+void onButtonWake() {
+    if (!welcomeAnimationDone) {
+        showWelcomeMessage();
     }
+    messageStartTime = millis();
+    showingWelcome = true;
+    displayActive = true;
+}
 
-    unsigned long currentTime = millis();
-    bool setState = digitalRead(BTN_SET);
-    bool upState = digitalRead(BTN_UP);
-    bool downState = digitalRead(BTN_DOWN);
-
-    // Wywołuj updateActivityTime() TYLKO gdy naprawdę jest wciśnięty jakiś przycisk
-    if (!setState || !upState || !downState) {
-        updateActivityTime(); // Aktualizuj czas aktywności TYLKO gdy przycisk jest wciśnięty
-    }
-
-    static unsigned long lastButtonCheck = 0;
-    const unsigned long buttonDebounce = 50;
-    static unsigned long legalModeStart = 0;
-    static unsigned long resetTripStart = 0;
-
-    // Sprawdź najpierw czy nie jesteśmy w czasie blokady po specjalnej kombinacji
-    if (currentTime - lastSpecialComboTime < SPECIAL_COMBO_LOCKOUT) {
-        // Jesteśmy w okresie blokady po kombinacji klawiszy - ignorujemy wszystkie klawisze
-        // Resetujemy też stany, aby uniknąć niepożądanych akcji
-        upPressStartTime = 0;
-        downPressStartTime = 0;
-        setPressStartTime = 0;
-        upLongPressExecuted = false;
-        downLongPressExecuted = false;
-        setLongPressExecuted = false;
-        return;
-    }
+// Długi SET - pożegnanie, po GOODBYE_DELAY uśpienie
+void onButtonGoodbye() {
+    display.clearBuffer();
+    display.setFont(czcionka_srednia);
+    display.drawStr(5, 32, "Do widzenia ;)");
+    displayRenderer.present();
+    messageStartTime = millis();
+}
 
-    // Obsługa włączania/wyłączania wyświetlacza
-    if (!displayActive) {
-        if (!setState && (currentTime - lastDebounceTime) > DEBOUNCE_DELAY) {
-            if (!setPressStartTime) {
-                setPressStartTime = currentTime;
-            } else if (!setLongPressExecuted && (currentTime - setPressStartTime) > SET_LONG_PRESS) {
-                if (!welcomeAnimationDone) {
-                    showWelcomeMessage();  // Pokaż animację powitania
-                } 
-                messageStartTime = currentTime;
-                setLongPressExecuted = true;
-                showingWelcome = true;
-                displayActive = true;
-            }
-        } else if (setState && setPressStartTime) {
-            setPressStartTime = 0;
-            setLongPressExecuted = false;
-            lastDebounceTime = currentTime;
-        }
-        return;
-    }
+void onButtonAssistUp() {
+    if (assistLevel < 5) assistLevel++;
+}
 
-    // Obsługa przycisków gdy wyświetlacz jest aktywny
-    if (!showingWelcome) {
+void onButtonAssistDown() {
+    if (assistLevel > 0) assistLevel--;
+}
 
-        // Sprawdzanie trybu legal (UP + SET) - przełączanie trybu legalnego
-        if (displayActive && !showingWelcome && !upState && !setState) {
-            if (legalModeStart == 0) {
-                legalModeStart = currentTime;
-            } else if ((currentTime - legalModeStart) > 500) { // 0.5 sekundy przytrzymania
-                toggleLegalMode();
-                while (!digitalRead(BTN_UP) || !digitalRead(BTN_SET)) {
-                    delay(10); // Czekaj na puszczenie przycisków
-                }
-                legalModeStart = 0;
-                lastDebounceTime = currentTime;
-                
-                // Ustaw czas ostatniej kombinacji
-                lastSpecialComboTime = currentTime;
-                
-                // Reset wszystkich stanów przycisków
-                upPressStartTime = 0;
-                downPressStartTime = 0;
-                setPressStartTime = 0;
-                upLongPressExecuted = false;
-                downLongPressExecuted = false;
-                setLongPressExecuted = false;
-                
-                return; // Zakończ funkcję handleButtons po obsłudze kombinacji SET+UP
-            }
-        } else {
-            legalModeStart = 0;
-        }
+// Długi UP - sterowanie światłami
+void onButtonLights() {
+    if (lightManager.getControlMode() == LightManager::SMART_CONTROL) {
+        // Cykliczne przełączanie: dzień -> noc -> wyłączone
+        lightManager.cycleMode();
+    } else if (lightManager.getMode() == LightManager::OFF) {
+        // Tryb sterownika: włącz światła
+        lightManager.setMode(LightManager::DAY); // Tymczasowo ustawiam DAY jako "włączone" w trybie sterownika
+        // TODO: Dodać wysyłanie komendy UART do sterownika KT
+    } else {
+        lightManager.setMode(LightManager::OFF);
+        // TODO: Dodać wysyłanie komendy UART do sterownika KT
+    }
+    applyBacklightSettings();
+}
 
-        // Sprawdzanie kombinacji SET + DOWN - reset danych przejazdu
-        if (displayActive && !showingWelcome && !setState && !downState) {
-            if (resetTripStart == 0) {
-                resetTripStart = currentTime;
-            } else if ((currentTime - resetTripStart) > 500) { // 0.5 sekundy przytrzymania
-                resetTripData();                
-                clearTripData();
-                
-                // Czekaj na puszczenie przycisków
-                while (!digitalRead(BTN_DOWN) || !digitalRead(BTN_SET)) {
-                    delay(10);
-                }
-                resetTripStart = 0;
-                lastDebounceTime = currentTime;
-                
-                // Ustaw czas ostatniej kombinacji
-                lastSpecialComboTime = currentTime;
-                
-                // Reset wszystkich stanów przycisków
-                upPressStartTime = 0;
-                downPressStartTime = 0;
-                setPressStartTime = 0;
-                upLongPressExecuted = false;
-                downLongPressExecuted = false;
-                setLongPressExecuted = false;
-                
-                return; // Zakończ funkcję handleButtons po obsłudze kombinacji SET+DOWN
-            }
+// Długi DOWN - tempomat (>= 10 km/h) albo tryb prowadzenia (< 8 km/h)
+void onButtonDownHold() {
+    if (speed_kmh >= 10.0) {
+        cruiseControlActive = !cruiseControlActive;
+        assistLevelAsText = cruiseControlActive; // Pokaż "T" gdy tempomat aktywny
+
+        if (cruiseControlActive) {
+            DEBUG_INFO("Aktywacja tempomatu");
         } else {
-            resetTripStart = 0;
+            DEBUG_INFO("Dezaktywacja tempomatu");
         }
+    } else if (speed_kmh < 8.0) {
+        walkAssistActive = true;
+        showWalkAssistMode(true);  // Wyślij bufor, żeby od razu pokazać ekran
 
-        if (!upState && (currentTime - lastDebounceTime) > DEBOUNCE_DELAY) {
-            if (!upPressStartTime) {
-                upPressStartTime = currentTime;
-            } else if (!upLongPressExecuted && (currentTime - upPressStartTime) > LONG_PRESS_TIME) {
-                // Długie naciśnięcie przycisku UP - sterowanie światłami
-                if (lightManager.getControlMode() == LightManager::SMART_CONTROL) {
-                    // Cykliczne przełączanie: dzień -> noc -> wyłączone
-                    lightManager.cycleMode();
-                    applyBacklightSettings();
-                } else {
-                    // Tryb sterownika: włącz/wyłącz światła
-                    if (lightManager.getMode() == LightManager::OFF) {
-                        // Włącz światła (wysyłając komendę UART do sterownika)
-                        lightManager.setMode(LightManager::DAY); // Tymczasowo ustawiam DAY jako "włączone" w trybie sterownika
-                        // TODO: Dodać wysyłanie komendy UART do sterownika KT
-                        applyBacklightSettings();
-                    } else {
-                        // Wyłącz światła
-                        lightManager.setMode(LightManager::OFF);
-                        // TODO: Dodać wysyłanie komendy UART do sterownika KT
-                        applyBacklightSettings();
-                    }
-                }
-                upLongPressExecuted = true;
-            }
-        } else if (upState && upPressStartTime) {
-            if (!upLongPressExecuted && (currentTime - upPressStartTime) < LONG_PRESS_TIME) {
-                if (assistLevel < 5) assistLevel++;
-            }
-            upPressStartTime = 0;
-            upLongPressExecuted = false;
-            lastDebounceTime = currentTime;
-        }
+        DEBUG_INFO("Aktywacja trybu prowadzenia roweru");
+    }
+}
 
-        // Obsługa przycisku DOWN (zmiana asysty/tryb prowadzenia/tempomat)
-        if (!downState && (currentTime - lastDebounceTime) > DEBOUNCE_DELAY) {
-            if (!downPressStartTime) {
-                downPressStartTime = currentTime;
-            } else if (!downLongPressExecuted && (currentTime - downPressStartTime) > LONG_PRESS_TIME) {
-                // Długie przytrzymanie przycisku DOWN
-                if (speed_kmh >= 10.0) {
-                    // Prędkość >= 10 km/h - włącz tempomat
-                    cruiseControlActive = !cruiseControlActive; // Przełącz stan tempomatu
-                    assistLevelAsText = cruiseControlActive; // Pokaż "T" gdy tempomat aktywny
-                    
-                    if (cruiseControlActive) {
-                        DEBUG_INFO("Aktywacja tempomatu");
-                    } else {
-                        DEBUG_INFO("Dezaktywacja tempomatu");
-                    }
-                    
-                    downLongPressExecuted = true;
-                } else if (speed_kmh < 8.0) {
-                    // Prędkość < 8 km/h - włącz tryb prowadzenia roweru
-                    walkAssistActive = true;
-                    showWalkAssistMode(true);  // Wyślij bufor, żeby od razu pokazać ekran
-                    
-                    DEBUG_INFO("Aktywacja trybu prowadzenia roweru");
-                    
-                    downLongPressExecuted = true;
-                }
-            }
-        } else if (downState && downPressStartTime) {
-            // Przycisk puszczony
-            if (walkAssistActive) {
-                // Wyłącz tryb prowadzenia roweru gdy przycisk DOWN jest puszczony
-                walkAssistActive = false;
-                DEBUG_INFO("Dezaktywacja trybu prowadzenia roweru");
-            }
-            
-            // UWAGA: Usunięto wyłączanie tempomatu przyciskiem DOWN - teraz tylko hamulec może go wyłączyć
-            
-            if (!downLongPressExecuted && (currentTime - downPressStartTime) < LONG_PRESS_TIME) {
-                // Krótkie kliknięcie DOWN - zmniejszenie asysty
-                if (assistLevel > 0) assistLevel--;
-            }
-            
-            downPressStartTime = 0;
-            downLongPressExecuted = false;
-            lastDebounceTime = currentTime;
-        }
+// Puszczenie DOWN kończy tryb prowadzenia (tempomat wyłącza tylko hamulec)
+void onButtonDownRelease() {
+    if (walkAssistActive) {
+        walkAssistActive = false;
+        DEBUG_INFO("Dezaktywacja trybu prowadzenia roweru");
+    }
+}
 
-        // Obsługa przycisku SET
-        static unsigned long lastSetRelease = 0;
-        static bool waitingForSecondClick = false;
-
-        if (!setState) {  // Przycisk wciśnięty
-            if (!setPressStartTime) {
-                setPressStartTime = currentTime;
-            } else if (!setLongPressExecuted && (currentTime - setPressStartTime) > SET_LONG_PRESS) {
-                // Długie przytrzymanie (>3s) - wyłączenie
-                display.clearBuffer();
-                display.setFont(czcionka_srednia);
-                display.drawStr(5, 32, "Do widzenia ;)");
-                display.sendBuffer();
-                messageStartTime = currentTime;
-                setLongPressExecuted = true;
-            }
-        } else if (setPressStartTime) {  // Przycisk puszczony
-            if (!setLongPressExecuted) {
-                unsigned long releaseTime = currentTime;
-
-                if (waitingForSecondClick && (releaseTime - lastSetRelease) < DOUBLE_CLICK_TIME) {
-                    // Podwójne kliknięcie
-                    if (currentMainScreen == USB_SCREEN) {
-                        // Przełącz stan USB
-                        usbEnabled = !usbEnabled;
-                        digitalWrite(UsbPin, usbEnabled ? HIGH : LOW);
-                    } else if (inSubScreen) {
-                        inSubScreen = false;  // Wyjście z pod-ekranów
-                    } else if (hasSubScreens(currentMainScreen)) {
-                        inSubScreen = true;  // Wejście do pod-ekranów
-                        currentSubScreen = 0;
-                    }
-                    waitingForSecondClick = false;
-                } else {
-                    // Pojedyncze kliknięcie
-                    if (!waitingForSecondClick) {
-                        waitingForSecondClick = true;
-                        lastSetRelease = releaseTime;
-                    } else if ((releaseTime - lastSetRelease) >= DOUBLE_CLICK_TIME) {
-                        // Przełączanie ekranów/pod-ekranów
-                        if (inSubScreen) {
-                            currentSubScreen = (currentSubScreen + 1) % getSubScreenCount(currentMainScreen);
-                        } else {
-                            currentMainScreen = (MainScreen)((currentMainScreen + 1) % MAIN_SCREEN_COUNT);
-                        }
-                        waitingForSecondClick = false;
-                    }
-                }
-            }
-            setPressStartTime = 0;
-            setLongPressExecuted = false;
-            lastDebounceTime = currentTime;
-        }
+// Kliknięcie SET - następny ekran / pod-ekran
+void onButtonNextScreen() {
+    if (inSubScreen) {
+        currentSubScreen = (currentSubScreen + 1) % getSubScreenCount(currentMainScreen);
+    } else {
+        currentMainScreen = (MainScreen)((currentMainScreen + 1) % MAIN_SCREEN_COUNT);
+    }
+}
 
-        // Reset flagi oczekiwania na drugie kliknięcie po upływie czasu
-        if (waitingForSecondClick && (currentTime - lastSetRelease) >= DOUBLE_CLICK_TIME) {
-            // Wykonaj akcję pojedynczego kliknięcia
-            if (inSubScreen) {
-                currentSubScreen = (currentSubScreen + 1) % getSubScreenCount(currentMainScreen);
-            } else {
-                currentMainScreen = (MainScreen)((currentMainScreen + 1) % MAIN_SCREEN_COUNT);
-            }
-            waitingForSecondClick = false;
-        }
+// Podwójne kliknięcie SET - USB na ekranie USB, poza nim wejście/wyjście z pod-ekranów
+void onButtonSetDoubleClick() {
+    if (currentMainScreen == USB_SCREEN) {
+        usbEnabled = !usbEnabled;
+        digitalWrite(UsbPin, usbEnabled ? HIGH : LOW);
+    } else if (inSubScreen) {
+        inSubScreen = false;
+    } else if (hasSubScreens(currentMainScreen)) {
+        inSubScreen = true;
+        currentSubScreen = 0;
     }
+}
 
-    // Obsługa komunikatów powitalnych/pożegnalnych
-    if (messageStartTime > 0 && (currentTime - messageStartTime) >= GOODBYE_DELAY) {
+void onButtonResetTrip() {
+    resetTripData();
+    clearTripData();
+}
+
+// Gesty przycisków: kontekst, przyciski, gest, czas [ms], powtarzanie [ms], obsługa
+const ButtonGesture BUTTON_GESTURES[] = {
+    { BUTTON_CONTEXT_OFF,    BUTTON_MASK_SET,                  GESTURE_LONG_PRESS,   SET_LONG_PRESS,    0, onButtonWake },
+    { BUTTON_CONTEXT_CONFIG, BUTTON_MASK_SET,                  GESTURE_LONG_PRESS,   CONFIG_EXIT_PRESS, 0, deactivateConfigMode },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP | BUTTON_MASK_SET,  GESTURE_COMBO,        COMBO_HOLD_TIME,   0, toggleLegalMode },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET | BUTTON_MASK_DOWN, GESTURE_COMBO,       COMBO_HOLD_TIME,   0, onButtonResetTrip },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP | BUTTON_MASK_DOWN, GESTURE_COMBO,        COMBO_HOLD_TIME,   0, activateConfigMode },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP,                   GESTURE_CLICK,        0,                 0, onButtonAssistUp },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP,                   GESTURE_LONG_PRESS,   LONG_PRESS_TIME,   0, onButtonLights },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN,                 GESTURE_CLICK,        0,                 0, onButtonAssistDown },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN,                 GESTURE_LONG_PRESS,   LONG_PRESS_TIME,   0, onButtonDownHold },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN,                 GESTURE_RELEASE,      0,                 0, onButtonDownRelease },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET,                  GESTURE_CLICK,        0,                 0, onButtonNextScreen },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET,                  GESTURE_DOUBLE_CLICK, DOUBLE_CLICK_TIME, 0, onButtonSetDoubleClick },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET,                  GESTURE_LONG_PRESS,   SET_LONG_PRESS,    0, onButtonGoodbye }
+};
+const uint8_t BUTTON_PINS[BUTTON_COUNT] = { BTN_UP, BTN_DOWN, BTN_SET };
+ButtonManager buttons(BUTTON_GESTURES, sizeof(BUTTON_GESTURES) / sizeof(BUTTON_GESTURES[0]));
+
+// Koniec komunikatu powitalnego/pożegnalnego; po pożegnaniu uśpienie
+void updateMessageTimeout() {
+    if (messageStartTime > 0 && (millis() - messageStartTime) >= GOODBYE_DELAY) {
         if (!showingWelcome) {
             displayActive = false;
             goToSleep();
         }
         messageStartTime = 0;
         showingWelcome = false;
-    }
-}
-
-// sprawdzanie trybu konfiguracji
-void checkConfigMode() {
-    // Dodaj sprawdzenie czy wyświetlacz jest aktywny
-    if (!displayActive) {
-        return; // Jeśli system jest wyłączony, nie aktywuj trybu konfiguracji
-    }
-
-    static unsigned long upDownPressTime = 0;
-    static bool bothButtonsPressed = false;
-
-    if (!digitalRead(BTN_UP) && !digitalRead(BTN_DOWN)) {
-        if (!bothButtonsPressed) {
-            bothButtonsPressed = true;
-            upDownPressTime = millis();
-        } else if ((millis() - upDownPressTime > 500) && !configModeActive) {
-            activateConfigMode();
-        }
-    } else {
-        bothButtonsPressed = false;
+        displayRenderer.invalidate();
     }
 }
 
@@ -2359,10 +1926,6 @@ void activateConfigMode() {
     configModeActive = true;
 
     // Wyłącz wszystkie światła przy wejściu w tryb konfiguracji
-    digitalWrite(FrontDayPin, LOW);
-    digitalWrite(FrontPin, LOW);
-    digitalWrite(RearPin, LOW);
-    //lightMode = 0; // Wymuś tryb świateł na "wyłączone"
     lightManager.setMode(LightManager::OFF);
 
     // 1. Inicjalizacja LittleFS
@@ -2377,17 +1940,13 @@ void activateConfigMode() {
     WiFi.softAP("e-Bike System PMW", "#mamrower");
     DEBUG_INFO("Tryb AP aktywny");
     
-    // 3. Konfiguracja serwera - najpierw pliki statyczne
-    server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
-    
-    // Dodanie obsługi typów MIME
-    server.on("/style.css", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(LittleFS, "/style.css", "text/css");
-    });
-    
-    server.on("/script.js", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(LittleFS, "/script.js", "application/javascript");
-    });
+    // 3. Konfiguracja serwera - najpierw pliki interfejsu (skompresowane, z ETag)
+    if (webAssets.begin(LittleFS)) {
+        server.addHandler(&webAssets);
+    } else {
+        // Pliki wgrane bez tools/build_web.py
+        server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
+    }
 
     server.on("/api/reset-filesystem", HTTP_GET, [](AsyncWebServerRequest *request) {
         bool success = false;
@@ -2405,23 +1964,18 @@ void activateConfigMode() {
             DEBUG_INFO("Formatowanie systemu plików nie powiodło się");
         }
         
-        StaticJsonDocument<128> doc;
-        doc["success"] = success;
-        doc["message"] = success ? "System plikow zresetowany pomyslnie" : "Blad resetowania systemu plikow";
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        ApiResponse response(request);
+        response.json().beginObject()
+            .field("success", success)
+            .field("message", success ? "System plikow zresetowany pomyslnie" : "Blad resetowania systemu plikow")
+            .endObject();
+        response.send();
     });
 
     server.on("/api/version", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<200> doc;
-        doc["version"] = VERSION;
-        
-        String response;
-        serializeJson(doc, response);
-        
-        request->send(200, "application/json", response);
+        ApiResponse response(request);
+        response.json().beginObject().field("version", VERSION).endObject();
+        response.send();
     });
 
     // 4. Dodanie endpointów API
@@ -2443,7 +1997,8 @@ void deactivateConfigMode() {
     configModeActive = false;
     
     display.clearBuffer();
-    display.sendBuffer();
+    displayRenderer.present();
+    displayRenderer.invalidate();
 }
 
 // przełączanie trybu legal
@@ -2456,11 +2011,12 @@ void toggleLegalMode() {
     drawCenteredText("zostal", 35, czcionka_srednia);
     drawCenteredText(legalMode ? "wlaczony" : "wylaczony", 50, czcionka_srednia);
     
-    display.sendBuffer();
+    displayRenderer.present();
     delay(1500);
     
     display.clearBuffer();
-    display.sendBuffer();
+    displayRenderer.present();
+    displayRenderer.invalidate();
 }
 
 // --- Funkcje pomocnicze ---
@@ -2495,59 +2051,83 @@ int getSubScreenCount(MainScreen screen) {
 }
 
 void resetTripData() {
-    speed_avg_kmh = 0;
-    speed_max_kmh = 0;
     distance_km = 0;
-    cadence_avg_rpm = 0;
-    cadence_max_rpm = 0;
-    cadence_sum = 0;
-    cadence_samples = 0;
-    power_avg_w = 0;
-    power_max_w = 0;
-    
-    // Zresetuj liczniki używane do obliczania średnich
-    speed_sum = 0;
-    speed_count = 0;
+    tripMetrics.reset();
+    energy.resetTrip();
+    settingsStore.markDirty(SETTINGS_TRIP);
+    settingsStore.markDirty(SETTINGS_ENERGY);
+
+    // Zamknij zapis przejazdu - kolejny ruch rozpocznie nowy plik
+    rideRecorder.finishRide();
     
     DEBUG_INFO("Zresetowano dane przejazdu");
 }
 
 //
 void setCadencePulsesPerRevolution(uint8_t pulses) {
-    if (pulses >= 1 && pulses <= 24) {
+    if (pulses >= 1 && pulses <= CADENCE_MAX_PULSES_PER_REV) {
         cadence_pulses_per_revolution = pulses;
-        preferences.begin("cadence", false);
-        preferences.putUChar("pulses", pulses);
-        preferences.end();
+        cadenceFilter.setPulsesPerRevolution(pulses);
+        updateCadenceDebounce();
+        generalSettings.cadencePulses = pulses;
+        settingsStore.markDirty(SETTINGS_GENERAL);
         DEBUG_INFO("Ustawiono %d impulsow na obrot korby", pulses);
     } else {
-        DEBUG_ERROR("Bledna wartosc dla impulsow na obrot (dozwolony zakres: 1-24)");
+        DEBUG_ERROR("Bledna wartosc dla impulsow na obrot (dozwolony zakres: 1-%d)", CADENCE_MAX_PULSES_PER_REV);
     }
 }
 
 // tryb uśpienia
 void goToSleep() {
     DEBUG_INFO("Wchodze w tryb glebokiego uspienia (DEEP SLEEP)...");
-    //DEBUG_INFO("Aktualny tryb swiatel: %d", (int)lightManager.getMode());
+
+    // Zapis plików tylko z tego rdzenia - zadanie usług kończy bieżące zadanie i staje
+    stopServiceTask();
+
+    // Uśpienie przed odłożonym startem - pliki są potrzebne do zapisu
+    if (settingsReady && !storageReady) {
+        startStorage();
+    }
+
+    // Zapisz niepełny blok przejazdu i niezapisane metry licznika
+    if (storageReady) {
+        rideRecorder.finishRide();
+        odometer.flush();
+    }
+    publishPersistSnapshots();  // Stan z ostatnich ms przed zapisem
+    settingsStore.markDirty(SETTINGS_ENERGY);
+    settingsStore.markDirty(SETTINGS_TRIP);
+    settingsStore.flush();
+    //DEBUG_INFO("Aktualny tryb swiatel: %d", (int)lightManager.getMode());
+
+    // Stan do szybkiego wybudzenia - po zapisie ustawień, przed wyłączeniem świateł
+    if (settingsReady) {
+        saveSleepSnapshot();
+    } else {
+        SleepSnapshot::invalidate();
+    }
 
     // Wyłącz wszystkie LEDy
-    digitalWrite(FrontDayPin, LOW);
-    digitalWrite(FrontPin, LOW);
-    digitalWrite(RearPin, LOW);
+    lightManager.shutdown();
     digitalWrite(UsbPin, LOW);
 
     delay(50);
 
     // Wyłącz OLED
     display.clearBuffer();
-    display.sendBuffer();
-    display.setPowerSave(1);  // Wprowadź OLED w tryb oszczędzania energii
+    displayRenderer.present();
+    displayRenderer.waitIdle(DISPLAY_FLUSH_WAIT_MS);
+    {
+        I2cBusLock lock;
+        display.setPowerSave(1);  // Wprowadź OLED w tryb oszczędzania energii
+    }
 
     // Zapisz stan trybu świateł przed uśpieniem
     // Już nie jest potrzebne - LightManager zapisuje stan automatycznie
 
     //DEBUG_INFO("Konfiguracja wybudzania przez przycisk SET (GPIO12)");
     DEBUG_INFO("Przechodze do DEEP SLEEP. Do zobaczenia po wybudzeniu!");
+    DebugLog::flush();  // Wpisy z pierścienia przed uśpieniem
     Serial.flush(); // Upewnij się, że wszystkie dane zostały wysłane
 
     // Konfiguracja wybudzania przez przycisk SET
@@ -2606,198 +2186,16 @@ void applyBacklightSettings() {
     displayBrightness = map(targetBrightness, 0, 100, 0, 255);
     
     // Zastosuj jasność do wyświetlacza
-    display.setContrast(displayBrightness);
-    
-    DEBUG_LIGHT("  Zastosowano jasnosc: %d (kontrast: %d)", targetBrightness, displayBrightness);
-}
-
-void printLightConfigFile() {
-    if (!LittleFS.begin(false)) {
-        DEBUG_ERROR("Blad montowania systemu plikow");
-        return;
-    }
-    
-    if (LittleFS.exists("/light_config.json")) {
-        File file = LittleFS.open("/light_config.json", "r");
-        if (file) {
-            DEBUG_INFO("=== ZAWARTOSC PLIKU KONFIGURACYJNEGO SWIATEL ===");
-            while (file.available()) {
-                Serial.write(file.read());
-            }
-
-            file.close();
-        } else {
-            DEBUG_INFO("Nie można otworzyc pliku konfiguracyjnego");
-        }
-    } else {
-        DEBUG_ERROR("Plik konfiguracyjny /light_config.json nie istnieje");
+    {
+        I2cBusLock lock;
+        display.setContrast(displayBrightness);
     }
     
-    // Sprawdź też stary plik
-    if (LittleFS.exists("/lights.json")) {
-        File file = LittleFS.open("/lights.json", "r");
-        if (file) {
-            DEBUG_INFO("=== ZAWARTOSC STAREGO PLIKU KONFIGURACYJNEGO ===");
-            while (file.available()) {
-                Serial.write(file.read());
-            }
-
-            file.close();
-        }
-    }
-}
-
-// sprawdzanie poprawności temperatury
-bool isValidTemperature(float temp) {
-    return (temp >= -50.0 && temp <= 100.0);
-}
-
-// obsługa temperatury
-void handleTemperature() {
-    unsigned long currentMillis = millis();
-
-    if (!conversionRequested && (currentMillis - lastTempRequest >= TEMP_REQUEST_INTERVAL)) {
-        // Żądanie konwersji z obu czujników
-        sensorsAir.requestTemperatures();
-        sensorsController.requestTemperatures();
-        conversionRequested = true;
-        lastTempRequest = currentMillis;
-    }
-
-    if (conversionRequested && (currentMillis - lastTempRequest >= 750)) {
-        // Odczyt z obu czujników
-        currentTemp = sensorsAir.getTempCByIndex(0);
-        temp_controller = sensorsController.getTempCByIndex(0);
-        conversionRequested = false;
-    }
+    DEBUG_LIGHT("  Zastosowano jasnosc: %d (kontrast: %d)", targetBrightness, displayBrightness);
 }
 
 // --- Funkcje konfiguracji systemu ---
 
-// wczytywanie wszystkich ustawień
-void loadSettings() {
-    File configFile = LittleFS.open("/config.json", "r");
-    if (!configFile) {
-        DEBUG_INFO("Nie udalo sie otworzyc pliku konfiguracyjnego");
-        return;
-    }
-
-    StaticJsonDocument<1024> doc;
-    DeserializationError error = deserializeJson(doc, configFile);
-
-    if (error) {
-        DEBUG_INFO("Nie udalo sie przetworzyc pliku konfiguracyjnego");
-        return;
-    }
-
-    // Wczytywanie ustawień świateł - teraz to obsługuje LightManager
-    // Nie musimy już ładować lightSettings z pliku
-
-    // Wczytywanie ustawień podświetlenia
-    if (doc.containsKey("backlight")) {
-        backlightSettings.dayBrightness = doc["backlight"]["dayBrightness"] | 100;
-        backlightSettings.nightBrightness = doc["backlight"]["nightBrightness"] | 50;
-        backlightSettings.autoMode = doc["backlight"]["autoMode"] | false;
-    }
-
-    // Wczytywanie ustawień WiFi
-    if (doc.containsKey("wifi")) {
-        strlcpy(wifiSettings.ssid, doc["wifi"]["ssid"] | "", sizeof(wifiSettings.ssid));
-        strlcpy(wifiSettings.password, doc["wifi"]["password"] | "", sizeof(wifiSettings.password));
-    }
-
-    // Wczytywanie ustawień sterownika
-    if (doc.containsKey("controller")) {
-        controllerSettings.type = doc["controller"]["type"] | "kt-lcd";
-        
-        if (controllerSettings.type == "kt-lcd") {
-            for (int i = 1; i <= 5; i++) {
-                controllerSettings.ktParams[i-1] = doc["controller"]["p"][String(i)] | 0;
-            }
-            for (int i = 1; i <= 15; i++) {
-                controllerSettings.ktParams[i+4] = doc["controller"]["c"][String(i)] | 0;
-            }
-            for (int i = 1; i <= 3; i++) {
-                controllerSettings.ktParams[i+19] = doc["controller"]["l"][String(i)] | 0;
-            }
-        } else {
-            for (int i = 1; i <= 20; i++) {
-                controllerSettings.s866Params[i-1] = doc["controller"]["p"][String(i)] | 0;
-            }
-        }
-    }
-
-    configFile.close();
-}
-
-// zapis wszystkich ustawień
-void saveSettings() {
-    StaticJsonDocument<1024> doc;
-
-    // Zapisywanie ustawień czasu
-    JsonObject timeObj = doc.createNestedObject("time");
-    timeObj["ntpEnabled"] = timeSettings.ntpEnabled;
-    timeObj["hours"] = timeSettings.hours;
-    timeObj["minutes"] = timeSettings.minutes;
-    timeObj["seconds"] = timeSettings.seconds;
-    timeObj["day"] = timeSettings.day;
-    timeObj["month"] = timeSettings.month;
-    timeObj["year"] = timeSettings.year;
-
-    // Zapisywanie ustawień świateł - teraz to obsługuje LightManager
-    JsonObject lightObj = doc.createNestedObject("light");
-    // Użyj wartości z lightManager
-    lightObj["dayLights"] = (int)lightManager.getDayConfig();
-    lightObj["nightLights"] = (int)lightManager.getNightConfig();
-    lightObj["dayBlink"] = lightManager.getDayBlink();
-    lightObj["nightBlink"] = lightManager.getNightBlink();
-    lightObj["blinkFrequency"] = lightManager.getBlinkFrequency();
-
-    // Zapisywanie ustawień podświetlenia
-    JsonObject backlightObj = doc.createNestedObject("backlight");
-    backlightObj["dayBrightness"] = backlightSettings.dayBrightness;
-    backlightObj["nightBrightness"] = backlightSettings.nightBrightness;
-    backlightObj["autoMode"] = backlightSettings.autoMode;
-
-    // Zapisywanie ustawień WiFi
-    JsonObject wifiObj = doc.createNestedObject("wifi");
-    wifiObj["ssid"] = wifiSettings.ssid;
-    wifiObj["password"] = wifiSettings.password;
-
-    // Zapisywanie ustawień sterownika
-    JsonObject controllerObj = doc.createNestedObject("controller");
-    controllerObj["type"] = controllerSettings.type;
-    
-    JsonObject paramsObj = controllerObj.createNestedObject("params");
-    if (controllerSettings.type == "kt-lcd") {
-      for (int i = 1; i <= 5; i++) {
-        paramsObj["p"][String(i)] = controllerSettings.ktParams[i-1];
-      }
-      for (int i = 1; i <= 15; i++) {
-        paramsObj["c"][String(i)] = controllerSettings.ktParams[i+4];
-      }
-      for (int i = 1; i <= 3; i++) {
-        paramsObj["l"][String(i)] = controllerSettings.ktParams[i+19];
-      }
-    } else {
-      for (int i = 1; i <= 20; i++) {
-        paramsObj["p"][String(i)] = controllerSettings.s866Params[i-1];
-      }
-    }
-
-    File configFile = LittleFS.open("/config.json", "w");
-    if (!configFile) {
-        DEBUG_INFO("Nie udalo sie otworzyc pliku konfiguracyjnego do zapisu");
-        return;
-    }
-
-    if (serializeJson(doc, configFile) == 0) {
-        DEBUG_INFO("Nie udalo sie zapisac pliku konfiguracyjnego");
-    }
-
-    configFile.close();
-}
-
 // konwersja parametru na indeks
 int getParamIndex(const String& param) {
     if (param.startsWith("p")) {
@@ -2812,12 +2210,12 @@ int getParamIndex(const String& param) {
 
 // aktualizacja parametrów kontrolera
 void updateControllerParam(const String& param, int value) {
-    if (controllerSettings.type == "kt-lcd") {
+    if (strcmp(controllerSettings.type, "kt-lcd") == 0) {
         int index = getParamIndex(param);
         if (index >= 0 && index < 23) { // 5 (P) + 15 (C) + 3 (L) = 23 parametry
             controllerSettings.ktParams[index] = value;
         }
-    } else if (controllerSettings.type == "s866") {
+    } else if (strcmp(controllerSettings.type, "s866") == 0) {
         if (param.startsWith("p")) {
             int index = param.substring(1).toInt() - 1;
             if (index >= 0 && index < 20) {
@@ -2825,7 +2223,7 @@ void updateControllerParam(const String& param, int value) {
             }
         }
     }
-    saveSettings();
+    settingsStore.markDirty(SETTINGS_CONTROLLER);
 }
 
 // konwersja trybu świateł na string
@@ -2841,132 +2239,59 @@ const char* getLightModeString(LightSettings::LightMode mode) {
 
 // --- Funkcje serwera WWW ---
 
-// Funkcja do pobierania wartości licznika
-float getOdometerValue() {
-    if (!LittleFS.begin(false)) {
-        DEBUG_ERROR("Blad montowania LittleFS");
-        return 0.0;
-    }
-    
-    if (!LittleFS.exists("/odometer.json")) {
-        DEBUG_ERROR("Nie znaleziono pliku licznika");
-        return 0.0;
-    }
-    
-    File file = LittleFS.open("/odometer.json", "r");
-    if (!file) {
-        DEBUG_ERROR("Nie udalo sie otworzyc pliku licznika do odczytu");
-        return 0.0;
-    }
-    
-    StaticJsonDocument<64> doc;
-    DeserializationError error = deserializeJson(doc, file);
-    file.close();
-    
-    if (error) {
-        DEBUG_ERROR("Nie udalo sie przetworzyc pliku licznika");
-        return 0.0;
-    }
-    
-    return doc["value"];
-}
-
-// Funkcja do zapisywania wartości licznika
-bool saveOdometerValue(float value) {
-    if (!LittleFS.begin(false)) {
-        DEBUG_ERROR("Blad montowania LittleFS");
-        return false;
-    }
-    
-    // Usuń istniejący plik
-    if (LittleFS.exists("/odometer.json")) {
-        LittleFS.remove("/odometer.json");
-    }
-    
-    File file = LittleFS.open("/odometer.json", "w");
-    if (!file) {
-        DEBUG_ERROR("Nie udalo sie otworzyc pliku licznika do zapisu");
-        return false;
-    }
-    
-    StaticJsonDocument<64> doc;
-    doc["value"] = value;
-    
-    size_t bytes = serializeJson(doc, file);
-    file.close();
-    
-    if (bytes == 0) {
-        DEBUG_ERROR("Nie udalo sie zapisac pliku licznika");
-        return false;
-    }
-    
-    return true;
-}
-
 // konfiguracja serwera WWW
 void setupWebServer() {
-    // Serwowanie plików statycznych
-    server.serveStatic("/", LittleFS, "/");
-
+    // Lista plików dowolnej długości - wysyłana porcjami, po jednym pliku
     server.on("/api/filesystem/status", HTTP_GET, [](AsyncWebServerRequest* request) {
-        StaticJsonDocument<512> doc;
-        
-        // Informacje o systemie plików
-        doc["totalBytes"] = LittleFS.totalBytes();
-        doc["usedBytes"] = LittleFS.usedBytes();
-        doc["freeBytes"] = LittleFS.totalBytes() - LittleFS.usedBytes();
-        
-        // Lista plików
-        JsonArray files = doc.createNestedArray("files");
-        File root = LittleFS.open("/");
-        File file = root.openNextFile();
-        
-        while (file) {
-            JsonObject fileObj = files.createNestedObject();
-            fileObj["name"] = file.name();
-            fileObj["size"] = file.size();
-            fileObj["isDir"] = file.isDirectory();
-            file = root.openNextFile();
-        }
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        ApiResponse::sendChunked(request, std::make_shared<JsonDirectoryList>(LittleFS, "/", "files",
+            [](JsonWriter& json) {
+                // Informacje o systemie plików
+                json.field("totalBytes", LittleFS.totalBytes());
+                json.field("usedBytes", LittleFS.usedBytes());
+                json.field("freeBytes", LittleFS.totalBytes() - LittleFS.usedBytes());
+            },
+            [](JsonWriter& json, File& file) {
+                json.beginObject()
+                    .field("name", file.name())
+                    .field("size", file.size())
+                    .field("isDir", file.isDirectory())
+                    .endObject();
+            }));
     });
 
     // Dodaj endpoint do otrzymania informacji diagnostycznych
     server.on("/api/debug-odometer", HTTP_GET, [](AsyncWebServerRequest *request) {
-        #ifdef DEBUG_INFO_ENABLED
-        //odometer.debugPreferences();
-        #endif
-        
-        StaticJsonDocument<256> doc;
-        doc["isValid"] = odometer.isValid();
-        doc["currentValue"] = odometer.getRawTotal();
-        
-        // Dodaj informacje o preferencjach
-        preferences.begin("system", true);
-        JsonObject prefsInfo = doc.createNestedObject("preferences");
-        prefsInfo["freeEntries"] = preferences.freeEntries();
-        preferences.end();
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("isValid", odometer.isValid());
+        json.field("currentValue", odometer.getRawTotal());
+
+        // Stan dziennika licznika
+        json.beginObject("journal");
+        json.field("activeFile", odometer.getActiveFile());
+        json.field("recordsInFile", odometer.getRecordsInFile());
+        json.field("maxRecords", ODOMETER_MAX_RECORDS);
+        json.field("sequence", odometer.getSequence());
+        json.field("writesSinceBoot", odometer.getWriteCount());
+        json.endObject();
         
         // Dodaj informacje o systemie plików
-        JsonObject fsInfo = doc.createNestedObject("filesystem");
-        fsInfo["totalBytes"] = LittleFS.totalBytes();
-        fsInfo["usedBytes"] = LittleFS.usedBytes();
-        fsInfo["freeBytes"] = LittleFS.totalBytes() - LittleFS.usedBytes();
-        fsInfo["odometerFileExists"] = LittleFS.exists("/odometer.json");
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        json.beginObject("filesystem");
+        json.field("totalBytes", LittleFS.totalBytes());
+        json.field("usedBytes", LittleFS.usedBytes());
+        json.field("freeBytes", LittleFS.totalBytes() - LittleFS.usedBytes());
+        json.field("legacyFileExists", LittleFS.exists(ODOMETER_LEGACY_FILE));
+        json.endObject();
+
+        json.endObject();
+        response.send();
     });
 
     // Licznik całkowity 
     // Endpoint do pobierania wartości licznika
     server.on("/api/odometer", HTTP_GET, [](AsyncWebServerRequest *request) {
-        float value = getOdometerValue();
-        request->send(200, "text/plain", String(value));
+        request->send(200, "text/plain", String(odometer.getRawTotal()));
     });
 
     // Endpoint do ustawiania wartości licznika
@@ -2975,7 +2300,12 @@ void setupWebServer() {
             String valueStr = request->getParam("value", true)->value();
             float value = valueStr.toFloat();
             
-            bool success = saveOdometerValue(value);
+            // Formularz odsyła wartość zaokrągloną w dół - bez zmiany nie nadpisujemy
+            // metrów przejechanych ponad pełny kilometr
+            bool success = true;
+            if ((uint32_t)value != (uint32_t)odometer.getRawTotal()) {
+                success = odometer.setInitialValue(value);
+            }
             
             if (success) {
                 request->send(200, "text/plain", "OK");
@@ -2989,92 +2319,531 @@ void setupWebServer() {
 
     // Światła
     server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest* request) {
-        DynamicJsonDocument doc(1024);
-        JsonObject root = doc.to<JsonObject>();
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
         
         // Dodaj obiekt lights z konfiguracją
-        JsonObject lights = doc.createNestedObject("lights");
-        lights["dayLights"] = lightManager.getConfigString(lightManager.getDayConfig());
-        lights["nightLights"] = lightManager.getConfigString(lightManager.getNightConfig());
-        lights["dayBlink"] = lightManager.getDayBlink();
-        lights["nightBlink"] = lightManager.getNightBlink();
-        lights["blinkFrequency"] = lightManager.getBlinkFrequency();
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        json.beginObject("lights");
+        json.field("dayLights", lightManager.getConfigString(lightManager.getDayConfig()));
+        json.field("nightLights", lightManager.getConfigString(lightManager.getNightConfig()));
+        json.field("dayBlink", lightManager.getDayBlink());
+        json.field("nightBlink", lightManager.getNightBlink());
+        json.field("blinkFrequency", lightManager.getBlinkFrequency());
+        json.endObject();
+
+        json.endObject();
+        response.send();
     });
 
-    server.on("/api/lights/file", HTTP_GET, [](AsyncWebServerRequest *request) {
+    // Statystyki magazynu ustawień - liczniki zapisu liczone od początku sesji konfiguracji
+    server.on("/api/settings/status", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("loadUs", settingsStore.getLoadUs());
+        json.field("generation", settingsStore.getGeneration());
+        json.field("windowMs", settingsStore.getStatsAgeMs());
+        json.field("dirtyMarks", settingsStore.getDirtyMarks());
+        json.field("flashWrites", settingsStore.getFlashWrites());
+        json.field("skippedWrites", settingsStore.getSkippedWrites());
+        json.field("bytesWritten", settingsStore.getBytesWritten());
+        json.field("lastWriteUs", settingsStore.getLastWriteUs());
+        json.field("pending", settingsStore.isDirty());
+        json.endObject();
+
+        if (request->hasParam("reset")) {
+            settingsStore.resetStats();
+        }
+
+        response.send();
+    });
+
+    // Dane BMS - spójna migawka ostatnich odpowiedzi
+    server.on("/api/bms", HTTP_GET, [](AsyncWebServerRequest* request) {
+        BmsData data;
+        bool valid = bms.read(data);
+
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("connected", bleClient && bleClient->isConnected());
+        json.field("valid", valid);
+        if (valid) {
+            json.field("voltage", data.voltage);
+            json.field("current", data.current);
+            json.field("remainingCapacity", data.remainingCapacity);
+            json.field("totalCapacity", data.totalCapacity);
+            json.field("soc", data.soc);
+            json.field("cycles", data.cycles);
+            json.field("charging", data.charging);
+            json.field("discharging", data.discharging);
+
+            json.beginArray("cells");
+            for (uint8_t i = 0; i < data.cellCount; i++) {
+                json.item(data.cellVoltages[i]);
+            }
+            json.endArray();
+            json.beginArray("temperatures");
+            for (uint8_t i = 0; i < data.tempCount; i++) {
+                json.item(data.temperatures[i]);
+            }
+            json.endArray();
+        }
+
+        json.beginObject("stats");
+        json.field("frames", bms.getFramesOk());
+        json.field("checksumErrors", bms.getChecksumErrors());
+        json.field("framingErrors", bms.getFramingErrors());
+        json.field("bytesDropped", bms.getBytesDropped());
+        json.endObject();
+
+        json.endObject();
+        response.send();
+    });
+
+    // Temperatury, adresy czujników i czasy kroków pomiaru (?reset=1 zeruje czasy)
+    server.on("/api/temperature", HTTP_GET, [](AsyncWebServerRequest* request) {
+        static const char* const CHANNEL_NAMES[TEMP_CHANNEL_COUNT] = { "air", "controller", "motor" };
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+
+        json.beginObject("channels");
+        for (uint8_t i = 0; i < TEMP_CHANNEL_COUNT; i++) {
+            TemperatureChannel channel = (TemperatureChannel)i;
+            json.beginObject(CHANNEL_NAMES[i]);
+            json.field("present", temperatures.isPresent(channel));
+            if (temperatures.get(channel) != TEMP_INVALID) {
+                json.field("value", temperatures.get(channel));
+            }
+            json.field("errors", temperatures.getErrors(channel));
+            if (channel != TEMP_CHANNEL_MOTOR) {
+                char address[24];
+                temperatures.formatAddress(channel, address, sizeof(address));
+                json.field("address", address);
+            }
+            json.endObject();
+        }
+        json.endObject();
+        json.field("ntcMilliVolts", temperatures.getNtcMilliVolts());
+
+        json.beginObject("maxUs");
+        json.field("call", temperatures.getMaxCallUs());
+        for (uint8_t i = 0; i < TEMP_STEP_COUNT; i++) {
+            TemperatureStep step = (TemperatureStep)i;
+            json.field(TemperatureManager::getStepName(step), temperatures.getMaxStepUs(step));
+        }
+        json.endObject();
+
+        json.endObject();
+        if (request->hasParam("reset")) {
+            temperatures.resetTiming();
+        }
+
+        response.send();
+    });
+
+    // Opóźnienia obsługi przycisków (?reset=1 zeruje)
+    server.on("/api/buttons", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        response.json().beginObject()
+            .field("events", buttons.getEventCount())
+            .field("maxDetectUs", buttons.getMaxDetectUs())
+            .field("maxDispatchUs", buttons.getMaxDispatchUs())
+            .field("avgDispatchUs", buttons.getAvgDispatchUs())
+            .field("dropped", buttons.getDroppedEvents())
+            .endObject();
+        if (request->hasParam("reset")) {
+            buttons.resetStats();
+        }
+
+        response.send();
+    });
+
+    // Zużycie energii i szacowany zasięg
+    server.on("/api/energy", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("powerW", energy.getPowerW());
+        json.field("tripWh", energy.getTripWh());
+        json.field("tripWhPerKm", energy.getTripWhPerKm());
+        json.field("rollingWhPerKm", energy.getRollingWhPerKm());
+        json.field("rollingKm", energy.getRollingKm());
+        json.field("whPerKm", energy.getWhPerKm());
+        json.field("totalWh", energy.getTotalWh());
+        json.field("remainingWh", battery_capacity_wh);
+        json.field("rangeKm", range_km);
+        json.endObject();
+        response.send();
+    });
+
+    // Statystyki przejazdu - średnie ważone czasem, maksima, rozrzut
+    server.on("/api/trip", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("distanceKm", distance_km);
+        json.beginObject("metrics");
+        TripMetrics trip;  // Migawka - statystyki zmienia pętla główna na drugim rdzeniu
+        tripSnapshot.read(trip);
+        trip.toJson(json);
+        json.endObject();
+        json.endObject();
+        response.send();
+    });
+
+    // Stan czujników TPMS i harmonogramu skanowania (?reset=1 zeruje liczniki)
+    server.on("/api/tpms", HTTP_GET, [](AsyncWebServerRequest* request) {
+        unsigned long now = millis();
+
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("enabled", bluetoothConfig.tpmsEnabled);
+        json.field("scanning", tpmsScanning);
+        json.field("parked", tpmsScheduler.isParked());
+        json.field("dutyCyclePermille", tpmsScheduler.getDutyCyclePermille(now));
+        json.field("windows", tpmsScheduler.getWindows());
+        json.field("searches", tpmsScheduler.getSearches());
+        json.field("misses", tpmsScheduler.getMisses());
+        json.field("advertsSeen", tpmsReceiver.getAdvertsSeen());
+        json.field("advertsAccepted", tpmsReceiver.getAdvertsAccepted());
+
+        const TpmsData* data[TPMS_SENSOR_COUNT] = { &frontTpms, &rearTpms };
+        const char* names[TPMS_SENSOR_COUNT] = { "front", "rear" };
+        for (uint8_t i = 0; i < TPMS_SENSOR_COUNT; i++) {
+            json.beginObject(names[i]);
+            json.field("active", data[i]->isActive);
+            json.field("pressure", data[i]->pressure);
+            json.field("temperature", data[i]->temperature);
+            json.field("battery", data[i]->batteryPercent);
+            json.field("periodMs", tpmsScheduler.getPeriodMs(i));
+            json.field("missStreak", tpmsScheduler.getMissStreak(i));
+            uint32_t freshness = tpmsScheduler.getFreshnessMs(i, now);
+            if (freshness != UINT32_MAX) {
+                json.field("freshnessMs", freshness);
+            }
+            json.endObject();
+        }
+        json.endObject();
+
+        if (request->hasParam("reset")) {
+            tpmsScheduler.resetStats(now);
+        }
+
+        response.send();
+    });
+
+    // Diagnostyka harmonogramu zadań (?reset=1 zeruje liczniki)
+    server.on("/api/scheduler", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("uptimeMs", millis());
+        json.field("windowMs", millis() - scheduler.getStatsStartMs());
+        json.field("idleMs", scheduler.getIdleMs());
+        json.field("serviceIdleMs", serviceScheduler.getIdleMs());
+        json.field("rideSnapshotVersion", rideSnapshot.getVersion());
+        json.field("serviceSnapshotVersion", serviceSnapshot.getVersion());
+
+        // Zadania obu rdzeni; "core" - rdzeń ESP32
+        json.beginArray("tasks");
+        const TaskScheduler* schedulers[] = { &serviceScheduler, &scheduler };
+        for (uint8_t core = 0; core < 2; core++) {
+            for (uint8_t i = 0; i < schedulers[core]->getTaskCount(); i++) {
+                const TaskScheduler::Task& task = schedulers[core]->getTask(i);
+                json.beginObject();
+                json.field("name", task.name);
+                json.field("core", core);
+                json.field("periodMs", task.periodUs / 1000);
+                json.field("priority", (int)task.priority);
+                json.field("enabled", task.enabled);
+                json.field("runs", task.runs);
+                json.field("lastRunUs", task.lastRunUs);
+                json.field("maxRunUs", task.maxRunUs);
+                json.field("maxLatenessUs", task.maxLatenessUs);
+                json.field("misses", task.misses);
+                json.field("overruns", task.overruns);
+                json.endObject();
+            }
+        }
+        json.endArray();
+        json.endObject();
+
+        if (request->hasParam("reset")) {
+            scheduler.resetStats();
+            serviceScheduler.resetStats();
+        }
+
+        response.send();
+    });
+
+    // Profiler: histogramy czasu sekcji, sterta i zapas stosu zadań (?reset zeruje po odczycie)
+    server.on("/api/perf", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("cpuMhz", getCpuFrequencyMhz());
+        json.field("uptimeMs", millis());
+        json.field("windowMs", millis() - Profiler::getStatsStartMs());
+        json.field("profiling", PROFILING);
+
+        json.beginObject("heap");
+        json.field("free", ESP.getFreeHeap());
+        json.field("minFree", ESP.getMinFreeHeap());
+        json.field("largestBlock", ESP.getMaxAllocHeap());
+        json.endObject();
+
+        // Czasy startu od uruchomienia programu; holdUs to czekanie na przytrzymanie SET
+        json.beginObject("boot");
+        json.field("resumed", bootTiming.resumed);
+        json.field("restoreUs", bootTiming.restoreUs);
+        json.field("settingsUs", bootTiming.settingsUs);
+        json.field("holdUs", bootTiming.holdUs);
+        json.field("setupUs", bootTiming.setupUs);
+        json.field("firstFrameUs", bootTiming.firstFrameUs);
+        json.field("deferredUs", bootTiming.deferredUs);
+        json.endObject();
+
+        // Pliki interfejsu od włączenia trybu konfiguracji
+        const WebAssets::Stats& webStats = webAssets.getStats();
+        json.beginObject("web");
+        json.field("assets", webAssets.getCount());
+        json.field("requests", webStats.requests);
+        json.field("notModified", webStats.notModified);
+        json.field("bytesSent", webStats.bytesSent);
+        json.endObject();
+
+        // Odpowiedzi JSON od ostatniego ?reset; sterta mierzona przy wysyłaniu każdej z nich
+        const ApiResponse::Stats& apiStats = ApiResponse::getStats();
+        json.beginObject("api");
+        json.field("responses", apiStats.responses);
+        json.field("chunked", apiStats.chunked);
+        json.field("bytes", apiStats.bytes);
+        json.field("maxBytes", apiStats.maxBytes);
+        json.field("minFreeHeap", apiStats.minFreeHeap);
+        json.field("minLargestBlock", apiStats.minLargestBlock);
+        json.field("overflows", apiStats.overflows);
+        json.endObject();
+
+        // Zapas stosu w bajtach (najmniejszy od startu zadania)
+        json.beginArray("tasks");
+        for (uint8_t i = 0; i < Profiler::getTaskCount(); i++) {
+            const Profiler::TaskInfo& task = Profiler::getTask(i);
+            json.beginObject();
+            json.field("name", task.name);
+            json.field("stackFree", uxTaskGetStackHighWaterMark(task.handle));
+            json.endObject();
+        }
+        json.endArray();
+
+        // "buckets" od przedziału "firstBucket"; przedział i to [2^i, 2^(i+1)) cykli
+        json.beginArray("sections");
+        uint32_t cyclesPerUs = getCpuFrequencyMhz();
+        for (uint8_t i = 0; i < PERF_SECTION_COUNT; i++) {
+            Profiler::Section section;
+            Profiler::read((PerfSection)i, section);
+
+            json.beginObject();
+            json.field("name", Profiler::getName((PerfSection)i));
+            json.field("count", section.count);
+            json.field("totalUs", (uint32_t)(section.totalCycles / cyclesPerUs));
+            json.field("avgUs", section.count > 0 ? (uint32_t)(section.totalCycles / section.count / cyclesPerUs) : 0);
+            json.field("maxUs", section.maxCycles / cyclesPerUs);
+
+            int8_t first = -1;
+            int8_t last = -1;
+            for (uint8_t b = 0; b < Profiler::BUCKET_COUNT; b++) {
+                if (section.buckets[b] > 0) {
+                    if (first < 0) first = b;
+                    last = b;
+                }
+            }
+            json.field("firstBucket", first < 0 ? 0 : first);
+            json.beginArray("buckets");
+            for (int8_t b = first; first >= 0 && b <= last; b++) {
+                json.item(section.buckets[b]);
+            }
+            json.endArray();
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+
+        if (request->hasParam("reset")) {
+            Profiler::reset();
+            ApiResponse::resetStats();
+        }
+
+        response.send();
+    });
+
+    // Poziomy logów dla kategorii i wyjście (tekst/binarne), z licznikami pierścienia
+    server.on("/api/log", HTTP_GET, [](AsyncWebServerRequest* request) {
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.beginObject("levels");
+        for (uint8_t i = 0; i < DebugLog::CATEGORY_COUNT; i++) {
+            DebugLog::Category category = (DebugLog::Category)i;
+            json.field(DebugLog::getCategoryName(category), (int)DebugLog::getLevel(category));
+        }
+        json.endObject();
+        json.field("binary", DebugLog::getOutput() == DebugLog::OUTPUT_BINARY);
+
+        DebugLog::Stats stats = DebugLog::getStats();
+        json.field("written", stats.written);
+        json.field("dropped", stats.dropped);
+        json.field("drained", stats.drained);
+        json.field("maxUsed", stats.maxUsed);
+        json.field("capacity", stats.capacity);
+        json.endObject();
+        response.send();
+    });
+
+    // {"levels": {"light": 4, ...}, "binary": false}; poziomy 0 (wył.) - 4 (szczegóły)
+    server.on("/api/log", HTTP_POST, [](AsyncWebServerRequest* request) {}, NULL,
+        [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            StaticJsonDocument<256> doc;
+            if (deserializeJson(doc, (const char*)data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+
+            JsonObject levels = doc["levels"];
+            for (uint8_t i = 0; i < DebugLog::CATEGORY_COUNT; i++) {
+                DebugLog::Category category = (DebugLog::Category)i;
+                if (levels.containsKey(DebugLog::getCategoryName(category))) {
+                    int level = constrain(levels[DebugLog::getCategoryName(category)].as<int>(),
+                                          DebugLog::LEVEL_OFF, DebugLog::LEVEL_DETAIL);
+                    DebugLog::setLevel(category, (DebugLog::Level)level);
+                }
+            }
+            if (doc.containsKey("binary")) {
+                DebugLog::setOutput(doc["binary"].as<bool>() ? DebugLog::OUTPUT_BINARY : DebugLog::OUTPUT_TEXT);
+            }
+
+            request->send(200, "application/json", "{\"status\":\"ok\"}");
+        }
+    );
+
+    // Lista przejazdów (/api/rides) i pobieranie przejazdu (/api/rides/<id>[?format=csv])
+    server.on("/api/rides", HTTP_GET, [](AsyncWebServerRequest* request) {
         if (!LittleFS.begin(false)) {
             request->send(500, "application/json", "{\"error\":\"Failed to mount filesystem\"}");
             return;
         }
-        
-        if (LittleFS.exists("/light_config.json")) {
-            File file = LittleFS.open("/light_config.json", "r");
-            if (!file) {
-                request->send(500, "application/json", "{\"error\":\"Failed to open config file\"}");
+
+        String url = request->url();
+        if (url.length() > 11 && url.startsWith("/api/rides/")) {
+            uint16_t id = (uint16_t)url.substring(11).toInt();
+            char path[24];
+            RideRecorder::buildPath(id, path, sizeof(path));
+
+            if (id == 0 || !LittleFS.exists(path)) {
+                request->send(404, "application/json", "{\"error\":\"Ride not found\"}");
                 return;
             }
-            
-            // Odczytaj zawartość pliku
-            String content = file.readString();
-            file.close();
-            
-            // Analizuj JSON, aby wyświetlić go w bardziej czytelnej formie
-            StaticJsonDocument<256> doc;
-            DeserializationError error = deserializeJson(doc, content);
-            
-            if (error) {
-                request->send(200, "text/plain", content); // Pokaż surową zawartość w przypadku błędu parsowania
-            } else {
-                // Dodaj dodatkowe informacje
-                JsonObject debug = doc.createNestedObject("_debug");
-                if (doc.containsKey("dayConfig")) {
-                    uint8_t dayConfigValue = doc["dayConfig"];
-                    debug["dayConfig_hex"] = "0x" + String(dayConfigValue, HEX);
-                    debug["dayConfig_bin"] = "0b" + String(dayConfigValue, BIN);
-                    debug["dayConfig_FRONT"] = (dayConfigValue & LightManager::FRONT) != 0;
-                    debug["dayConfig_DRL"] = (dayConfigValue & LightManager::DRL) != 0;
-                    debug["dayConfig_REAR"] = (dayConfigValue & LightManager::REAR) != 0;
-                }
-                
-                if (doc.containsKey("nightConfig")) {
-                    uint8_t nightConfigValue = doc["nightConfig"];
-                    debug["nightConfig_hex"] = "0x" + String(nightConfigValue, HEX);
-                    debug["nightConfig_bin"] = "0b" + String(nightConfigValue, BIN);
-                    debug["nightConfig_FRONT"] = (nightConfigValue & LightManager::FRONT) != 0;
-                    debug["nightConfig_DRL"] = (nightConfigValue & LightManager::DRL) != 0;
-                    debug["nightConfig_REAR"] = (nightConfigValue & LightManager::REAR) != 0;
+
+            // Zapisywany przejazd - najpierw zrzuć bufor RAM do pliku
+            if (rideRecorder.isActive() && rideRecorder.getCurrentId() == id) {
+                rideRecorder.flush(true);
+            }
+
+            if (request->hasParam("format") && request->getParam("format")->value() == "csv") {
+                std::shared_ptr<RideCsvExporter> exporter = std::make_shared<RideCsvExporter>();
+                if (!exporter->open(id)) {
+                    request->send(500, "application/json", "{\"error\":\"Invalid ride file\"}");
+                    return;
                 }
-                
-                String enriched;
-                serializeJsonPretty(doc, enriched);
-                request->send(200, "application/json", enriched);
+                request->send(request->beginChunkedResponse("text/csv",
+                    [exporter](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                        return exporter->read(buffer, maxLen);
+                    }));
+            } else {
+                // Surowy plik binarny, wysyłany z systemu plików porcjami
+                request->send(LittleFS, path, "application/octet-stream", true);
             }
-        } else {
-            request->send(404, "application/json", "{\"error\":\"Config file not found\"}");
+            return;
         }
+
+        // Lista przejazdów porcjami - liczba plików nie ogranicza odpowiedzi
+        ApiResponse::sendChunked(request, std::make_shared<JsonDirectoryList>(LittleFS, RIDES_DIR, "rides",
+            [](JsonWriter& json) {
+                json.field("recording", rideRecorder.isActive());
+                json.field("currentId", rideRecorder.getCurrentId());
+                json.field("sampleRate", rideRecorder.getSampleRate());
+                json.field("droppedSamples", rideRecorder.getDroppedSamples());
+                json.field("freeBytes", LittleFS.totalBytes() - LittleFS.usedBytes());
+            },
+            [](JsonWriter& json, File& entry) {
+                RideFileHeader header;
+                if (entry.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                    header.magic == RIDE_FILE_MAGIC) {
+                    json.beginObject()
+                        .field("id", atoi(entry.name()))
+                        .field("size", entry.size())
+                        .field("start", header.startEpoch)
+                        .field("sampleRate", header.sampleRateHz)
+                        .endObject();
+                }
+            }));
+    });
+
+    // Konfiguracja świateł w postaci zapisywanej w /settings.bin
+    server.on("/api/lights/file", HTTP_GET, [](AsyncWebServerRequest *request) {
+        uint8_t dayConfigValue = lightManager.getDayConfig();
+        uint8_t nightConfigValue = lightManager.getNightConfig();
+
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("dayConfig", dayConfigValue);
+        json.field("nightConfig", nightConfigValue);
+        json.field("dayBlink", lightManager.getDayBlink());
+        json.field("nightBlink", lightManager.getNightBlink());
+        json.field("blinkFrequency", lightManager.getBlinkFrequency());
+
+        // Dodaj dodatkowe informacje
+        json.beginObject("_debug");
+        json.field("stored", settingsStore.isLoaded(SETTINGS_LIGHTS));
+        json.field("pendingWrite", settingsStore.isDirty());
+        json.field("dayConfig_hex", "0x" + String(dayConfigValue, HEX));
+        json.field("dayConfig_bin", "0b" + String(dayConfigValue, BIN));
+        json.field("dayConfig_FRONT", (dayConfigValue & LightManager::FRONT) != 0);
+        json.field("dayConfig_DRL", (dayConfigValue & LightManager::DRL) != 0);
+        json.field("dayConfig_REAR", (dayConfigValue & LightManager::REAR) != 0);
+        json.field("nightConfig_hex", "0x" + String(nightConfigValue, HEX));
+        json.field("nightConfig_bin", "0b" + String(nightConfigValue, BIN));
+        json.field("nightConfig_FRONT", (nightConfigValue & LightManager::FRONT) != 0);
+        json.field("nightConfig_DRL", (nightConfigValue & LightManager::DRL) != 0);
+        json.field("nightConfig_REAR", (nightConfigValue & LightManager::REAR) != 0);
+        json.endObject();
+
+        json.endObject();
+        response.send();
     });
 
     // Endpoint GET dla konfiguracji świateł
     server.on("/api/lights/config", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<512> doc;
-        
-        doc["status"] = "ok";
-        JsonObject lights = doc.createNestedObject("lights");
-        lights["dayLights"] = lightManager.getConfigString(lightManager.getDayConfig());
-        lights["nightLights"] = lightManager.getConfigString(lightManager.getNightConfig());
-        lights["dayBlink"] = lightManager.getDayBlink();
-        lights["nightBlink"] = lightManager.getNightBlink();
-        lights["blinkFrequency"] = lightManager.getBlinkFrequency();
-        lights["currentMode"] = (int)lightManager.getMode();
-        lights["controlMode"] = (int)lightManager.getControlMode(); // Dodaj informację o trybie sterowania
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("status", "ok");
+        json.beginObject("lights");
+        json.field("dayLights", lightManager.getConfigString(lightManager.getDayConfig()));
+        json.field("nightLights", lightManager.getConfigString(lightManager.getNightConfig()));
+        json.field("dayBlink", lightManager.getDayBlink());
+        json.field("nightBlink", lightManager.getNightBlink());
+        json.field("blinkFrequency", lightManager.getBlinkFrequency());
+        json.field("currentMode", (int)lightManager.getMode());
+        json.field("controlMode", (int)lightManager.getControlMode()); // Dodaj informację o trybie sterowania
+        lightManager.patternsToJson(json); // Wzory świateł: kroki [jasność, ms], przydział do wyjść, hamulec
+        json.endObject();
+        json.endObject();
+        response.send();
     });
 
     // Endpoint POST dla konfiguracji świateł
@@ -3123,8 +2892,8 @@ void setupWebServer() {
             return;
         }
         
-        // Parsowanie JSON
-        StaticJsonDocument<512> doc;
+        // Parsowanie JSON (z wzorami świateł do ~2 kB)
+        DynamicJsonDocument doc(3072);
         DeserializationError error = deserializeJson(doc, jsonString);
         
         if (error) {
@@ -3174,33 +2943,48 @@ void setupWebServer() {
             DEBUG_LIGHT("Ustawiono czestotliwosc migania: %d", (int)doc["blinkFrequency"]);
         }
         
-        // Zapisz konfigurację
-        configSuccess = lightManager.saveConfig();
-        DEBUG_LIGHT("Zapis konfiguracji %s", configSuccess ? "powiodl sie" : "nie powiodl sie");
+        // Wzory świateł - po blinkFrequency, żeby jawnie podany wzór migania miał pierwszeństwo
+        if (doc.containsKey("patterns") || doc.containsKey("dayPatterns") ||
+            doc.containsKey("nightPatterns") || doc.containsKey("brakeLevel")) {
+            if (!lightManager.patternsFromJson(doc.as<JsonObjectConst>())) {
+                request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid light patterns\"}");
+                return;
+            }
+        }
+        
+        // Zapis do pliku nastąpi z opóźnieniem, razem z innymi zmianami
+        settingsStore.markDirty(SETTINGS_LIGHTS);
+        settingsStore.markDirty(SETTINGS_LIGHT_PATTERNS); // Wzór migania zależy od blinkFrequency
+        configSuccess = true;
         
         // Przygotuj odpowiedź
-        StaticJsonDocument<512> responseDoc;
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
         
         if (configSuccess) {
-            responseDoc["status"] = "ok";
-            responseDoc["message"] = "Konfiguracja zapisana pomyślnie";
+            json.field("status", "ok");
+            json.field("message", "Konfiguracja zapisana pomyślnie");
             
             // Dodaj aktualne ustawienia świateł do odpowiedzi
-            JsonObject lights = responseDoc.createNestedObject("lights");
-            lights["dayLights"] = lightManager.getConfigString(lightManager.getDayConfig());
-            lights["nightLights"] = lightManager.getConfigString(lightManager.getNightConfig());
-            lights["dayBlink"] = lightManager.getDayBlink();
-            lights["nightBlink"] = lightManager.getNightBlink();
-            lights["blinkFrequency"] = lightManager.getBlinkFrequency();
-            lights["currentMode"] = (int)lightManager.getMode();
+            json.beginObject("lights");
+            json.field("dayLights", lightManager.getConfigString(lightManager.getDayConfig()));
+            json.field("nightLights", lightManager.getConfigString(lightManager.getNightConfig()));
+            json.field("dayBlink", lightManager.getDayBlink());
+            json.field("nightBlink", lightManager.getNightBlink());
+            json.field("blinkFrequency", lightManager.getBlinkFrequency());
+            json.field("currentMode", (int)lightManager.getMode());
+            lightManager.patternsToJson(json);
+            json.endObject();
             
             // Zastosuj nowe ustawienia natychmiast
             LightManager::LightMode currentMode = lightManager.getMode();
             lightManager.setMode(currentMode);  // To wymusi ponowną konfigurację świateł
         } else {
-            responseDoc["status"] = "error";
-            responseDoc["message"] = "Błąd podczas zapisu konfiguracji świateł";
+            json.field("status", "error");
+            json.field("message", "Błąd podczas zapisu konfiguracji świateł");
         }
+        json.endObject();
 
         if (doc.containsKey("controlMode")) {
             int controlMode = doc["controlMode"].as<int>();
@@ -3208,66 +2992,75 @@ void setupWebServer() {
             applyBacklightSettings();
         }
 
-        String responseStr;
-        serializeJson(responseDoc, responseStr);
-        DEBUG_LIGHT("Wysylam odpowiedz: %s", responseStr.c_str());
-        
-        request->send(200, "application/json", responseStr);
+        DEBUG_LIGHT("Wysylam odpowiedz: %u B", (unsigned)json.getLength());
+        response.send();
     });
 
     // Dodaj endpoint do testowania konfiguracji
     server.on("/api/lights/debug", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<512> doc;
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
         
-        doc["dayConfig"] = lightManager.getDayConfig();
-        doc["dayConfigString"] = lightManager.getConfigString(lightManager.getDayConfig());
-        doc["nightConfig"] = lightManager.getNightConfig();
-        doc["nightConfigString"] = lightManager.getConfigString(lightManager.getNightConfig());
-        doc["dayBlink"] = lightManager.getDayBlink();
-        doc["nightBlink"] = lightManager.getNightBlink();
-        doc["blinkFrequency"] = lightManager.getBlinkFrequency();
-        doc["currentMode"] = (int)lightManager.getMode();
+        json.field("dayConfig", lightManager.getDayConfig());
+        json.field("dayConfigString", lightManager.getConfigString(lightManager.getDayConfig()));
+        json.field("nightConfig", lightManager.getNightConfig());
+        json.field("nightConfigString", lightManager.getConfigString(lightManager.getNightConfig()));
+        json.field("dayBlink", lightManager.getDayBlink());
+        json.field("nightBlink", lightManager.getNightBlink());
+        json.field("blinkFrequency", lightManager.getBlinkFrequency());
+        json.field("currentMode", (int)lightManager.getMode());
         
         // Dodaj binarne reprezentacje
-        doc["dayConfig_binary"] = String(lightManager.getDayConfig(), BIN);
-        doc["nightConfig_binary"] = String(lightManager.getNightConfig(), BIN);
+        json.field("dayConfig_binary", String(lightManager.getDayConfig(), BIN));
+        json.field("nightConfig_binary", String(lightManager.getNightConfig(), BIN));
         
         // Sprawdź poszczególne bity (flagi)
-        doc["dayConfig_FRONT"] = (lightManager.getDayConfig() & LightManager::FRONT) != 0;
-        doc["dayConfig_DRL"] = (lightManager.getDayConfig() & LightManager::DRL) != 0;
-        doc["dayConfig_REAR"] = (lightManager.getDayConfig() & LightManager::REAR) != 0;
+        json.field("dayConfig_FRONT", (lightManager.getDayConfig() & LightManager::FRONT) != 0);
+        json.field("dayConfig_DRL", (lightManager.getDayConfig() & LightManager::DRL) != 0);
+        json.field("dayConfig_REAR", (lightManager.getDayConfig() & LightManager::REAR) != 0);
         
-        doc["nightConfig_FRONT"] = (lightManager.getNightConfig() & LightManager::FRONT) != 0;
-        doc["nightConfig_DRL"] = (lightManager.getNightConfig() & LightManager::DRL) != 0;
-        doc["nightConfig_REAR"] = (lightManager.getNightConfig() & LightManager::REAR) != 0;
-        
-        String response;
-        serializeJson(doc, response);
+        json.field("nightConfig_FRONT", (lightManager.getNightConfig() & LightManager::FRONT) != 0);
+        json.field("nightConfig_DRL", (lightManager.getNightConfig() & LightManager::DRL) != 0);
+        json.field("nightConfig_REAR", (lightManager.getNightConfig() & LightManager::REAR) != 0);
+
+        // Silnik wzorów - bieżąca jasność wyjść i koszt kroku timera
+        json.beginArray("outputLevels");
+        for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+            json.item(lightManager.getOutputLevel(i));
+        }
+        json.endArray();
+        json.field("brakeBoost", lightManager.isBrakeBoosted());
+        json.field("pwmWrites", lightManager.getPwmWrites());
+        json.field("maxTickUs", lightManager.getMaxTickUs());
+        json.endObject();
         
-        DEBUG_LIGHT("Konfiguracja swiatel: %s", response.c_str());
+        DEBUG_LIGHT("Konfiguracja swiatel: dzien 0x%02X, noc 0x%02X, tryb %d",
+            lightManager.getDayConfig(), lightManager.getNightConfig(), (int)lightManager.getMode());
         
-        request->send(200, "application/json", response);
+        response.send();
     });
 
     // Endpoint do pobierania czasu (GET)
     server.on("/api/time", HTTP_GET, [](AsyncWebServerRequest* request) {
-        DateTime now = rtc.now();
-        
-        StaticJsonDocument<200> doc;
-        JsonObject time = doc.createNestedObject("time");
-        time["year"] = now.year();
-        time["month"] = now.month();
-        time["day"] = now.day();
-        time["hours"] = now.hour();
-        time["minutes"] = now.minute();
-        time["seconds"] = now.second();
-        
-        String response;
-        serializeJson(doc, response);
+        DateTime now;
+        {
+            I2cBusLock lock;
+            now = rtc.now();
+        }
         
-        //DEBUG_INFO("Wysylam aktualny czas: %s", response.c_str());
-
-        request->send(200, "application/json", response);
+        ApiResponse response(request);
+        response.json().beginObject()
+            .beginObject("time")
+            .field("year", now.year())
+            .field("month", now.month())
+            .field("day", now.day())
+            .field("hours", now.hour())
+            .field("minutes", now.minute())
+            .field("seconds", now.second())
+            .endObject()
+            .endObject();
+        response.send();
     });
 
     // Endpoint do ustawiania czasu (POST)
@@ -3292,7 +3085,10 @@ void setupWebServer() {
                     minute >= 0 && minute <= 59 &&
                     second >= 0 && second <= 59) {
                     
-                    rtc.adjust(DateTime(year, month, day, hour, minute, second));
+                    {
+                        I2cBusLock lock;
+                        rtc.adjust(DateTime(year, month, day, hour, minute, second));
+                    }
                     
                     DEBUG_INFO("Czas zostal zaktualizowany: %d-%02d-%02d %02d:%02d:%02d", year, month, day, hour, minute, second);
                     
@@ -3339,52 +3135,51 @@ void setupWebServer() {
         
         // Aktualizacja ustawień auto-off
         if (doc.containsKey("autoOffTime")) {
-            autoOffTime = doc["autoOffTime"] | 0;
-            DEBUG_INFO("Aktualizuje autoOffTime: %d minut", autoOffTime);
-            saveAutoOffSettings();
+            generalSettings.autoOffTime = constrain(doc["autoOffTime"] | 0, 0, 60);
+            DEBUG_INFO("Aktualizuje autoOffTime: %d minut", generalSettings.autoOffTime);
+            settingsStore.markDirty(SETTINGS_GENERAL);
         }
         
         // Zastosuj ustawienia
         applyBacklightSettings();
-        saveBacklightSettingsToFile();
+        settingsStore.markDirty(SETTINGS_BACKLIGHT);
         
         request->send(200, "application/json", "{\"status\":\"ok\"}");
     });
 
     // Endpoint do obsługi konfiguracji wyświetlacza
     server.on("/api/display/config", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<512> doc;
-        
         // Przekształć wartość jasności na procenty, jeśli jest poza zakresem 0-100
         int brightnessToSend = displayBrightness;
         if (brightnessToSend > 100) {
             brightnessToSend = map(displayBrightness, 0, 255, 0, 100);
         }
         
-        doc["brightness"] = brightnessToSend;
-        doc["dayBrightness"] = backlightSettings.dayBrightness;
-        doc["nightBrightness"] = backlightSettings.nightBrightness;
-        doc["autoMode"] = backlightSettings.autoMode;
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
+        json.field("brightness", brightnessToSend);
+        json.field("dayBrightness", backlightSettings.dayBrightness);
+        json.field("nightBrightness", backlightSettings.nightBrightness);
+        json.field("autoMode", backlightSettings.autoMode);
         // Dodaj bezpośrednio wartość autoOffTime
-        doc["autoOffTime"] = autoOffTime;
-
-        String response;
-        serializeJson(doc, response);
+        json.field("autoOffTime", generalSettings.autoOffTime);
+        json.endObject();
         
-        DEBUG_INFO("Wysyłam konfigurację wyświetlacza: %s", response.c_str());
+        DEBUG_INFO("Wysyłam konfigurację wyświetlacza: jasnosc %d, auto %d, wylaczenie %d min",
+            brightnessToSend, backlightSettings.autoMode, generalSettings.autoOffTime);
         
-        request->send(200, "application/json", response);
+        response.send();
     });
 
     // Endpoint GET dla ustawień auto-off
     server.on("/api/display/auto-off", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<64> doc;
-        doc["autoOffTime"] = autoOffTime;
-        doc["enabled"] = autoOffEnabled;
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        ApiResponse response(request);
+        response.json().beginObject()
+            .field("autoOffTime", generalSettings.autoOffTime)
+            .field("enabled", autoOffEnabled)
+            .endObject();
+        response.send();
     });
 
     // Endpoint POST dla ustawień auto-off
@@ -3400,19 +3195,15 @@ void setupWebServer() {
             
             if (!error) {
                 if (doc.containsKey("autoOffTime")) {
-                    autoOffTime = doc["autoOffTime"].as<int>();
-                    
-                    // Ogranicz wartość do sensownego zakresu
-                    if (autoOffTime < 0) autoOffTime = 0;
-                    if (autoOffTime > 60) autoOffTime = 60;  // Max 60 minut
+                    // Ogranicz wartość do sensownego zakresu (max 60 minut)
+                    generalSettings.autoOffTime = constrain(doc["autoOffTime"].as<int>(), 0, 60);
                 }
                 
                 if (doc.containsKey("enabled")) {
                     autoOffEnabled = doc["enabled"].as<bool>();
                 }
                                 
-                // Zapisz ustawienia do pliku
-                saveAutoOffSettings();
+                settingsStore.markDirty(SETTINGS_GENERAL);
                 
                 request->send(200, "application/json", "{\"status\":\"ok\"}");
             } else {
@@ -3444,12 +3235,19 @@ void setupWebServer() {
                         generalSettings.wheelSize = doc["wheelSize"].as<uint8_t>();
                     }
                     
-                    // Zapisz ustawienia od razu po zmianie
-                    saveGeneralSettingsToFile();
+                    settingsStore.markDirty(SETTINGS_GENERAL);
                     DEBUG_INFO("Zapisano ustawienia ogolne");
                     DEBUG_INFO("Rozmiar kola: %d", generalSettings.wheelSize);
                 }
 
+                if (doc.containsKey("rideSampleRate")) {
+                    generalSettings.rideSampleRate = constrain(doc["rideSampleRate"].as<int>(), RIDE_MIN_RATE_HZ, RIDE_MAX_RATE_HZ);
+                    rideRecorder.setSampleRate(generalSettings.rideSampleRate);
+                    serviceScheduler.setPeriod(rideSampleTaskId, rideRecorder.getSamplePeriodMs());
+                    settingsStore.markDirty(SETTINGS_GENERAL);
+                    DEBUG_INFO("Czestotliwosc zapisu przejazdu: %d Hz", generalSettings.rideSampleRate);
+                }
+
                 request->send(200, "application/json", "{\"success\":true}");
             } else {
                 request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
@@ -3458,16 +3256,15 @@ void setupWebServer() {
 
     // Dodaj w setupWebServer():
     server.on("/get-bluetooth-config", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<256> doc; // Zwiększ rozmiar dokumentu
-        doc["bmsEnabled"] = bluetoothConfig.bmsEnabled;
-        doc["tpmsEnabled"] = bluetoothConfig.tpmsEnabled;
-        doc["bmsMac"] = bluetoothConfig.bmsMac;
-        doc["frontTpmsMac"] = bluetoothConfig.frontTpmsMac; // Dodaj to
-        doc["rearTpmsMac"] = bluetoothConfig.rearTpmsMac;   // Dodaj to
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        ApiResponse response(request);
+        response.json().beginObject()
+            .field("bmsEnabled", bluetoothConfig.bmsEnabled)
+            .field("tpmsEnabled", bluetoothConfig.tpmsEnabled)
+            .field("bmsMac", bluetoothConfig.bmsMac)
+            .field("frontTpmsMac", bluetoothConfig.frontTpmsMac)
+            .field("rearTpmsMac", bluetoothConfig.rearTpmsMac)
+            .endObject();
+        response.send();
     });
 
     server.on("/save-bluetooth-config", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
@@ -3499,7 +3296,8 @@ void setupWebServer() {
                 strlcpy(bluetoothConfig.rearTpmsMac, doc["rearTpmsMac"], sizeof(bluetoothConfig.rearTpmsMac));
             }
             
-            saveBluetoothConfigToFile();
+            tpmsAddressesChanged = true;
+            settingsStore.markDirty(SETTINGS_BLUETOOTH);
             request->send(200, "application/json", "{\"success\":true}");
         } else {
             request->send(400, "application/json", "{\"success\":false,\"error\":\"Invalid JSON\"}");
@@ -3508,16 +3306,17 @@ void setupWebServer() {
     
     // Endpoint do pobierania aktualnych ustawień ogólnych
     server.on("/get-general-settings", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<64> doc;
+        ApiResponse response(request);
+        JsonWriter& json = response.json();
+        json.beginObject();
         if (generalSettings.wheelSize == 0) {
-            doc["wheelSize"] = "700C";
+            json.field("wheelSize", "700C");
         } else {
-            doc["wheelSize"] = generalSettings.wheelSize;
+            json.field("wheelSize", generalSettings.wheelSize);
         }
-        
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+        json.field("rideSampleRate", generalSettings.rideSampleRate);
+        json.endObject();
+        response.send();
     });
     
     server.on("/api/controller/config", HTTP_POST, [](AsyncWebServerRequest* request) {
@@ -3527,33 +3326,9 @@ void setupWebServer() {
             DeserializationError error = deserializeJson(doc, jsonString);
 
             if (!error) {
-                controllerSettings.type = doc["type"].as<String>();
-                
-                if (controllerSettings.type == "kt-lcd") {
-                    for (int i = 1; i <= 5; i++) {
-                        if (doc["p"].containsKey(String(i))) {
-                            controllerSettings.ktParams[i-1] = doc["p"][String(i)].as<int>();
-                        }
-                    }
-                    for (int i = 1; i <= 15; i++) {
-                        if (doc["c"].containsKey(String(i))) {
-                            controllerSettings.ktParams[i+4] = doc["c"][String(i)].as<int>();
-                        }
-                    }
-                    for (int i = 1; i <= 3; i++) {
-                        if (doc["l"].containsKey(String(i))) {
-                            controllerSettings.ktParams[i+19] = doc["l"][String(i)].as<int>();
-                        }
-                    }
-                } else {
-                    for (int i = 1; i <= 20; i++) {
-                        if (doc["p"].containsKey(String(i))) {
-                            controllerSettings.s866Params[i-1] = doc["p"][String(i)].as<int>();
-                        }
-                    }
-                }
-                
-                saveSettings();
+                strlcpy(controllerSettings.type, doc["type"] | "kt-lcd", sizeof(controllerSettings.type));
+                readControllerParams(doc.as<JsonVariantConst>());
+                settingsStore.markDirty(SETTINGS_CONTROLLER);
                 request->send(200, "application/json", "{\"status\":\"ok\"}");
             } else {
                 request->send(400, "application/json", "{\"status\":\"error\",\"message\":\"Invalid JSON\"}");
@@ -3563,28 +3338,44 @@ void setupWebServer() {
         }
     });
 
+    telemetry.setJsonFormatter(formatTelemetryJson);
     ws.onEvent([](AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len) {
         switch (type) {
             case WS_EVT_CONNECT:
                 DEBUG_INFO("Klient WebSocket #%u polaczony z %s\n", client->id(), client->remoteIP().toString().c_str());
+                if (ws.count() == 1) {
+                    settingsStore.resetStats(); // Nowa sesja konfiguracji
+                }
+                telemetry.onConnect(client->id());
                 webConfigActive = true; // Ustaw flagę aktywnej konfiguracji WWW
                 updateActivityTime(); // Zresetuj timer aktywności
                 break;
             case WS_EVT_DISCONNECT:
                 DEBUG_INFO("Klient WebSocket #%u rozlaczony\n", client->id());
+                telemetry.onDisconnect(client->id());
                 if (ws.count() == 0) {
                     webConfigActive = false; // Jeśli nie ma już żadnych klientów, wyłącz flagę
+                    DEBUG_INFO("Koniec sesji konfiguracji: %u zmian, %u zapisow ustawien",
+                        settingsStore.getDirtyMarks(), settingsStore.getFlashWrites());
                 }
                 break;
-            case WS_EVT_DATA:
+            case WS_EVT_DATA: {
                 updateActivityTime(); // Każda komunikacja to aktywność
+
+                // Negocjacja telemetrii - tylko kompletne wiadomości tekstowe w jednej ramce
+                AwsFrameInfo* info = (AwsFrameInfo*)arg;
+                if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                    telemetry.onMessage(client->id(), data, len);
+                }
                 break;
+            }
         }
     });
     server.addHandler(&ws);
 
     // Start serwera
     server.begin();
+    Profiler::watchTask("async_tcp", xTaskGetHandle("async_tcp"));
 }
 
 // --- Funkcje systemu plików ---
@@ -3717,36 +3508,6 @@ void listFiles() {
     }
 }
 
-// wczytywanie konfiguracji
-bool loadConfig() {
-    if(!LittleFS.exists("/config.json")) {
-        DEBUG_INFO("Tworzenie domyslnego pliku konfiguracyjnego...");
-        // Tworzymy domyślną konfigurację
-        StaticJsonDocument<512> defaultConfig;
-        defaultConfig["version"] = "1.0.0";
-        defaultConfig["timezone"] = "Europe/Warsaw";
-        defaultConfig["lastUpdate"] = "";
-        
-        File configFile = LittleFS.open("/config.json", "w");
-        if(!configFile) {
-            DEBUG_ERROR("Nie udalo sie utworzyc pliku konfiguracyjnego");
-            return false;
-        }
-        serializeJson(defaultConfig, configFile);
-        configFile.close();
-    }
-    
-    // Czytamy konfigurację
-    File configFile = LittleFS.open("/config.json", "r");
-    if(!configFile) {
-        DEBUG_ERROR("Nie udalo sie otworzyc pliku konfiguracyjnego");
-        return false;
-    }
-    
-    DEBUG_INFO("Plik konfiguracyjny wczytany pomyslnie");
-    return true;
-}
-
 /********************************************************************
  * DEKLARACJE I IMPLEMENTACJE FUNKCJI
  ********************************************************************/
@@ -3781,19 +3542,8 @@ void initializeDefaultSettings() {
 // Funkcje pomocnicze do setup()
 
 void initializeTemperatureSensors() {
-    // Inicjalizacja DS18B20
-    sensorsAir.begin();
-    sensorsController.begin();
-    // Ustawienie trybu nieblokującego
-    sensorsAir.setWaitForConversion(false);
-    sensorsController.setWaitForConversion(false);
-    // Ustawienie najwyższej rozdzielczości
-    sensorsAir.setResolution(12);
-    sensorsController.setResolution(12);
-    
-    // Pierwsze żądanie pomiaru
-    sensorsAir.requestTemperatures();
-    sensorsController.requestTemperatures();
+    // Adresy DS18B20 wyszukiwane raz, pomiary w sensorTask()
+    temperatures.begin();
 }
 
 void initializeRTC() {
@@ -3804,25 +3554,26 @@ void initializeRTC() {
         DEBUG_ERROR("RTC utracil zasilanie, ustawiam aktualny czas");
         rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
     }
+
+    // Pierwszy odczyt dla obu rdzeni - dalej co RTC_READ_INTERVAL_MS w clockTask()
+    rtcEpoch = rtc.now().unixtime();
+    rtcStampMs = millis();
+    clockEpoch = rtcEpoch;
+    clockStampMs = rtcStampMs;
+    topBarTime = DateTime(clockEpoch);
 }
 
 void initializePins() {
-    // Przyciski
-    pinMode(BTN_UP, INPUT_PULLUP);
-    pinMode(BTN_DOWN, INPUT_PULLUP);
+    // Przyciski - przerwania i timer rozpoznawania gestów
+    buttons.begin(BUTTON_PINS);
 
-    // Światła
-    pinMode(FrontDayPin, OUTPUT);
-    pinMode(FrontPin, OUTPUT);
-    pinMode(RearPin, OUTPUT);
-    
-    // Inicjalizacja menedżera świateł
-    lightManager.begin(FrontPin, FrontDayPin, RearPin);
-    lightManager.setMode(LightManager::OFF); // Wyłącz światła po włączeniu ESP
-    
-    // Hamulec
+    // Hamulec (czyta go też timer świateł - podbicie tylnego przy hamowaniu)
     pinMode(BRAKE_SENSOR_PIN, INPUT_PULLUP);
 
+    // Światła - PWM (LEDC) i timer wzorów
+    lightManager.begin(FrontPin, FrontDayPin, RearPin, BRAKE_SENSOR_PIN);
+    lightManager.setMode(LightManager::OFF); // Wyłącz światła po włączeniu ESP
+
     // Kadencja
     pinMode(CADENCE_SENSOR_PIN, INPUT_PULLUP);
     attachInterrupt(digitalPinToInterrupt(CADENCE_SENSOR_PIN), cadence_ISR, FALLING);
@@ -3835,157 +3586,268 @@ void initializePins() {
 
 void resetCadenceData() {
     cadence_rpm = 0;
-    cadence_avg_rpm = 0;
-    cadence_max_rpm = 0;
-    cadence_sum = 0;
-    cadence_samples = 0;
-
-    // Wczytaj liczbę impulsów na obrót z pamięci preferences
-    preferences.begin("cadence", false);
-    cadence_pulses_per_revolution = preferences.getUChar("pulses", 1); // Domyślnie 1
-    preferences.end();
-}
-
-// wczytywanie ustawień podświetlenia
-void loadBacklightSettingsFromFile() {
-    // Sprawdź czy plik istnieje
-    if (!LittleFS.exists(CONFIG_FILE)) {
-        DEBUG_LIGHT("Brak pliku konfiguracyjnego, używam ustawień domyślnych");
-        // Ustaw wartości domyślne
-        backlightSettings.Brightness = 70;
-        backlightSettings.dayBrightness = 100;
-        backlightSettings.nightBrightness = 50;
-        backlightSettings.autoMode = false;
-        // Zapisz domyślne ustawienia do pliku
-        saveBacklightSettingsToFile();
-        return;
-    }
+    cadenceFilter.reset();
+}
 
-    File file = LittleFS.open(CONFIG_FILE, "r");
-    if (!file) {
-        DEBUG_LIGHT("Nie można otworzyć pliku konfiguracyjnego, używam ustawień domyślnych");
-        // Ustaw wartości domyślne
-        backlightSettings.Brightness = 70;
-        backlightSettings.dayBrightness = 100;
-        backlightSettings.nightBrightness = 50;
-        backlightSettings.autoMode = false;
-        return;
-    }
+// rejestracja struktur konfiguracyjnych w magazynie ustawień
+// (drugi argument to wersja schematu - zwiększyć przy zmianie struktury)
+void registerSettings() {
+    settingsStore.registerSection(SETTINGS_GENERAL, 1, &generalSettings, sizeof(generalSettings));
+    settingsStore.registerSection(SETTINGS_BACKLIGHT, 1, &backlightSettings, sizeof(backlightSettings));
+    settingsStore.registerSection(SETTINGS_BLUETOOTH, 1, &bluetoothConfig, sizeof(bluetoothConfig));
+    settingsStore.registerSection(SETTINGS_LIGHTS, 1, lightManager.getConfigData(), sizeof(LightConfig));
+    settingsStore.registerSection(SETTINGS_CONTROLLER, 1, &controllerSettings, sizeof(controllerSettings));
+    settingsStore.registerSection(SETTINGS_WIFI, 1, &wifiSettings, sizeof(wifiSettings));
+    settingsStore.registerSection(SETTINGS_ENERGY, 1, energy.getStateData(), sizeof(EnergyState), readEnergySnapshot);
+    settingsStore.registerSection(SETTINGS_TRIP, 1, tripMetrics.getData(), TripMetrics::getDataSize(), readTripSnapshot);
+    settingsStore.registerSection(SETTINGS_LIGHT_PATTERNS, 1, lightManager.getPatternData(), sizeof(LightPatternConfig));
+}
 
-    // Sprawdź rozmiar pliku
-    size_t fileSize = file.size();
-    if (fileSize == 0) {
-        DEBUG_LIGHT("Plik konfiguracyjny jest pusty, używam ustawień domyślnych");
-        file.close();
-        // Ustaw wartości domyślne
-        backlightSettings.Brightness = 70;
-        backlightSettings.dayBrightness = 100;
-        backlightSettings.nightBrightness = 50;
-        backlightSettings.autoMode = false;
-        saveBacklightSettingsToFile(); // Zapisz domyślne ustawienia
-        return;
+// odczyt starego pliku JSON (tylko migracja)
+bool readLegacyJson(const char* path, JsonDocument& doc) {
+    doc.clear();
+
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
     }
 
-    StaticJsonDocument<200> doc;
     DeserializationError error = deserializeJson(doc, file);
     file.close();
 
     if (error) {
-        DEBUG_LIGHT("Błąd podczas parsowania JSON: %s, używam ustawień domyślnych", error.c_str());
-        // Ustaw wartości domyślne
-        backlightSettings.Brightness = 70;
-        backlightSettings.dayBrightness = 100;
-        backlightSettings.nightBrightness = 50;
-        backlightSettings.autoMode = false;
-        saveBacklightSettingsToFile(); // Zapisz poprawne ustawienia
+        DEBUG_ERROR("Migracja: blad parsowania %s: %s", path, error.c_str());
+        return false;
+    }
+    return true;
+}
+
+// parametry sterownika z JSON: {"p": {"1": ..}, "c": {..}, "l": {..}}
+void readControllerParams(JsonVariantConst params) {
+    char key[4];
+
+    if (strcmp(controllerSettings.type, "kt-lcd") == 0) {
+        for (int i = 1; i <= 5; i++) {
+            snprintf(key, sizeof(key), "%d", i);
+            if (params["p"].containsKey(key)) {
+                controllerSettings.ktParams[i-1] = params["p"][key].as<int>();
+            }
+        }
+        for (int i = 1; i <= 15; i++) {
+            snprintf(key, sizeof(key), "%d", i);
+            if (params["c"].containsKey(key)) {
+                controllerSettings.ktParams[i+4] = params["c"][key].as<int>();
+            }
+        }
+        for (int i = 1; i <= 3; i++) {
+            snprintf(key, sizeof(key), "%d", i);
+            if (params["l"].containsKey(key)) {
+                controllerSettings.ktParams[i+19] = params["l"][key].as<int>();
+            }
+        }
+    } else {
+        for (int i = 1; i <= 20; i++) {
+            snprintf(key, sizeof(key), "%d", i);
+            if (params["p"].containsKey(key)) {
+                controllerSettings.s866Params[i-1] = params["p"][key].as<int>();
+            }
+        }
+    }
+}
+
+// przeniesienie ustawień ze starych plików JSON do /settings.bin
+void migrateLegacySettings() {
+    DynamicJsonDocument doc(1536);
+    bool found = false;
+
+    if (readLegacyJson("/display_config.json", doc)) {
+        backlightSettings.Brightness = constrain(doc["brightness"] | 70, 10, 100);
+        backlightSettings.dayBrightness = constrain(doc["dayBrightness"] | 100, 10, 100);
+        backlightSettings.nightBrightness = constrain(doc["nightBrightness"] | 50, 10, 100);
+        backlightSettings.autoMode = doc["autoMode"] | false;
+        found = true;
+    }
+
+    if (readLegacyJson("/general_config.json", doc)) {
+        generalSettings.wheelSize = doc["wheelSize"] | 26;
+        generalSettings.rideSampleRate = constrain(doc["rideSampleRate"] | 2, RIDE_MIN_RATE_HZ, RIDE_MAX_RATE_HZ);
+        found = true;
+    }
+
+    if (readLegacyJson("/auto_off.json", doc)) {
+        generalSettings.autoOffTime = constrain(doc["autoOffTime"] | 0, 0, 60);
+        found = true;
+    }
+
+    if (readLegacyJson("/bluetooth_config.json", doc)) {
+        bluetoothConfig.bmsEnabled = doc["bmsEnabled"] | false;
+        bluetoothConfig.tpmsEnabled = doc["tpmsEnabled"] | false;
+        strlcpy(bluetoothConfig.bmsMac, doc["bmsMac"] | "", sizeof(bluetoothConfig.bmsMac));
+        strlcpy(bluetoothConfig.frontTpmsMac, doc["frontTpmsMac"] | "", sizeof(bluetoothConfig.frontTpmsMac));
+        strlcpy(bluetoothConfig.rearTpmsMac, doc["rearTpmsMac"] | "", sizeof(bluetoothConfig.rearTpmsMac));
+        found = true;
+    }
+
+    if (readLegacyJson("/light_config.json", doc)) {
+        LightConfig* light = lightManager.getConfigData();
+        light->dayConfig = doc["dayConfig"] | light->dayConfig;
+        light->nightConfig = doc["nightConfig"] | light->nightConfig;
+        light->dayBlink = doc["dayBlink"] | light->dayBlink;
+        light->nightBlink = doc["nightBlink"] | light->nightBlink;
+        light->blinkFrequency = constrain(doc["blinkFrequency"] | light->blinkFrequency, 100, 2000);
+        found = true;
+    }
+
+    if (readLegacyJson("/config.json", doc)) {
+        strlcpy(wifiSettings.ssid, doc["wifi"]["ssid"] | "", sizeof(wifiSettings.ssid));
+        strlcpy(wifiSettings.password, doc["wifi"]["password"] | "", sizeof(wifiSettings.password));
+
+        if (doc.containsKey("controller")) {
+            strlcpy(controllerSettings.type, doc["controller"]["type"] | "kt-lcd", sizeof(controllerSettings.type));
+            readControllerParams(doc["controller"]["params"]);
+        }
+        found = true;
+    }
+
+    // Zapis całego obrazu - także gdy nie było starych plików (same wartości domyślne)
+    settingsStore.markDirty(SETTINGS_GENERAL);
+    settingsStore.markDirty(SETTINGS_BACKLIGHT);
+    settingsStore.markDirty(SETTINGS_BLUETOOTH);
+    settingsStore.markDirty(SETTINGS_LIGHTS);
+    settingsStore.markDirty(SETTINGS_CONTROLLER);
+    settingsStore.markDirty(SETTINGS_WIFI);
+    if (!settingsStore.flush()) {
+        DEBUG_ERROR("Migracja: nie udalo sie zapisac %s", SETTINGS_FILE);
         return;
     }
 
-    // Wczytaj ustawienia z pliku z wartościami domyślnymi jeśli pole nie istnieje
-    backlightSettings.Brightness = doc["brightness"] | 70;
-    backlightSettings.dayBrightness = doc["dayBrightness"] | 100;
-    backlightSettings.nightBrightness = doc["nightBrightness"] | 50;
-    backlightSettings.autoMode = doc["autoMode"] | false;
+    if (found) {
+        for (const char* path : LEGACY_SETTINGS_FILES) {
+            if (LittleFS.exists(path)) {
+                LittleFS.remove(path);
+            }
+        }
+        DEBUG_INFO("Przeniesiono ustawienia ze starych plikow JSON do %s", SETTINGS_FILE);
+    }
+}
 
-    // Walidacja wczytanych wartości - zapewnienie, że mieszczą się w dopuszczalnym zakresie
-    backlightSettings.Brightness = constrain(backlightSettings.Brightness, 10, 100);
-    backlightSettings.dayBrightness = constrain(backlightSettings.dayBrightness, 10, 100);
-    backlightSettings.nightBrightness = constrain(backlightSettings.nightBrightness, 10, 100);
+// Zastosowanie wczytanych ustawień (z pliku albo z kopii RTC)
+void applyLoadedSettings() {
+    settingsReady = true;
 
-    DEBUG_LIGHT("Wczytano ustawienia z pliku:");
-    DEBUG_LIGHT("Brightness: %d", backlightSettings.Brightness);
-    DEBUG_LIGHT("Day Brightness: %d", backlightSettings.dayBrightness);
-    DEBUG_LIGHT("Night Brightness: %d", backlightSettings.nightBrightness);
-    DEBUG_LIGHT("Auto Mode: %d", backlightSettings.autoMode ? 1 : 0);
+    if (generalSettings.cadencePulses < 1 || generalSettings.cadencePulses > CADENCE_MAX_PULSES_PER_REV) {
+        generalSettings.cadencePulses = 1;
+    }
+    cadence_pulses_per_revolution = generalSettings.cadencePulses;
+    cadenceFilter.setPulsesPerRevolution(cadence_pulses_per_revolution);
+    updateCadenceDebounce();
 
-    // Zastosuj wczytane ustawienia
+    // Przejazd trwa po uśpieniu - dystans z zapisanego stanu energii
+    distance_km = energy.getTripKm();
+
+    rideRecorder.setSampleRate(generalSettings.rideSampleRate);
+
+    // Zastosuj wczytane ustawienia podświetlenia
     applyBacklightSettings();
 }
 
+// Licznik całkowity i rejestrator przejazdów (system plików już zamontowany)
+void startRecorders() {
+    // Licznik całkowity (przy pierwszym starcie przenosi wartość z /odometer.json)
+    if (!odometer.begin()) {
+        DEBUG_ERROR("Blad inicjalizacji licznika!");
+    }
+
+    rideRecorder.begin();
+    storageReady = true;
+}
+
+// Pliki po szybkim wybudzeniu (odłożony start albo uśpienie przed nim)
+void startStorage() {
+    if (initLittleFS()) {
+        startRecorders();
+    }
+}
+
+// Start bez kopii RTC: ustawienia z /settings.bin, licznik i rejestrator od razu
 void initializeFileSystemAndSettings() {
     // Najpierw sprawdź i inicjalizuj system plików
     if (!LittleFS.begin(true)) {
         DEBUG_ERROR("Blad montowania LittleFS");
-        // Ustaw domyślne wartości w przypadku błędu
-        initializeDefaultSettings();
         return;
     } 
     
     DEBUG_INFO("LittleFS zamontowany pomyslnie");
     
-    // Wczytaj ustawienia z plików
-    loadBacklightSettingsFromFile();
-    loadGeneralSettingsFromFile();
-    loadBluetoothConfigFromFile();
-    loadAutoOffSettings(); // Dodaj tę linijkę
-    
-    // Sprawdź i utwórz konfigurację Bluetooth jeśli nie istnieje
-    if (!LittleFS.exists("/bluetooth_config.json")) {
-        DEBUG_BLE("Tworze domyslny plik konfiguracyjny Bluetooth");
-        createDefaultBluetoothConfig();
+    // Wczytaj ustawienia z /settings.bin (przy pierwszym starcie - ze starych plików JSON)
+    if (!settingsStore.begin()) {
+        migrateLegacySettings();
     }
+    applyLoadedSettings();
 
-    // Obsługa licznika
-    cleanupOldOdometer();
-    initializeOdometer();
-    
-    // Zastosuj wczytane ustawienia podświetlenia
-    applyBacklightSettings();
+    startRecorders();
 }
 
-void createDefaultBluetoothConfig() {
-    bluetoothConfig.bmsEnabled = false;
-    bluetoothConfig.tpmsEnabled = false;
-    strcpy(bluetoothConfig.bmsMac, "");
-    strcpy(bluetoothConfig.frontTpmsMac, "");
-    strcpy(bluetoothConfig.rearTpmsMac, "");
-    saveBluetoothConfigToFile();
-}
+// Szybkie wybudzenie: ustawienia, przebieg i stan ekranu z pamięci RTC.
+// System plików i radio startują później (deferredStartTask).
+bool resumeFromSleepSnapshot() {
+    SleepState state;
+    if (!SleepSnapshot::restore(state, settingsStore)) {
+        DEBUG_INFO("Brak kopii stanu w RTC - start z plikow");
+        return false;
+    }
 
-void cleanupOldOdometer() {
-    if (LittleFS.exists("/odometer.json")) {
-        DEBUG_INFO("Usuwanie starego pliku licznika...");
-        
-        if (LittleFS.remove("/odometer.json")) {
-            DEBUG_INFO("Stary plik licznika usuniety");
-        } else {
-            DEBUG_ERROR("Nie udalo sie usunac starego pliku licznika");
-        }
+    bootTiming.resumed = true;
+    bootTiming.restoreUs = SleepSnapshot::getRestoreUs();
+    applyLoadedSettings();
+
+    odometer.resume(state.odometerMeters);
+    if (state.mainScreen < MAIN_SCREEN_COUNT) {
+        currentMainScreen = (MainScreen)state.mainScreen;
+        inSubScreen = state.inSubScreen && hasSubScreens(currentMainScreen);
+        currentSubScreen = inSubScreen && state.subScreen < getSubScreenCount(currentMainScreen) ? state.subScreen : 0;
+    }
+    assistLevel = constrain(state.assistLevel, 0, 5);
+    legalMode = state.legalMode;
+    if (state.lightMode <= LightManager::NIGHT) {
+        lightManager.setMode((LightManager::LightMode)state.lightMode);
     }
+
+    DEBUG_INFO("Stan przywrocony z pamieci RTC w %u us", bootTiming.restoreUs);
+    return true;
 }
 
-void initializeOdometer() {
-    if (!odometer.isValid()) {
-        DEBUG_INFO("Inicjalizacja licznika...");
-        
-        if (!odometer.isValid()) {
-            DEBUG_INFO("Blad inicjalizacji licznika!");
-        } else {
-            DEBUG_INFO("Licznik zainicjalizowany pomyslnie");
-        }
+// Kopia stanu w pamięci RTC przed uśpieniem
+void saveSleepSnapshot() {
+    SleepState state;
+    state.odometerMeters = odometer.getTotalMeters();
+    state.mainScreen = currentMainScreen;
+    state.subScreen = currentSubScreen;
+    state.inSubScreen = inSubScreen;
+    state.assistLevel = assistLevel;
+    state.lightMode = lightManager.getMode();
+    state.legalMode = legalMode;
+    SleepSnapshot::save(state, settingsStore);
+}
+
+// NVS dla BLE i WiFi - bez kasowania przy każdym starcie (tylko gdy partycja tego wymaga)
+void initializeNvs() {
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        DEBUG_INFO("NVS wymaga wyczyszczenia (%d)", err);
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+    if (err != ESP_OK) {
+        DEBUG_ERROR("Blad podczas inicjalizacji NVS: %d", err);
+        return;
     }
 
-    DEBUG_INFO("Stan licznika: %s, Wartosc: %.2f", odometer.isValid() ? "OK" : "BLAD", odometer.getRawTotal());
+    // Diagnostyka NVS
+    nvs_stats_t nvs_stats;
+    if (nvs_get_stats(NULL, &nvs_stats) == ESP_OK) {
+        DEBUG_INFO("NVS: wpisy uzyte/wolne/calkowite: %d/%d/%d", nvs_stats.used_entries, nvs_stats.free_entries, nvs_stats.total_entries);
+    }
 }
 
 void initializeBluetooth() {
@@ -4000,7 +3862,7 @@ void initializeBluetooth() {
         // Inicjalizacja struktur TPMS
         resetTpmsData();
         loadTpmsAddresses();
-        startTpmsScan();
+        tpmsScheduler.begin(millis()); // Pierwsze wyszukiwanie przy najbliższym tpmsTask()
     }
 }
 
@@ -4020,9 +3882,26 @@ void printSystemInfo() {
 
 void handleInitialSetButton() {
     unsigned long startTime = millis();
+    uint32_t holdStartUs = (uint32_t)esp_timer_get_time();
     while (!digitalRead(BTN_SET)) {  // Czekaj na puszczenie przycisku
         if ((millis() - startTime) > SET_LONG_PRESS) {
+            bootTiming.holdUs = (uint32_t)esp_timer_get_time() - holdStartUs;
             displayActive = true;
+
+            #if RESUME_SKIP_WELCOME
+            if (bootTiming.resumed) {
+                // Szybkie wybudzenie - ekran główny od razu, jeszcze z wciśniętym SET
+                welcomeAnimationDone = true;
+                if (displayRenderer.render()) {
+                    markFirstFrame();
+                }
+                while (!digitalRead(BTN_SET)) {
+                    delay(10);
+                }
+                break;
+            }
+            #endif
+
             showingWelcome = true;
             messageStartTime = millis();
             
@@ -4045,8 +3924,11 @@ void setup() {
     // Sprawdź przyczynę wybudzenia
     esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
 
-    // Inicjalizacja UART dla Serial Monitor i komunikacji z KT
+    // Inicjalizacja UART dla Serial Monitor i komunikacji z KT.
+    // Bufor nadawczy pozwala DebugLog::drain() wysyłać logi bez czekania na UART.
+    Serial.setTxBufferSize(DEBUG_LOG_TX_BUFFER);
     Serial.begin(115200);
+    DebugLog::begin(Serial);
     Serial2.begin(CONTROLLER_UART_BAUD, SERIAL_8N1, CONTROLLER_RX_PIN, CONTROLLER_TX_PIN);
     
     DEBUG_INFO("=== Inicjalizacja systemu ===");
@@ -4058,46 +3940,31 @@ void setup() {
     }
     
     // Inicjalizacja podstawowych komponentów
+    I2cBus::begin();
     Wire.begin();
     display.begin();
     display.setFontDirection(0);
     display.clearBuffer();
-    display.sendBuffer();
+    displayRenderer.present();
+    setupDisplayRenderer();
+    #if DISPLAY_ASYNC_FLUSH
+    displayRenderer.startFlushTask(DISPLAY_FLUSH_CORE, DISPLAY_FLUSH_PRIORITY);
+    Profiler::watchTask("oledFlush", displayRenderer.getFlushTask());
+    #endif
+    Profiler::watchTask("loop", xTaskGetCurrentTaskHandle());
     
     // Konfiguracja pinu przycisku SET (niezbędnego do wybudzenia)
     pinMode(BTN_SET, INPUT_PULLUP);
 
     // Jeśli nie zostaliśmy wybudzeni przez przycisk, natychmiast przechodzimy do trybu uśpienia
     if (wakeup_reason != ESP_SLEEP_WAKEUP_EXT0) {
-        #ifdef DEBUG_INFO_ENABLED
         DEBUG_INFO("Normalne uruchomienie - przechodze do trybu uspienia");
-        Serial.flush();
-        #endif
         goToSleep();
         return; // Ten kod nigdy nie zostanie wykonany
     }
     
-    // Od tego momentu wiemy, że zostaliśmy wybudzeni przez przycisk SET
-    
-    // Inicjalizacja NVS (połączone operacje czyszczenia i inicjalizacji)
-    esp_err_t err = nvs_flash_erase();
-    if (err != ESP_OK) {
-        DEBUG_INFO("Blad podczas czyszczenia NVS: %d\n", err);
-    }
-    
-    if ((err = nvs_flash_init()) != ESP_OK) {
-        DEBUG_INFO("Blad podczas inicjalizacji NVS: %d\n", err);
-        return;
-    }
-    
-    DEBUG_INFO("NVS zainicjalizowane pomyslnie");
-    
-    // Diagnostyka NVS (tylko w trybie DEBUG)
-    nvs_stats_t nvs_stats;
-    if (nvs_get_stats(NULL, &nvs_stats) == ESP_OK) {
-        DEBUG_INFO("=== Statystyki NVS ===");
-        DEBUG_INFO("Wpisy uzyte/wolne/calkowite: %d/%d/%d", nvs_stats.used_entries, nvs_stats.free_entries, nvs_stats.total_entries);
-    }
+    // Od tego momentu wiemy, że zostaliśmy wybudzeni przez przycisk SET.
+    // NVS, diagnostyka plików i BLE startują po pierwszej klatce (deferredStartTask).
 
     // Inicjalizacja czujników temperatury
     initializeTemperatureSensors();
@@ -4108,16 +3975,15 @@ void setup() {
     // Inicjalizacja pinów
     initializePins();
     
-    // Inicjalizacja systemu plików i wczytanie ustawień
-    initializeFileSystemAndSettings();
-
-    // Zastosuj wczytane ustawienia
-    applyBacklightSettings();
+    // Wartości domyślne - zostają dla sekcji, których nie ma w pliku ani w kopii RTC
+    initializeDefaultSettings();
+    registerSettings();
 
-    // Inicjalizacja BLE jeśli potrzebne
-    if (bluetoothConfig.bmsEnabled || bluetoothConfig.tpmsEnabled) {
-        initializeBluetooth();
+    // Ustawienia i stan sprzed uśpienia z pamięci RTC, a bez kopii - z systemu plików
+    if (!resumeFromSleepSnapshot()) {
+        initializeFileSystemAndSettings();
     }
+    bootTiming.settingsUs = (uint32_t)esp_timer_get_time();
 
     // Zastosuj wczytane ustawienia
     setLights();  
@@ -4126,103 +3992,65 @@ void setup() {
     // Ustaw początkowy czas aktywności - dodaj po inicjalizacji innych zmiennych
     lastActivityTime = millis();
     webConfigActive = false;
-    
-    // Załaduj ustawienia auto-off - upewnij się, że to się dzieje
-    loadAutoOffSettings();
-
-    #if DEBUG_INFO_ENABLED
-    printSystemInfo();
-    #endif
 
     // Obsługa przycisku SET po wybudzeniu
     handleInitialSetButton();
+    bootTiming.setupUs = (uint32_t)esp_timer_get_time();
+    setupDoneMs = millis();
+
+    // Rejestracja zadań okresowych (po animacji powitania, żeby nie liczyć jej jako spóźnień)
+    setupScheduler();
 }
 
-// Implementacja funkcji loop
-void loop() {
-    // Zmienne statyczne do śledzenia czasu
-    static unsigned long lastButtonCheck = 0;
-    static unsigned long lastUpdate = 0;
-    static unsigned long lastAutoOffCheck = 0;
-    static unsigned long lastDebugTime = 0;
-    static unsigned long prevActivityTime = 0;
-    static unsigned long lastAutoSaveTime = 0;
-    static unsigned long lastWebSocketUpdate = 0;
-    static unsigned long lastBlinkToggle = 0;
-    static unsigned long last_rpm_calc = 0;
-
-    // Stałe czasowe
-    const unsigned long buttonInterval = 5;          // Interwał sprawdzania przycisków
-    const unsigned long updateInterval = 2000;       // Interwał ogólnej aktualizacji danych
-    const unsigned long AUTO_OFF_CHECK_INTERVAL = 5000;  // Sprawdzanie auto-off co 5s
-    const unsigned long DEBUG_INTERVAL = 10000;      // Debugowanie co 10s
-    const unsigned long AUTO_SAVE_INTERVAL = 60000;  // Automatyczny zapis co minutę
-    const unsigned long WEBSOCKET_UPDATE = 1000;     // Aktualizacja WebSocket co sekundę
-    const unsigned long rpm_calc_interval = 100;     // Obliczanie kadencji co 100ms
-
-    // Zmienne do śledzenia stanu świateł
-    static LightManager::LightMode lastLightMode = lightManager.getMode();
-    static LightManager::ControlMode lastControlMode = lightManager.getControlMode();
+// --- Zadania harmonogramu ---
 
-    unsigned long currentTime = millis();
+// Dane ze sterownika odbierane niezależnie od stanu wyświetlacza
+void controllerTask() {
+    PROFILE_SCOPE(PERF_CONTROLLER);
+    updateControllerData();
+}
 
-    // Sprawdzanie aktywności WebSocket i aktualizacja flagi
-    if (currentTime - lastWebSocketUpdate >= WEBSOCKET_UPDATE) {
-        if (ws.count() > 0) {
-            webConfigActive = true;  // Konfiguracja WWW jest aktywna
-            updateActivityTime();    // Aktualizuj czas aktywności
-
-            // Wyślij dane statusu do klientów WebSocket
-            DynamicJsonDocument statusDoc(512);
-            statusDoc["speed"] = speed_kmh;
-            statusDoc["temperature"] = currentTemp;
-            statusDoc["battery"] = battery_capacity_percent;
-            statusDoc["power"] = power_w;
-            
-            // Informacje o światłach
-            JsonObject lightStatus = statusDoc.createNestedObject("lights");
-            lightStatus["mode"] = lightManager.getModeString();
-            lightStatus["dayConfig"] = lightManager.getConfigString(lightManager.getDayConfig());
-            lightStatus["nightConfig"] = lightManager.getConfigString(lightManager.getNightConfig());
-            
-            String jsonStr;
-            serializeJson(statusDoc, jsonStr);
-            ws.textAll(jsonStr);
-        } else {
-            webConfigActive = false; // Brak aktywnych połączeń WebSocket
-        }
-        lastWebSocketUpdate = currentTime;
-    }
+// Obliczanie kadencji - impulsy czekają w buforze przerwania
+void cadenceTask() {
+    PROFILE_SCOPE(PERF_CADENCE);
+    updateCadence();
+}
 
-    // Sprawdzanie automatycznego wyłączania (tylko gdy nie ma aktywnej konfiguracji)
-    if (currentTime - lastAutoOffCheck >= AUTO_OFF_CHECK_INTERVAL) {
-        lastAutoOffCheck = currentTime;
-        if (displayActive && !configModeActive && !showingWelcome && !webConfigActive) {
-            checkAutoOff();
-        }
+// Hamulec i strzałki kadencji
+void brakeTask() {
+    updateCadenceLogic();
+}
+
+// Obsługa gestów przycisków (rozpoznawanie w przerwaniu i timerze ButtonManager)
+void buttonTask() {
+    PROFILE_SCOPE(PERF_BUTTONS);
+    uint8_t context = BUTTON_CONTEXT_NORMAL;
+    if (configModeActive) {
+        context = BUTTON_CONTEXT_CONFIG;
+    } else if (!displayActive) {
+        context = BUTTON_CONTEXT_OFF;
+    } else if (showingWelcome) {
+        context = BUTTON_CONTEXT_NONE;
     }
+    buttons.setContext(context);
 
-    // Debugowanie stanu auto-off
-    if (currentTime - lastDebugTime > DEBUG_INTERVAL) {
-        lastDebugTime = currentTime;
-        
-        // Sprawdź czy lastActivityTime się zmienia (wskazuje na aktywność)
-        bool activityDetected = (lastActivityTime != prevActivityTime);
-        prevActivityTime = lastActivityTime;
-        
-        DEBUG_INFO("Auto-off status: czas=%d min, lastActivity=%u s, konfiguracja=%s, WWW=%s, aktywnosc=%s", 
-            autoOffTime, 
-            (currentTime - lastActivityTime) / 1000, 
-            configModeActive ? "TAK" : "NIE",
-            webConfigActive ? "TAK" : "NIE",
-            activityDetected ? "WYKRYTA" : "BRAK");
+    // Naciśnięcie lub trzymanie przycisku to aktywność
+    if (buttons.takeActivity() || buttons.getPressedMask() != 0) {
+        updateActivityTime();
     }
 
-    // Automatyczny zapis danych
-    if (currentTime - lastAutoSaveTime >= AUTO_SAVE_INTERVAL) {
-        // Zapisz dane odometru i inne ważne dane
-        lastAutoSaveTime = currentTime;
+    buttons.dispatch();
+
+    if (!configModeActive) {
+        updateMessageTimeout();
     }
+}
+
+// Reakcja na zmianę trybu świateł (wzory i miganie odtwarza timer LightManager)
+void lightTask() {
+    PROFILE_SCOPE(PERF_LIGHTS);
+    static LightManager::LightMode lastLightMode = lightManager.getMode();
+    static LightManager::ControlMode lastControlMode = lightManager.getControlMode();
 
     // Sprawdzanie zmian trybu świateł
     if (lightManager.getMode() != lastLightMode || lightManager.getControlMode() != lastControlMode) {
@@ -4234,9 +4062,20 @@ void loop() {
         applyBacklightSettings();
         updateActivityTime(); // Zmiana świateł to też aktywność
     }
+}
+
+// Odświeżanie ekranu - limit klatek pilnuje DisplayRenderer
+void displayTask() {
+    PROFILE_SCOPE(PERF_DISPLAY);
 
     // Tryb konfiguracji - wyświetlanie ekranu AP
-    if (configModeActive) {      
+    if (configModeActive) {
+        static unsigned long lastConfigScreen = 0;
+        if (millis() - lastConfigScreen < 1000) {
+            return;
+        }
+        lastConfigScreen = millis();
+
         display.clearBuffer();
 
         // Wycentruj każdą linię tekstu
@@ -4246,158 +4085,498 @@ void loop() {
         drawCenteredText("haslo: #mamrower", 51, czcionka_mala);
         drawCenteredText("IP: 192.168.4.1", 62, czcionka_mala);
 
-        display.sendBuffer();
-
-        // Sprawdź długie przytrzymanie SET do wyjścia
-        static unsigned long setPressStartTime = 0;
-        if (!digitalRead(BTN_SET)) { 
-            if (setPressStartTime == 0) {
-                setPressStartTime = millis();
-                updateActivityTime(); // Naciśnięcie przycisku to aktywność
-            } else if (millis() - setPressStartTime > 50) { // Zwiększono z 50ms na 1000ms dla pewności
-                deactivateConfigMode();
-                setPressStartTime = 0;
-            }
-        } else {
-            setPressStartTime = 0;
-        }
-        return; // Wyjdź z pętli loop gdy w trybie konfiguracji
+        displayRenderer.present();
+        displayRenderer.invalidate();
+        return;
     }
 
-    // Sprawdzaj czy nie trzeba włączyć trybu konfiguracji
-    checkConfigMode();
+    // Aktualizuj wyświetlacz tylko jeśli jest aktywny i nie wyświetla komunikatów
+    if (!displayActive || messageStartTime != 0) {
+        return;
+    }
 
-    // Obsługa przycisków
-    if (currentTime - lastButtonCheck >= buttonInterval) {
-        handleButtons(); // Ta funkcja powinna wewnątrz wywoływać updateActivityTime()
-        lastButtonCheck = currentTime;
+    // Sprawdzanie trybu prowadzenia roweru
+    bool sent;
+    if (walkAssistActive) {
+        sent = displayRenderer.renderFullScreen(drawWalkAssistScreen);
+    } else {
+        // Przerysowanie tylko zmienionych widżetów
+        sent = displayRenderer.render();
     }
 
-    // Obsługa migania świateł
-    lightManager.update(); // Aktualizacja stanu świateł
+    if (sent && !firstFrameShown) {
+        markFirstFrame();
+    }
+}
 
-    // Aktualizuj wyświetlacz tylko jeśli jest aktywny i nie wyświetla komunikatów
-    if (displayActive && messageStartTime == 0) {
-        display.clearBuffer();
-        
-        // Sprawdzanie trybu prowadzenia roweru
-        if (walkAssistActive) {
-            showWalkAssistMode(false);
-        } else {
-            drawTopBar();
-            drawHorizontalLine();
-            drawVerticalLine();
-            drawAssistLevel();
-            drawMainDisplay();
-            drawLightStatus();
-            handleTemperature();
-            updateBmsData();
+// Pierwsza klatka ekranu głównego po wybudzeniu - koniec pomiaru startu
+void markFirstFrame() {
+    bootTiming.firstFrameUs = (uint32_t)esp_timer_get_time();
+    firstFrameShown = true;
+    DEBUG_INFO("Start (%s): pierwsza klatka po %u ms, bez przytrzymania SET %u ms",
+        bootTiming.resumed ? "kopia RTC" : "pliki",
+        bootTiming.firstFrameUs / 1000, (bootTiming.firstFrameUs - bootTiming.holdUs) / 1000);
+}
+
+// Odłożony start (rdzeń usług): po pierwszej klatce albo po DEFERRED_START_TIMEOUT_MS.
+// Jednorazowy - na końcu włącza zadania korzystające z plików i BLE.
+void deferredStartTask() {
+    if (!firstFrameShown && millis() - setupDoneMs < DEFERRED_START_TIMEOUT_MS) {
+        return;
+    }
+    serviceScheduler.setEnabled(deferredStartTaskId, false);
+
+    // Po kopii RTC system plików nie był jeszcze montowany
+    if (!storageReady) {
+        startStorage();
+    }
+    if (storageReady) {
+        DEBUG_INFO("LittleFS: zajete %u/%u KB", LittleFS.usedBytes() / 1024, LittleFS.totalBytes() / 1024);
+        if (DebugLog::enabled(DebugLog::TAG_DETAIL)) {
+            listFiles();
         }
+    }
 
-        // Obliczanie kadencji
-        unsigned long now = millis();
-        if (now - last_rpm_calc >= rpm_calc_interval) {
-            unsigned long dt_sum = 0;
-            int valid_intervals = 0;
-            for (int i = 0; i < CADENCE_SAMPLES_WINDOW - 1; i++) {
-                unsigned long dt = cadence_pulse_times[i] - cadence_pulse_times[i + 1];
-                if (dt > 0 && cadence_pulse_times[i + 1] != 0) {
-                    dt_sum += dt;
-                    valid_intervals++;
-                }
-            }
-            
-            int rpm = 0;
-            if (valid_intervals > 0 && (now - cadence_pulse_times[0]) < 2000) {
-                float avg_period = (float)dt_sum / valid_intervals;
-                rpm = (60000.0 / avg_period) / cadence_pulses_per_revolution;
-            }
-            cadence_rpm = rpm;
-
-            // Histereza dla strzałki kadencji
-            switch (cadence_arrow_state) {
-                case ARROW_NONE:
-                    if (cadence_rpm > 0 && cadence_rpm < CADENCE_OPTIMAL_MIN)
-                        cadence_arrow_state = ARROW_DOWN;
-                    else if (cadence_rpm > CADENCE_OPTIMAL_MAX)
-                        cadence_arrow_state = ARROW_UP;
-                    break;
-                case ARROW_DOWN:
-                    if (cadence_rpm >= CADENCE_OPTIMAL_MIN + CADENCE_HYSTERESIS)
-                        cadence_arrow_state = ARROW_NONE;
-                    break;
-                case ARROW_UP:
-                    if (cadence_rpm <= CADENCE_OPTIMAL_MAX - CADENCE_HYSTERESIS)
-                        cadence_arrow_state = ARROW_NONE;
-                    break;
-            }
+    initializeNvs();
 
-            // Liczenie średniej/maksymalnej kadencji
-            cadence_sum += cadence_rpm;
-            cadence_samples++;
-            if (cadence_rpm > cadence_max_rpm) cadence_max_rpm = cadence_rpm;
+    // Inicjalizacja BLE jeśli potrzebne
+    if (bluetoothConfig.bmsEnabled || bluetoothConfig.tpmsEnabled) {
+        initializeBluetooth();
+    }
 
-            last_rpm_calc = now;
-        }
+    if (DebugLog::enabled(DebugLog::TAG_INFO)) {
+        printSystemInfo();
+    }
 
-        // Co 5s aktualizuj wyświetlaną średnią i max
-        if (now - last_avg_max_update >= AVG_MAX_UPDATE_INTERVAL) {
-            if (cadence_samples > 0)
-                cadence_avg_rpm = cadence_sum / cadence_samples;
-            else
-                cadence_avg_rpm = 0;
-            last_avg_max_update = now;
-        }
+    for (uint8_t i = 0; i < deferredTaskCount; i++) {
+        serviceScheduler.setEnabled(deferredTaskIds[i], true);
+    }
 
-        updateCadenceLogic();
-        drawCadenceArrowsAndCircle();
-        display.sendBuffer();
+    bootTiming.deferredUs = (uint32_t)esp_timer_get_time();
+    DEBUG_INFO("Start: odlozona czesc gotowa po %u ms", bootTiming.deferredUs / 1000);
+}
 
-        // Obsługa TPMS
-        if (bluetoothConfig.tpmsEnabled) {
-            if (tpmsScanning && (currentTime - lastTpmsScanTime > 5000)) {
-                stopTpmsScan();
-            }
-            
-            if (!tpmsScanning && (currentTime - lastTpmsScanTime > TPMS_SCAN_INTERVAL)) {
-                startTpmsScan();
-            }
-            
-            checkTpmsTimeout();
+// Czujniki temperatury
+void sensorTask() {
+    PROFILE_SCOPE(PERF_TEMPERATURE);
+    temperatures.update();
+    currentTemp = temperatures.get(TEMP_CHANNEL_AIR);
+    temp_controller = temperatures.get(TEMP_CHANNEL_CONTROLLER);
+    temp_motor = temperatures.get(TEMP_CHANNEL_MOTOR);
+}
+
+// Sekwencja zapytań BMS (zapis do charakterystyki BLE - rdzeń usług)
+void bmsTask() {
+    PROFILE_SCOPE(PERF_BMS);
+    updateBmsData();
+}
+
+// Migawka stanu jazdy dla rdzenia usług
+void publishRideSnapshot() {
+    RideSnapshot snapshot;
+    snapshot.stampMs = millis();
+    snapshot.epoch = topBarTime.unixtime();
+    snapshot.speedKmh = speed_kmh;
+    snapshot.distanceKm = distance_km;
+    snapshot.batteryVoltage = battery_voltage;
+    snapshot.batteryCurrent = battery_current;
+    snapshot.tempAir = currentTemp;
+    snapshot.tempController = temp_controller;
+    snapshot.tempMotor = temp_motor;
+    snapshot.odometerMeters = odometer.getTotalMeters();
+    snapshot.cadenceRpm = cadence_rpm;
+    snapshot.powerW = power_w;
+    snapshot.batteryPercent = battery_capacity_percent;
+    snapshot.assistLevel = assistLevel;
+    snapshot.lightMode = lightManager.getMode();
+    snapshot.lightDayConfig = lightManager.getDayConfig();
+    snapshot.lightNightConfig = lightManager.getNightConfig();
+    rideSnapshot.write(snapshot);
+}
+
+// Energia i statystyki przejazdu dla magazynu ustawień - zapis pliku na rdzeniu usług
+// kopiuje migawkę, nie struktury zmieniane właśnie przez pętlę główną
+void publishPersistSnapshots() {
+    energySnapshot.write(*energy.getStateData());
+    tripSnapshot.write(tripMetrics);
+}
+
+// Dane z rdzenia usług: czujniki TPMS i aktywność WWW
+void applyServiceSnapshot() {
+    static uint32_t appliedVersion = 0;
+    uint32_t version = serviceSnapshot.getVersion();
+    if (version == appliedVersion) {
+        return;
+    }
+
+    ServiceSnapshot snapshot;
+    if (!serviceSnapshot.read(snapshot)) {
+        return;
+    }
+    appliedVersion = version;
+
+    pressure_bar = snapshot.front.pressureBar;
+    pressure_temp = snapshot.front.temperature;
+    pressure_voltage = snapshot.front.batteryPercent / 100.0; // Konwersja % na napięcie 0-1
+    pressure_active = snapshot.front.active;
+    pressure_rear_bar = snapshot.rear.pressureBar;
+    pressure_rear_temp = snapshot.rear.temperature;
+    pressure_rear_voltage = snapshot.rear.batteryPercent / 100.0;
+    pressure_rear_active = snapshot.rear.active;
+
+    clockEpoch = snapshot.rtcEpoch;
+    clockStampMs = snapshot.rtcStampMs;
+
+    // Połączony klient WWW wstrzymuje automatyczne wyłączenie
+    webConfigActive = snapshot.webClients > 0;
+    if (webConfigActive) {
+        updateActivityTime();
+    }
+}
+
+// Wymiana migawek po stronie pętli głównej
+void snapshotTask() {
+    publishRideSnapshot();
+    publishPersistSnapshots();
+    applyServiceSnapshot();
+}
+
+static void fillTpmsWheel(TpmsWheelSnapshot& wheel, const TpmsData& sensor) {
+    wheel.pressureBar = sensor.pressure;
+    wheel.temperature = sensor.temperature;
+    wheel.batteryPercent = sensor.batteryPercent;
+    wheel.active = sensor.isActive;
+}
+
+// Migawka stanu usług dla pętli głównej
+void serviceSnapshotTask() {
+    ServiceSnapshot snapshot;
+    snapshot.stampMs = millis();
+    fillTpmsWheel(snapshot.front, frontTpms);
+    fillTpmsWheel(snapshot.rear, rearTpms);
+    snapshot.webClients = ws.count();
+    snapshot.rtcEpoch = rtcEpoch;
+    snapshot.rtcStampMs = rtcStampMs;
+    serviceSnapshot.write(snapshot);
+}
+
+// Odczyt RTC - jedyna cykliczna transakcja zegara na wspólnej magistrali I2C
+void clockTask() {
+    DateTime now;
+    {
+        I2cBusLock lock;
+        now = rtc.now();
+    }
+    rtcEpoch = now.unixtime();
+    rtcStampMs = millis();
+}
+
+// Obsługa TPMS
+void tpmsTask() {
+    PROFILE_SCOPE(PERF_TPMS);
+    if (!bluetoothConfig.tpmsEnabled) {
+        return;
+    }
+
+    // Odczyty przekazane z zadania BLE
+    TpmsReading reading;
+    while (tpmsReceiver.pop(reading)) {
+        updateTpmsData(reading);
+        tpmsScheduler.onReading(reading.position, reading.receivedMs);
+    }
+
+    unsigned long currentTime = millis();
+    static unsigned long lastMovingTime = 0;
+    RideSnapshot ride;
+    if (rideSnapshot.read(ride) && ride.speedKmh >= 1.0) {
+        lastMovingTime = currentTime;
+    }
+    tpmsScheduler.setParked(currentTime - lastMovingTime > TPMS_PARKED_AFTER_MS);
+
+    // Okna skanowania wyznacza harmonogram na podstawie okresów rozgłoszeń czujników
+    switch (tpmsScheduler.update(currentTime)) {
+        case TpmsScanScheduler::START_SCAN:
+            startTpmsScan();
+            break;
+        case TpmsScanScheduler::STOP_SCAN:
+            stopTpmsScan();
+            break;
+        default:
+            break;
+    }
+    
+    checkTpmsTimeout();
+}
+
+// Migawka jazdy, z której formatowana jest bieżąca wysyłka telemetrii
+RideSnapshot telemetryRide;
+
+// Status w formacie JSON dla klientów bez negocjacji (dotychczasowy format)
+size_t formatTelemetryJson(char* buffer, size_t len) {
+    const RideSnapshot& ride = telemetryRide;
+    char temperature[12] = "null";
+    if (ride.tempAir != TEMP_INVALID) {
+        snprintf(temperature, sizeof(temperature), "%.1f", ride.tempAir);
+    }
+    int written = snprintf(buffer, len,
+        "{\"speed\":%.1f,\"temperature\":%s,\"battery\":%d,\"power\":%d,"
+        "\"lights\":{\"mode\":\"%s\",\"dayConfig\":\"%s\",\"nightConfig\":\"%s\"}}",
+        ride.speedKmh, temperature, ride.batteryPercent, ride.powerW,
+        LightManager::getModeName((LightManager::LightMode)ride.lightMode),
+        LightManager::getConfigName(ride.lightDayConfig),
+        LightManager::getConfigName(ride.lightNightConfig));
+    return (written > 0 && (size_t)written < len) ? written : 0;
+}
+
+// Temperatura w 0.1 °C; brak odczytu jako TELEMETRY_NO_VALUE, nie -999 °C
+int32_t telemetryTemperature(float celsius) {
+    return celsius == TEMP_INVALID ? TELEMETRY_NO_VALUE : lroundf(celsius * 10);
+}
+
+// Migawka pomiarów w jednostkach stałoprzecinkowych protokołu telemetrii
+void collectTelemetry(const RideSnapshot& ride, TelemetrySnapshot& snapshot) {
+    snapshot.values[TELEMETRY_SPEED] = lroundf(ride.speedKmh * 10);
+    snapshot.values[TELEMETRY_CADENCE] = ride.cadenceRpm;
+    snapshot.values[TELEMETRY_POWER] = ride.powerW;
+    snapshot.values[TELEMETRY_VOLTAGE] = lroundf(ride.batteryVoltage * 10);
+    snapshot.values[TELEMETRY_CURRENT] = lroundf(ride.batteryCurrent * 10);
+    snapshot.values[TELEMETRY_BATTERY] = ride.batteryPercent;
+    snapshot.values[TELEMETRY_TEMP_AIR] = telemetryTemperature(ride.tempAir);
+    snapshot.values[TELEMETRY_TEMP_CONTROLLER] = telemetryTemperature(ride.tempController);
+    snapshot.values[TELEMETRY_TEMP_MOTOR] = telemetryTemperature(ride.tempMotor);
+    snapshot.values[TELEMETRY_ASSIST] = ride.assistLevel;
+    snapshot.values[TELEMETRY_LIGHT_MODE] = ride.lightMode;
+    snapshot.values[TELEMETRY_LIGHT_DAY] = ride.lightDayConfig;
+    snapshot.values[TELEMETRY_LIGHT_NIGHT] = ride.lightNightConfig;
+    snapshot.values[TELEMETRY_TRIP_DISTANCE] = lroundf(ride.distanceKm * 1000);
+    snapshot.values[TELEMETRY_ODOMETER] = ride.odometerMeters;
+}
+
+// Wysyłka telemetrii WebSocket (aktywność WWW przekazuje migawka usług)
+void webSocketTask() {
+    PROFILE_SCOPE(PERF_WEBSOCKET);
+    if (ws.count() > 0 && rideSnapshot.read(telemetryRide)) {
+        // Kanał sam decyduje, którym klientom minął okres wysyłki
+        TelemetrySnapshot snapshot;
+        collectTelemetry(telemetryRide, snapshot);
+        telemetry.publish(snapshot);
+    }
+}
+
+// Sprawdzanie automatycznego wyłączania (tylko gdy nie ma aktywnej konfiguracji)
+void autoOffTask() {
+    if (displayActive && !configModeActive && !showingWelcome && !webConfigActive) {
+        checkAutoOff();
+    }
+}
+
+// Stan baterii i zasięg z ostatniej odpowiedzi BMS
+void dataUpdateTask() {
+
+    // Zasięg z pozostałej energii według BMS i bieżącego zużycia
+    BmsData bmsData;
+    if (bms.read(bmsData)) {
+        battery_voltage = bmsData.voltage;
+        battery_capacity_percent = bmsData.soc;
+        battery_capacity_ah = bmsData.remainingCapacity;
+        battery_capacity_wh = bmsData.remainingCapacity * bmsData.voltage;
+        range_km = energy.estimateRangeKm(battery_capacity_wh);
+    }
+}
+
+// Próbkowanie telemetrii do rejestratora przejazdów (z migawki jazdy - rdzeń usług,
+// razem z zapisem bloków, więc plik przejazdu obsługuje jedno zadanie)
+void rideSampleTask() {
+    static unsigned long rideStartMs = 0;
+
+    RideSnapshot ride;
+    if (!rideSnapshot.read(ride)) {
+        return;
+    }
+
+    // Przejazd zaczyna się przy pierwszym ruchu lub pedałowaniu
+    if (!rideRecorder.isActive()) {
+        if (ride.speedKmh <= 0.0f && ride.cadenceRpm <= 0) {
+            return;
+        }
+        if (!rideRecorder.startRide(ride.epoch)) {
+            return;
         }
+        rideStartMs = millis();
+    }
+
+    RideSample sample;
+    sample.values[RIDE_COL_TIME] = millis() - rideStartMs;
+    sample.values[RIDE_COL_SPEED] = lroundf(ride.speedKmh * 10.0f);
+    sample.values[RIDE_COL_CADENCE] = ride.cadenceRpm;
+    sample.values[RIDE_COL_POWER] = ride.powerW;
+    sample.values[RIDE_COL_VOLTAGE] = lroundf(ride.batteryVoltage * 10.0f);
+    sample.values[RIDE_COL_CURRENT] = lroundf(ride.batteryCurrent * 10.0f);
+    sample.values[RIDE_COL_BATTERY] = ride.batteryPercent;
+    sample.values[RIDE_COL_TEMP_AIR] = lroundf(ride.tempAir * 10.0f);
+    sample.values[RIDE_COL_TEMP_MOTOR] = lroundf(ride.tempMotor * 10.0f);
+    sample.values[RIDE_COL_DISTANCE] = lroundf(ride.distanceKm * 1000.0f);
+    rideRecorder.record(sample);
+}
 
-        // Aktualizacja danych co określony interwał
-        if (currentTime - lastUpdate >= updateInterval) {
-            // Aktualizacja wszystkich danych (prędkość, temperatura, itp.)
-            speed_kmh = (speed_kmh >= 35.0) ? 0.0 : speed_kmh + 0.1;
-            temp_motor = 30.0 + random(20);
-            range_km = 50.0 - (random(20) / 10.0);
-            odometer.updateTotal(distance_km);
-            distance_km += 0.1;
-            power_w = 100 + random(300);
-            power_avg_w = power_w * 0.8;
-            power_max_w = power_w * 1.2;
-            battery_current = random(50, 150) / 10.0;
-            battery_capacity_wh = battery_voltage * battery_capacity_ah;
-            battery_capacity_wh = 14.5 - (random(20) / 10.0);
-            battery_capacity_percent = (battery_capacity_percent <= 0) ? 100 : battery_capacity_percent - 1;
-            battery_voltage = (battery_voltage <= 42.0) ? 50.0 : battery_voltage - 0.1;
-            
-            // Aktualizacja średniej i maksymalnej prędkości
-            static float speed_sum = 0;
-            static int speed_count = 0;
-            speed_sum += speed_kmh;
-            speed_count++;
-            speed_avg_kmh = speed_sum / speed_count;
-            if (speed_kmh > speed_max_kmh) {
-                speed_max_kmh = speed_kmh;
+// Zapis pełnych bloków przejazdu poza ścieżką próbkowania
+void rideFlushTask() {
+    rideRecorder.flush();
+}
+
+// Odłożony zapis ustawień - seria zmian z WWW kończy się jednym zapisem
+void settingsTask() {
+    settingsStore.update();
+}
+
+// Automatyczny zapis danych
+void autoSaveTask() {
+    // Licznik zapisuje się co ODOMETER_COMMIT_METERS; tu dopisuje resztę po postoju
+    odometer.update();
+}
+
+// Debugowanie stanu auto-off i statystyki podsystemów
+void debugTask() {
+    static unsigned long prevActivityTime = 0;
+    unsigned long currentTime = millis();
+
+    // Sprawdź czy lastActivityTime się zmienia (wskazuje na aktywność)
+    bool activityDetected = (lastActivityTime != prevActivityTime);
+    prevActivityTime = lastActivityTime;
+    
+    DEBUG_INFO("Auto-off status: czas=%d min, lastActivity=%u s, konfiguracja=%s, WWW=%s, aktywnosc=%s", 
+        generalSettings.autoOffTime, 
+        (currentTime - lastActivityTime) / 1000, 
+        configModeActive ? "TAK" : "NIE",
+        webConfigActive ? "TAK" : "NIE",
+        activityDetected ? "WYKRYTA" : "BRAK");
+
+    // Statystyki przepustowości pętli za ostatnie okno
+    loopMonitor.printReport();
+
+    DEBUG_INFO("KT: ramki=%u, bledy CRC=%u, odrzucone bajty=%u, opoznienie=%u/%u us",
+        ktController.getTelemetry().frameCount,
+        ktController.getDecoder().getChecksumErrors(),
+        ktController.getDecoder().getDiscardedBytes(),
+        ktController.getLastLatencyUs(),
+        ktController.getMaxLatencyUs());
+
+    DisplayRenderer::Stats displayStats = displayRenderer.collectStats();
+    DEBUG_INFO("OLED: %u B/s przez I2C, %u klatek/s, przerysowania widzetow=%u, pelne klatki=%u, odlozone=%u",
+        displayStats.bytesPerSec, displayStats.flushesPerSec,
+        displayStats.widgetRedraws, displayStats.fullFrames, displayStats.deferredFrames);
+    DEBUG_INFO("OLED (%s): zatrzymanie petli %u/%u us na klatke, zapis I2C %u/%u us",
+        displayStats.async ? "zadanie zapisu" : "synchronicznie",
+        displayStats.avgStallUs, displayStats.maxStallUs,
+        displayStats.avgFlushUs, displayStats.maxFlushUs);
+
+    const TaskScheduler* schedulers[] = { &scheduler, &serviceScheduler };
+    for (const TaskScheduler* taskScheduler : schedulers) {
+        for (uint8_t i = 0; i < taskScheduler->getTaskCount(); i++) {
+            const TaskScheduler::Task& task = taskScheduler->getTask(i);
+            if (task.misses > 0 || task.overruns > 0) {
+                DEBUG_INFO("Zadanie %s: spoznienia=%u, przekroczenia=%u, max czas=%u us, max spoznienie=%u us",
+                    task.name, task.misses, task.overruns, task.maxRunUs, task.maxLatenessUs);
             }
-            
-            lastUpdate = currentTime;
         }
     }
 }
 
+// Zadanie usług: własny harmonogram na rdzeniu 0; kończy się na żądanie przed uśpieniem
+void serviceTask(void* arg) {
+    while (!serviceStopRequested) {
+        uint32_t untilNextUs = serviceScheduler.run();
+        serviceScheduler.idle(untilNextUs);
+    }
+    serviceStopped = true;
+    vTaskDelete(nullptr);
+}
+
+void startServiceTask() {
+    serviceStopRequested = false;
+    serviceStopped = false;
+    if (xTaskCreatePinnedToCore(serviceTask, "service", SERVICE_TASK_STACK, nullptr,
+                                SERVICE_TASK_PRIORITY, &serviceTaskHandle, SERVICE_TASK_CORE) != pdPASS) {
+        serviceTaskHandle = nullptr;
+        DEBUG_ERROR("Nie udalo sie uruchomic zadania uslug");
+        return;
+    }
+    Profiler::watchTask("service", serviceTaskHandle);
+}
+
+// Zatrzymanie po zakończeniu bieżącego zadania - nie w trakcie zapisu pliku
+void stopServiceTask() {
+    if (serviceTaskHandle == nullptr) {
+        return;
+    }
+
+    serviceStopRequested = true;
+    unsigned long startMs = millis();
+    while (!serviceStopped && millis() - startMs < SERVICE_STOP_TIMEOUT_MS) {
+        delay(1);
+    }
+    if (!serviceStopped) {
+        DEBUG_ERROR("Zadanie uslug nie zatrzymalo sie w %u ms", SERVICE_STOP_TIMEOUT_MS);
+    }
+    serviceTaskHandle = nullptr;
+}
+
+// Rejestracja podsystemów w harmonogramach obu rdzeni
+void setupScheduler() {
+    // Rdzeń 1 (loop) - wszystko, co widzi rowerzysta
+    scheduler.addTask("controller", 5,     TaskScheduler::PRIORITY_HIGH,   controllerTask);
+    scheduler.addTask("buttons",    5,     TaskScheduler::PRIORITY_HIGH,   buttonTask);
+    scheduler.addTask("brake",      10,    TaskScheduler::PRIORITY_HIGH,   brakeTask);
+    scheduler.addTask("cadence",    100,   TaskScheduler::PRIORITY_HIGH,   cadenceTask);
+    scheduler.addTask("lights",     50,    TaskScheduler::PRIORITY_NORMAL, lightTask);
+    scheduler.addTask("display",    10,    TaskScheduler::PRIORITY_NORMAL, displayTask);
+    scheduler.addTask("snapshot",   SNAPSHOT_PERIOD_MS, TaskScheduler::PRIORITY_NORMAL, snapshotTask);
+    scheduler.addTask("sensors",    100,   TaskScheduler::PRIORITY_LOW,    sensorTask);
+    scheduler.addTask("data",       2000,  TaskScheduler::PRIORITY_LOW,    dataUpdateTask);
+    scheduler.addTask("autoOff",    5000,  TaskScheduler::PRIORITY_LOW,    autoOffTask);
+    scheduler.addTask("debug",      10000, TaskScheduler::PRIORITY_LOW,    debugTask);
+    scheduler.addTask("autoSave",   60000, TaskScheduler::PRIORITY_LOW,    autoSaveTask);
+    scheduler.resetStats();
+
+    // Rdzeń 0 - radio, WWW i zapis plików; z rdzeniem 1 tylko przez migawki
+    deferredStartTaskId = serviceScheduler.addTask("deferredStart", 20, TaskScheduler::PRIORITY_HIGH, deferredStartTask);
+    serviceScheduler.addTask("serviceSnapshot", SNAPSHOT_PERIOD_MS, TaskScheduler::PRIORITY_HIGH, serviceSnapshotTask);
+    serviceScheduler.addTask("websocket",  50,    TaskScheduler::PRIORITY_NORMAL, webSocketTask);
+    serviceScheduler.addTask("clock",      RTC_READ_INTERVAL_MS, TaskScheduler::PRIORITY_NORMAL, clockTask);
+
+    // Pliki i BLE - włączane po odłożonym starcie
+    deferredTaskCount = 0;
+    deferredTaskIds[deferredTaskCount++] = serviceScheduler.addTask("bms",        100,   TaskScheduler::PRIORITY_NORMAL, bmsTask);
+    deferredTaskIds[deferredTaskCount++] = serviceScheduler.addTask("tpms",       100,   TaskScheduler::PRIORITY_NORMAL, tpmsTask);
+    rideSampleTaskId = serviceScheduler.addTask("rideSample", rideRecorder.getSamplePeriodMs(), TaskScheduler::PRIORITY_NORMAL, rideSampleTask);
+    deferredTaskIds[deferredTaskCount++] = rideSampleTaskId;
+    deferredTaskIds[deferredTaskCount++] = serviceScheduler.addTask("rideFlush",  1000,  TaskScheduler::PRIORITY_LOW,    rideFlushTask);
+    deferredTaskIds[deferredTaskCount++] = serviceScheduler.addTask("settings",   250,   TaskScheduler::PRIORITY_LOW,    settingsTask);
+    for (uint8_t i = 0; i < deferredTaskCount; i++) {
+        serviceScheduler.setEnabled(deferredTaskIds[i], false);
+    }
+    serviceScheduler.resetStats();
+    Profiler::reset();
+
+    // Pierwsze migawki przed startem drugiego rdzenia
+    publishRideSnapshot();
+    publishPersistSnapshots();
+    startServiceTask();
+
+    // Od teraz logi wysyła drain() w czasie bezczynności harmonogramów
+    DebugLog::flush();
+    DebugLog::setDeferred(true);
+}
+
+// Implementacja funkcji loop
+void loop() {
+    // Pomiar czasu pełnego obiegu pętli
+    loopMonitor.tick();
+
+    // Wykonaj zadania, których termin minął, i odpocznij do następnego
+    uint32_t untilNextUs = scheduler.run();
+    scheduler.idle(untilNextUs);
+}
 
 /*
 Piny przycisków
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ButtonManager.h"
+#include "FakeClock.h"
+
+// Tablica gestów zasilana sekwencjami zboczy z czasami jak z przerwania:
+// drgania styków, kliknięcia, podwójne kliknięcia, przytrzymania, kombinacje
+// i konteksty. process() wołane co BUTTON_TIMER_PERIOD_US jak z timera.
+
+static std::vector<int> fired;
+
+template <int N>
+static void record() {
+    fired.push_back(N);
+}
+
+enum TestGesture {
+    UP_CLICK,
+    UP_LONG,
+    DOWN_CLICK,
+    DOWN_REPEAT,
+    SET_CLICK,
+    SET_DOUBLE,
+    SET_RELEASE,
+    UP_DOWN_COMBO,
+    OFF_SET_LONG
+};
+
+static const ButtonGesture GESTURES[] = {
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP, GESTURE_CLICK, 0, 0, record<UP_CLICK> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP, GESTURE_LONG_PRESS, 1000, 0, record<UP_LONG> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN, GESTURE_CLICK, 0, 0, record<DOWN_CLICK> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN, GESTURE_HOLD_REPEAT, 500, 200, record<DOWN_REPEAT> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET, GESTURE_CLICK, 0, 0, record<SET_CLICK> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET, GESTURE_DOUBLE_CLICK, 300, 0, record<SET_DOUBLE> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET, GESTURE_RELEASE, 0, 0, record<SET_RELEASE> },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP | BUTTON_MASK_DOWN, GESTURE_COMBO, 2000, 0, record<UP_DOWN_COMBO> },
+    { BUTTON_CONTEXT_OFF, BUTTON_MASK_SET, GESTURE_LONG_PRESS, 2000, 0, record<OFF_SET_LONG> }
+};
+
+class ButtonManagerTest : public ::testing::Test {
+protected:
+    ButtonManager buttons { GESTURES, sizeof(GESTURES) / sizeof(GESTURES[0]) };
+    uint32_t startUs = 0;
+    std::vector<ButtonEvent> events;
+
+    void SetUp() override {
+        FakeClock::reset();
+        fired.clear();
+        buttons.setContext(BUTTON_CONTEXT_NORMAL);
+    }
+
+    // Zbocze w chwili ms od początku testu (stan wszystkich przycisków)
+    void edge(uint32_t ms, uint8_t mask) {
+        runUntil(ms);
+        buttons.onEdge(mask, startUs + ms * 1000);
+    }
+
+    // Zbocze z drganiami styku: trzy przełączenia w ciągu 6 ms przed stanem końcowym
+    void bouncyEdge(uint32_t ms, uint8_t from, uint8_t to) {
+        edge(ms, to);
+        buttons.onEdge(from, startUs + ms * 1000 + 2000);
+        buttons.onEdge(to, startUs + ms * 1000 + 4000);
+        buttons.onEdge(from, startUs + ms * 1000 + 5000);
+        buttons.onEdge(to, startUs + ms * 1000 + 6000);
+    }
+
+    // Timer co BUTTON_TIMER_PERIOD_US aż do chwili ms
+    void runUntil(uint32_t ms) {
+        while ((int32_t)(startUs + ms * 1000 - (uint32_t)FakeClock::nowUs()) >= (int32_t)BUTTON_TIMER_PERIOD_US) {
+            FakeClock::advanceUs(BUTTON_TIMER_PERIOD_US);
+            buttons.process(micros());
+        }
+    }
+
+    // Koniec sekwencji: gesty do pętli głównej
+    void finish(uint32_t ms) {
+        runUntil(ms);
+        buttons.dispatch();
+    }
+};
+
+TEST_F(ButtonManagerTest, ShortPressIsClick) {
+    edge(100, BUTTON_MASK_UP);
+    edge(180, 0);
+    finish(600);
+    EXPECT_EQ(fired, std::vector<int>({ UP_CLICK }));
+
+    // Rozpoznanie najpóźniej debounce + okres timera po puszczeniu
+    EXPECT_LE(buttons.getMaxDetectUs(), BUTTON_DEBOUNCE_US + BUTTON_TIMER_PERIOD_US);
+}
+
+TEST_F(ButtonManagerTest, ContactBounceGivesSingleClick) {
+    bouncyEdge(100, 0, BUTTON_MASK_DOWN);
+    bouncyEdge(200, BUTTON_MASK_DOWN, 0);
+    finish(600);
+    EXPECT_EQ(fired, std::vector<int>({ DOWN_CLICK }));
+}
+
+TEST_F(ButtonManagerTest, BounceShorterThanDebounceIsIgnored) {
+    // Impuls 10 ms - stan wraca, zanim minie BUTTON_DEBOUNCE_US
+    edge(100, BUTTON_MASK_UP);
+    buttons.onEdge(0, startUs + 110000);
+    finish(600);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_EQ(buttons.getPressedMask(), 0);
+}
+
+TEST_F(ButtonManagerTest, LongPressFiresOnceWithoutClick) {
+    edge(100, BUTTON_MASK_UP);
+    finish(1095);
+    EXPECT_TRUE(fired.empty());
+    finish(1140);
+    EXPECT_EQ(fired, std::vector<int>({ UP_LONG }));
+
+    edge(3000, 0);
+    finish(3500);
+    EXPECT_EQ(fired, std::vector<int>({ UP_LONG }));
+}
+
+TEST_F(ButtonManagerTest, HoldRepeatsUntilRelease) {
+    edge(100, BUTTON_MASK_DOWN);
+    edge(1050, 0);  // Próg 500 ms, powtórzenia po 700 i 900 ms
+    finish(1500);
+    EXPECT_EQ(fired, std::vector<int>({ DOWN_REPEAT, DOWN_REPEAT, DOWN_REPEAT }));
+}
+
+TEST_F(ButtonManagerTest, ClickWaitsForDoubleClickWindow) {
+    edge(100, BUTTON_MASK_SET);
+    edge(180, 0);
+    finish(450);
+    // Puszczenie od razu, kliknięcie dopiero po oknie 300 ms
+    EXPECT_EQ(fired, std::vector<int>({ SET_RELEASE }));
+    finish(600);
+    EXPECT_EQ(fired, std::vector<int>({ SET_RELEASE, SET_CLICK }));
+}
+
+TEST_F(ButtonManagerTest, DoubleClickReplacesClicks) {
+    edge(100, BUTTON_MASK_SET);
+    edge(160, 0);
+    edge(260, BUTTON_MASK_SET);
+    edge(330, 0);
+    finish(1000);
+    EXPECT_EQ(fired, std::vector<int>({ SET_RELEASE, SET_RELEASE, SET_DOUBLE }));
+}
+
+TEST_F(ButtonManagerTest, SlowSecondClickIsTwoClicks) {
+    edge(100, BUTTON_MASK_SET);
+    edge(160, 0);
+    edge(600, BUTTON_MASK_SET);
+    edge(660, 0);
+    finish(1200);
+    EXPECT_EQ(fired, std::vector<int>({ SET_RELEASE, SET_CLICK, SET_RELEASE, SET_CLICK }));
+}
+
+TEST_F(ButtonManagerTest, ComboConsumesPressesOfBothButtons) {
+    edge(100, BUTTON_MASK_UP);
+    edge(150, BUTTON_MASK_UP | BUTTON_MASK_DOWN);
+    finish(2140);
+    EXPECT_TRUE(fired.empty());
+    finish(2200);
+    EXPECT_EQ(fired, std::vector<int>({ UP_DOWN_COMBO }));
+
+    // Puszczenie po kombinacji nie daje kliknięć ani długiego naciśnięcia
+    edge(2500, BUTTON_MASK_UP);
+    edge(2600, 0);
+    finish(4000);
+    EXPECT_EQ(fired, std::vector<int>({ UP_DOWN_COMBO }));
+}
+
+TEST_F(ButtonManagerTest, OverlappingShortPressesGiveNoClicks) {
+    edge(100, BUTTON_MASK_UP);
+    edge(150, BUTTON_MASK_UP | BUTTON_MASK_DOWN);
+    edge(250, BUTTON_MASK_DOWN);
+    edge(300, 0);
+    finish(1000);
+    EXPECT_TRUE(fired.empty());
+
+    // Kolejne naciśnięcie działa normalnie
+    edge(1100, BUTTON_MASK_UP);
+    edge(1180, 0);
+    finish(1500);
+    EXPECT_EQ(fired, std::vector<int>({ UP_CLICK }));
+}
+
+TEST_F(ButtonManagerTest, ContextSelectsGestures) {
+    buttons.setContext(BUTTON_CONTEXT_OFF);
+    edge(100, BUTTON_MASK_UP);
+    edge(180, 0);
+    edge(300, BUTTON_MASK_SET);
+    finish(2400);
+    EXPECT_EQ(fired, std::vector<int>({ OFF_SET_LONG }));
+    edge(2500, 0);
+
+    buttons.setContext(BUTTON_CONTEXT_NONE);
+    edge(3000, BUTTON_MASK_SET);
+    edge(3100, 0);
+    edge(3200, BUTTON_MASK_DOWN);
+    edge(4000, 0);
+    finish(5000);
+    EXPECT_EQ(fired, std::vector<int>({ OFF_SET_LONG }));
+}
+
+TEST_F(ButtonManagerTest, ThresholdsSurviveMicrosOverflow) {
+    // Przytrzymanie przechodzi przez przepełnienie micros() (co ~71 min)
+    FakeClock::reset(0x100000000ULL - 500000);
+    startUs = (uint32_t)FakeClock::nowUs();
+    edge(100, BUTTON_MASK_UP);
+    finish(1095);
+    EXPECT_TRUE(fired.empty());
+    finish(1140);
+    EXPECT_EQ(fired, std::vector<int>({ UP_LONG }));
+}
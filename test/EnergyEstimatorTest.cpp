@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "EnergyEstimator.h"
+
+// Całkowanie mocy i przypisanie energii do kilometrów, także gdy jeden
+// odcinek obejmuje kilka kilometrów naraz
+
+class EnergyEstimatorTest : public ::testing::Test {
+protected:
+    EnergyEstimator energy;
+
+    // Stała moc przez podany czas, próbki co 100 ms
+    void drive(float powerW, uint32_t seconds, uint32_t& stampUs) {
+        for (uint32_t i = 0; i < seconds * 10; i++) {
+            stampUs += 100000;
+            energy.addSample(stampUs, 50.0f, powerW / 50.0f);
+        }
+    }
+};
+
+TEST_F(EnergyEstimatorTest, IntegratesPowerAndSkipsGaps) {
+    uint32_t stampUs = 0;
+    energy.addSample(stampUs, 50.0f, 10.0f);
+    drive(500.0f, 36, stampUs);
+    EXPECT_NEAR(energy.getTripWh(), 5.0f, 0.01f);
+
+    // Przerwa dłuższa niż ENERGY_MAX_GAP_US - bez energii za ten czas
+    stampUs += ENERGY_MAX_GAP_US + 1;
+    energy.addSample(stampUs, 50.0f, 10.0f);
+    EXPECT_NEAR(energy.getTripWh(), 5.0f, 0.01f);
+}
+
+TEST_F(EnergyEstimatorTest, LongSegmentIsSpreadOverKilometres) {
+    uint32_t stampUs = 0;
+    energy.addSample(stampUs, 50.0f, 0.0f);
+    drive(360.0f, 350, stampUs);   // 35 Wh
+    float tripWh = energy.getTripWh();
+
+    energy.addDistance(3.5f);
+
+    EXPECT_EQ(energy.getRollingKm(), 3);
+    const EnergyState* state = energy.getStateData();
+    EXPECT_NEAR(state->currentKm, 0.5f, 1e-4f);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_NEAR(state->bucketWh[i], tripWh / 3.5f, 0.01f);
+    }
+    EXPECT_NEAR(energy.getRollingWhPerKm(), tripWh / 3.5f, 0.01f);
+    EXPECT_NEAR(state->rollingWh + state->currentWh, tripWh, 0.01f);
+}
+
+TEST_F(EnergyEstimatorTest, SegmentLongerThanWindowKeepsSumsConsistent) {
+    uint32_t stampUs = 0;
+    energy.addSample(stampUs, 50.0f, 0.0f);
+    drive(240.0f, 600, stampUs);   // 40 Wh
+    energy.addDistance(ENERGY_ROLLING_KM + 2.25f);
+
+    const EnergyState* state = energy.getStateData();
+    EXPECT_EQ(energy.getRollingKm(), ENERGY_ROLLING_KM);
+    float sum = 0;
+    for (uint8_t i = 0; i < ENERGY_ROLLING_KM; i++) sum += state->bucketWh[i];
+    EXPECT_NEAR(state->rollingWh, sum, 1e-3f);
+    EXPECT_NEAR(state->currentKm, 0.25f, 1e-3f);
+    EXPECT_NEAR(energy.getRollingWhPerKm(), 40.0f / (ENERGY_ROLLING_KM + 2.25f), 0.01f);
+}
+
+TEST_F(EnergyEstimatorTest, RangeUsesPriorUntilEnoughKilometres) {
+    EXPECT_FLOAT_EQ(energy.getWhPerKm(), ENERGY_DEFAULT_WH_PER_KM);
+    EXPECT_FLOAT_EQ(energy.estimateRangeKm(120.0f), 120.0f / ENERGY_DEFAULT_WH_PER_KM);
+    EXPECT_FLOAT_EQ(energy.estimateRangeKm(0), 0);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "HostSimulator.h"
+#include "FakeClock.h"
+
+// Przebieg symulatora: dane ze sterownika, kadencja, przyciski i ekran
+// przechodzą przez te same moduły i zadania co na rowerze
+
+TEST(HostSimulatorTest, RideReachesSpeedDistanceAndCadence) {
+    HostSimulator sim;
+    sim.begin();
+    sim.setRide({ 25.0f, 90, 8.0f, true });
+    sim.runFor(10000);
+
+    EXPECT_NEAR(sim.getSpeedKmh(), 25.0f, 0.2f);
+    // 10 s przy 25 km/h to ~69 m (pierwsza ramka bez całkowania)
+    EXPECT_NEAR(sim.getDistanceKm(), 0.069f, 0.003f);
+    EXPECT_NEAR(sim.getCadenceRpm(), 90, 1);
+    EXPECT_EQ(sim.getPowerW(), (int)(SIM_BMS_VOLTAGE * 8.0f));
+    EXPECT_EQ(sim.getController().getDecoder().getChecksumErrors(), 0u);
+
+    RideSnapshot snapshot;
+    ASSERT_TRUE(sim.readRideSnapshot(snapshot));
+    EXPECT_NEAR(snapshot.speedKmh, 25.0f, 0.2f);
+    EXPECT_EQ(snapshot.cadenceRpm, sim.getCadenceRpm());
+}
+
+TEST(HostSimulatorTest, IdenticalRunsAreDeterministic) {
+    uint32_t iterations[2];
+    float distance[2];
+    for (int run = 0; run < 2; run++) {
+        HostSimulator sim;
+        sim.begin();
+        sim.setRide({ 18.0f, 70, 5.0f, true });
+        iterations[run] = sim.runFor(5000);
+        distance[run] = sim.getDistanceKm();
+    }
+    EXPECT_EQ(iterations[0], iterations[1]);
+    EXPECT_EQ(distance[0], distance[1]);
+}
+
+TEST(HostSimulatorTest, ButtonsDriveAssistAndLights) {
+    HostSimulator sim;
+    sim.begin();
+    sim.runFor(200);
+    uint8_t assist = sim.getAssistLevel();
+
+    sim.click(BUTTON_UP);
+    EXPECT_EQ(sim.getAssistLevel(), assist + 1);
+    sim.click(BUTTON_DOWN);
+    EXPECT_EQ(sim.getAssistLevel(), assist);
+
+    LightManager::LightMode mode = sim.getLights().getMode();
+    sim.hold(BUTTON_UP, 1200);
+    EXPECT_NE(sim.getLights().getMode(), mode);
+    EXPECT_EQ(sim.getAssistLevel(), assist);   // Długie naciśnięcie to nie kliknięcie
+}
+
+TEST(HostSimulatorTest, DisplayPanelMatchesFrameBuffer) {
+    HostSimulator sim;
+    sim.begin();
+    sim.setRide({ 12.3f, 0, 2.0f, true });
+    sim.runFor(1000);
+
+    U8G2& display = sim.getDisplay();
+    EXPECT_GT(display.getU8x8()->bytesSent, 0u);
+    EXPECT_EQ(memcmp(display.getU8x8()->panel, display.getBufferPtr(), FAKE_U8G2_BUFFER_SIZE), 0);
+
+    // Na postoju zmienia się tylko dwukropek zegara (co 500 ms): wysyłane są
+    // dwa wiersze kafli górnego paska zamiast 20 pełnych klatek na sekundę
+    sim.setRide({ 0.0f, 0, 0.0f, false });
+    sim.runFor(1500);
+    uint32_t sent = display.getU8x8()->bytesSent;
+    sim.runFor(1000);
+    EXPECT_EQ(display.getU8x8()->bytesSent - sent, 2u * 2 * FAKE_U8G2_WIDTH);
+}
+
+TEST(HostSimulatorTest, FlushTaskTakesI2cOutOfLoop) {
+    // Pełne klatki co 50 ms: przy 400 kHz każda to ~24 ms transmisji
+    DisplayRenderer::Stats stats[2];
+    uint32_t controllerLatenessUs[2];
+    for (int async = 0; async < 2; async++) {
+        HostSimulator sim;
+        sim.setAsyncFlush(async != 0);
+        sim.begin();
+        sim.setFullFrames(true);
+        sim.setRide({ 20.0f, 80, 6.0f, true });
+        sim.runFor(500);
+        sim.getRenderer().collectStats();
+        sim.getScheduler().resetStats();
+        sim.runFor(3000);
+
+        stats[async] = sim.getRenderer().collectStats();
+        controllerLatenessUs[async] = sim.getScheduler().getTask(0).maxLatenessUs;
+        ASSERT_TRUE(sim.getRenderer().waitIdle(100));
+        EXPECT_EQ(memcmp(sim.getDisplay().getU8x8()->panel, sim.getDisplay().getBufferPtr(), FAKE_U8G2_BUFFER_SIZE), 0);
+    }
+
+    EXPECT_FALSE(stats[0].async);
+    EXPECT_GT(stats[0].avgStallUs, 20000u);
+    EXPECT_GT(controllerLatenessUs[0], 20000u);
+
+    // W zadaniu pętla tylko kopiuje wiersze, transmisja trwa tyle samo
+    EXPECT_TRUE(stats[1].async);
+    EXPECT_LT(stats[1].maxStallUs, 1000u);
+    EXPECT_LT(controllerLatenessUs[1], 1000u);
+    EXPECT_NEAR(stats[1].avgFlushUs, stats[0].avgFlushUs, 100);
+    EXPECT_EQ(stats[1].deferredFrames, 0u);
+}
+
+TEST(HostSimulatorTest, SchedulerIdlesBetweenDeadlines) {
+    HostSimulator sim;
+    sim.begin();
+    uint32_t iterations = sim.runFor(1000);
+
+    // Najkrótszy okres zadań to 5 ms - pętla nie kręci się na pusto
+    EXPECT_GT(iterations, 150u);
+    EXPECT_LT(iterations, 1000u);
+    EXPECT_GT(sim.getScheduler().getIdleMs(), 500u);
+}
+
+TEST(HostSimulatorTest, ControllerSilenceZeroesLiveValues) {
+    HostSimulator sim;
+    sim.begin();
+    sim.setRide({ 25.0f, 0, 10.0f, true });
+    sim.runFor(3000);
+    ASSERT_GT(sim.getSpeedKmh(), 20.0f);
+    ASSERT_GT(sim.getPowerW(), 0);
+
+    sim.setRide({ 25.0f, 0, 10.0f, false });
+    sim.runFor(RIDE_KT_LINK_TIMEOUT_MS + 200);
+    EXPECT_EQ(sim.getSpeedKmh(), 0.0f);
+    EXPECT_EQ(sim.getPowerW(), 0);
+    EXPECT_EQ(sim.getBatteryCurrent(), 0.0f);
+
+    // Po 30 s ciszy dystans nie przyrasta o czas przerwy
+    sim.runFor(30000);
+    float distance = sim.getDistanceKm();
+    sim.setRide({ 25.0f, 0, 10.0f, true });
+    sim.runFor(150);
+    EXPECT_NEAR(sim.getDistanceKm(), distance, 0.001f);
+}
+
+TEST(HostSimulatorTest, ControllerLatencyStartsAtFirstByte) {
+    HostSimulator sim;
+    sim.begin();
+    sim.runFor(500);
+    ASSERT_GT(sim.getController().getTelemetry().frameCount, 0u);
+
+    // Ramka czeka w buforze do zadania co 5 ms - całe czekanie jest w opóźnieniu
+    EXPECT_LE(sim.getController().getMaxLatencyUs(), 5000u);
+
+    // Ramka w dwóch częściach: od nagłówka do publikacji mija 12 ms
+    sim.setRide({ 0.0f, 0, 0.0f, false });
+    sim.runFor(50);
+    const uint8_t frame[KT_FRAME_SIZE] = { KT_FRAME_HEADER, 12, 0, 0x0B, 0xB8, 0, 0x0B ^ 0xB8 ^ 12, 0, 0, 0, 0, 0 };
+    Serial2.inject(frame, 6);
+    sim.runFor(12);
+    Serial2.inject(frame + 6, KT_FRAME_SIZE - 6);
+    uint32_t count = sim.getController().getTelemetry().frameCount;
+    sim.runFor(10);
+    ASSERT_EQ(sim.getController().getTelemetry().frameCount, count + 1);
+    EXPECT_GE(sim.getController().getLastLatencyUs(), 12000u);
+}
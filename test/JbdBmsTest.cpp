@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "FakeClock.h"
+#include "JbdBms.h"
+
+// Składanie ramek JBD z powiadomień BLE: jednostki odpowiedzi 0x03/0x04,
+// dowolny podział na fragmenty, liczniki błędów i powrót do synchronizacji
+
+typedef std::vector<uint8_t> Bytes;
+
+// Ramka odpowiedzi z poprawną sumą: 0x10000 - (status + N + dane)
+static Bytes buildFrame(uint8_t command, const Bytes& data, uint8_t status = 0) {
+    Bytes frame = { JBD_FRAME_START, command, status, (uint8_t)data.size() };
+    uint16_t sum = status + data.size();
+    for (uint8_t byte : data) {
+        frame.push_back(byte);
+        sum += byte;
+    }
+    uint16_t checksum = (uint16_t)(0x10000 - sum);
+
+    frame.push_back(checksum >> 8);
+    frame.push_back(checksum & 0xFF);
+    frame.push_back(JBD_FRAME_END);
+    return frame;
+}
+
+static void putWord(Bytes& data, uint16_t value) {
+    data.push_back(value >> 8);
+    data.push_back(value & 0xFF);
+}
+
+// 0x03: 23 bajty nagłówka + temperatury NTC w 0.1 K
+static Bytes basicInfo(uint16_t centiVolts, int16_t centiAmps, uint8_t soc, uint16_t cycles,
+                       const std::vector<uint16_t>& deciKelvin = { 2981, 2681 }) {
+    Bytes data;
+    putWord(data, centiVolts);
+    putWord(data, (uint16_t)centiAmps);
+    putWord(data, 1000);      // Pozostało 10.00 Ah
+    putWord(data, 2000);      // Pojemność 20.00 Ah
+    putWord(data, cycles);
+    data.resize(19, 0);       // Data produkcji, balans, zabezpieczenia, wersja
+    data.push_back(soc);
+    data.push_back(0x03);     // MOSFET ładowania i rozładowania załączone
+    data.push_back(13);       // Liczba cel
+    data.push_back((uint8_t)deciKelvin.size());
+    for (uint16_t value : deciKelvin) putWord(data, value);
+    return buildFrame(JBD_CMD_BASIC_INFO, data);
+}
+
+static Bytes cellInfo(uint8_t cells, uint16_t firstMilliVolts) {
+    Bytes data;
+    for (uint8_t i = 0; i < cells; i++) putWord(data, firstMilliVolts + i);
+    return buildFrame(JBD_CMD_CELL_INFO, data);
+}
+
+class JbdBmsTest : public ::testing::Test {
+protected:
+    JbdBms bms;
+
+    void SetUp() override {
+        FakeClock::reset();
+    }
+
+    void feed(const Bytes& bytes) {
+        bms.feed(bytes.data(), bytes.size());
+    }
+};
+
+TEST_F(JbdBmsTest, BasicInfoDecodesUnits) {
+    BmsData data;
+    EXPECT_FALSE(bms.read(data));
+
+    feed(basicInfo(5234, -1250, 55, 42));
+
+    ASSERT_TRUE(bms.read(data));
+    EXPECT_FLOAT_EQ(data.voltage, 52.34f);
+    EXPECT_FLOAT_EQ(data.current, -12.5f);
+    EXPECT_FLOAT_EQ(data.remainingCapacity, 10.0f);
+    EXPECT_FLOAT_EQ(data.totalCapacity, 20.0f);
+    EXPECT_EQ(data.cycles, 42);
+    EXPECT_EQ(data.soc, 55);
+    EXPECT_TRUE(data.charging);
+    EXPECT_TRUE(data.discharging);
+    ASSERT_EQ(data.tempCount, 2);
+    EXPECT_FLOAT_EQ(data.temperatures[0], 25.0f);
+    EXPECT_FLOAT_EQ(data.temperatures[1], -5.0f);
+    EXPECT_EQ(bms.getFramesOk(), 1u);
+}
+
+TEST_F(JbdBmsTest, BasicInfoLimitsTemperaturesToPayload) {
+    // Zgłoszone 6 czujników, w danych tylko 5 - więcej niż JBD_MAX_TEMPS
+    Bytes frame = basicInfo(5000, 0, 50, 1, { 2931, 2931, 2931, 2931, 2931 });
+    frame[4 + 22] = 6;
+    uint16_t sum = 0;
+    for (size_t i = 2; i < frame.size() - 3; i++) sum += frame[i];
+    uint16_t checksum = (uint16_t)(0x10000 - sum);
+    frame[frame.size() - 3] = checksum >> 8;
+    frame[frame.size() - 2] = checksum & 0xFF;
+    feed(frame);
+
+    BmsData data;
+    ASSERT_TRUE(bms.read(data));
+    EXPECT_EQ(data.tempCount, JBD_MAX_TEMPS);
+    EXPECT_FLOAT_EQ(data.temperatures[JBD_MAX_TEMPS - 1], 20.0f);
+}
+
+TEST_F(JbdBmsTest, CellInfoDecodesAndClampsCellCount) {
+    feed(cellInfo(13, 3650));
+
+    BmsData data;
+    ASSERT_TRUE(bms.read(data));
+    ASSERT_EQ(data.cellCount, 13);
+    EXPECT_FLOAT_EQ(data.cellVoltages[0], 3.650f);
+    EXPECT_FLOAT_EQ(data.cellVoltages[12], 3.662f);
+
+    feed(cellInfo(24, 3300));
+    ASSERT_TRUE(bms.read(data));
+    EXPECT_EQ(data.cellCount, JBD_MAX_CELLS);
+    EXPECT_FLOAT_EQ(data.cellVoltages[JBD_MAX_CELLS - 1], 3.315f);
+}
+
+TEST_F(JbdBmsTest, ErrorsAreCountedAndNotPublished) {
+    Bytes corrupted = basicInfo(5234, 0, 55, 42);
+    corrupted[6] ^= 0x01;
+    feed(corrupted);
+    EXPECT_EQ(bms.getChecksumErrors(), 1u);
+
+    Bytes badEnd = basicInfo(5234, 0, 55, 42);
+    badEnd.back() = 0x00;
+    feed(badEnd);
+    EXPECT_EQ(bms.getFramingErrors(), 1u);
+
+    // Status różny od zera - BMS odrzucił zapytanie
+    feed(buildFrame(JBD_CMD_BASIC_INFO, Bytes(23, 0), 0x80));
+    EXPECT_EQ(bms.getFramingErrors(), 2u);
+
+    // Za krótka odpowiedź 0x03
+    feed(buildFrame(JBD_CMD_BASIC_INFO, Bytes(10, 0)));
+    EXPECT_EQ(bms.getFramingErrors(), 3u);
+
+    BmsData data;
+    EXPECT_FALSE(bms.read(data));
+    EXPECT_EQ(bms.getFramesOk(), 0u);
+
+    // Nieobsługiwana komenda: poprawna ramka, ale nic do publikacji
+    feed(buildFrame(0x05, Bytes(4, 0x41)));
+    EXPECT_FALSE(bms.read(data));
+    EXPECT_EQ(bms.getChecksumErrors(), 1u);
+    EXPECT_EQ(bms.getFramingErrors(), 3u);
+}
+
+TEST_F(JbdBmsTest, ResyncsAfterGarbage) {
+    feed({ 0x00, 0x77, 0x12, 0x34 });
+    feed(cellInfo(13, 3600));
+
+    BmsData data;
+    ASSERT_TRUE(bms.read(data));
+    EXPECT_EQ(data.cellCount, 13);
+    EXPECT_EQ(bms.getBytesDropped(), 4u);
+}
+
+TEST_F(JbdBmsTest, StaleFragmentIsDroppedAfterTimeout) {
+    Bytes first = basicInfo(5234, 0, 55, 42);
+    feed(Bytes(first.begin(), first.begin() + 20));
+
+    // Reszta nie przyszła (rozłączenie); nowa ramka zaczyna się od początku
+    FakeClock::advanceMs(JBD_FRAME_TIMEOUT_MS + 100);
+    feed(basicInfo(4810, 250, 30, 7));
+
+    BmsData data;
+    ASSERT_TRUE(bms.read(data));
+    EXPECT_FLOAT_EQ(data.voltage, 48.10f);
+    EXPECT_FLOAT_EQ(data.current, 2.5f);
+    EXPECT_EQ(bms.getFramingErrors(), 1u);
+    EXPECT_EQ(bms.getFramesOk(), 1u);
+}
+
+TEST_F(JbdBmsTest, ResetDropsPartialFrame) {
+    Bytes frame = cellInfo(13, 3600);
+    feed(Bytes(frame.begin(), frame.begin() + 10));
+    bms.reset();
+    feed(Bytes(frame.begin() + 10, frame.end()));
+
+    BmsData data;
+    EXPECT_FALSE(bms.read(data));
+    EXPECT_EQ(bms.getFramingErrors(), 1u);
+
+    feed(frame);
+    EXPECT_TRUE(bms.read(data));
+}
+
+// Strumień jak z BLE: na przemian 0x03 i 0x04 ze zmiennymi wartościami,
+// co któraś ramka uszkodzona, pocięty losowo na fragmenty 1..20 B (MTU)
+TEST_F(JbdBmsTest, RandomFragmentationFuzz) {
+    std::mt19937 rng(20240611);
+    const uint32_t FRAMES = 4000;
+
+    Bytes stream;
+    uint32_t expectedOk = 0;
+    uint32_t expectedChecksumErrors = 0;
+    uint16_t lastVoltage = 0;
+    uint16_t lastCellMv = 0;
+
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        bool basic = (i % 2) == 0;
+        uint16_t voltage = 4000 + (rng() % 1500);
+        uint16_t cellMv = 3000 + (rng() % 1200);
+        Bytes frame = basic ? basicInfo(voltage, (int16_t)(rng() % 4000) - 2000, rng() % 101, i)
+                            : cellInfo(1 + rng() % JBD_MAX_CELLS, cellMv);
+
+        if (rng() % 10 == 0) {
+            // Przekłamany bajt danych - ramka ma zostać odrzucona
+            frame[4 + rng() % frame[3]] ^= 0x10;
+            expectedChecksumErrors++;
+        } else {
+            expectedOk++;
+            if (basic) lastVoltage = voltage;
+            else lastCellMv = cellMv;
+        }
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        size_t chunk = std::min<size_t>(1 + rng() % 20, stream.size() - offset);
+        bms.feed(&stream[offset], chunk);
+        offset += chunk;
+
+        // Migawka zmienia się tylko po pełnej, poprawnej ramce
+        ASSERT_EQ(bms.getVersion(), bms.getFramesOk());
+        FakeClock::advanceMs(1);
+    }
+
+    EXPECT_EQ(bms.getFramesOk(), expectedOk);
+    EXPECT_EQ(bms.getChecksumErrors(), expectedChecksumErrors);
+    EXPECT_EQ(bms.getFramingErrors(), 0u);
+    EXPECT_EQ(bms.getBytesDropped(), 0u);
+
+    BmsData data;
+    ASSERT_TRUE(bms.read(data));
+    EXPECT_FLOAT_EQ(data.voltage, lastVoltage / 100.0f);
+    EXPECT_FLOAT_EQ(data.cellVoltages[0], lastCellMv / 1000.0f);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "FakeClock.h"
+#include "KtController.h"
+
+// Dekoder ramek KT bezpośrednio: poprawna ramka, powrót do synchronizacji po
+// błędnej sumie i ramka rozcięta między kolejne odczyty portu
+
+typedef std::vector<uint8_t> Bytes;
+
+// Ramka z poprawnym XOR B1..B11 (bez B6)
+static Bytes ktFrame(uint16_t wheelPeriodMs, uint8_t currentSteps, uint8_t mode = KT_MODE_ASSIST) {
+    Bytes frame(KT_FRAME_SIZE, 0);
+    frame[0] = KT_FRAME_HEADER;
+    frame[1] = 12;
+    frame[3] = wheelPeriodMs >> 8;
+    frame[4] = wheelPeriodMs & 0xFF;
+    frame[7] = mode;
+    frame[8] = currentSteps;
+    uint8_t crc = 0;
+    for (uint8_t i = 1; i < KT_FRAME_SIZE; i++) {
+        if (i != KT_CHECKSUM_INDEX) crc ^= frame[i];
+    }
+    frame[KT_CHECKSUM_INDEX] = crc;
+    return frame;
+}
+
+// Liczba ramek zamkniętych przez bajty
+static uint32_t feedAll(KtFrameDecoder& decoder, const Bytes& bytes) {
+    uint32_t frames = 0;
+    for (uint8_t byte : bytes) {
+        if (decoder.feed(byte)) frames++;
+    }
+    return frames;
+}
+
+TEST(KtFrameDecoderTest, DecodesFrameAfterNoise) {
+    KtFrameDecoder decoder;
+    Bytes stream = { 0x00, 0xFF, 0x13 };
+    Bytes frame = ktFrame(1000, 32);
+    stream.insert(stream.end(), frame.begin(), frame.end());
+
+    EXPECT_EQ(feedAll(decoder, stream), 1u);
+    EXPECT_EQ(memcmp(decoder.frame(), frame.data(), KT_FRAME_SIZE), 0);
+    EXPECT_EQ(decoder.getDiscardedBytes(), 3u);
+    EXPECT_EQ(decoder.getChecksumErrors(), 0u);
+    EXPECT_EQ(decoder.getLength(), 0u);
+}
+
+TEST(KtFrameDecoderTest, ResyncsOnHeaderInsideBadFrame) {
+    KtFrameDecoder decoder;
+
+    // Urwana ramka (5 bajtów), zaraz po niej pełna - pierwsze 12 bajtów ma złą
+    // sumę, a nagłówek drugiej ramki leży już w buforze
+    Bytes good = ktFrame(800, 40);
+    Bytes stream(good.begin(), good.begin() + 5);
+    stream.insert(stream.end(), good.begin(), good.end());
+
+    EXPECT_EQ(feedAll(decoder, stream), 1u);
+    EXPECT_EQ(decoder.getChecksumErrors(), 1u);
+    EXPECT_EQ(decoder.getDiscardedBytes(), 5u);
+    EXPECT_EQ(memcmp(decoder.frame(), good.data(), KT_FRAME_SIZE), 0);
+
+    // Przekłamany bajt bez nagłówka w środku - tracimy tylko tę ramkę
+    Bytes bad = ktFrame(800, 40);
+    bad[8] ^= 0x04;
+    Bytes next = ktFrame(900, 8);
+    stream = bad;
+    stream.insert(stream.end(), next.begin(), next.end());
+
+    EXPECT_EQ(feedAll(decoder, stream), 1u);
+    EXPECT_EQ(decoder.getChecksumErrors(), 2u);
+    EXPECT_EQ(decoder.getDiscardedBytes(), 5u + KT_FRAME_SIZE);
+    EXPECT_EQ(memcmp(decoder.frame(), next.data(), KT_FRAME_SIZE), 0);
+}
+
+TEST(KtFrameDecoderTest, FrameSplitAcrossPolls) {
+    FakeClock::reset();
+    HardwareSerial port(2);
+    KtController controller;
+    Bytes frame = ktFrame(1000, 32);
+
+    // Sam nagłówek w pierwszym odczycie
+    port.inject(frame.data(), 1);
+    EXPECT_FALSE(controller.poll(port));
+    EXPECT_EQ(controller.getDecoder().getLength(), 1u);
+
+    FakeClock::advanceUs(3000);
+    port.inject(frame.data() + 1, 6);
+    EXPECT_FALSE(controller.poll(port));
+    EXPECT_EQ(controller.getDecoder().getLength(), 7u);
+
+    FakeClock::advanceUs(2000);
+    port.inject(frame.data() + 7, KT_FRAME_SIZE - 7);
+    EXPECT_TRUE(controller.poll(port));
+
+    const KtTelemetry& telemetry = controller.getTelemetry();
+    EXPECT_EQ(telemetry.frameCount, 1u);
+    EXPECT_EQ(telemetry.wheelPeriodMs, 1000u);
+    EXPECT_FLOAT_EQ(telemetry.current, 32 * KT_CURRENT_STEP_A);
+    EXPECT_EQ(telemetry.movingMode, KT_MODE_ASSIST);
+    // Opóźnienie liczone od odczytu nagłówka, nie od ostatniego fragmentu
+    EXPECT_GE(controller.getLastLatencyUs(), 5000u);
+    EXPECT_EQ(controller.getDecoder().getChecksumErrors(), 0u);
+}
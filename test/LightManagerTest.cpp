@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "FakeClock.h"
+#include "LightManager.h"
+
+// Silnik wzorów świateł na timerze wirtualnego zegara: kroki wzorów co
+// LIGHT_TICK_MS, wypełnienie LEDC, zapis PWM tylko przy zmianie i podbicie
+// tylnego światła przy hamowaniu
+
+#define FRONT_PIN 19
+#define DRL_PIN 18
+#define REAR_PIN 23
+#define BRAKE_PIN 26
+
+#define FULL_DUTY (1UL << LIGHT_PWM_BITS)
+
+class LightManagerTest : public ::testing::Test {
+protected:
+    LightManager lights;
+
+    void SetUp() override {
+        FakeClock::reset();
+        FakeGpio::reset();
+        lights.begin(FRONT_PIN, DRL_PIN, REAR_PIN, BRAKE_PIN);
+    }
+
+    void TearDown() override {
+        lights.shutdown();
+    }
+
+    // Poziomy wyjścia w kolejnych taktach timera
+    std::vector<uint8_t> record(LightOutput output, uint32_t ticks) {
+        std::vector<uint8_t> levels;
+        for (uint32_t i = 0; i < ticks; i++) {
+            FakeClock::advanceMs(LIGHT_TICK_MS);
+            levels.push_back(lights.getOutputLevel(output));
+        }
+        return levels;
+    }
+
+    // Długości kolejnych odcinków stałego poziomu
+    static std::vector<uint32_t> runLengths(const std::vector<uint8_t>& levels) {
+        std::vector<uint32_t> runs;
+        for (size_t i = 0; i < levels.size(); i++) {
+            if (i == 0 || levels[i] != levels[i - 1]) runs.push_back(0);
+            runs.back()++;
+        }
+        return runs;
+    }
+};
+
+TEST_F(LightManagerTest, OffModeKeepsOutputsDark) {
+    record(LIGHT_OUTPUT_FRONT, 50);
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        EXPECT_EQ(lights.getOutputLevel(i), 0);
+        EXPECT_EQ(FakeGpio::getLedcDuty(LIGHT_LEDC_CHANNEL + i), 0u);
+    }
+}
+
+TEST_F(LightManagerTest, DayModeBlinksRearWithConfiguredPeriod) {
+    lights.setMode(LightManager::DAY);
+    std::vector<uint8_t> rear = record(LIGHT_OUTPUT_REAR, 300);
+
+    // 500 ms świeci, 500 ms nie; pierwszy takt po zmianie zaczyna od kroku 0
+    std::vector<uint32_t> runs = runLengths(rear);
+    ASSERT_GE(runs.size(), 3u);
+    EXPECT_EQ(rear[0], 255);
+    EXPECT_EQ(runs[0], 50u);
+    EXPECT_EQ(runs[1], 50u);
+    EXPECT_EQ(runs[2], 50u);
+
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_DRL), 255);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_FRONT), 0);
+    EXPECT_EQ(FakeGpio::getLedcDuty(LIGHT_LEDC_CHANNEL + LIGHT_OUTPUT_DRL), FULL_DUTY);
+}
+
+TEST_F(LightManagerTest, PwmIsWrittenOnlyOnChange) {
+    lights.setMode(LightManager::DAY);
+    FakeClock::advanceMs(LIGHT_TICK_MS);
+    uint32_t writes = lights.getPwmWrites();
+    uint32_t ledcWrites = FakeGpio::getLedcWrites();
+
+    // 3 s migania: 6 zmian tylnego, dzienne bez zmian
+    record(LIGHT_OUTPUT_REAR, 300);
+    EXPECT_EQ(lights.getPwmWrites() - writes, 6u);
+    EXPECT_EQ(FakeGpio::getLedcWrites() - ledcWrites, 6u);
+}
+
+TEST_F(LightManagerTest, NightRearIsSteadyWithoutBlink) {
+    lights.setMode(LightManager::NIGHT);
+    std::vector<uint8_t> rear = record(LIGHT_OUTPUT_REAR, 200);
+    EXPECT_EQ(runLengths(rear), std::vector<uint32_t>({ 200 }));
+    EXPECT_EQ(rear[0], 255);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_FRONT), 255);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_DRL), 0);
+}
+
+TEST_F(LightManagerTest, MultiStepPatternTiming) {
+    lights.getPatternData()->dayPattern[LIGHT_OUTPUT_REAR] = LIGHT_PATTERN_DOUBLE_FLASH;
+    lights.getPatternData()->dayPattern[LIGHT_OUTPUT_DRL] = LIGHT_PATTERN_PULSE;
+    lights.setMode(LightManager::DAY);
+
+    std::vector<uint8_t> rear = record(LIGHT_OUTPUT_REAR, 200);
+    std::vector<uint32_t> runs = runLengths(rear);
+    EXPECT_EQ(std::vector<uint32_t>(runs.begin(), runs.begin() + 5),
+              std::vector<uint32_t>({ 8, 12, 8, 72, 8 }));
+
+    // Pośredni poziom idzie do LEDC wprost
+    lights.refresh();
+    FakeClock::advanceMs(LIGHT_TICK_MS);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_DRL), 64);
+    EXPECT_EQ(FakeGpio::getLedcDuty(LIGHT_LEDC_CHANNEL + LIGHT_OUTPUT_DRL), 64u);
+}
+
+TEST_F(LightManagerTest, BlinkFrequencyChangesPattern) {
+    lights.setMode(LightManager::DAY);
+    lights.setBlinkFrequency(200);
+    std::vector<uint32_t> runs = runLengths(record(LIGHT_OUTPUT_REAR, 100));
+    EXPECT_EQ(runs[0], 20u);
+    EXPECT_EQ(runs[1], 20u);
+
+    // Poza zakresem 100..2000 ms - bez zmian
+    lights.setBlinkFrequency(50);
+    EXPECT_EQ(lights.getBlinkFrequency(), 200);
+}
+
+TEST_F(LightManagerTest, BrakeBoostsRearDuringOffPhase) {
+    lights.setMode(LightManager::DAY);
+    record(LIGHT_OUTPUT_REAR, 60);   // Faza wyłączona migania
+    ASSERT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_REAR), 0);
+
+    FakeGpio::setLevel(BRAKE_PIN, LOW);
+    FakeClock::advanceMs(LIGHT_TICK_MS);
+    EXPECT_TRUE(lights.isBrakeBoosted());
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_REAR), 255);
+
+    FakeGpio::setLevel(BRAKE_PIN, HIGH);
+    FakeClock::advanceMs(LIGHT_TICK_MS);
+    EXPECT_FALSE(lights.isBrakeBoosted());
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_REAR), 0);
+
+    // Przy wyłączonych światłach hamulec nie zapala tylnego
+    lights.setMode(LightManager::OFF);
+    FakeGpio::setLevel(BRAKE_PIN, LOW);
+    record(LIGHT_OUTPUT_REAR, 5);
+    EXPECT_FALSE(lights.isBrakeBoosted());
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_REAR), 0);
+}
+
+TEST_F(LightManagerTest, ConfigModeLightsEverythingUntilDeactivated) {
+    lights.setMode(LightManager::DAY);
+    lights.activateConfigMode();
+    record(LIGHT_OUTPUT_REAR, 120);
+    for (uint8_t i = 0; i < LIGHT_OUTPUT_COUNT; i++) {
+        EXPECT_EQ(lights.getOutputLevel(i), 255);
+    }
+
+    // Zmiana trybu w trakcie konfiguracji nie rusza świateł
+    lights.setMode(LightManager::NIGHT);
+    record(LIGHT_OUTPUT_REAR, 5);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_DRL), 255);
+
+    lights.deactivateConfigMode();
+    record(LIGHT_OUTPUT_REAR, 5);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_DRL), 0);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_FRONT), 255);
+}
+
+TEST_F(LightManagerTest, CycleModeAndShutdown) {
+    lights.cycleMode();
+    EXPECT_EQ(lights.getMode(), LightManager::DAY);
+    lights.cycleMode();
+    EXPECT_EQ(lights.getMode(), LightManager::NIGHT);
+    record(LIGHT_OUTPUT_FRONT, 5);
+    EXPECT_EQ(lights.getOutputLevel(LIGHT_OUTPUT_FRONT), 255);
+
+    // Wyłączenie przed uśpieniem: wyjścia od razu na 0, timer zatrzymany
+    lights.shutdown();
+    EXPECT_EQ(FakeGpio::getLedcDuty(LIGHT_LEDC_CHANNEL + LIGHT_OUTPUT_FRONT), 0u);
+    uint32_t writes = FakeGpio::getLedcWrites();
+    record(LIGHT_OUTPUT_FRONT, 50);
+    EXPECT_EQ(FakeGpio::getLedcWrites(), writes);
+
+    lights.cycleMode();
+    EXPECT_EQ(lights.getMode(), LightManager::OFF);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <LittleFS.h>
+#include "FakeClock.h"
+#include "OdometerManager.h"
+
+// Dziennik licznika przy zaniku zasilania: zapis przerwany na każdym bajcie,
+// także w chwili przełączenia pliku A/B, i dalsza jazda po ponownym starcie
+
+#define STEP_KM 0.1f     // Jeden rekord na ODOMETER_COMMIT_METERS
+
+class OdometerManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        FakeClock::reset();
+        FakeFs::format();
+    }
+
+    // Ponowny start: nowy obiekt czyta dziennik z plików
+    static uint32_t reboot() {
+        OdometerManager odometer;
+        EXPECT_TRUE(odometer.begin());
+        return odometer.getTotalMeters();
+    }
+
+    static void ride(uint32_t records) {
+        OdometerManager odometer;
+        ASSERT_TRUE(odometer.begin());
+        for (uint32_t i = 0; i < records; i++) {
+            odometer.addDistance(STEP_KM);
+        }
+    }
+
+    static void restoreFile(const char* path, const std::string& data) {
+        LittleFS.remove(path);
+        if (!data.empty()) FakeFs::writeFile(path, data);
+    }
+};
+
+TEST_F(OdometerManagerTest, JournalRotatesAndSurvivesRestart) {
+    ride(ODOMETER_MAX_RECORDS + 10);
+    EXPECT_EQ(reboot(), (ODOMETER_MAX_RECORDS + 10) * 100u);
+    EXPECT_EQ(FakeFs::readFile(ODOMETER_JOURNAL_B).size(), 10 * sizeof(OdometerRecord));
+}
+
+TEST_F(OdometerManagerTest, TornFinalRecordIsSkippedAndJournalStaysReadable) {
+    ride(5);
+
+    // Zasilanie znika po 7 bajtach szóstego rekordu
+    FakeFs::setWriteBudget(7);
+    ride(1);
+    FakeFs::restorePower();
+    ASSERT_EQ(FakeFs::readFile(ODOMETER_JOURNAL_A).size(), 5 * sizeof(OdometerRecord) + 7);
+    EXPECT_EQ(reboot(), 500u);
+
+    // Dalsze rekordy nie mogą lądować za urwanym ogonem z przesunięciem
+    ride(3);
+    EXPECT_EQ(reboot(), 800u);
+    ride(1);
+    EXPECT_EQ(reboot(), 900u);
+}
+
+TEST_F(OdometerManagerTest, PowerCutDuringFirstRecord) {
+    for (size_t cut = 1; cut < sizeof(OdometerRecord); cut++) {
+        SCOPED_TRACE(testing::Message() << "przerwanie po " << cut << " B");
+        FakeFs::format();
+
+        // Pusty dziennik, zasilanie znika w trakcie pierwszego rekordu
+        FakeFs::setWriteBudget(cut);
+        ride(1);
+        FakeFs::restorePower();
+        ASSERT_EQ(FakeFs::readFile(ODOMETER_JOURNAL_A).size(), cut);
+        EXPECT_EQ(reboot(), 0u);
+
+        // Kolejne rekordy nie mogą trafić za urwany początek
+        ride(5);
+        EXPECT_EQ(reboot(), 500u);
+        ride(ODOMETER_MAX_RECORDS);
+        EXPECT_EQ(reboot(), (ODOMETER_MAX_RECORDS + 5) * 100u);
+    }
+}
+
+TEST_F(OdometerManagerTest, PowerCutAtEveryByteAroundRotation) {
+    // Dziennik tuż przed przełączeniem pliku
+    const uint32_t prefix = ODOMETER_MAX_RECORDS - 3;
+    ride(prefix);
+    const std::string savedA = FakeFs::readFile(ODOMETER_JOURNAL_A);
+    const std::string savedB = FakeFs::readFile(ODOMETER_JOURNAL_B);
+    const uint32_t prefixMeters = prefix * 100;
+
+    // Okno 6 rekordów: trzy do końca pliku A i trzy po przełączeniu na B
+    const uint32_t attempts = 6;
+    const size_t windowBytes = attempts * sizeof(OdometerRecord);
+
+    for (size_t cut = 0; cut <= windowBytes; cut++) {
+        SCOPED_TRACE(testing::Message() << "przerwanie po " << cut << " B");
+        restoreFile(ODOMETER_JOURNAL_A, savedA);
+        restoreFile(ODOMETER_JOURNAL_B, savedB);
+
+        uint32_t committed;
+        {
+            OdometerManager odometer;
+            ASSERT_TRUE(odometer.begin());
+            FakeFs::setWriteBudget(cut);
+            for (uint32_t i = 0; i < attempts; i++) {
+                odometer.addDistance(STEP_KM);
+            }
+            committed = odometer.getWriteCount();
+        }
+        FakeFs::restorePower();
+
+        // Ostatni potwierdzony zapis nigdy nie ginie, a rekord w toku najwyżej się pojawia
+        uint32_t meters = reboot();
+        EXPECT_GE(meters, prefixMeters + committed * 100);
+        EXPECT_LE(meters, prefixMeters + (committed + 1) * 100);
+
+        // Po starcie dziennik dalej działa - od razu i przez kolejne przełączenie pliku
+        ride(2);
+        EXPECT_EQ(reboot(), meters + 200);
+        ride(ODOMETER_MAX_RECORDS);
+        EXPECT_EQ(reboot(), meters + (ODOMETER_MAX_RECORDS + 2) * 100);
+    }
+}
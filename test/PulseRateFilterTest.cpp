@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "PulseRateFilter.h"
+
+// Filtr impulsów: zgubione impulsy dzielone na części, ale skokowa zmiana
+// tempa (odstęp stale k razy dłuższy niż mediana) nie może być nimi na zawsze
+
+#define TIMEOUT_US 4000000UL
+
+static uint32_t intervalUs(uint32_t rpm) {
+    return 60000000UL / rpm;
+}
+
+class PulseRateFilterTest : public ::testing::Test {
+protected:
+    PulseRateFilter filter { TIMEOUT_US };
+    uint32_t nowUs = 1000000;
+
+    void SetUp() override {
+        filter.addPulse(nowUs);
+    }
+
+    // Kolejny impuls po 'pulses' odstępach (pulses > 1 - zgubione po drodze)
+    void pulse(uint32_t rpm, uint32_t pulses = 1) {
+        nowUs += intervalUs(rpm) * pulses;
+        filter.addPulse(nowUs);
+        filter.update(nowUs);
+    }
+};
+
+TEST_F(PulseRateFilterTest, SteadyCadence) {
+    for (int i = 0; i < 10; i++) pulse(90);
+    EXPECT_EQ(filter.getRpm(), 90);
+    EXPECT_EQ(filter.getRecoveredPulses(), 0u);
+}
+
+TEST_F(PulseRateFilterTest, IsolatedMissedPulsesAreRecovered) {
+    for (int i = 0; i < 10; i++) pulse(90);
+
+    pulse(90, 2);
+    EXPECT_EQ(filter.getRpm(), 90);
+    for (int i = 0; i < 5; i++) pulse(90);
+
+    // Dwa odstępy z rzędu ze zgubionym impulsem wciąż są naprawiane
+    pulse(90, 2);
+    pulse(90, 3);
+    EXPECT_EQ(filter.getRpm(), 90);
+    for (int i = 0; i < 5; i++) pulse(90);
+
+    EXPECT_EQ(filter.getRecoveredPulses(), 4u);
+    EXPECT_EQ(filter.getRpm(), 90);
+}
+
+TEST_F(PulseRateFilterTest, HalvedCadenceIsNotTreatedAsMissedPulses) {
+    for (int i = 0; i < 20; i++) pulse(90);
+    ASSERT_EQ(filter.getRpm(), 90);
+
+    // Skok 90 -> 45 RPM: pierwsze PULSE_FILTER_SPLIT_STREAK odstępów wygląda
+    // jak zgubione impulsy, następny zaczyna nową serię
+    for (int i = 0; i < PULSE_FILTER_SPLIT_STREAK + 1; i++) pulse(45);
+    EXPECT_EQ(filter.getInstantMilliRpm() / 1000, 45u);
+
+    for (int i = 0; i < 10; i++) pulse(45);
+    EXPECT_EQ(filter.getRpm(), 45);
+    EXPECT_EQ(filter.getRecoveredPulses(), (uint32_t)PULSE_FILTER_SPLIT_STREAK);
+
+    // Powrót do 90 RPM to zwykłe krótsze odstępy
+    for (int i = 0; i < 10; i++) pulse(90);
+    EXPECT_EQ(filter.getRpm(), 90);
+}
+
+TEST_F(PulseRateFilterTest, ThirdOfCadenceConverges) {
+    for (int i = 0; i < 20; i++) pulse(90);
+    for (int i = 0; i < 10; i++) pulse(30);
+    EXPECT_EQ(filter.getRpm(), 30);
+}
+
+TEST_F(PulseRateFilterTest, JitterDoesNotTriggerRejectOrSplit) {
+    // Odstępy 90 RPM +-8% z powtarzalnego generatora (nierówne pedałowanie, magnes
+    // mijający czujnik pod różnym kątem)
+    uint32_t seed = 12345;
+    uint16_t lowest = 0xFFFF;
+    uint16_t highest = 0;
+    for (int i = 0; i < 200; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int32_t jitterUs = (int32_t)((seed >> 8) % 106667) - 53333;
+        nowUs += intervalUs(90) + jitterUs;
+        filter.addPulse(nowUs);
+        filter.update(nowUs);
+        if (i >= 5) {
+            lowest = min(lowest, filter.getRpm());
+            highest = max(highest, filter.getRpm());
+        }
+    }
+
+    EXPECT_GE(lowest, 84);
+    EXPECT_LE(highest, 96);
+    EXPECT_EQ(filter.getRejectedPulses(), 0u);
+    EXPECT_EQ(filter.getRecoveredPulses(), 0u);
+    EXPECT_NEAR(filter.getAverageRpm(), 90, 1);
+}
+
+TEST_F(PulseRateFilterTest, ContactBounceIsRejected) {
+    for (int i = 0; i < 5; i++) pulse(90);
+
+    // Każdy impuls kontaktronu z odbiciem 3 ms później, co trzeci z dwoma
+    uint32_t bounces = 0;
+    for (int i = 0; i < 30; i++) {
+        pulse(90);
+        filter.addPulse(nowUs + 3000);
+        bounces++;
+        if (i % 3 == 0) {
+            filter.addPulse(nowUs + 7000);
+            bounces++;
+        }
+        filter.update(nowUs + 8000);
+        EXPECT_EQ(filter.getRpm(), 90);
+    }
+
+    EXPECT_EQ(filter.getRejectedPulses(), bounces);
+    EXPECT_EQ(filter.getRecoveredPulses(), 0u);
+    EXPECT_EQ(filter.getMaxRpm(), 90);
+}
+
+TEST_F(PulseRateFilterTest, StoppedPedalsDecayToZero) {
+    for (int i = 0; i < 10; i++) pulse(90);
+    ASSERT_EQ(filter.getRpm(), 90);
+
+    // Przerwa krótsza niż PULSE_FILTER_MAX_SPLIT odstępów - to mogą być zgubione impulsy
+    filter.update(nowUs + intervalUs(90) * 4);
+    EXPECT_EQ(filter.getRpm(), 90);
+
+    // Dłużej - wartość nie wyższa niż z czasu od ostatniego impulsu
+    uint16_t previous = 90;
+    for (uint32_t afterUs = intervalUs(90) * 5; afterUs < TIMEOUT_US; afterUs += 250000) {
+        filter.update(nowUs + afterUs);
+        EXPECT_LE(filter.getRpm(), (uint16_t)((60000000ULL + afterUs / 2) / afterUs));
+        EXPECT_LE(filter.getRpm(), previous);
+        EXPECT_GT(filter.getRpm(), 0);
+        previous = filter.getRpm();
+    }
+
+    filter.update(nowUs + TIMEOUT_US);
+    EXPECT_EQ(filter.getRpm(), 0);
+    EXPECT_EQ(filter.getInstantMilliRpm(), 0u);
+    EXPECT_FALSE(filter.isActive());
+
+    // Maksimum przejazdu zostaje
+    EXPECT_EQ(filter.getMaxRpm(), 90);
+}
+
+TEST_F(PulseRateFilterTest, TripAverageSkipsStopsAndKeepsMax) {
+    for (int i = 0; i < 10; i++) pulse(60);
+
+    // Postój dłuższy niż timeout - pierwszy impuls po nim zaczyna nową serię
+    nowUs += TIMEOUT_US + 1000000;
+    filter.addPulse(nowUs);
+    filter.update(nowUs);
+    for (int i = 0; i < 10; i++) pulse(120);
+
+    // 20 odstępów w 15 s jazdy = 80 RPM
+    EXPECT_EQ(filter.getAverageRpm(), 80);
+    EXPECT_EQ(filter.getMaxRpm(), 120);
+    EXPECT_EQ(filter.getRpm(), 120);
+
+    filter.resetTrip();
+    EXPECT_EQ(filter.getAverageRpm(), 0);
+    EXPECT_EQ(filter.getMaxRpm(), 0);
+
+    // Po zerowaniu maksimum tylko z nowych wartości (okno wygładzania schodzi ze 120)
+    for (int i = 0; i < 5; i++) pulse(90);
+    EXPECT_EQ(filter.getAverageRpm(), 90);
+    EXPECT_GE(filter.getMaxRpm(), 90);
+    EXPECT_LT(filter.getMaxRpm(), 120);
+}
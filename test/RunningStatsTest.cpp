@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "RunningStats.h"
+#include "TripMetrics.h"
+
+// Statystyki strumieniowe porównywane z liczeniem wprost na wszystkich
+// próbkach, średnia ważona czasem i eksport metryk przejazdu
+
+struct Exact {
+    double mean;
+    double variance;
+    double minimum;
+    double maximum;
+};
+
+template <typename T>
+static Exact exact(const std::vector<T>& values) {
+    Exact result = { 0, 0, (double)values[0], (double)values[0] };
+    for (T value : values) {
+        result.mean += value;
+        result.minimum = std::min(result.minimum, (double)value);
+        result.maximum = std::max(result.maximum, (double)value);
+    }
+    result.mean /= values.size();
+    for (T value : values) result.variance += (value - result.mean) * (value - result.mean);
+    result.variance = values.size() > 1 ? result.variance / (values.size() - 1) : 0;
+    return result;
+}
+
+class CapturePrint : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t c) override { text += (char)c; return 1; }
+};
+
+TEST(RunningStatsTest, MatchesTwoPassStatistics) {
+    std::mt19937 rng(7);
+    std::normal_distribution<float> speed(25.0f, 4.0f);
+    RunningStats<float> stats;
+    std::vector<float> values;
+
+    for (int i = 0; i < 5000; i++) {
+        float value = speed(rng);
+        values.push_back(value);
+        stats.add(value);
+    }
+
+    Exact expected = exact(values);
+    EXPECT_EQ(stats.getCount(), values.size());
+    EXPECT_NEAR(stats.getMean(), expected.mean, 1e-4);
+    EXPECT_NEAR(stats.getVariance(), expected.variance, 1e-3);
+    EXPECT_FLOAT_EQ(stats.getMin(), expected.minimum);
+    EXPECT_FLOAT_EQ(stats.getMax(), expected.maximum);
+}
+
+TEST(RunningStatsTest, LongRideKeepsPrecision) {
+    // 10 h co 100 ms wokół dużej wartości - suma w float traciłaby cyfry
+    RunningStats<float> stats;
+    for (uint32_t i = 0; i < 360000; i++) {
+        stats.add(1000.0f + ((i & 1) ? 0.5f : -0.5f));
+    }
+    EXPECT_NEAR(stats.getMean(), 1000.0f, 1e-4);
+    EXPECT_NEAR(stats.getStdDev(), 0.5f, 1e-4);
+}
+
+TEST(RunningStatsTest, TimeMeanWeightsByDuration) {
+    RunningStats<float> stats;
+    stats.add(10.0f, 0);
+    stats.add(30.0f, 1000);   // 10 przez 1 s
+    stats.add(0.0f, 4000);    // 30 przez 3 s
+    EXPECT_FLOAT_EQ(stats.getTimeMean(), (10.0f * 1 + 30.0f * 3) / 4);
+    EXPECT_EQ(stats.getDurationMs(), 4000u);
+
+    // Średnia z próbek nie zależy od czasu
+    EXPECT_FLOAT_EQ(stats.getMean(), 40.0f / 3);
+}
+
+TEST(RunningStatsTest, GapsAndPausesAreNotCounted) {
+    RunningStats<float> stats;
+    stats.add(20.0f, 0);
+    stats.add(20.0f, 1000);
+    stats.add(50.0f, 1000 + RUNNING_STATS_MAX_GAP_MS + 1);  // Uśpienie - odcinek pominięty
+    EXPECT_EQ(stats.getDurationMs(), 1000u);
+
+    stats.add(50.0f, 8000);
+    stats.pause();
+    stats.add(90.0f, 9000);   // Czas od pauzy nie jest liczony
+    stats.add(90.0f, 9500);
+    EXPECT_EQ(stats.getDurationMs(), 1000u + 1999u + 500u);
+    EXPECT_NEAR(stats.getTimeMean(), (20.0f * 1000 + 50.0f * 1999 + 90.0f * 500) / 3499.0f, 1e-3);
+}
+
+TEST(RunningStatsTest, StateSurvivesByteCopy) {
+    // Magazyn ustawień zapisuje obiekt jako blok bajtów
+    RunningStats<float> original;
+    original.add(12.0f, 0);
+    original.add(18.0f, 1000);
+
+    RunningStats<float> restored;
+    memcpy((void*)&restored, (const void*)&original, sizeof(original));
+    original.add(24.0f, 2000);
+    restored.add(24.0f, 2000);
+
+    EXPECT_EQ(restored.getCount(), original.getCount());
+    EXPECT_FLOAT_EQ(restored.getTimeMean(), original.getTimeMean());
+    EXPECT_FLOAT_EQ(restored.getVariance(), original.getVariance());
+}
+
+template <typename T, uint16_t N>
+static void checkWindowAgainstBruteForce(const std::vector<T>& values) {
+    WindowedStats<T, N> window;
+    for (size_t i = 0; i < values.size(); i++) {
+        window.add(values[i]);
+
+        size_t first = (i + 1 > N) ? i + 1 - N : 0;
+        std::vector<T> recent(values.begin() + first, values.begin() + i + 1);
+        Exact expected = exact(recent);
+
+        ASSERT_EQ(window.getCount(), recent.size()) << "probka " << i;
+        ASSERT_EQ(window.getMin(), (T)expected.minimum) << "probka " << i;
+        ASSERT_EQ(window.getMax(), (T)expected.maximum) << "probka " << i;
+        ASSERT_NEAR(window.getMean(), expected.mean, 1e-3) << "probka " << i;
+        ASSERT_NEAR(window.getVariance(), expected.variance, 1e-2) << "probka " << i;
+    }
+}
+
+TEST(WindowedStatsTest, MatchesBruteForceOverRandomSequence) {
+    std::mt19937 rng(11);
+    std::vector<float> values;
+    for (int i = 0; i < 2000; i++) values.push_back((rng() % 10000) / 100.0f);
+    checkWindowAgainstBruteForce<float, 8>(values);
+}
+
+TEST(WindowedStatsTest, MonotonicRunsAndRepeatedValues) {
+    // Serie rosnące, malejące i stałe - najgorszy przypadek kolejek min/max
+    std::vector<int16_t> values;
+    for (int i = 0; i < 50; i++) values.push_back(i);
+    for (int i = 50; i > -50; i--) values.push_back(i);
+    for (int i = 0; i < 30; i++) values.push_back(7);
+    checkWindowAgainstBruteForce<int16_t, 5>(values);
+
+    WindowedStats<int16_t, 5> constant;
+    for (int i = 0; i < 100; i++) constant.add(7);
+    EXPECT_GE(constant.getVariance(), 0.0f);
+    EXPECT_NEAR(constant.getStdDev(), 0.0f, 1e-3);
+}
+
+TEST(TripMetricsTest, ExportsEveryMetric) {
+    TripMetrics metrics;
+    metrics.add(TRIP_SPEED, 20.0f, 0);
+    metrics.add(TRIP_SPEED, 30.0f, 2000);
+    metrics.add(TRIP_SPEED, 0.0f, 3000);
+    metrics.add(TRIP_POWER, 250.0f, 0);
+
+    EXPECT_FLOAT_EQ(metrics.getAverage(TRIP_SPEED), (20.0f * 2 + 30.0f) / 3);
+    EXPECT_FLOAT_EQ(metrics.getMax(TRIP_SPEED), 30.0f);
+
+    CapturePrint out;
+    {
+        JsonWriter json(out);
+        json.beginObject();
+        metrics.toJson(json);
+        json.endObject();
+    }
+    for (uint8_t i = 0; i < TRIP_METRIC_COUNT; i++) {
+        std::string key = std::string("\"") + TripMetrics::getInfo((TripMetric)i).name + "\":{";
+        EXPECT_NE(out.text.find(key), std::string::npos) << out.text;
+    }
+    EXPECT_NE(out.text.find("\"speed\":{\"unit\":\"km/h\""), std::string::npos) << out.text;
+    EXPECT_NE(out.text.find("\"samples\":3,\"durationS\":3}"), std::string::npos) << out.text;
+    EXPECT_EQ(out.text.front(), '{');
+    EXPECT_EQ(out.text.back(), '}');
+}
+
+TEST(TripMetricsTest, DataBlockRoundTripAndReset) {
+    TripMetrics metrics;
+    metrics.add(TRIP_CADENCE, 80.0f, 0);
+    metrics.add(TRIP_CADENCE, 90.0f, 1000);
+
+    TripMetrics restored;
+    ASSERT_EQ(TripMetrics::getDataSize(), sizeof(RunningStats<float>) * TRIP_METRIC_COUNT);
+    memcpy(restored.getData(), metrics.getData(), TripMetrics::getDataSize());
+    EXPECT_FLOAT_EQ(restored.getAverage(TRIP_CADENCE), 80.0f);
+    EXPECT_EQ(restored.get(TRIP_CADENCE).getCount(), 2u);
+
+    restored.reset();
+    EXPECT_EQ(restored.get(TRIP_CADENCE).getCount(), 0u);
+    EXPECT_FLOAT_EQ(restored.getAverage(TRIP_CADENCE), 0.0f);
+}
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "CoreSnapshots.h"
+#include "EnergyEstimator.h"
+#include "Seqlock.h"
+#include "SettingsStore.h"
+
+// Migawki między rdzeniami pod obciążeniem: pisarz w osobnym wątku (jak pętla
+// główna na rdzeniu 1) i czytelnicy równolegle. Na PC z jednym procesorem wątki
+// nie muszą działać naprawdę równocześnie - sprawdzamy tylko, że żaden odczyt
+// nie jest rozerwany, wersje rosną, a ostatni odczyt to ostatni zapis.
+
+#define STRESS_WRITES 200000
+#define STRESS_WORDS 63
+
+// Każde pole wynika z numeru zapisu - rozerwana kopia ma pola z różnych zapisów
+struct StressValue {
+    uint32_t serial;
+    uint32_t words[STRESS_WORDS];
+};
+
+static void fillStress(StressValue& value, uint32_t serial) {
+    value.serial = serial;
+    for (uint32_t i = 0; i < STRESS_WORDS; i++) value.words[i] = serial * 2654435761u + i;
+}
+
+static bool isConsistent(const StressValue& value) {
+    for (uint32_t i = 0; i < STRESS_WORDS; i++) {
+        if (value.words[i] != value.serial * 2654435761u + i) return false;
+    }
+    return true;
+}
+
+struct ReaderStats {
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    uint32_t lastSerial = 0;
+};
+
+TEST(SeqlockTest, ConcurrentReadersNeverSeeTornValue) {
+    Seqlock<StressValue> lock;
+    std::atomic<bool> done(false);
+
+    StressValue empty;
+    EXPECT_FALSE(lock.read(empty));
+
+    std::vector<ReaderStats> stats(2);
+    std::vector<std::thread> readers;
+    for (ReaderStats& reader : stats) {
+        readers.emplace_back([&lock, &done, &reader]() {
+            StressValue value;
+            for (;;) {
+                bool finished = done.load(std::memory_order_acquire);
+                if (lock.read(value)) {
+                    reader.reads++;
+                    if (!isConsistent(value)) reader.torn++;
+                    if (value.serial < reader.lastSerial) reader.backwards++;
+                    reader.lastSerial = value.serial;
+                }
+                if (finished) break;
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    StressValue value;
+    for (uint32_t serial = 1; serial <= STRESS_WRITES; serial++) {
+        fillStress(value, serial);
+        lock.write(value);
+        if ((serial & 0xFF) == 0) std::this_thread::yield();  // Czytelnicy też na jednym rdzeniu
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& reader : readers) reader.join();
+
+    EXPECT_EQ(lock.getVersion(), (uint32_t)STRESS_WRITES);
+    for (const ReaderStats& reader : stats) {
+        EXPECT_GT(reader.reads, 0u);
+        EXPECT_EQ(reader.torn, 0u);
+        EXPECT_EQ(reader.backwards, 0u);
+        // Ostatni odczyt po zakończeniu pisarza
+        EXPECT_EQ(reader.lastSerial, (uint32_t)STRESS_WRITES);
+    }
+}
+
+TEST(CoreSnapshotsTest, BothDirectionsStayConsistent) {
+    // Rdzeń 1 publikuje RideSnapshot i czyta ServiceSnapshot, rdzeń 0 odwrotnie
+    Seqlock<RideSnapshot> ride;
+    Seqlock<ServiceSnapshot> service;
+    std::atomic<bool> serviceDone(false);
+    std::atomic<uint32_t> rideTorn(0);
+    std::atomic<uint32_t> serviceTorn(0);
+    const uint32_t ROUNDS = 50000;
+
+    std::thread serviceCore([&]() {
+        ServiceSnapshot snapshot = {};
+        RideSnapshot seen;
+        for (uint32_t n = 1; n <= ROUNDS; n++) {
+            snapshot.stampMs = n;
+            snapshot.rtcEpoch = 1700000000u + n;
+            snapshot.rtcStampMs = n;
+            snapshot.front.pressureBar = n * 0.5f;
+            snapshot.rear.pressureBar = n * 0.25f;
+            snapshot.webClients = n & 3;
+            service.write(snapshot);
+
+            if (ride.read(seen) &&
+                (seen.odometerMeters != seen.stampMs * 3 || seen.speedKmh != (float)(seen.stampMs & 0xFFFF))) {
+                rideTorn++;
+            }
+            if ((n & 0x3F) == 0) std::this_thread::yield();
+        }
+        serviceDone.store(true, std::memory_order_release);
+    });
+
+    RideSnapshot snapshot = {};
+    ServiceSnapshot seen;
+    uint32_t n = 0;
+    while (!serviceDone.load(std::memory_order_acquire)) {
+        n++;
+        snapshot.stampMs = n;
+        snapshot.odometerMeters = n * 3;
+        snapshot.speedKmh = (float)(n & 0xFFFF);
+        ride.write(snapshot);
+
+        if (service.read(seen) &&
+            (seen.rtcEpoch != 1700000000u + seen.stampMs || seen.rtcStampMs != seen.stampMs ||
+             seen.front.pressureBar != seen.stampMs * 0.5f || seen.rear.pressureBar != seen.stampMs * 0.25f)) {
+            serviceTorn++;
+        }
+        if ((n & 0x3F) == 0) std::this_thread::yield();
+    }
+    serviceCore.join();
+
+    EXPECT_EQ(rideTorn.load(), 0u);
+    EXPECT_EQ(serviceTorn.load(), 0u);
+    EXPECT_EQ(service.getVersion(), ROUNDS);
+    EXPECT_EQ(ride.getVersion(), n);
+    ASSERT_TRUE(service.read(seen));
+    EXPECT_EQ(seen.stampMs, ROUNDS);
+}
+
+// Sekcja energii jak w main.ino: strukturę zmienia rdzeń 1, zapis pliku kopiuje migawkę
+static Seqlock<EnergyState>* energySnapshot;
+
+static bool readEnergySnapshot(void* out) {
+    EnergyState state;
+    if (!energySnapshot->read(state)) return false;
+    memcpy(out, &state, sizeof(state));
+    return true;
+}
+
+// Stan z niezmiennikiem: wszystkie pola wynikają z n
+static void fillEnergy(EnergyState& state, uint32_t n) {
+    state.tripWh = (float)n;
+    state.tripKm = (float)n / 8;
+    state.totalWh = (float)n + 1000;
+    for (uint8_t i = 0; i < ENERGY_ROLLING_KM; i++) state.bucketWh[i] = (float)n;
+    state.rollingWh = (float)n * ENERGY_ROLLING_KM;
+    state.currentWh = (float)n / 2;
+    state.currentKm = 0.5f;
+    state.bucketHead = n % ENERGY_ROLLING_KM;
+    state.bucketCount = ENERGY_ROLLING_KM;
+}
+
+static bool isEnergyConsistent(const EnergyState& state) {
+    EnergyState expected;
+    memset(&expected, 0, sizeof(expected));
+    fillEnergy(expected, (uint32_t)state.tripWh);
+    return memcmp(&expected, &state, sizeof(state)) == 0;
+}
+
+class SettingsSnapshotTest : public ::testing::Test {
+protected:
+    EnergyState live;
+    Seqlock<EnergyState> snapshot;
+    SettingsStore store;
+
+    void SetUp() override {
+        FakeFs::format();
+        energySnapshot = &snapshot;
+        memset(&live, 0, sizeof(live));
+        ASSERT_TRUE(store.registerSection(SETTINGS_ENERGY, 1, &live, sizeof(live), readEnergySnapshot));
+    }
+
+    // Sekcja energii z obrazu zgodnego z plikiem
+    EnergyState saved() {
+        std::vector<uint8_t> image(store.getImageSize());
+        EnergyState state;
+        memset(&state, 0, sizeof(state));
+        if (store.exportImage(image.data(), image.size())) memcpy(&state, image.data(), sizeof(state));
+        return state;
+    }
+};
+
+TEST_F(SettingsSnapshotTest, WritesPublishedSnapshotNotLiveStruct) {
+    // Przed pierwszą publikacją - kopia struktury (stan z setup())
+    fillEnergy(live, 5);
+    store.markDirty(SETTINGS_ENERGY);
+    ASSERT_TRUE(store.flush());
+    EXPECT_FLOAT_EQ(saved().tripWh, 5.0f);
+
+    EnergyState published;
+    fillEnergy(published, 7);
+    snapshot.write(published);
+    fillEnergy(live, 9);   // Zmiana w toku na drugim rdzeniu, jeszcze bez publikacji
+    store.markDirty(SETTINGS_ENERGY);
+    ASSERT_TRUE(store.flush());
+    EXPECT_FLOAT_EQ(saved().tripWh, 7.0f);
+
+    // Migawka bez zmian - porównanie też z migawką, bez zapisu do flash
+    uint32_t writes = store.getFlashWrites();
+    store.markDirty(SETTINGS_ENERGY);
+    ASSERT_TRUE(store.flush());
+    EXPECT_EQ(store.getFlashWrites(), writes);
+    EXPECT_EQ(store.getSkippedWrites(), 1u);
+}
+
+TEST_F(SettingsSnapshotTest, FlushWhileOwnerPublishes) {
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> lastPublished(0);
+
+    // Pierwsza publikacja przed startem drugiego wątku, jak w setup()
+    fillEnergy(live, 0);
+    snapshot.write(live);
+
+    // Pętla główna: stan zmieniany po polu, publikowany w całości (n dokładne w float)
+    std::thread owner([&]() {
+        for (uint32_t n = 1; n < (1u << 20) && !done.load(std::memory_order_acquire); n++) {
+            fillEnergy(live, n);
+            snapshot.write(live);
+            lastPublished.store(n, std::memory_order_release);
+            if ((n & 0x3F) == 0) std::this_thread::yield();
+        }
+    });
+
+    uint32_t torn = 0;
+    uint32_t previous = 0;
+    uint32_t backwards = 0;
+    for (int i = 0; i < 300; i++) {
+        store.markDirty(SETTINGS_ENERGY);
+        ASSERT_TRUE(store.flush());
+        EnergyState state = saved();
+        if (!isEnergyConsistent(state)) torn++;
+        if ((uint32_t)state.tripWh < previous) backwards++;
+        previous = (uint32_t)state.tripWh;
+        std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+    owner.join();
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(backwards, 0u);
+    EXPECT_LE(previous, lastPublished.load());
+    EXPECT_EQ(store.getFlashWrites() + store.getSkippedWrites(), 300u);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+#include "HostSimulator.h"
+
+// Pierścień impulsów kadencji pod obciążeniem: producent w osobnym wątku
+// (jak cadence_ISR na rdzeniu 1) i czytelnik pracujący równolegle
+
+#define STRESS_RING_SIZE 64   // Jak CADENCE_RING_SIZE w main.ino
+
+// Producent wysyła kolejne numery w zadanym tempie (0 - bez przerw), czytelnik
+// odbiera je co readerPeriodUs (0 - stale, oddając procesor). Zwraca odebrane wartości.
+static std::vector<uint32_t> runStress(SpscRing<uint32_t, STRESS_RING_SIZE>& ring, uint32_t count,
+                                       uint32_t pulsePeriodUs, uint32_t readerPeriodUs,
+                                       uint32_t& pushed) {
+    std::atomic<bool> done(false);
+    std::vector<uint32_t> received;
+    received.reserve(count);
+    pushed = 0;
+
+    std::thread reader([&]() {
+        uint32_t value;
+        for (;;) {
+            bool finished = done.load(std::memory_order_acquire);
+            while (ring.pop(value)) {
+                received.push_back(value);
+            }
+            if (finished) break;
+            if (readerPeriodUs > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(readerPeriodUs));
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    auto next = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        if (pulsePeriodUs > 0) {
+            next += std::chrono::microseconds(pulsePeriodUs);
+            // Oddaje procesor czytelnikowi (test działa też na jednym rdzeniu)
+            while (std::chrono::steady_clock::now() < next) std::this_thread::yield();
+        }
+        if (ring.push(i)) pushed++;
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+    return received;
+}
+
+TEST(SpscRingTest, TenKilohertzPulsesWithConcurrentReader) {
+    SpscRing<uint32_t, STRESS_RING_SIZE> ring;
+    uint32_t pushed;
+    // 10 kHz przez 0,5 s, czytelnik co 1 ms. Czy czytelnik nadąży, zależy od
+    // planisty systemu PC - sprawdzamy, że zgubione są dokładnie te impulsy,
+    // które policzono jako zgubione, a reszta przyszła w kolejności.
+    std::vector<uint32_t> received = runStress(ring, 5000, 100, 1000, pushed);
+
+    ASSERT_EQ(received.size(), pushed);
+    EXPECT_EQ(pushed + ring.getDropped(), 5000u);
+    uint32_t missing = received.empty() ? 5000 : received[0] + (4999 - received.back());
+    for (uint32_t i = 1; i < received.size(); i++) {
+        ASSERT_LT(received[i - 1], received[i]);
+        missing += received[i] - received[i - 1] - 1;
+    }
+    EXPECT_EQ(missing, ring.getDropped());
+}
+
+// Ten sam przypadek w czasie wirtualnym: zadanie co 5 ms przy 10 kHz zastaje
+// 50 impulsów - mieści się w pierścieniu, a co 7 ms (70) już nie
+TEST(SpscRingTest, ReaderPeriodBoundsLossAtTenKilohertz) {
+    const uint32_t periods[] = { 5, 7 };
+    for (uint32_t readerMs : periods) {
+        SpscRing<uint32_t, STRESS_RING_SIZE> ring;
+        uint32_t next = 0;
+        uint32_t expected = 0;
+        uint32_t value;
+        for (uint32_t tick = 0; tick < 200; tick++) {
+            for (uint32_t i = 0; i < readerMs * 10; i++) {
+                ring.push(next++);
+            }
+            while (ring.pop(value)) {
+                if (value == expected) expected++;
+            }
+        }
+        if (readerMs * 10 <= ring.capacity()) {
+            EXPECT_EQ(ring.getDropped(), 0u);
+            EXPECT_EQ(expected, next);
+        } else {
+            EXPECT_EQ(ring.getDropped(), 200u * (readerMs * 10 - ring.capacity()));
+        }
+    }
+}
+
+TEST(SpscRingTest, FullSpeedProducerLosesNothingSilently) {
+    SpscRing<uint32_t, STRESS_RING_SIZE> ring;
+    uint32_t pushed;
+    // Producent bez przerw, czytelnik wolniejszy - pierścień się przepełnia
+    std::vector<uint32_t> received = runStress(ring, 200000, 0, 50, pushed);
+
+    // Każdy impuls albo odebrany, albo policzony jako zgubiony; kolejność zachowana
+    EXPECT_EQ(received.size(), pushed);
+    EXPECT_EQ(pushed + ring.getDropped(), 200000u);
+    for (uint32_t i = 1; i < received.size(); i++) {
+        ASSERT_LT(received[i - 1], received[i]);
+    }
+}
+
+TEST(SpscRingTest, ItemsAreNeverTorn) {
+    struct Pair {
+        uint32_t value;
+        uint32_t inverse;
+    };
+    SpscRing<Pair, 16> ring;
+    std::atomic<bool> done(false);
+    uint32_t torn = 0;
+    uint32_t popped = 0;
+
+    std::thread reader([&]() {
+        Pair pair;
+        while (!done.load(std::memory_order_acquire) || !ring.isEmpty()) {
+            while (ring.pop(pair)) {
+                if (pair.inverse != ~pair.value) torn++;
+                popped++;
+            }
+        }
+    });
+    for (uint32_t i = 0; i < 500000; i++) {
+        ring.push({ i, ~i });
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(popped + ring.getDropped(), 500000u);
+}
+
+// Jeden magnes: impuls co 0,6-1,5 s, czyli rzadziej niż odczyt pierścienia co 100 ms.
+// W 2d48278 zadanie kadencji zerowało historię, gdy miało mniej niż dwa znaczniki,
+// więc przy takim czujniku kadencja zawsze wynosiła 0.
+TEST(SpscRingTest, SinglePulsePerRevolutionGivesCadence) {
+    HostSimulator sim;
+    sim.begin();
+
+    sim.setRide({ 15.0f, 100, 0.0f, true });
+    sim.runFor(6000);
+    EXPECT_NEAR(sim.getCadenceRpm(), 100, 1);
+
+    sim.setRide({ 15.0f, 40, 0.0f, true });
+    sim.runFor(10000);
+    EXPECT_NEAR(sim.getCadenceRpm(), 40, 1);
+    EXPECT_GT(sim.getPulsesSent(), 15u);
+}
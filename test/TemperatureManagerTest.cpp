@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "FakeClock.h"
+#include "TemperatureManager.h"
+
+// Tablica NTC względem równania B, automat pomiaru DS18B20 (jeden krok na
+// wywołanie), odrzucanie wartości 85 °C po włączeniu i utrata czujnika
+
+#define AIR_PIN 15
+#define CONTROLLER_PIN 4
+#define NTC_PIN 34
+
+// NTC10k B3950 do masy, 10k do 3.3 V
+static double ntcCelsius(double milliVolts) {
+    double resistance = 10000.0 * milliVolts / (3300.0 - milliVolts);
+    return 1.0 / (1.0 / 298.15 + log(resistance / 10000.0) / 3950.0) - 273.15;
+}
+
+class TemperatureManagerTest : public ::testing::Test {
+protected:
+    OneWire airBus { AIR_PIN };
+    OneWire controllerBus { CONTROLLER_PIN };
+    DallasTemperature air { &airBus };
+    DallasTemperature controller { &controllerBus };
+    TemperatureManager temperatures { air, controller, NTC_PIN };
+
+    void SetUp() override {
+        FakeClock::reset();
+        FakeGpio::reset();
+        FakeGpio::setMilliVolts(NTC_PIN, 1650);
+        air.setTemperature(21.5f);
+        controller.setTemperature(35.0f);
+    }
+
+    // Pętla woła update() co 10 ms
+    void runFor(uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += 10) {
+            FakeClock::advanceMs(10);
+            temperatures.update();
+        }
+    }
+};
+
+TEST(NtcTableTest, MatchesBetaEquation) {
+    // -20..120 °C to ok. 3014..129 mV
+    double worst = 0;
+    for (uint16_t mv = 130; mv <= 3010; mv++) {
+        double error = fabs(TemperatureManager::ntcToDeciCelsius(mv) / 10.0 - ntcCelsius(mv));
+        worst = std::max(worst, error);
+    }
+    EXPECT_LT(worst, 0.3);
+    EXPECT_NEAR(TemperatureManager::ntcToDeciCelsius(1650), 250, 1);  // R = 10k, 25 °C
+}
+
+TEST(NtcTableTest, MonotonicAndClamped) {
+    int16_t previous = TemperatureManager::ntcToDeciCelsius(0);
+    EXPECT_EQ(previous, 1500);
+    for (uint32_t mv = 1; mv <= 4095; mv++) {
+        int16_t value = TemperatureManager::ntcToDeciCelsius(mv);
+        ASSERT_LE(value, previous) << mv << " mV";
+        previous = value;
+    }
+    EXPECT_EQ(previous, -400);
+}
+
+TEST_F(TemperatureManagerTest, BeginConfiguresAsyncConversion) {
+    temperatures.begin();
+    EXPECT_TRUE(temperatures.isPresent(TEMP_CHANNEL_AIR));
+    EXPECT_TRUE(temperatures.isPresent(TEMP_CHANNEL_CONTROLLER));
+    EXPECT_EQ(air.getResolution(), TEMP_DS18B20_RESOLUTION);
+    EXPECT_FALSE(air.getWaitForConversion());
+
+    char text[24];
+    temperatures.formatAddress(TEMP_CHANNEL_AIR, text, sizeof(text));
+    EXPECT_STREQ(text, "28292A2B2C2D2E2F");
+    temperatures.formatAddress(TEMP_CHANNEL_MOTOR, text, sizeof(text));
+    EXPECT_STREQ(text, "");
+}
+
+TEST_F(TemperatureManagerTest, OneBusOperationPerCall) {
+    temperatures.begin();
+
+    // Żądania konwersji w kolejnych wywołaniach, nie w jednym
+    FakeClock::advanceMs(TEMP_REQUEST_INTERVAL_MS);
+    temperatures.update();
+    EXPECT_EQ(air.getRequests() + controller.getRequests(), 0u);
+    temperatures.update();
+    EXPECT_EQ(air.getRequests(), 1u);
+    EXPECT_EQ(controller.getRequests(), 0u);
+    temperatures.update();
+    EXPECT_EQ(controller.getRequests(), 1u);
+
+    // Odczyt dopiero po czasie konwersji 12 bitów, po jednym czujniku
+    FakeClock::advanceMs(700);
+    temperatures.update();
+    temperatures.update();
+    EXPECT_EQ(air.getReads(), 0u);
+
+    FakeClock::advanceMs(50);
+    temperatures.update();
+    temperatures.update();
+    EXPECT_EQ(air.getReads(), 1u);
+    EXPECT_EQ(controller.getReads(), 0u);
+    temperatures.update();
+    EXPECT_EQ(controller.getReads(), 1u);
+
+    EXPECT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_AIR), 21.5f);
+    EXPECT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_CONTROLLER), 35.0f);
+}
+
+TEST_F(TemperatureManagerTest, PowerOnValueIsRejectedOnlyWithoutHistory) {
+    temperatures.begin();
+    air.setTemperature(85.0f);
+    runFor(2000);
+    EXPECT_EQ(temperatures.get(TEMP_CHANNEL_AIR), TEMP_INVALID);
+    EXPECT_GT(temperatures.getErrors(TEMP_CHANNEL_AIR), 0u);
+
+    air.setTemperature(80.0f);
+    runFor(2000);
+    EXPECT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_AIR), 80.0f);
+
+    // Po wcześniejszym odczycie 85 °C to zwykła temperatura
+    air.setTemperature(85.0f);
+    runFor(2000);
+    EXPECT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_AIR), 85.0f);
+}
+
+TEST_F(TemperatureManagerTest, LostSensorIsInvalidatedAndRescanned) {
+    temperatures.begin();
+    runFor(2000);
+    ASSERT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_CONTROLLER), 35.0f);
+
+    // Pojedynczy błąd nie kasuje wartości, TEMP_MAX_FAILURES kolejnych - tak
+    controller.setConnected(false);
+    runFor(TEMP_REQUEST_INTERVAL_MS);
+    EXPECT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_CONTROLLER), 35.0f);
+    runFor(TEMP_REQUEST_INTERVAL_MS * TEMP_MAX_FAILURES);
+    EXPECT_EQ(temperatures.get(TEMP_CHANNEL_CONTROLLER), TEMP_INVALID);
+    EXPECT_FALSE(temperatures.isPresent(TEMP_CHANNEL_CONTROLLER));
+    EXPECT_TRUE(temperatures.isPresent(TEMP_CHANNEL_AIR));
+
+    // Bez ponownego wyszukania odłączony czujnik nie jest odpytywany
+    uint32_t reads = controller.getReads();
+    runFor(5000);
+    EXPECT_EQ(controller.getReads(), reads);
+
+    controller.setConnected(true);
+    controller.setTemperature(40.0f);
+    runFor(TEMP_RESCAN_INTERVAL_MS + 3000);
+    EXPECT_TRUE(temperatures.isPresent(TEMP_CHANNEL_CONTROLLER));
+    EXPECT_FLOAT_EQ(temperatures.get(TEMP_CHANNEL_CONTROLLER), 40.0f);
+}
+
+TEST_F(TemperatureManagerTest, OutOfRangeReadingsCountAsFailures) {
+    temperatures.begin();
+    runFor(2000);
+    air.setTemperature(TEMP_MAX_VALID + 10.0f);
+    runFor(TEMP_REQUEST_INTERVAL_MS * (TEMP_MAX_FAILURES + 1));
+    EXPECT_EQ(temperatures.get(TEMP_CHANNEL_AIR), TEMP_INVALID);
+    EXPECT_GE(temperatures.getErrors(TEMP_CHANNEL_AIR), (uint32_t)TEMP_MAX_FAILURES);
+}
+
+TEST_F(TemperatureManagerTest, NtcIsOversampledAndRangeChecked) {
+    temperatures.begin();
+    EXPECT_FALSE(temperatures.isPresent(TEMP_CHANNEL_MOTOR));
+
+    // NTC_OVERSAMPLE próbek po NTC_SAMPLES_PER_CALL na wywołanie
+    for (uint8_t i = 0; i < NTC_OVERSAMPLE / NTC_SAMPLES_PER_CALL - 1; i++) temperatures.update();
+    EXPECT_EQ(temperatures.get(TEMP_CHANNEL_MOTOR), TEMP_INVALID);
+    temperatures.update();
+    EXPECT_NEAR(temperatures.get(TEMP_CHANNEL_MOTOR), 25.0f, 0.15f);
+    EXPECT_EQ(temperatures.getNtcMilliVolts(), 1650);
+    EXPECT_TRUE(temperatures.isPresent(TEMP_CHANNEL_MOTOR));
+
+    // Przerwany przewód - napięcie pod zasilaniem
+    FakeGpio::setMilliVolts(NTC_PIN, 3290);
+    runFor(100);
+    EXPECT_EQ(temperatures.get(TEMP_CHANNEL_MOTOR), TEMP_INVALID);
+    EXPECT_GT(temperatures.getErrors(TEMP_CHANNEL_MOTOR), 0u);
+
+    // Zwarcie
+    FakeGpio::setMilliVolts(NTC_PIN, 20);
+    runFor(100);
+    EXPECT_EQ(temperatures.get(TEMP_CHANNEL_MOTOR), TEMP_INVALID);
+}
+
+TEST_F(TemperatureManagerTest, WithoutNtcPinMotorIsAbsent) {
+    TemperatureManager noNtc(air, controller, -1);
+    noNtc.begin();
+    for (int i = 0; i < 100; i++) noNtc.update();
+    EXPECT_FALSE(noNtc.isPresent(TEMP_CHANNEL_MOTOR));
+    EXPECT_EQ(noNtc.get(TEMP_CHANNEL_MOTOR), TEMP_INVALID);
+}
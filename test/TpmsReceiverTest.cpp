@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "FakeClock.h"
+#include "TpmsReceiver.h"
+
+// Rozgłoszenia TPMS: adresy z ustawień, struktury AD, dane producenta
+// i filtrowanie obcych urządzeń przed dekodowaniem
+
+typedef std::vector<uint8_t> Bytes;
+
+static const uint8_t FRONT_MAC[6] = { 0x80, 0xEA, 0xCA, 0x10, 0x20, 0x30 };
+static const uint8_t REAR_MAC[6] = { 0x81, 0xEA, 0xCA, 0x10, 0x20, 0x31 };
+static const uint8_t OTHER_MAC[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+
+static void putLe32(Bytes& data, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) data.push_back((value >> (i * 8)) & 0xFF);
+}
+
+// Flagi + nazwa + dane producenta, jak w rozgłoszeniu czujnika
+static Bytes advert(uint8_t sensor, uint32_t pressurePa, int32_t temperatureCenti,
+                    uint8_t battery, bool alarm) {
+    Bytes data = { 0x02, 0x01, 0x06, 0x05, 0x09, 'T', 'P', 'M', 'S' };
+    data.push_back(1 + TPMS_PAYLOAD_LENGTH);
+    data.push_back(0xFF);
+    data.push_back(0x00);
+    data.push_back(0x01);
+    data.push_back(sensor);
+    for (uint8_t i = 0; i < 5; i++) data.push_back(0xA0 + i);
+    putLe32(data, pressurePa);
+    putLe32(data, (uint32_t)temperatureCenti);
+    data.push_back(battery);
+    data.push_back(alarm ? 1 : 0);
+    return data;
+}
+
+class TpmsReceiverTest : public ::testing::Test {
+protected:
+    TpmsReceiver receiver;
+
+    void SetUp() override {
+        FakeClock::reset();
+        receiver.setSensors("80:EA:CA:10:20:30", "81:ea:ca:10:20:31");
+    }
+
+    void deliver(const uint8_t mac[6], const Bytes& payload) {
+        receiver.onResult(BLEAdvertisedDevice(mac, payload.data(), payload.size()));
+    }
+};
+
+TEST_F(TpmsReceiverTest, ParseMacAcceptsColonsDashesAndCase) {
+    uint8_t mac[6];
+    ASSERT_TRUE(TpmsReceiver::parseMac("80:EA:ca:10:20:3f", mac));
+    EXPECT_EQ(mac[0], 0x80);
+    EXPECT_EQ(mac[2], 0xCA);
+    EXPECT_EQ(mac[5], 0x3F);
+    EXPECT_TRUE(TpmsReceiver::parseMac("80-EA-CA-10-20-30", mac));
+
+    EXPECT_FALSE(TpmsReceiver::parseMac(nullptr, mac));
+    EXPECT_FALSE(TpmsReceiver::parseMac("", mac));
+    EXPECT_FALSE(TpmsReceiver::parseMac("80:EA:CA:10:20", mac));
+    EXPECT_FALSE(TpmsReceiver::parseMac("80:EA:CA:10:20:3", mac));
+    EXPECT_FALSE(TpmsReceiver::parseMac("80:EA:CA:10:20:30:", mac));
+    EXPECT_FALSE(TpmsReceiver::parseMac("80:EA:CA:10:20:3G", mac));
+    EXPECT_FALSE(TpmsReceiver::parseMac("80EACA102030", mac));
+}
+
+TEST_F(TpmsReceiverTest, InvalidAddressDisablesPosition) {
+    receiver.setSensors("80:EA:CA:10:20:30", "zly adres");
+    EXPECT_TRUE(receiver.isSensorEnabled(TPMS_FRONT));
+    EXPECT_FALSE(receiver.isSensorEnabled(TPMS_REAR));
+
+    deliver(REAR_MAC, advert(2, 300000, 2000, 90, false));
+    TpmsReading reading;
+    EXPECT_FALSE(receiver.pop(reading));
+}
+
+TEST_F(TpmsReceiverTest, DecodePayloadReadsManufacturerData) {
+    Bytes payload = advert(3, 248500, -1250, 87, true);
+    TpmsReading reading;
+    ASSERT_TRUE(TpmsReceiver::decodePayload(payload.data(), payload.size(), reading));
+    EXPECT_EQ(reading.sensorNumber, 3);
+    EXPECT_EQ(reading.address[0], 0xA0);
+    EXPECT_EQ(reading.address[4], 0xA4);
+    EXPECT_EQ(reading.pressurePa, 248500u);
+    EXPECT_EQ(reading.temperatureCenti, -1250);
+    EXPECT_EQ(reading.batteryPercent, 87);
+    EXPECT_TRUE(reading.alarm);
+}
+
+TEST_F(TpmsReceiverTest, DecodePayloadRejectsMalformedStructures) {
+    TpmsReading reading;
+    Bytes good = advert(1, 250000, 2000, 90, false);
+    size_t manufacturer = 9;  // Pozycja struktury 0xFF w advert()
+
+    // Inny producent
+    Bytes otherVendor = good;
+    otherVendor[manufacturer + 3] = 0x02;
+    EXPECT_FALSE(TpmsReceiver::decodePayload(otherVendor.data(), otherVendor.size(), reading));
+
+    // Za krótkie dane producenta
+    Bytes shortData = good;
+    shortData[manufacturer] = TPMS_PAYLOAD_LENGTH;
+    shortData.pop_back();
+    EXPECT_FALSE(TpmsReceiver::decodePayload(shortData.data(), shortData.size(), reading));
+
+    // Struktura AD wychodzi poza pakiet
+    Bytes truncated(good.begin(), good.end() - 4);
+    EXPECT_FALSE(TpmsReceiver::decodePayload(truncated.data(), truncated.size(), reading));
+
+    // Zerowa długość struktury
+    Bytes zero = good;
+    zero[3] = 0;
+    EXPECT_FALSE(TpmsReceiver::decodePayload(zero.data(), zero.size(), reading));
+
+    // Brak danych producenta
+    Bytes flagsOnly(good.begin(), good.begin() + manufacturer);
+    EXPECT_FALSE(TpmsReceiver::decodePayload(flagsOnly.data(), flagsOnly.size(), reading));
+    EXPECT_FALSE(TpmsReceiver::decodePayload(good.data(), 0, reading));
+}
+
+TEST_F(TpmsReceiverTest, OnlyConfiguredSensorsReachQueue) {
+    FakeClock::advanceMs(1234);
+    deliver(OTHER_MAC, advert(9, 100000, 0, 50, false));
+    deliver(FRONT_MAC, advert(1, 250000, 2100, 90, false));
+    deliver(REAR_MAC, advert(2, 310000, 2200, 80, false));
+    deliver(FRONT_MAC, Bytes(5, 0x00));  // Właściwy adres, ale śmieci w danych
+
+    EXPECT_EQ(receiver.getAdvertsSeen(), 4u);
+    EXPECT_EQ(receiver.getAdvertsAccepted(), 2u);
+
+    TpmsReading reading;
+    ASSERT_TRUE(receiver.pop(reading));
+    EXPECT_EQ(reading.position, TPMS_FRONT);
+    EXPECT_EQ(reading.pressurePa, 250000u);
+    EXPECT_EQ(reading.receivedMs, 1234u);
+    ASSERT_TRUE(receiver.pop(reading));
+    EXPECT_EQ(reading.position, TPMS_REAR);
+    EXPECT_EQ(reading.temperatureCenti, 2200);
+    EXPECT_FALSE(receiver.pop(reading));
+}
+
+TEST_F(TpmsReceiverTest, FullQueueCountsDrops) {
+    // Pętla główna nie odbiera - kolejka przyjmuje tylko tyle, ile ma miejsca
+    for (uint32_t i = 0; i < TPMS_QUEUE_SIZE * 2; i++) {
+        deliver(FRONT_MAC, advert(1, 250000 + i, 2000, 90, false));
+    }
+    EXPECT_EQ(receiver.getAdvertsAccepted() + receiver.getDropped(), TPMS_QUEUE_SIZE * 2u);
+    EXPECT_GT(receiver.getDropped(), 0u);
+
+    // Najstarsze odczyty wychodzą pierwsze
+    TpmsReading reading;
+    ASSERT_TRUE(receiver.pop(reading));
+    EXPECT_EQ(reading.pressurePa, 250000u);
+}
@@ -0,0 +1,330 @@
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+// Zastępnik rdzenia Arduino-ESP32 do budowania modułów na PC (testy i symulator).
+//
+// Czas płynie tylko na żądanie (FakeClock.h) - millis()/micros() zwracają zegar
+// wirtualny, delay() go przesuwa, a przesunięcie wywołuje timery esp_timer, których
+// termin minął. Piny, ADC, LEDC i UART to tablice w pamięci ustawiane przez test
+// (FakeGpio, FakeSerial). FreeRTOS ma tylko tyle, ile potrzebują moduły
+// działające w jednym wątku: semafory nie blokują, zadania się nie uruchamiają.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include "esp_err.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define FAKE_GPIO_COUNT 40
+#define FAKE_LEDC_CHANNELS 16
+
+#define digitalPinToInterrupt(p) (p)
+
+// Jak w Arduino-ESP32: min/max z biblioteki standardowej, nie makra
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+typedef uint8_t byte;
+
+// ---------------------------------------------------------------- String
+
+class String {
+public:
+    String() {}
+    String(const char* s) : text(s ? s : "") {}
+    String(const std::string& s) : text(s) {}
+    String(char c) : text(1, c) {}
+    String(int value) : text(std::to_string(value)) {}
+    String(unsigned int value) : text(std::to_string(value)) {}
+    String(long value) : text(std::to_string(value)) {}
+    String(unsigned long value) : text(std::to_string(value)) {}
+    String(float value, unsigned int digits = 2) { setFloat(value, digits); }
+    String(double value, unsigned int digits = 2) { setFloat(value, digits); }
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool isEmpty() const { return text.empty(); }
+    void reserve(unsigned int size) { text.reserve(size); }
+
+    String& operator+=(const String& s) { text += s.text; return *this; }
+    String& operator+=(const char* s) { text += s ? s : ""; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    bool concat(const String& s) { text += s.text; return true; }
+    bool concat(const char* s) { text += s ? s : ""; return true; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+    friend String operator+(const String& a, const char* b) { return String(a.text + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.text); }
+
+    bool operator==(const String& s) const { return text == s.text; }
+    bool operator==(const char* s) const { return text == (s ? s : ""); }
+    bool operator!=(const String& s) const { return text != s.text; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    char operator[](unsigned int index) const { return index < text.size() ? text[index] : '\0'; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = text.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const char* s, unsigned int from = 0) const {
+        size_t pos = text.find(s, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < text.size() && to > from ? String(text.substr(from, to - from)) : String();
+    }
+    bool startsWith(const char* prefix) const { return text.compare(0, strlen(prefix), prefix) == 0; }
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+
+private:
+    std::string text;
+
+    void setFloat(double value, unsigned int digits) {
+        char buffer[40];
+        snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+        text = buffer;
+    }
+};
+
+// ---------------------------------------------------------------- Print / Stream / UART
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            if (write(*buffer++) == 0) break;
+            n++;
+        }
+        return n;
+    }
+    size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int digits = 2) { return printf("%.*f", digits, value); }
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        return write((const uint8_t*)buffer, min((size_t)len, sizeof(buffer) - 1));
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t n = 0;
+        while (n < length && available() > 0) {
+            buffer[n++] = (uint8_t)read();
+        }
+        return n;
+    }
+};
+
+#define SERIAL_8N1 0x800001c
+
+// UART: odbierane bajty podaje test (inject), wysłane zostają w getOutput()
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int uart) : uart(uart), echo(false), capture(true), txSpace(4096), txBytes(0) {}
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1) {
+        (void)baud; (void)config; (void)rxPin; (void)txPin;
+    }
+    void end() {}
+    void setRxBufferSize(size_t size) { (void)size; }
+    operator bool() const { return true; }
+
+    int available() override { return (int)rx.size(); }
+    int read() override {
+        if (rx.empty()) return -1;
+        uint8_t c = rx.front();
+        rx.pop_front();
+        return c;
+    }
+    int peek() override { return rx.empty() ? -1 : rx.front(); }
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (capture) tx.append((const char*)buffer, size);
+        txBytes += size;
+        if (echo) fwrite(buffer, 1, size, stdout);
+        return size;
+    }
+    int availableForWrite() override { return (int)txSpace; }
+
+    // Strona testu
+    void inject(const uint8_t* data, size_t length) { rx.insert(rx.end(), data, data + length); }
+    const std::string& getOutput() const { return tx; }
+    void clearOutput() { tx.clear(); }
+    void setEcho(bool enabled) { echo = enabled; }          // Kopia wyjścia na stdout
+    void setCapture(bool enabled) { capture = enabled; }    // false - wyjście tylko liczone (benchmark)
+    size_t getBytesWritten() const { return txBytes; }
+    void setTxSpace(size_t bytes) { txSpace = bytes; }       // Wolne miejsce w buforze nadawczym
+
+private:
+    int uart;
+    bool echo;
+    bool capture;
+    size_t txSpace;
+    size_t txBytes;
+    std::deque<uint8_t> rx;
+    std::string tx;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+// ---------------------------------------------------------------- czas
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// ---------------------------------------------------------------- GPIO, ADC, LEDC
+
+typedef void (*voidFuncPtr)();
+typedef void (*voidFuncPtrArg)(void*);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+void attachInterrupt(uint8_t pin, voidFuncPtr handler, int mode);
+void attachInterruptArg(uint8_t pin, voidFuncPtrArg handler, void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+typedef enum {
+    ADC_0db,
+    ADC_2_5db,
+    ADC_6db,
+    ADC_11db
+} adc_attenuation_t;
+
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+// ---------------------------------------------------------------- ESP
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getHeapSize();
+    uint32_t getCycleCount();    // Cykle zegara wirtualnego przy getCpuFrequencyMhz()
+    void restart();
+};
+
+extern EspClass ESP;
+
+uint32_t getCpuFrequencyMhz();
+
+// ---------------------------------------------------------------- FreeRTOS
+
+typedef void* TaskHandle_t;
+typedef struct FakeSemaphore* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+typedef struct {
+    volatile uint32_t owner;
+    volatile uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+// Semafory nie czekają na oddanie - czekają tylko na chwilę, w której zadanie je oddało
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+// Zadania na przemian z pętlą: powiadomienie uruchamia zadanie do jego następnego czekania
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+BaseType_t xPortGetCoreID();
+BaseType_t xPortInIsrContext();
+
+#endif // FAKE_ARDUINO_H
@@ -0,0 +1,71 @@
+#ifndef FAKE_ARDUINOJSON_H
+#define FAKE_ARDUINOJSON_H
+
+#include <Arduino.h>
+
+// Zaślepka ArduinoJson: tylko typy, z którymi kompilują się moduły.
+// Wszystkie wartości są puste (isNull), a deserializeJson zawsze zwraca błąd -
+// ścieżki parsowania JSON nie są testowane na PC, zostają z wartościami domyślnymi.
+
+class JsonArrayConst;
+
+class JsonVariantConst {
+public:
+    bool isNull() const { return true; }
+    template <typename T>
+    T as() const { return T(); }
+    template <typename T>
+    bool is() const { return false; }
+    JsonVariantConst operator[](int index) const { (void)index; return JsonVariantConst(); }
+    JsonVariantConst operator[](const char* key) const { (void)key; return JsonVariantConst(); }
+
+    int operator|(int fallback) const { return fallback; }
+    float operator|(float fallback) const { return fallback; }
+    bool operator|(bool fallback) const { return fallback; }
+    const char* operator|(const char* fallback) const { return fallback; }
+};
+
+class JsonArrayConst {
+public:
+    bool isNull() const { return true; }
+    size_t size() const { return 0; }
+    JsonVariantConst operator[](int index) const { (void)index; return JsonVariantConst(); }
+    const JsonVariantConst* begin() const { return nullptr; }
+    const JsonVariantConst* end() const { return nullptr; }
+};
+
+class JsonObjectConst {
+public:
+    bool isNull() const { return true; }
+    bool containsKey(const char* key) const { (void)key; return false; }
+    JsonVariantConst operator[](const char* key) const { (void)key; return JsonVariantConst(); }
+};
+
+class DeserializationError {
+public:
+    enum Code { Ok, NotSupported };
+
+    DeserializationError(Code code = NotSupported) : code(code) {}
+    explicit operator bool() const { return code != Ok; }
+    const char* c_str() const { return code == Ok ? "Ok" : "NotSupported"; }
+
+private:
+    Code code;
+};
+
+template <size_t N>
+class StaticJsonDocument {
+public:
+    JsonVariantConst operator[](const char* key) const { (void)key; return JsonVariantConst(); }
+    JsonObjectConst as() const { return JsonObjectConst(); }
+    void clear() {}
+};
+
+template <typename Document, typename Input>
+DeserializationError deserializeJson(Document& doc, Input& input) {
+    (void)doc;
+    (void)input;
+    return DeserializationError::NotSupported;
+}
+
+#endif // FAKE_ARDUINOJSON_H
@@ -0,0 +1,39 @@
+#ifndef FAKE_BLEDEVICE_H
+#define FAKE_BLEDEVICE_H
+
+#include <Arduino.h>
+#include <vector>
+
+// Tylko typy potrzebne odbiornikom rozgłoszeń: adres i surowe dane pakietu
+typedef uint8_t esp_bd_addr_t[6];
+
+class BLEAddress {
+public:
+    explicit BLEAddress(const uint8_t mac[6]) { memcpy(address, mac, sizeof(address)); }
+    esp_bd_addr_t* getNative() { return &address; }
+
+private:
+    esp_bd_addr_t address;
+};
+
+class BLEAdvertisedDevice {
+public:
+    BLEAdvertisedDevice(const uint8_t mac[6], const uint8_t* payload, size_t length) :
+        address(mac), payload(payload, payload + length) {}
+
+    BLEAddress getAddress() { return address; }
+    uint8_t* getPayload() { return payload.data(); }
+    size_t getPayloadLength() { return payload.size(); }
+
+private:
+    BLEAddress address;
+    std::vector<uint8_t> payload;
+};
+
+class BLEAdvertisedDeviceCallbacks {
+public:
+    virtual ~BLEAdvertisedDeviceCallbacks() {}
+    virtual void onResult(BLEAdvertisedDevice advertisedDevice) = 0;
+};
+
+#endif // FAKE_BLEDEVICE_H
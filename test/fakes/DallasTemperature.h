@@ -0,0 +1,68 @@
+#ifndef FAKE_DALLAS_TEMPERATURE_H
+#define FAKE_DALLAS_TEMPERATURE_H
+
+#include <Arduino.h>
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+typedef uint8_t DeviceAddress[8];
+
+// Jeden czujnik DS18B20 na magistrali, sterowany przez test.
+// getTempC() zwraca wartość ustawioną przed ostatnim requestTemperatures(),
+// a DEVICE_DISCONNECTED_C, gdy czujnik odłączono.
+class DallasTemperature {
+public:
+    explicit DallasTemperature(OneWire* bus) :
+        bus(bus), connected(true), pending(85.0f), converted(85.0f),
+        requests(0), reads(0), resolution(9), waitForConversion(true)
+    {
+        for (uint8_t i = 0; i < 8; i++) address[i] = 0x28 + i;
+    }
+
+    void begin() {}
+    void setWaitForConversion(bool wait) { waitForConversion = wait; }
+    uint16_t millisToWaitForConversion(uint8_t bits) const { return 750 / (1 << (12 - bits)); }
+
+    bool getAddress(uint8_t* out, uint8_t index) {
+        if (!connected || index > 0) return false;
+        memcpy(out, address, sizeof(address));
+        return true;
+    }
+    bool setResolution(const uint8_t* device, uint8_t bits) {
+        (void)device;
+        resolution = bits;
+        return connected;
+    }
+
+    void requestTemperatures() {
+        requests++;
+        converted = connected ? pending : DEVICE_DISCONNECTED_C;
+    }
+    float getTempC(const uint8_t* device) {
+        reads++;
+        if (!connected || memcmp(device, address, sizeof(address)) != 0) return DEVICE_DISCONNECTED_C;
+        return converted;
+    }
+
+    // Strona testu
+    void setConnected(bool value) { connected = value; }
+    void setTemperature(float celsius) { pending = celsius; }
+    uint32_t getRequests() const { return requests; }
+    uint32_t getReads() const { return reads; }
+    uint8_t getResolution() const { return resolution; }
+    bool getWaitForConversion() const { return waitForConversion; }
+
+private:
+    OneWire* bus;
+    DeviceAddress address;
+    bool connected;
+    float pending;
+    float converted;
+    uint32_t requests;
+    uint32_t reads;
+    uint8_t resolution;
+    bool waitForConversion;
+};
+
+#endif // FAKE_DALLAS_TEMPERATURE_H
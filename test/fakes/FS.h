@@ -0,0 +1,95 @@
+#ifndef FAKE_FS_H
+#define FAKE_FS_H
+
+#include <Arduino.h>
+#include <memory>
+
+// System plików na katalogu tymczasowym PC (FakeFs::root()).
+//
+// Każdy write() trafia od razu do pliku, bajt w bajt - po "odcięciu zasilania"
+// na dysku zostaje dokładnie to, co zdążyło się zapisać. Budżet zapisu
+// (FakeFs::setWriteBudget) odcina zasilanie po podanej liczbie bajtów: zapis, który
+// go przekracza, jest ucinany, a dalsze zapisy, open("w"/"a"), rename i remove
+// kończą się błędem do FakeFs::restorePower(). Tak test sprawdza przerwanie zapisu
+// w każdym miejscu.
+
+namespace fs {
+
+struct FileImpl;
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    operator bool() const;
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    size_t read(uint8_t* buffer, size_t size);
+    int read() override;
+    int peek() override;
+    int available() override;
+    void flush() override {}
+
+    bool seek(uint32_t position);
+    size_t position() const;
+    size_t size() const;
+    void close();
+
+    const char* name() const;    // Nazwa bez katalogu
+    const char* path() const;
+    bool isDirectory() const;
+    File openNextFile(const char* mode = "r");
+    time_t getLastWrite() const { return 0; }
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = "r", bool create = false);
+    File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace FakeFs {
+    // Katalog główny (tworzony przy pierwszym użyciu)
+    const char* root();
+
+    // Usuwa wszystkie pliki i przywraca zasilanie
+    void format();
+
+    // Zasilanie odcinane po tylu zapisanych bajtach od wywołania
+    void setWriteBudget(size_t bytes);
+    void restorePower();
+    bool isPowerCut();
+
+    // Bajty zapisane od format() - do wyznaczenia wszystkich punktów przerwania
+    size_t getBytesWritten();
+
+    // Zawartość pliku (pusty napis, gdy go nie ma)
+    std::string readFile(const char* path);
+    void writeFile(const char* path, const std::string& data);
+}
+
+#endif // FAKE_FS_H
@@ -0,0 +1,524 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <rom/crc.h>
+#include <semaphore.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FakeClock.h"
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+EspClass ESP;
+
+// ---------------------------------------------------------------- zegar i timery
+
+struct FakeTimer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t periodUs;    // 0 - jednorazowy
+    uint64_t dueUs;
+    bool active;
+    bool deleted;
+};
+
+static std::atomic<uint64_t> clockUs(0);
+static std::vector<FakeTimer*> timers;
+
+// Zegar zadania FreeRTOS, gdy kod działa w jego wątku (patrz niżej) - czas zajęcia
+// zadania (transmisja I2C, delay) nie zatrzymuje pętli głównej
+static thread_local uint64_t* taskClockUs = nullptr;
+
+// Numer przebiegu zegara - chwile zapamiętane przed reset() nie obowiązują
+static uint32_t clockEpoch = 0;
+
+uint64_t FakeClock::nowUs() {
+    if (taskClockUs != nullptr) {
+        return *taskClockUs;
+    }
+    return clockUs.load(std::memory_order_relaxed);
+}
+
+void FakeClock::advanceUs(uint64_t us) {
+    if (taskClockUs != nullptr) {
+        *taskClockUs += us;
+        return;
+    }
+
+    uint64_t targetUs = nowUs() + us;
+
+    for (;;) {
+        // Najwcześniejszy termin w przedziale; callback może tworzyć i zatrzymywać timery
+        FakeTimer* next = nullptr;
+        for (FakeTimer* timer : timers) {
+            if (timer->active && timer->dueUs <= targetUs && (next == nullptr || timer->dueUs < next->dueUs)) {
+                next = timer;
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+
+        clockUs.store(next->dueUs, std::memory_order_relaxed);
+        if (next->periodUs > 0) {
+            next->dueUs += next->periodUs;
+        } else {
+            next->active = false;
+        }
+        next->callback(next->arg);
+    }
+
+    clockUs.store(targetUs, std::memory_order_relaxed);
+}
+
+void FakeClock::advanceMs(uint32_t ms) {
+    advanceUs((uint64_t)ms * 1000);
+}
+
+void FakeClock::reset(uint64_t startUs) {
+    // Timery należą do obiektów poprzedniego testu - tylko je wyłączamy,
+    // bo obiekty mogą jeszcze trzymać uchwyty
+    for (FakeTimer* timer : timers) {
+        timer->active = false;
+    }
+    clockUs.store(startUs, std::memory_order_relaxed);
+    clockEpoch++;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    if (args == nullptr || args->callback == nullptr || handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FakeTimer* timer = new FakeTimer();
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    timer->periodUs = 0;
+    timer->dueUs = 0;
+    timer->active = false;
+    timer->deleted = false;
+    timers.push_back(timer);
+    *handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    if (timer == nullptr || periodUs == 0) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->periodUs = periodUs;
+    timer->dueUs = FakeClock::nowUs() + periodUs;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    if (timer == nullptr) return ESP_ERR_INVALID_ARG;
+    if (timer->active) return ESP_ERR_INVALID_STATE;
+    timer->periodUs = 0;
+    timer->dueUs = FakeClock::nowUs() + timeoutUs;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer == nullptr || !timer->active) return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer == nullptr) return ESP_ERR_INVALID_ARG;
+    for (size_t i = 0; i < timers.size(); i++) {
+        if (timers[i] == timer) {
+            timers.erase(timers.begin() + i);
+            break;
+        }
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)FakeClock::nowUs();
+}
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(FakeClock::nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)FakeClock::nowUs();
+}
+
+void delay(uint32_t ms) {
+    FakeClock::advanceMs(ms);
+}
+
+void delayMicroseconds(uint32_t us) {
+    FakeClock::advanceUs(us);
+}
+
+void yield() {
+}
+
+// ---------------------------------------------------------------- GPIO, ADC, LEDC
+
+struct FakePin {
+    int level;
+    uint32_t milliVolts;
+    voidFuncPtr handler;
+    voidFuncPtrArg handlerArg;
+    void* arg;
+    int mode;
+};
+
+static FakePin pins[FAKE_GPIO_COUNT];
+static uint32_t ledcDuty[FAKE_LEDC_CHANNELS];
+static uint32_t ledcWrites = 0;
+static bool pinsReady = false;
+
+static void initPins() {
+    if (pinsReady) return;
+    pinsReady = true;
+    FakeGpio::reset();
+}
+
+void FakeGpio::reset() {
+    pinsReady = true;
+    for (uint8_t i = 0; i < FAKE_GPIO_COUNT; i++) {
+        pins[i] = FakePin();
+        pins[i].level = HIGH;  // Wejścia z podciąganiem w spoczynku
+    }
+    memset(ledcDuty, 0, sizeof(ledcDuty));
+    ledcWrites = 0;
+}
+
+void FakeGpio::setLevel(uint8_t pin, int level) {
+    initPins();
+    if (pin >= FAKE_GPIO_COUNT) return;
+    FakePin& p = pins[pin];
+    if (p.level == level) return;
+    p.level = level;
+
+    bool fire = p.mode == CHANGE || (p.mode == RISING && level == HIGH) || (p.mode == FALLING && level == LOW);
+    if (!fire) return;
+    if (p.handler) p.handler();
+    if (p.handlerArg) p.handlerArg(p.arg);
+}
+
+int FakeGpio::getLevel(uint8_t pin) {
+    initPins();
+    return pin < FAKE_GPIO_COUNT ? pins[pin].level : LOW;
+}
+
+void FakeGpio::setMilliVolts(uint8_t pin, uint32_t milliVolts) {
+    initPins();
+    if (pin < FAKE_GPIO_COUNT) pins[pin].milliVolts = milliVolts;
+}
+
+uint32_t FakeGpio::getLedcDuty(uint8_t channel) {
+    return channel < FAKE_LEDC_CHANNELS ? ledcDuty[channel] : 0;
+}
+
+uint32_t FakeGpio::getLedcWrites() {
+    return ledcWrites;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    initPins();
+    if (pin >= FAKE_GPIO_COUNT) return;
+    if (mode == INPUT_PULLUP) pins[pin].level = HIGH;
+    if (mode == INPUT_PULLDOWN) pins[pin].level = LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return FakeGpio::getLevel(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    initPins();
+    if (pin < FAKE_GPIO_COUNT) pins[pin].level = level ? HIGH : LOW;
+}
+
+void attachInterrupt(uint8_t pin, voidFuncPtr handler, int mode) {
+    initPins();
+    if (pin >= FAKE_GPIO_COUNT) return;
+    pins[pin].handler = handler;
+    pins[pin].handlerArg = nullptr;
+    pins[pin].mode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, voidFuncPtrArg handler, void* arg, int mode) {
+    initPins();
+    if (pin >= FAKE_GPIO_COUNT) return;
+    pins[pin].handler = nullptr;
+    pins[pin].handlerArg = handler;
+    pins[pin].arg = arg;
+    pins[pin].mode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    initPins();
+    if (pin >= FAKE_GPIO_COUNT) return;
+    pins[pin].handler = nullptr;
+    pins[pin].handlerArg = nullptr;
+    pins[pin].mode = 0;
+}
+
+uint16_t analogRead(uint8_t pin) {
+    initPins();
+    return pin < FAKE_GPIO_COUNT ? (uint16_t)min(pins[pin].milliVolts * 4095 / 3300, 4095U) : 0;
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+    initPins();
+    return pin < FAKE_GPIO_COUNT ? pins[pin].milliVolts : 0;
+}
+
+void analogReadResolution(uint8_t bits) {
+    (void)bits;
+}
+
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation) {
+    (void)pin;
+    (void)attenuation;
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t bits) {
+    (void)channel;
+    (void)bits;
+    return frequency;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    (void)pin;
+    (void)channel;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel >= FAKE_LEDC_CHANNELS) return;
+    ledcDuty[channel] = duty;
+    ledcWrites++;
+}
+
+// ---------------------------------------------------------------- ESP
+
+static uint32_t heapUsed = 0;
+static uint32_t heapMinFree = FakeHeap::SIZE;
+
+void FakeHeap::setUsed(uint32_t bytes) {
+    heapUsed = min(bytes, FakeHeap::SIZE);
+    heapMinFree = min(heapMinFree, FakeHeap::SIZE - heapUsed);
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return FakeHeap::SIZE - heapUsed;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return heapMinFree;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();
+}
+
+uint32_t EspClass::getHeapSize() {
+    return FakeHeap::SIZE;
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(FakeClock::nowUs() * FakeClock::CPU_MHZ);
+}
+
+void EspClass::restart() {
+    abort();
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return FakeClock::CPU_MHZ;
+}
+
+// ---------------------------------------------------------------- FreeRTOS
+
+// Zadania działają we własnych wątkach, ale zawsze tylko jeden wątek naraz:
+// xTaskNotifyGive oddaje sterowanie zadaniu aż do jego następnego czekania
+// w ulTaskNotifyTake, więc przebieg jest powtarzalny. Zadanie ma własny zegar
+// (start od chwili powiadomienia) - semafor oddany przez zadanie jest dostępny
+// dla pętli dopiero, gdy zegar wirtualny dojdzie do tej chwili.
+struct FakeTask {
+    TaskFunction_t fn;
+    void* arg;
+    std::thread thread;
+    sem_t toTask;            // Przekazanie sterowania (semafory POSIX - pamięć synchronizowana)
+    sem_t toLoop;
+    bool deleted;
+    uint32_t notifications;
+    uint64_t clockUs;
+};
+
+struct FakeTaskDeleted {};
+
+static thread_local FakeTask* currentTask = nullptr;
+
+// Pętla -> zadanie; wraca, gdy zadanie czeka
+static void runTask(FakeTask* task) {
+    sem_post(&task->toTask);
+    sem_wait(&task->toLoop);
+}
+
+// Zadanie -> pętla; wraca przy następnym runTask
+static void yieldTask(FakeTask* task) {
+    sem_post(&task->toLoop);
+    sem_wait(&task->toTask);
+    if (task->deleted) {
+        throw FakeTaskDeleted();
+    }
+}
+
+struct FakeSemaphore {
+    uint32_t count;
+    uint64_t readyUs;        // Oddany przez zadanie - dostępny od tej chwili
+    uint32_t readyEpoch;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new FakeSemaphore{0, 0, 0};
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new FakeSemaphore{1, 0, 0};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (semaphore == nullptr || semaphore->count == 0) {
+        return pdFALSE;
+    }
+
+    // Oddany "w przyszłości" przez zadanie - czekanie przesuwa zegar czekającego
+    uint64_t nowUs = FakeClock::nowUs();
+    if (semaphore->readyEpoch == clockEpoch && semaphore->readyUs > nowUs) {
+        uint64_t waitUs = semaphore->readyUs - nowUs;
+        if (ticks != portMAX_DELAY && waitUs > (uint64_t)ticks * portTICK_PERIOD_MS * 1000) {
+            return pdFALSE;
+        }
+        FakeClock::advanceUs(waitUs);
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore == nullptr || semaphore->count > 0) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    semaphore->readyUs = FakeClock::nowUs();
+    semaphore->readyEpoch = clockEpoch;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)name; (void)stack; (void)priority; (void)core;
+    FakeTask* task = new FakeTask();
+    task->fn = fn;
+    task->arg = arg;
+    sem_init(&task->toTask, 0, 0);
+    sem_init(&task->toLoop, 0, 0);
+    task->deleted = false;
+    task->notifications = 0;
+    task->clockUs = FakeClock::nowUs();
+
+    task->thread = std::thread([task]() {
+        currentTask = task;
+        taskClockUs = &task->clockUs;
+        sem_wait(&task->toTask);
+        try {
+            if (!task->deleted) task->fn(task->arg);
+        } catch (const FakeTaskDeleted&) {
+        }
+        sem_post(&task->toLoop);
+    });
+
+    // Jak w FreeRTOS nowe zadanie rusza od razu - do pierwszego czekania
+    runTask(task);
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+    FakeTask* task = static_cast<FakeTask*>(handle);
+    if (task == nullptr) {
+        return pdFAIL;
+    }
+    task->notifications++;
+    if (currentTask == nullptr) {
+        if (task->clockUs < FakeClock::nowUs()) task->clockUs = FakeClock::nowUs();
+        runTask(task);
+    }
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    FakeTask* task = currentTask;
+    if (task == nullptr) {
+        return 0;
+    }
+    while (task->notifications == 0) {
+        if (ticks != portMAX_DELAY) {
+            return 0;
+        }
+        yieldTask(task);
+    }
+    uint32_t value = task->notifications;
+    task->notifications = clear ? 0 : value - 1;
+    return value;
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+    FakeTask* task = static_cast<FakeTask*>(handle);
+    if (task == nullptr || task == currentTask) {
+        return;
+    }
+    task->deleted = true;
+    sem_post(&task->toTask);
+    task->thread.join();
+    sem_destroy(&task->toTask);
+    sem_destroy(&task->toLoop);
+    delete task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks * portTICK_PERIOD_MS);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 0;
+}
+
+BaseType_t xPortGetCoreID() {
+    return 1;
+}
+
+BaseType_t xPortInIsrContext() {
+    return pdFALSE;
+}
+
+// ---------------------------------------------------------------- ROM
+
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
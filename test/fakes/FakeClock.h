@@ -0,0 +1,39 @@
+#ifndef FAKE_CLOCK_H
+#define FAKE_CLOCK_H
+
+#include <stdint.h>
+
+// Zegar wirtualny zastępników: stoi, dopóki test go nie przesunie.
+// Przesunięcie wywołuje po kolei wszystkie timery esp_timer z terminem w tym
+// przedziale (zegar wskazuje wtedy termin timera), więc przebieg jest powtarzalny
+// co do mikrosekundy niezależnie od szybkości komputera.
+namespace FakeClock {
+    uint64_t nowUs();
+    void advanceUs(uint64_t us);
+    void advanceMs(uint32_t ms);
+
+    // Zegar na podanej chwili, bez timerów (nowy test)
+    void reset(uint64_t startUs = 0);
+
+    // Takty CPU na mikrosekundę dla ESP.getCycleCount()
+    const uint32_t CPU_MHZ = 240;
+}
+
+// Piny, ADC i wyjścia LEDC
+namespace FakeGpio {
+    // Zmiana poziomu wywołuje przerwanie dołączone do pinu (jak zbocze na wejściu)
+    void setLevel(uint8_t pin, int level);
+    int getLevel(uint8_t pin);
+    void setMilliVolts(uint8_t pin, uint32_t milliVolts);
+    uint32_t getLedcDuty(uint8_t channel);
+    uint32_t getLedcWrites();
+    void reset();
+}
+
+// Sterta: zajętość widziana przez ESP.getFreeHeap()
+namespace FakeHeap {
+    const uint32_t SIZE = 320 * 1024;
+    void setUsed(uint32_t bytes);
+}
+
+#endif // FAKE_CLOCK_H
@@ -0,0 +1,283 @@
+#include <FS.h>
+#include <LittleFS.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+fs::LittleFSFS LittleFS;
+
+namespace fs {
+
+struct FileImpl {
+    std::string path;       // Ścieżka w systemie urządzenia ("/odo_a.bin")
+    std::string name;
+    FILE* file;
+    DIR* dir;
+    bool writable;
+
+    FileImpl() : file(nullptr), dir(nullptr), writable(false) {}
+    ~FileImpl() { close(); }
+
+    void close() {
+        if (file) fclose(file);
+        if (dir) closedir(dir);
+        file = nullptr;
+        dir = nullptr;
+    }
+};
+
+} // namespace fs
+
+static std::string rootDir;
+static size_t bytesWritten = 0;
+static bool budgetSet = false;
+static size_t budgetLeft = 0;
+static bool powerCut = false;
+
+static void removeTree(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::string child = path + "/" + name;
+        struct stat st;
+        if (stat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            removeTree(child);
+            rmdir(child.c_str());
+        } else {
+            unlink(child.c_str());
+        }
+    }
+    closedir(dir);
+}
+
+static void removeRoot() {
+    if (!rootDir.empty()) {
+        removeTree(rootDir);
+        rmdir(rootDir.c_str());
+    }
+}
+
+const char* FakeFs::root() {
+    if (rootDir.empty()) {
+        char pattern[] = "/tmp/fakefs-XXXXXX";
+        const char* created = mkdtemp(pattern);
+        if (created == nullptr) {
+            perror("mkdtemp");
+            abort();
+        }
+        rootDir = created;
+        atexit(removeRoot);
+    }
+    return rootDir.c_str();
+}
+
+static std::string hostPath(const char* path) {
+    std::string result = FakeFs::root();
+    if (path == nullptr || path[0] != '/') result += "/";
+    if (path) result += path;
+    return result;
+}
+
+void FakeFs::format() {
+    removeTree(root());
+    bytesWritten = 0;
+    restorePower();
+}
+
+void FakeFs::setWriteBudget(size_t bytes) {
+    budgetSet = true;
+    budgetLeft = bytes;
+    powerCut = false;
+}
+
+void FakeFs::restorePower() {
+    budgetSet = false;
+    powerCut = false;
+}
+
+bool FakeFs::isPowerCut() {
+    return powerCut;
+}
+
+size_t FakeFs::getBytesWritten() {
+    return bytesWritten;
+}
+
+std::string FakeFs::readFile(const char* path) {
+    std::string data;
+    FILE* file = fopen(hostPath(path).c_str(), "rb");
+    if (!file) return data;
+    char buffer[512];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, n);
+    }
+    fclose(file);
+    return data;
+}
+
+void FakeFs::writeFile(const char* path, const std::string& data) {
+    FILE* file = fopen(hostPath(path).c_str(), "wb");
+    if (!file) return;
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+namespace fs {
+
+File::operator bool() const {
+    return impl && (impl->file || impl->dir);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!impl || !impl->file || !impl->writable || powerCut) {
+        return 0;
+    }
+
+    size_t allowed = size;
+    if (budgetSet && allowed > budgetLeft) {
+        allowed = budgetLeft;
+        powerCut = true;
+    }
+
+    size_t n = fwrite(buffer, 1, allowed, impl->file);
+    fflush(impl->file);
+    bytesWritten += n;
+    if (budgetSet) budgetLeft -= n;
+    return n;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!impl || !impl->file) return 0;
+    return fread(buffer, 1, size, impl->file);
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+    if (!impl || !impl->file) return -1;
+    int c = fgetc(impl->file);
+    if (c != EOF) ungetc(c, impl->file);
+    return c == EOF ? -1 : c;
+}
+
+int File::available() {
+    if (!impl || !impl->file) return 0;
+    return (int)(size() - position());
+}
+
+bool File::seek(uint32_t pos) {
+    return impl && impl->file && fseek(impl->file, pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || !impl->file) return 0;
+    long pos = ftell(impl->file);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+    if (!impl || !impl->file) return 0;
+    struct stat st;
+    return fstat(fileno(impl->file), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    if (impl) impl->close();
+}
+
+const char* File::name() const {
+    return impl ? impl->name.c_str() : "";
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : "";
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl || !impl->dir) return File();
+    while (struct dirent* entry = readdir(impl->dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::string child = impl->path;
+        if (child.empty() || child.back() != '/') child += "/";
+        child += name;
+        return LittleFS.open(child.c_str(), mode);
+    }
+    return File();
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+    (void)create;
+    std::string host = hostPath(path);
+    std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    const char* slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+
+    struct stat st;
+    bool isDir = stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    if (mode[0] == 'r' && isDir) {
+        impl->dir = opendir(host.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+
+    if (mode[0] != 'r' && powerCut) {
+        return File();
+    }
+
+    const char* hostMode = mode[0] == 'w' ? "wb" : (mode[0] == 'a' ? "ab" : "rb");
+    impl->file = fopen(host.c_str(), hostMode);
+    impl->writable = mode[0] != 'r';
+    return impl->file ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    if (powerCut) return false;
+    return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    if (powerCut) return false;
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    if (powerCut) return false;
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || exists(path);
+}
+
+bool FS::rmdir(const char* path) {
+    if (powerCut) return false;
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+size_t LittleFSFS::usedBytes() {
+    size_t total = 0;
+    DIR* dir = opendir(FakeFs::root());
+    if (!dir) return 0;
+    while (struct dirent* entry = readdir(dir)) {
+        struct stat st;
+        std::string child = std::string(FakeFs::root()) + "/" + entry->d_name;
+        if (stat(child.c_str(), &st) == 0 && S_ISREG(st.st_mode)) total += st.st_size;
+    }
+    closedir(dir);
+    return total;
+}
+
+} // namespace fs
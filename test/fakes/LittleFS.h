@@ -0,0 +1,32 @@
+#ifndef FAKE_LITTLEFS_H
+#define FAKE_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+    LittleFSFS() : mounted(false) {}
+
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs") {
+        (void)formatOnFail; (void)basePath; (void)maxOpenFiles; (void)partitionLabel;
+        FakeFs::root();
+        mounted = true;
+        return true;
+    }
+    void end() { mounted = false; }
+    bool format() { FakeFs::format(); return true; }
+    size_t totalBytes() { return 1408 * 1024; }
+    size_t usedBytes();
+
+private:
+    bool mounted;
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // FAKE_LITTLEFS_H
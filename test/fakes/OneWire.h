@@ -0,0 +1,16 @@
+#ifndef FAKE_ONEWIRE_H
+#define FAKE_ONEWIRE_H
+
+#include <Arduino.h>
+
+// Magistrala OneWire bez sprzętu - czujniki symuluje DallasTemperature
+class OneWire {
+public:
+    explicit OneWire(uint8_t pin) : pin(pin) {}
+    uint8_t getPin() const { return pin; }
+
+private:
+    uint8_t pin;
+};
+
+#endif // FAKE_ONEWIRE_H
@@ -0,0 +1,101 @@
+#ifndef FAKE_PREFERENCES_H
+#define FAKE_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// NVS w pamięci: przestrzenie nazw przeżywają obiekt Preferences (jak po restarcie
+// urządzenia) do FakePreferences::clearAll().
+class Preferences {
+public:
+    typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+    Preferences() : space(nullptr), readOnly(false) {}
+
+    bool begin(const char* name, bool readOnly = false) {
+        space = &storage()[name];
+        this->readOnly = readOnly;
+        return true;
+    }
+    void end() { space = nullptr; }
+
+    bool clear() {
+        if (!writable()) return false;
+        space->clear();
+        return true;
+    }
+    bool remove(const char* key) { return writable() && space->erase(key) > 0; }
+    bool isKey(const char* key) const { return space && space->count(key) > 0; }
+
+    size_t putBytes(const char* key, const void* value, size_t length) {
+        if (!writable()) return 0;
+        const uint8_t* bytes = (const uint8_t*)value;
+        (*space)[key].assign(bytes, bytes + length);
+        return length;
+    }
+    size_t getBytes(const char* key, void* buffer, size_t maxLength) const {
+        const std::vector<uint8_t>* value = find(key);
+        if (!value || value->size() > maxLength) return 0;
+        memcpy(buffer, value->data(), value->size());
+        return value->size();
+    }
+    size_t getBytesLength(const char* key) const {
+        const std::vector<uint8_t>* value = find(key);
+        return value ? value->size() : 0;
+    }
+
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value) + 1); }
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+
+    uint8_t getUChar(const char* key, uint8_t fallback = 0) const { return get(key, fallback); }
+    uint16_t getUShort(const char* key, uint16_t fallback = 0) const { return get(key, fallback); }
+    int32_t getInt(const char* key, int32_t fallback = 0) const { return get(key, fallback); }
+    uint32_t getUInt(const char* key, uint32_t fallback = 0) const { return get(key, fallback); }
+    float getFloat(const char* key, float fallback = NAN) const { return get(key, fallback); }
+    bool getBool(const char* key, bool fallback = false) const { return get<uint8_t>(key, fallback ? 1 : 0) != 0; }
+    String getString(const char* key, const String& fallback = String()) const {
+        const std::vector<uint8_t>* value = find(key);
+        return value && !value->empty() ? String((const char*)value->data()) : fallback;
+    }
+
+    // Strona testu
+    static std::map<std::string, Namespace>& storage() {
+        static std::map<std::string, Namespace> spaces;
+        return spaces;
+    }
+
+private:
+    Namespace* space;
+    bool readOnly;
+
+    bool writable() const { return space != nullptr && !readOnly; }
+
+    const std::vector<uint8_t>* find(const char* key) const {
+        if (!space) return nullptr;
+        Namespace::const_iterator it = space->find(key);
+        return it == space->end() ? nullptr : &it->second;
+    }
+
+    template <typename T>
+    T get(const char* key, T fallback) const {
+        const std::vector<uint8_t>* value = find(key);
+        if (!value || value->size() != sizeof(T)) return fallback;
+        T result;
+        memcpy(&result, value->data(), sizeof(T));
+        return result;
+    }
+};
+
+namespace FakePreferences {
+    inline void clearAll() { Preferences::storage().clear(); }
+}
+
+#endif // FAKE_PREFERENCES_H
@@ -0,0 +1,169 @@
+#ifndef FAKE_U8G2LIB_H
+#define FAKE_U8G2LIB_H
+
+#include <Arduino.h>
+#include "FakeClock.h"
+
+// U8g2 z buforem w pamięci, układ jak SSD1306 128x64 w trybie pełnego bufora:
+// 8 wierszy kafli po 128 B, bajt = pionowa kolumna 8 pikseli (bit 0 u góry).
+// u8x8_DrawTile kopiuje kafle do pamięci "panelu", więc test może porównać
+// obraz na ekranie z buforem i policzyć wysłane bajty. Po setBusClock transmisja
+// zajmuje czas wirtualny (9 bitów na bajt, z narzutem adresu i komend pozycji) -
+// czekanie pętli albo zadania zapisu, zależnie od wątku.
+//
+// Czcionki to tylko rozmiar komórki (szerokość, wysokość); znak rysowany jest
+// wzorem zależnym od kodu - różne napisy dają różne piksele, ale to nie jest
+// prawdziwy krój.
+
+#define FAKE_U8G2_WIDTH 128
+#define FAKE_U8G2_HEIGHT 64
+#define FAKE_U8G2_BUFFER_SIZE (FAKE_U8G2_WIDTH * FAKE_U8G2_HEIGHT / 8)
+
+#define U8X8_PIN_NONE 255
+#define FAKE_U8G2_TILE_OVERHEAD 7   // Bajty adresu i komend kolumny/strony na wywołanie
+
+struct u8x8_t {
+    uint8_t panel[FAKE_U8G2_BUFFER_SIZE];   // Zawartość wyświetlacza
+    uint32_t tileWrites;                    // Wywołania u8x8_DrawTile
+    uint32_t bytesSent;
+    uint32_t busClockHz;                    // 0 - transmisja bez czasu
+};
+
+inline void u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t count, uint8_t* tiles) {
+    if (y >= FAKE_U8G2_HEIGHT / 8 || x >= FAKE_U8G2_WIDTH / 8) return;
+    count = min<uint8_t>(count, FAKE_U8G2_WIDTH / 8 - x);
+    memcpy(u8x8->panel + y * FAKE_U8G2_WIDTH + x * 8, tiles, count * 8);
+    u8x8->tileWrites++;
+    u8x8->bytesSent += count * 8;
+    if (u8x8->busClockHz > 0) {
+        FakeClock::advanceUs((uint64_t)(count * 8 + FAKE_U8G2_TILE_OVERHEAD) * 9 * 1000000 / u8x8->busClockHz);
+    }
+}
+
+typedef uint8_t u8g2_uint_t;
+
+struct FakeRotation {};
+static const FakeRotation U8G2_R0 = {};
+
+// Czcionki: [szerokość komórki, wysokość]
+inline constexpr uint8_t u8g2_font_5x7_tr[] = { 5, 7 };
+inline constexpr uint8_t u8g2_font_6x10_tf[] = { 6, 10 };
+inline constexpr uint8_t u8g2_font_7x13B_tr[] = { 7, 13 };
+inline constexpr uint8_t u8g2_font_logisoso16_tn[] = { 10, 16 };
+inline constexpr uint8_t u8g2_font_logisoso24_tn[] = { 14, 24 };
+
+class U8G2 {
+public:
+    U8G2() : drawColor(1), font(u8g2_font_6x10_tf), powerSave(false), contrast(255), buffersSent(0) {
+        memset(buffer, 0, sizeof(buffer));
+        memset(&u8x8, 0, sizeof(u8x8));
+        setMaxClipWindow();
+    }
+    virtual ~U8G2() {}
+
+    bool begin() { clearDisplay(); return true; }
+    void clearBuffer() { memset(buffer, 0, sizeof(buffer)); }
+    void sendBuffer() {
+        for (uint8_t row = 0; row < FAKE_U8G2_HEIGHT / 8; row++) {
+            u8x8_DrawTile(&u8x8, 0, row, FAKE_U8G2_WIDTH / 8, buffer + row * FAKE_U8G2_WIDTH);
+        }
+        buffersSent++;
+    }
+    void clearDisplay() { clearBuffer(); memset(u8x8.panel, 0, sizeof(u8x8.panel)); }
+    void setPowerSave(uint8_t enabled) { powerSave = enabled != 0; }
+    void setContrast(uint8_t value) { contrast = value; }
+    void setBusClock(uint32_t clock) { u8x8.busClockHz = clock; }
+
+    uint8_t* getBufferPtr() { return buffer; }
+    u8x8_t* getU8x8() { return &u8x8; }
+    u8g2_uint_t getDisplayWidth() const { return FAKE_U8G2_WIDTH; }
+    u8g2_uint_t getDisplayHeight() const { return FAKE_U8G2_HEIGHT; }
+
+    void setClipWindow(u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t x1, u8g2_uint_t y1) {
+        clipX0 = x0; clipY0 = y0; clipX1 = x1; clipY1 = y1;
+    }
+    void setMaxClipWindow() { setClipWindow(0, 0, FAKE_U8G2_WIDTH, FAKE_U8G2_HEIGHT); }
+
+    void setDrawColor(uint8_t color) { drawColor = color; }
+    void setFont(const uint8_t* f) { font = f; }
+    void setFontMode(uint8_t mode) { (void)mode; }
+    void setFontPosBaseline() {}
+
+    void drawPixel(int x, int y) {
+        if (x < clipX0 || x >= clipX1 || y < clipY0 || y >= clipY1) return;
+        if (x < 0 || x >= FAKE_U8G2_WIDTH || y < 0 || y >= FAKE_U8G2_HEIGHT) return;
+        uint8_t& cell = buffer[(y / 8) * FAKE_U8G2_WIDTH + x];
+        uint8_t bit = 1 << (y % 8);
+        if (drawColor == 0) cell &= ~bit;
+        else if (drawColor == 2) cell ^= bit;
+        else cell |= bit;
+    }
+    void drawBox(int x, int y, int w, int h) {
+        for (int yy = y; yy < y + h; yy++) {
+            for (int xx = x; xx < x + w; xx++) drawPixel(xx, yy);
+        }
+    }
+    void drawFrame(int x, int y, int w, int h) {
+        drawHLine(x, y, w);
+        drawHLine(x, y + h - 1, w);
+        drawVLine(x, y, h);
+        drawVLine(x + w - 1, y, h);
+    }
+    void drawHLine(int x, int y, int w) { drawBox(x, y, w, 1); }
+    void drawVLine(int x, int y, int h) { drawBox(x, y, 1, h); }
+    void drawLine(int x0, int y0, int x1, int y1) {
+        int steps = max(abs(x1 - x0), abs(y1 - y0));
+        for (int i = 0; i <= steps; i++) {
+            drawPixel(x0 + (steps ? (x1 - x0) * i / steps : 0), y0 + (steps ? (y1 - y0) * i / steps : 0));
+        }
+    }
+
+    // y to linia bazowa, jak w U8g2
+    u8g2_uint_t drawStr(int x, int y, const char* s) {
+        uint8_t w = font[0];
+        uint8_t h = font[1];
+        int startX = x;
+        for (; *s; s++, x += w) {
+            uint8_t c = (uint8_t)*s;
+            if (c == ' ') continue;
+            for (uint8_t col = 0; col + 1 < w; col++) {
+                uint32_t bits = (c * 2654435761UL) >> (col * 3);
+                for (uint8_t row = 0; row + 1 < h; row++) {
+                    if (bits & (1UL << (row % 24))) drawPixel(x + col, y - h + 1 + row);
+                }
+            }
+        }
+        return x - startX;
+    }
+    u8g2_uint_t drawUTF8(int x, int y, const char* s) { return drawStr(x, y, s); }
+    u8g2_uint_t getStrWidth(const char* s) const { return strlen(s) * font[0]; }
+    u8g2_uint_t getUTF8Width(const char* s) const { return getStrWidth(s); }
+    int8_t getAscent() const { return font[1]; }
+    int8_t getMaxCharHeight() const { return font[1]; }
+
+    // Strona testu
+    bool isPowerSave() const { return powerSave; }
+    uint8_t getContrast() const { return contrast; }
+    uint32_t getBuffersSent() const { return buffersSent; }
+    bool getPixel(int x, int y) const { return buffer[(y / 8) * FAKE_U8G2_WIDTH + x] & (1 << (y % 8)); }
+
+private:
+    uint8_t buffer[FAKE_U8G2_BUFFER_SIZE];
+    u8x8_t u8x8;
+    uint8_t drawColor;
+    const uint8_t* font;
+    int clipX0, clipY0, clipX1, clipY1;
+    bool powerSave;
+    uint8_t contrast;
+    uint32_t buffersSent;
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C(FakeRotation rotation, uint8_t reset = U8X8_PIN_NONE,
+                                        uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) {
+        (void)rotation; (void)reset; (void)clock; (void)data;
+    }
+};
+
+#endif // FAKE_U8G2LIB_H
@@ -0,0 +1,9 @@
+#ifndef FAKE_ROM_CRC_H
+#define FAKE_ROM_CRC_H
+
+#include <stdint.h>
+
+// CRC32 jak w ROM ESP32 (wielomian 0xEDB88320, wartość początkowa i wynik negowane)
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#endif // FAKE_ROM_CRC_H
@@ -0,0 +1,14 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <stdint.h>
+
+// Licznik alokacji dla programów benchmarku: AllocationCounter.cpp podmienia
+// globalny operator new, więc liczy wszystko, co idzie przez new (String,
+// kontenery std, new w modułach). malloc() z C nie jest liczony.
+namespace AllocationCounter {
+    uint64_t count();
+    uint64_t bytes();
+}
+
+#endif // ALLOCATION_COUNTER_H
@@ -0,0 +1,511 @@
+#include "HostSimulator.h"
+#include <LittleFS.h>
+#include <Preferences.h>
+#include "DebugLog.h"
+#include "FakeClock.h"
+#include "I2cBus.h"
+
+// LightManager wywołuje to po zmianie trybu - podświetlenie nie jest symulowane
+void applyBacklightSettings() {}
+
+HostSimulator* HostSimulator::active = nullptr;
+
+const ButtonGesture HostSimulator::GESTURES[] = {
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP,   GESTURE_CLICK,      0,    0, onAssistUp },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP,   GESTURE_LONG_PRESS, 1000, 0, onLights },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN, GESTURE_CLICK,      0,    0, onAssistDown },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET,  GESTURE_CLICK,      0,    0, onNextScreen }
+};
+const uint8_t HostSimulator::GESTURE_COUNT = sizeof(GESTURES) / sizeof(GESTURES[0]);
+
+static const uint8_t BUTTON_PINS[BUTTON_COUNT] = { SIM_BTN_UP, SIM_BTN_DOWN, SIM_BTN_SET };
+
+HostSimulator::HostSimulator() :
+    display(U8G2_R0),
+    renderer(display),
+    buttons(GESTURES, GESTURE_COUNT),
+    lights(SIM_FRONT_PIN, SIM_FRONT_DAY_PIN, SIM_REAR_PIN),
+    cadenceFilter(SIM_CADENCE_TIMEOUT_US),
+    rideComputer(controller, bms, odometer, energy, tripMetrics),
+    oneWireAir(SIM_TEMP_AIR_PIN),
+    oneWireController(SIM_TEMP_CONTROLLER_PIN),
+    sensorsAir(&oneWireAir),
+    sensorsController(&oneWireController),
+    temperatures(sensorsAir, sensorsController, SIM_TEMP_MOTOR_PIN),
+    ride({ 0.0f, 0, 0.0f, true }),
+    frameTimer(nullptr),
+    pedalTimer(nullptr),
+    bmsTimer(nullptr),
+    framesSent(0),
+    pulsesSent(0),
+    fullFrames(false),
+    asyncFlush(DISPLAY_ASYNC_FLUSH),
+    cadenceRpm(0),
+    assistLevel(1),
+    screen(0)
+{
+}
+
+HostSimulator::~HostSimulator() {
+    if (renderer.getFlushTask() != nullptr) {
+        vTaskDelete(renderer.getFlushTask());
+    }
+    if (frameTimer != nullptr) {
+        esp_timer_stop(frameTimer);
+        esp_timer_delete(frameTimer);
+    }
+    if (pedalTimer != nullptr) {
+        esp_timer_stop(pedalTimer);
+        esp_timer_delete(pedalTimer);
+    }
+    if (bmsTimer != nullptr) {
+        esp_timer_stop(bmsTimer);
+        esp_timer_delete(bmsTimer);
+    }
+    lights.shutdown();
+    detachInterrupt(SIM_CADENCE_PIN);
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+        detachInterrupt(BUTTON_PINS[i]);
+    }
+    if (active == this) {
+        active = nullptr;
+    }
+}
+
+void HostSimulator::begin() {
+    // Każdy symulator zaczyna od tego samego stanu "sprzętu"
+    FakeClock::reset();
+    FakeGpio::reset();
+    FakeFs::format();
+    FakePreferences::clearAll();
+    Serial.setCapture(false);
+    Serial2.clearOutput();
+    while (Serial2.available() > 0) Serial2.read();
+    FakeGpio::setMilliVolts(SIM_TEMP_MOTOR_PIN, 1650);
+
+    active = this;
+
+    DebugLog::begin(Serial);
+    I2cBus::begin();
+    display.begin();
+    display.setBusClock(SIM_I2C_CLOCK_HZ);
+
+    buttons.begin(BUTTON_PINS);
+    lights.begin(SIM_FRONT_PIN, SIM_FRONT_DAY_PIN, SIM_REAR_PIN, SIM_BRAKE_PIN);
+    lights.setMode(LightManager::DAY);
+    temperatures.begin();
+    odometer.begin();
+
+    pinMode(SIM_CADENCE_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(SIM_CADENCE_PIN), cadenceIsr, FALLING);
+
+    renderer.addWidget("top",    {0, 0, 128, 12},  topBarSignature, drawTopBar);
+    renderer.addWidget("assist", {0, 13, 56, 31},  assistSignature, drawAssist);
+    renderer.addWidget("light",  {25, 36, 33, 12}, lightSignature,  drawLight);
+    renderer.addWidget("speed",  {69, 13, 59, 35}, speedSignature,  drawSpeed);
+    renderer.addWidget("main",   {0, 49, 128, 15}, mainSignature,   drawMain);
+    renderer.setStaticLayer(drawStaticLines);
+    renderer.setMaxFps(SIM_DISPLAY_MAX_FPS);
+    if (asyncFlush) {
+        renderer.startFlushTask(SIM_DISPLAY_FLUSH_CORE, SIM_DISPLAY_FLUSH_PRIORITY);
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = frameTimerCallback;
+    args.arg = this;
+    args.name = "simKt";
+    esp_timer_create(&args, &frameTimer);
+    esp_timer_start_periodic(frameTimer, SIM_KT_FRAME_PERIOD_MS * 1000UL);
+
+    args.callback = pedalTimerCallback;
+    args.name = "simPedal";
+    esp_timer_create(&args, &pedalTimer);
+
+    args.callback = bmsTimerCallback;
+    args.name = "simBms";
+    esp_timer_create(&args, &bmsTimer);
+    esp_timer_start_periodic(bmsTimer, SIM_BMS_PERIOD_MS * 1000UL);
+
+    // Tabela zadań jak setupScheduler() w main.ino
+    scheduler.addTask("controller", 5,     TaskScheduler::PRIORITY_HIGH,   controllerTask);
+    scheduler.addTask("buttons",    5,     TaskScheduler::PRIORITY_HIGH,   buttonTask);
+    scheduler.addTask("brake",      10,    TaskScheduler::PRIORITY_HIGH,   brakeTask);
+    scheduler.addTask("cadence",    100,   TaskScheduler::PRIORITY_HIGH,   cadenceTask);
+    scheduler.addTask("lights",     50,    TaskScheduler::PRIORITY_NORMAL, lightTask);
+    scheduler.addTask("display",    10,    TaskScheduler::PRIORITY_NORMAL, displayTask);
+    scheduler.addTask("snapshot",   SNAPSHOT_PERIOD_MS, TaskScheduler::PRIORITY_NORMAL, snapshotTask);
+    scheduler.addTask("sensors",    100,   TaskScheduler::PRIORITY_LOW,    sensorTask);
+    scheduler.addTask("data",       2000,  TaskScheduler::PRIORITY_LOW,    dataTask);
+    scheduler.addTask("autoOff",    5000,  TaskScheduler::PRIORITY_LOW,    autoOffTask);
+    scheduler.addTask("debug",      10000, TaskScheduler::PRIORITY_LOW,    debugTask);
+    scheduler.addTask("autoSave",   60000, TaskScheduler::PRIORITY_LOW,    autoSaveTask);
+    scheduler.resetStats();
+
+    DebugLog::flush();
+    DebugLog::setDeferred(true);
+}
+
+void HostSimulator::loop() {
+    loopMonitor.tick();
+    uint32_t untilNextUs = scheduler.run();
+
+    // Na ESP32 iteracja trwa, a pętla bez bezczynności kręci się aż do terminu;
+    // tu czas płynie tylko jawnie, więc przeskakujemy od razu do terminu
+    FakeClock::advanceUs(SIM_LOOP_COST_US);
+    if (untilNextUs < 1000) {
+        FakeClock::advanceUs(untilNextUs > SIM_LOOP_COST_US ? untilNextUs - SIM_LOOP_COST_US : 0);
+    } else {
+        scheduler.idle(untilNextUs);
+    }
+}
+
+uint32_t HostSimulator::runFor(uint32_t ms) {
+    uint64_t endUs = FakeClock::nowUs() + (uint64_t)ms * 1000;
+    uint32_t iterations = 0;
+    while (FakeClock::nowUs() < endUs) {
+        loop();
+        iterations++;
+    }
+    return iterations;
+}
+
+void HostSimulator::setRide(const SimRide& next) {
+    bool wasPedalling = ride.cadenceRpm > 0;
+    ride = next;
+    if (ride.cadenceRpm > 0 && !wasPedalling) {
+        schedulePedal();
+    }
+}
+
+void HostSimulator::setButton(ButtonId id, bool pressed) {
+    FakeGpio::setLevel(BUTTON_PINS[id], pressed ? LOW : HIGH);
+}
+
+void HostSimulator::click(ButtonId id) {
+    setButton(id, true);
+    runFor(80);
+    setButton(id, false);
+    runFor(400);
+}
+
+void HostSimulator::hold(ButtonId id, uint32_t ms) {
+    setButton(id, true);
+    runFor(ms);
+    setButton(id, false);
+    runFor(100);
+}
+
+// ---------------------------------------------------------------- otoczenie
+
+void HostSimulator::sendFrame() {
+    if (!ride.controllerLink) {
+        return;
+    }
+
+    uint16_t periodMs = KT_WHEEL_PERIOD_STOPPED;
+    if (ride.speedKmh > 0.5f) {
+        periodMs = (uint16_t)(SIM_WHEEL_CIRCUMFERENCE * 3600.0f / ride.speedKmh);
+    }
+
+    uint8_t frame[KT_FRAME_SIZE] = {0};
+    frame[0] = KT_FRAME_HEADER;
+    frame[1] = 12;                        // Poziom baterii wg sterownika
+    frame[3] = periodMs >> 8;
+    frame[4] = periodMs & 0xFF;
+    frame[7] = ride.currentA > 0 ? KT_MODE_ASSIST : 0;
+    frame[8] = (uint8_t)(ride.currentA / KT_CURRENT_STEP_A);
+    uint8_t crc = 0;
+    for (uint8_t i = 1; i < KT_FRAME_SIZE; i++) {
+        if (i != KT_CHECKSUM_INDEX) crc ^= frame[i];
+    }
+    frame[KT_CHECKSUM_INDEX] = crc;
+
+    Serial2.inject(frame, sizeof(frame));
+    framesSent++;
+}
+
+// Odpowiedź 0x03 (podstawowe dane) jak z powiadomienia BLE; prąd JBD ujemny przy rozładowaniu
+void HostSimulator::sendBmsFrame() {
+    uint16_t centiVolts = (uint16_t)lroundf(SIM_BMS_VOLTAGE * 100.0f);
+    int16_t centiAmps = (int16_t)lroundf(-ride.currentA * 100.0f);
+
+    uint8_t data[27] = {0};
+    data[0] = centiVolts >> 8;
+    data[1] = centiVolts & 0xFF;
+    data[2] = (uint16_t)centiAmps >> 8;
+    data[3] = (uint16_t)centiAmps & 0xFF;
+    data[4] = 1000 >> 8;                  // Pozostało 10.00 Ah
+    data[5] = 1000 & 0xFF;
+    data[6] = 2000 >> 8;                  // Pojemność 20.00 Ah
+    data[7] = 2000 & 0xFF;
+    data[19] = 50;                        // SOC [%]
+    data[20] = 0x03;                      // MOSFET ładowania i rozładowania
+    data[21] = 13;                        // Liczba cel
+    data[22] = 0;                         // Bez czujników temperatury
+
+    uint8_t frame[4 + 23 + 3];
+    frame[0] = JBD_FRAME_START;
+    frame[1] = JBD_CMD_BASIC_INFO;
+    frame[2] = 0;                         // Status OK
+    frame[3] = 23;
+    uint16_t sum = frame[2] + frame[3];
+    for (uint8_t i = 0; i < 23; i++) {
+        frame[4 + i] = data[i];
+        sum += data[i];
+    }
+    uint16_t checksum = (uint16_t)(0x10000 - sum);
+    frame[27] = checksum >> 8;
+    frame[28] = checksum & 0xFF;
+    frame[29] = JBD_FRAME_END;
+
+    bms.feed(frame, sizeof(frame));
+}
+
+void HostSimulator::schedulePedal() {
+    if (ride.cadenceRpm == 0 || pedalTimer == nullptr) {
+        return;
+    }
+    esp_timer_stop(pedalTimer);
+    esp_timer_start_once(pedalTimer, 60000000UL / ride.cadenceRpm);
+}
+
+void HostSimulator::frameTimerCallback(void* arg) {
+    static_cast<HostSimulator*>(arg)->sendFrame();
+}
+
+void HostSimulator::bmsTimerCallback(void* arg) {
+    static_cast<HostSimulator*>(arg)->sendBmsFrame();
+}
+
+void HostSimulator::pedalTimerCallback(void* arg) {
+    HostSimulator* self = static_cast<HostSimulator*>(arg);
+    // Magnes mija czujnik: zbocze opadające i powrót
+    FakeGpio::setLevel(SIM_CADENCE_PIN, LOW);
+    FakeGpio::setLevel(SIM_CADENCE_PIN, HIGH);
+    self->pulsesSent++;
+    self->schedulePedal();
+}
+
+void IRAM_ATTR HostSimulator::cadenceIsr() {
+    active->cadencePulses.push(micros());
+}
+
+// ---------------------------------------------------------------- zadania rdzenia 1
+
+void HostSimulator::controllerTask() {
+    active->rideComputer.update(Serial2, SIM_WHEEL_CIRCUMFERENCE);
+}
+
+void HostSimulator::buttonTask() {
+    active->buttons.setContext(BUTTON_CONTEXT_NORMAL);
+    active->buttons.takeActivity();
+    active->buttons.dispatch();
+}
+
+void HostSimulator::brakeTask() {
+    // Hamulec obsługuje timer LightManager; tu tylko odczyt pinu jak updateCadenceLogic()
+    (void)digitalRead(SIM_BRAKE_PIN);
+}
+
+void HostSimulator::cadenceTask() {
+    HostSimulator& sim = *active;
+    uint32_t stamp;
+    while (sim.cadencePulses.pop(stamp)) {
+        sim.cadenceFilter.addPulse(stamp);
+    }
+
+    sim.cadenceFilter.update(micros());
+    sim.cadenceRpm = sim.cadenceFilter.getRpm();
+
+    if (sim.cadenceFilter.isActive()) {
+        sim.tripMetrics.add(TRIP_CADENCE, sim.cadenceFilter.getSmoothedMilliRpm() / 1000.0f, millis());
+    } else {
+        sim.tripMetrics.pause(TRIP_CADENCE);
+    }
+}
+
+void HostSimulator::lightTask() {
+    // Wzory i miganie odtwarza timer LightManager - zadanie tylko wykrywa zmianę trybu
+    static LightManager::LightMode lastMode = LightManager::OFF;
+    if (active->lights.getMode() != lastMode) {
+        lastMode = active->lights.getMode();
+        applyBacklightSettings();
+    }
+}
+
+void HostSimulator::displayTask() {
+    if (active->fullFrames) {
+        active->renderer.invalidate();
+    }
+    active->renderer.render();
+}
+
+void HostSimulator::snapshotTask() {
+    HostSimulator& sim = *active;
+    RideSnapshot snapshot = {};
+    snapshot.stampMs = millis();
+    snapshot.speedKmh = sim.rideComputer.getSpeedKmh();
+    snapshot.distanceKm = sim.rideComputer.getDistanceKm();
+    snapshot.batteryVoltage = sim.rideComputer.getBatteryVoltage();
+    snapshot.batteryCurrent = sim.rideComputer.getBatteryCurrent();
+    snapshot.tempAir = sim.temperatures.get(TEMP_CHANNEL_AIR);
+    snapshot.tempController = sim.temperatures.get(TEMP_CHANNEL_CONTROLLER);
+    snapshot.tempMotor = sim.temperatures.get(TEMP_CHANNEL_MOTOR);
+    snapshot.odometerMeters = sim.odometer.getTotalMeters();
+    snapshot.cadenceRpm = sim.cadenceRpm;
+    snapshot.powerW = sim.rideComputer.getPowerW();
+    snapshot.assistLevel = sim.assistLevel;
+    snapshot.lightMode = sim.lights.getMode();
+    snapshot.lightDayConfig = sim.lights.getDayConfig();
+    snapshot.lightNightConfig = sim.lights.getNightConfig();
+    sim.rideSnapshot.write(snapshot);
+}
+
+void HostSimulator::sensorTask() {
+    active->temperatures.update();
+}
+
+void HostSimulator::dataTask() {
+    // Zasięg z pozostałej energii jak dataUpdateTask()
+    BmsData bmsData;
+    if (active->bms.read(bmsData)) {
+        (void)active->energy.estimateRangeKm(bmsData.remainingCapacity * bmsData.voltage);
+    }
+}
+
+void HostSimulator::autoOffTask() {
+    // Auto-wyłączenie usypia ESP32 - w symulatorze jazda trwa
+}
+
+void HostSimulator::debugTask() {
+    DEBUG_INFO("Symulator: %u ramek, %u impulsow, dystans %.3f km",
+        active->controller.getTelemetry().frameCount, active->pulsesSent, active->rideComputer.getDistanceKm());
+}
+
+void HostSimulator::autoSaveTask() {
+    active->odometer.update();
+}
+
+// ---------------------------------------------------------------- gesty
+
+void HostSimulator::onAssistUp() {
+    if (active->assistLevel < 5) active->assistLevel++;
+}
+
+void HostSimulator::onAssistDown() {
+    if (active->assistLevel > 0) active->assistLevel--;
+}
+
+void HostSimulator::onLights() {
+    active->lights.cycleMode();
+}
+
+void HostSimulator::onNextScreen() {
+    active->screen = (active->screen + 1) % 3;
+}
+
+// ---------------------------------------------------------------- widżety
+
+uint32_t HostSimulator::topBarSignature() {
+    unsigned long minutes = millis() / 60000;
+    return DisplayRenderer::Signature()
+        .add(minutes)
+        .add((millis() / 500) & 1)
+        .add((uint32_t)lroundf(active->rideComputer.getBatteryVoltage()))
+        .value();
+}
+
+void HostSimulator::drawTopBar() {
+    U8G2& display = active->display;
+    unsigned long minutes = millis() / 60000;
+    char timeStr[6];
+    snprintf(timeStr, sizeof(timeStr), ((millis() / 500) & 1) ? "%02lu:%02lu" : "%02lu %02lu",
+             (minutes / 60) % 24, minutes % 60);
+    display.setFont(u8g2_font_6x10_tf);
+    display.drawStr(0, 10, timeStr);
+
+    char voltStr[6];
+    snprintf(voltStr, sizeof(voltStr), "%.0fV", active->rideComputer.getBatteryVoltage());
+    display.drawStr(100, 10, voltStr);
+}
+
+uint32_t HostSimulator::speedSignature() {
+    return DisplayRenderer::Signature().add((uint32_t)lroundf(active->rideComputer.getSpeedKmh() * 10.0f)).value();
+}
+
+void HostSimulator::drawSpeed() {
+    U8G2& display = active->display;
+    char speedStr[10];
+    snprintf(speedStr, sizeof(speedStr), active->rideComputer.getSpeedKmh() < 10.0f ? "  %2.1f" : "%2.1f", active->rideComputer.getSpeedKmh());
+    display.setFont(u8g2_font_logisoso16_tn);
+    display.drawStr(72, 35, speedStr);
+    display.setFont(u8g2_font_5x7_tr);
+    display.drawStr(105, 45, "km/h");
+}
+
+uint32_t HostSimulator::assistSignature() {
+    return DisplayRenderer::Signature().add(active->assistLevel).add(active->cadenceRpm).value();
+}
+
+void HostSimulator::drawAssist() {
+    U8G2& display = active->display;
+    char assistStr[4];
+    snprintf(assistStr, sizeof(assistStr), "%u", active->assistLevel);
+    display.setFont(u8g2_font_logisoso24_tn);
+    display.drawStr(2, 40, assistStr);
+
+    char cadenceStr[8];
+    snprintf(cadenceStr, sizeof(cadenceStr), "%u", active->cadenceRpm);
+    display.setFont(u8g2_font_5x7_tr);
+    display.drawStr(25, 22, cadenceStr);
+}
+
+uint32_t HostSimulator::lightSignature() {
+    return DisplayRenderer::Signature().add(active->lights.getMode()).value();
+}
+
+void HostSimulator::drawLight() {
+    active->display.setFont(u8g2_font_5x7_tr);
+    active->display.drawStr(28, 45, active->lights.getModeName());
+}
+
+void HostSimulator::formatMain(char* value, size_t size, const char*& unit) {
+    switch (active->screen) {
+        case 0:
+            snprintf(value, size, "%.1f", active->rideComputer.getDistanceKm());
+            unit = "km";
+            break;
+        case 1:
+            snprintf(value, size, "%d", active->rideComputer.getPowerW());
+            unit = "W";
+            break;
+        default:
+            snprintf(value, size, "%.1f", active->odometer.getTotalMeters() / 1000.0f);
+            unit = "ODO";
+            break;
+    }
+}
+
+uint32_t HostSimulator::mainSignature() {
+    char value[16];
+    const char* unit;
+    formatMain(value, sizeof(value), unit);
+    return DisplayRenderer::Signature().add(active->screen).add(value).add(unit).value();
+}
+
+void HostSimulator::drawMain() {
+    U8G2& display = active->display;
+    char value[16];
+    const char* unit;
+    formatMain(value, sizeof(value), unit);
+    display.setFont(u8g2_font_7x13B_tr);
+    display.drawStr(2, 62, value);
+    display.setFont(u8g2_font_5x7_tr);
+    display.drawStr(100, 62, unit);
+}
+
+void HostSimulator::drawStaticLines() {
+    active->display.drawHLine(0, 12, 128);
+    active->display.drawHLine(0, 48, 128);
+    active->display.drawVLine(68, 12, 36);
+}
@@ -0,0 +1,206 @@
+#ifndef HOST_SIMULATOR_H
+#define HOST_SIMULATOR_H
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include <esp_timer.h>
+#include "ButtonManager.h"
+#include "CoreSnapshots.h"
+#include "DisplayRenderer.h"
+#include "EnergyEstimator.h"
+#include "JbdBms.h"
+#include "KtController.h"
+#include "LightManager.h"
+#include "LoopMonitor.h"
+#include "OdometerManager.h"
+#include "PulseRateFilter.h"
+#include "RideComputer.h"
+#include "Seqlock.h"
+#include "SpscRing.h"
+#include "TaskScheduler.h"
+#include "TemperatureManager.h"
+#include "TripMetrics.h"
+
+// Symulator rdzenia 1 na PC: te same moduły i ta sama tabela zadań co
+// setupScheduler() w main.ino, ale bez BLE, WiFi, serwera WWW i RTC (rdzeń 0).
+// main.ino nie kompiluje się poza ESP32, więc zadania pętli są tu odwzorowane
+// w skróconej postaci; obliczenia (RideComputer, PulseRateFilter, EnergyEstimator)
+// to te same moduły co w firmware - zadania tylko je wywołują.
+//
+// Otoczenie (sterownik KT, czujnik kadencji, przyciski) działa na timerach
+// esp_timer wirtualnego zegara: ramki trafiają do Serial2, impulsy kadencji
+// do przerwania na pinie, przyciski zmieniają poziom pinów. Odpowiedzi BMS
+// trafiają wprost do JbdBms (zadanie BLE rdzenia 0 nie jest symulowane).
+
+// Piny jak w main.ino
+#define SIM_BTN_UP 13
+#define SIM_BTN_DOWN 14
+#define SIM_BTN_SET 12
+#define SIM_FRONT_DAY_PIN 18
+#define SIM_FRONT_PIN 19
+#define SIM_REAR_PIN 23
+#define SIM_TEMP_AIR_PIN 15
+#define SIM_TEMP_CONTROLLER_PIN 4
+#define SIM_TEMP_MOTOR_PIN 34
+#define SIM_CADENCE_PIN 27
+#define SIM_BRAKE_PIN 26
+
+#define SIM_KT_FRAME_PERIOD_MS 100     // Sterownik KT nadaje ramkę co ~100 ms
+#define SIM_BMS_PERIOD_MS 1000         // Odpowiedź 0x03 z BMS co sekundę
+#define SIM_LOOP_COST_US 20            // Czas wirtualny jednej iteracji loop() bez bezczynności
+#define SIM_WHEEL_CIRCUMFERENCE 2.136f // 700C [m]
+#define SIM_BMS_VOLTAGE 48.0f          // Napięcie baterii w odpowiedziach BMS
+#define SIM_CADENCE_RING_SIZE 64
+#define SIM_CADENCE_TIMEOUT_US 2000000UL
+#define SIM_DISPLAY_MAX_FPS 20
+#define SIM_I2C_CLOCK_HZ 400000        // Domyślny zegar U8g2 dla SSD1306
+#define SIM_DISPLAY_FLUSH_CORE 1       // Jak DISPLAY_FLUSH_CORE/PRIORITY w main.ino
+#define SIM_DISPLAY_FLUSH_PRIORITY 2
+
+// Rowerzysta i sterownik widziane z zewnątrz
+struct SimRide {
+    float speedKmh;
+    uint16_t cadenceRpm;     // 0 - bez pedałowania
+    float currentA;          // Prąd baterii w ramkach KT
+    bool controllerLink;     // false - sterownik przestaje nadawać
+};
+
+class HostSimulator {
+public:
+    HostSimulator();
+    ~HostSimulator();
+
+    // Zapis OLED w zadaniu (domyślnie jak DISPLAY_ASYNC_FLUSH) - przed begin()
+    void setAsyncFlush(bool enabled) { asyncFlush = enabled; }
+
+    // Odpowiednik setup(): czysty zegar, pusty LittleFS, moduły i harmonogram
+    void begin();
+
+    // Jedna iteracja loop(); czas wirtualny przesuwa się do kolejnego terminu
+    void loop();
+    // Iteracje loop() aż upłynie podany czas wirtualny; zwraca liczbę iteracji
+    uint32_t runFor(uint32_t ms);
+
+    void setRide(const SimRide& ride);
+    void setButton(ButtonId id, bool pressed);
+    void click(ButtonId id);                  // Naciśnięcie 80 ms i odczekanie okna dwukliku
+    void hold(ButtonId id, uint32_t ms);
+
+    // Porównanie z wysyłaniem całego bufora: każda klatka jako pełna (wszystkie kafle)
+    void setFullFrames(bool enabled) { fullFrames = enabled; }
+
+    // Stan pętli głównej
+    float getSpeedKmh() const { return rideComputer.getSpeedKmh(); }
+    float getDistanceKm() const { return rideComputer.getDistanceKm(); }
+    int getPowerW() const { return rideComputer.getPowerW(); }
+    float getBatteryCurrent() const { return rideComputer.getBatteryCurrent(); }
+    uint16_t getCadenceRpm() const { return cadenceRpm; }
+    uint8_t getAssistLevel() const { return assistLevel; }
+    uint32_t getFramesSent() const { return framesSent; }
+    uint32_t getPulsesSent() const { return pulsesSent; }
+    bool readRideSnapshot(RideSnapshot& out) const { return rideSnapshot.read(out); }
+
+    TaskScheduler& getScheduler() { return scheduler; }
+    LoopMonitor& getLoopMonitor() { return loopMonitor; }
+    DisplayRenderer& getRenderer() { return renderer; }
+    U8G2& getDisplay() { return display; }
+    LightManager& getLights() { return lights; }
+    ButtonManager& getButtons() { return buttons; }
+    KtController& getController() { return controller; }
+    RideComputer& getRideComputer() { return rideComputer; }
+    PulseRateFilter& getCadenceFilter() { return cadenceFilter; }
+    OdometerManager& getOdometer() { return odometer; }
+    EnergyEstimator& getEnergy() { return energy; }
+    TripMetrics& getTripMetrics() { return tripMetrics; }
+    TemperatureManager& getTemperatures() { return temperatures; }
+
+private:
+    // Zadania harmonogramu, gesty i widżety to zwykłe wskaźniki funkcji -
+    // przekazują wywołanie do bieżącego symulatora
+    static HostSimulator* active;
+    static const ButtonGesture GESTURES[];
+    static const uint8_t GESTURE_COUNT;
+
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C display;
+    DisplayRenderer renderer;
+    TaskScheduler scheduler;
+    LoopMonitor loopMonitor;
+    ButtonManager buttons;
+    LightManager lights;
+    KtController controller;
+    JbdBms bms;
+    PulseRateFilter cadenceFilter;
+    SpscRing<uint32_t, SIM_CADENCE_RING_SIZE> cadencePulses;
+    OdometerManager odometer;
+    EnergyEstimator energy;
+    TripMetrics tripMetrics;
+    RideComputer rideComputer;
+    OneWire oneWireAir;
+    OneWire oneWireController;
+    DallasTemperature sensorsAir;
+    DallasTemperature sensorsController;
+    TemperatureManager temperatures;
+    Seqlock<RideSnapshot> rideSnapshot;
+
+    // Otoczenie
+    SimRide ride;
+    esp_timer_handle_t frameTimer;
+    esp_timer_handle_t pedalTimer;
+    esp_timer_handle_t bmsTimer;
+    uint32_t framesSent;
+    uint32_t pulsesSent;
+    bool fullFrames;
+    bool asyncFlush;
+
+    // Stan pętli jak zmienne globalne main.ino
+    uint16_t cadenceRpm;
+    uint8_t assistLevel;
+    uint8_t screen;
+
+    void sendFrame();
+    void sendBmsFrame();
+    void schedulePedal();
+
+    static void frameTimerCallback(void* arg);
+    static void pedalTimerCallback(void* arg);
+    static void bmsTimerCallback(void* arg);
+    static void IRAM_ATTR cadenceIsr();
+
+    // Zadania rdzenia 1
+    static void controllerTask();
+    static void buttonTask();
+    static void brakeTask();
+    static void cadenceTask();
+    static void lightTask();
+    static void displayTask();
+    static void snapshotTask();
+    static void sensorTask();
+    static void dataTask();
+    static void autoOffTask();
+    static void debugTask();
+    static void autoSaveTask();
+
+    // Gesty
+    static void onAssistUp();
+    static void onAssistDown();
+    static void onLights();
+    static void onNextScreen();
+
+    // Widżety
+    static uint32_t topBarSignature();
+    static void drawTopBar();
+    static uint32_t speedSignature();
+    static void drawSpeed();
+    static uint32_t assistSignature();
+    static void drawAssist();
+    static uint32_t lightSignature();
+    static void drawLight();
+    static uint32_t mainSignature();
+    static void drawMain();
+    static void drawStaticLines();
+    static void formatMain(char* value, size_t size, const char*& unit);
+};
+
+#endif // HOST_SIMULATOR_H
@@ -0,0 +1,166 @@
+// Benchmark pętli głównej na PC: symulator rdzenia 1 na wirtualnym zegarze,
+// przejazd według stałego scenariusza (przyspieszanie, jazda, postój, przyciski).
+//
+// Wynik:
+//   - iteracje loop() na sekundę czasu PC,
+//   - percentyle czasu jednej iteracji na PC (razem z timerami, które wypadły
+//     w czasie bezczynności - na ESP32 to osobne zadania, ale to też koszt pętli),
+//   - alokacje na stercie na iterację (operator new w całym procesie - String,
+//     kontenery std; malloc() z C nie jest liczony),
+//   - raport LoopMonitor w czasie wirtualnym (jak "loop" w /api/perf),
+//   - bajty obrazu OLED wysłane przez I2C na sekundę czasu wirtualnego i czas,
+//     na który klatka zatrzymuje pętlę (stall) - z zapisem w zadaniu i bez.
+//
+// Użycie:
+//   loop_benchmark                      # 200000 iteracji
+//   loop_benchmark --iterations 50000 --warmup 5000
+//   loop_benchmark --full-frames        # każda klatka pełna - porównanie z brudnymi kaflami
+//   loop_benchmark --async-flush 0      # zapis OLED w pętli (jak DISPLAY_ASYNC_FLUSH 0)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "AllocationCounter.h"
+#include "HostSimulator.h"
+#include "FakeClock.h"
+
+// ---------------------------------------------------------------- scenariusz
+
+#define SCENARIO_PERIOD_MS 60000UL
+
+// Minuta jazdy powtarzana w kółko: rozpędzanie, jazda z pedałowaniem, zjazd
+// bez pedałowania, hamowanie i postój. Przyciski co kilkanaście sekund.
+static void applyScenario(HostSimulator& sim, uint32_t nowMs) {
+    uint32_t t = nowMs % SCENARIO_PERIOD_MS;
+    SimRide ride = { 0.0f, 0, 0.0f, true };
+
+    if (t < 10000) {
+        ride.speedKmh = 2.5f * t / 1000.0f;
+        ride.cadenceRpm = 50 + t / 500;
+        ride.currentA = 12.0f;
+    } else if (t < 35000) {
+        ride.speedKmh = 25.0f + ((t / 1000) % 5);
+        ride.cadenceRpm = 80 + (t / 1000) % 10;
+        ride.currentA = 8.0f;
+    } else if (t < 45000) {
+        ride.speedKmh = 30.0f;
+    } else if (t < 50000) {
+        ride.speedKmh = 30.0f * (50000 - t) / 5000.0f;
+    }
+    sim.setRide(ride);
+
+    // Krótkie naciśnięcia: UP (wspomaganie), SET (ekran), DOWN (wspomaganie)
+    static const struct { uint32_t atMs; ButtonId button; } PRESSES[] = {
+        { 12000, BUTTON_UP }, { 20000, BUTTON_SET }, { 28000, BUTTON_DOWN }, { 52000, BUTTON_SET }
+    };
+    for (const auto& press : PRESSES) {
+        if (t >= press.atMs && t < press.atMs + 80) {
+            sim.setButton(press.button, true);
+        } else if (t >= press.atMs + 80 && t < press.atMs + 200) {
+            sim.setButton(press.button, false);
+        }
+    }
+}
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, uint8_t pct) {
+    if (sorted.empty()) return 0;
+    size_t index = (sorted.size() * pct + 99) / 100;
+    return sorted[std::min(index, sorted.size()) - 1];
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 200000;
+    uint32_t warmup = 10000;
+    bool fullFrames = false;
+    bool asyncFlush = DISPLAY_ASYNC_FLUSH;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--full-frames") == 0) {
+            fullFrames = true;
+        } else if (strcmp(argv[i], "--async-flush") == 0 && i + 1 < argc) {
+            asyncFlush = atoi(argv[++i]) != 0;
+        } else {
+            fprintf(stderr, "Uzycie: %s [--iterations N] [--warmup N] [--full-frames] [--async-flush 0|1]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (iterations == 0) {
+        fprintf(stderr, "Liczba iteracji musi byc dodatnia\n");
+        return 2;
+    }
+
+    HostSimulator sim;
+    sim.setAsyncFlush(asyncFlush);
+    sim.begin();
+    sim.setFullFrames(fullFrames);
+
+    // Rozgrzewka: pełne bufory, pierwsze zapisy licznika, statystyki od zera
+    for (uint32_t i = 0; i < warmup; i++) {
+        applyScenario(sim, millis());
+        sim.loop();
+    }
+    sim.getLoopMonitor().collect();
+    sim.getScheduler().resetStats();
+    sim.getRenderer().collectStats();
+
+    std::vector<uint32_t> latencyNs(iterations);
+    uint64_t startVirtualUs = FakeClock::nowUs();
+    uint64_t startAllocations = AllocationCounter::count();
+    uint64_t startBytes = AllocationCounter::bytes();
+    uint32_t startI2cBytes = sim.getDisplay().getU8x8()->bytesSent;
+    uint32_t startTileWrites = sim.getDisplay().getU8x8()->tileWrites;
+    auto startHost = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        applyScenario(sim, millis());
+        sim.loop();
+        auto end = std::chrono::steady_clock::now();
+        latencyNs[i] = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+
+    auto endHost = std::chrono::steady_clock::now();
+    uint64_t allocations = AllocationCounter::count() - startAllocations;
+    uint64_t bytes = AllocationCounter::bytes() - startBytes;
+    double hostSeconds = std::chrono::duration<double>(endHost - startHost).count();
+    double virtualSeconds = (FakeClock::nowUs() - startVirtualUs) / 1e6;
+    LoopMonitor::Report loop = sim.getLoopMonitor().collect();
+    DisplayRenderer::Stats display = sim.getRenderer().collectStats();
+    uint32_t i2cBytes = sim.getDisplay().getU8x8()->bytesSent - startI2cBytes;
+    uint32_t tileWrites = sim.getDisplay().getU8x8()->tileWrites - startTileWrites;
+
+    std::sort(latencyNs.begin(), latencyNs.end());
+
+    printf("Benchmark petli glownej (symulator rdzenia 1)\n");
+    printf("  iteracje:           %u (rozgrzewka %u)\n", iterations, warmup);
+    printf("  czas wirtualny:     %.1f s, czas PC: %.3f s\n", virtualSeconds, hostSeconds);
+    printf("  iteracje/s (PC):    %.0f\n", iterations / hostSeconds);
+    printf("  iteracja [ns]:      p50 %u  p95 %u  p99 %u  max %u\n",
+           percentile(latencyNs, 50), percentile(latencyNs, 95), percentile(latencyNs, 99), latencyNs.back());
+    printf("  alokacje/iteracje:  %.4f (%.2f B/iteracje, razem %llu)\n",
+           (double)allocations / iterations, (double)bytes / iterations, (unsigned long long)allocations);
+    printf("  LoopMonitor (czas wirtualny): %u it/s, p50 %u us, p95 %u us, p99 %u us\n",
+           loop.iterationsPerSec, loop.p50Us, loop.p95Us, loop.p99Us);
+    printf("  ramki KT: %u, impulsy kadencji: %u, dystans %.2f km\n",
+           sim.getController().getTelemetry().frameCount, sim.getPulsesSent(), sim.getDistanceKm());
+    printf("  OLED I2C (%s): %.0f B/s, %u zapisow kafli, %u B razem\n",
+           fullFrames ? "pelne klatki" : "brudne kafle", i2cBytes / virtualSeconds, tileWrites, i2cBytes);
+    printf("  OLED %s: stall petli sr. %u us, max %u us; I2C sr. %u us, max %u us; odlozone klatki %u\n",
+           display.async ? "w zadaniu" : "w petli", display.avgStallUs, display.maxStallUs,
+           display.avgFlushUs, display.maxFlushUs, display.deferredFrames);
+
+    // Czas wirtualny stoi w trakcie zadania, więc liczy się tylko spóźnienie względem terminu
+    printf("  zadanie        wywolania  spoznienie max [us]\n");
+    TaskScheduler& scheduler = sim.getScheduler();
+    for (uint8_t i = 0; i < scheduler.getTaskCount(); i++) {
+        const TaskScheduler::Task& task = scheduler.getTask(i);
+        printf("  %-12s %10u %20u\n", task.name, task.runs, task.maxLatenessUs);
+    }
+    return 0;
+}
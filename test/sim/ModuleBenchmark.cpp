@@ -0,0 +1,416 @@
+// Mikrobenchmarki pojedynczych modułów na PC: koszt ścieżek wywoływanych
+// z zadań BLE i pętli głównej, liczony na jeden przetworzony element
+// (bajt, ramkę, próbkę). Czas PC nie przekłada się wprost na ESP32, ale
+// pokazuje zmiany między wersjami. Alokacje to tylko przygotowanie danych -
+// liczba nie może rosnąć z --rounds (wyjątki opisane przy benchmarku).
+//
+// Użycie:
+//   module_benchmark                 # wszystkie, domyślna liczba powtórzeń
+//   module_benchmark --rounds 10     # krótki przebieg (ctest)
+//   module_benchmark jbd             # tylko benchmarki z "jbd" w nazwie
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "AllocationCounter.h"
+#include "ButtonManager.h"
+#include "FakeClock.h"
+#include "JbdBms.h"
+#include "KtController.h"
+#include "LightManager.h"
+#include "PulseRateFilter.h"
+#include "RunningStats.h"
+#include "TemperatureManager.h"
+#include "TripMetrics.h"
+#include "TpmsReceiver.h"
+
+struct ModuleBenchmark {
+    const char* name;
+    const char* unit;                 // Co jest liczone jako element
+    uint64_t (*run)(uint32_t rounds); // Zwraca liczbę przetworzonych elementów
+};
+
+// Zapobiega usunięciu wyników przez optymalizator
+static volatile float sink;
+
+// ---------------------------------------------------------------- JBD BMS
+
+static void jbdFrame(std::vector<uint8_t>& out, uint8_t command, const std::vector<uint8_t>& data) {
+    uint16_t sum = data.size();
+    for (uint8_t byte : data) sum += byte;
+    uint16_t checksum = (uint16_t)(0x10000 - sum);
+
+    out.push_back(JBD_FRAME_START);
+    out.push_back(command);
+    out.push_back(0);
+    out.push_back((uint8_t)data.size());
+    out.insert(out.end(), data.begin(), data.end());
+    out.push_back(checksum >> 8);
+    out.push_back(checksum & 0xFF);
+    out.push_back(JBD_FRAME_END);
+}
+
+// Para odpowiedzi 0x03 (2 czujniki) + 0x04 (13 cel) w powiadomieniach po 20 B
+static uint64_t benchJbdFeed(uint32_t rounds) {
+    std::vector<uint8_t> basic(27, 0);
+    basic[0] = 0x14; basic[1] = 0x72;   // 52.34 V
+    basic[19] = 55;
+    basic[22] = 2;
+    basic[23] = 0x0B; basic[24] = 0xA5;
+    basic[25] = 0x0B; basic[26] = 0xA5;
+    std::vector<uint8_t> cells;
+    for (uint8_t i = 0; i < 13; i++) {
+        cells.push_back(0x0E);
+        cells.push_back(0x42 + i);
+    }
+
+    std::vector<uint8_t> stream;
+    jbdFrame(stream, JBD_CMD_BASIC_INFO, basic);
+    jbdFrame(stream, JBD_CMD_CELL_INFO, cells);
+
+    JbdBms bms;
+    BmsData data;
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (size_t offset = 0; offset < stream.size(); offset += 20) {
+            bms.feed(&stream[offset], std::min<size_t>(20, stream.size() - offset));
+        }
+    }
+    bms.read(data);
+    sink = data.voltage;
+    if (bms.getFramesOk() != rounds * 2) {
+        fprintf(stderr, "jbd: %u ramek zamiast %u\n", bms.getFramesOk(), rounds * 2);
+        exit(1);
+    }
+    return (uint64_t)rounds * stream.size();
+}
+
+// ---------------------------------------------------------------- TPMS
+
+// Rozgłoszenie czujnika: flagi + dane producenta (AD 0xFF)
+static std::vector<uint8_t> tpmsAdvert(uint32_t pressurePa) {
+    std::vector<uint8_t> data = { 0x02, 0x01, 0x06, 1 + TPMS_PAYLOAD_LENGTH, 0xFF, 0x00, 0x01, 0x01 };
+    data.resize(8 + 5, 0xA0);
+    for (uint8_t i = 0; i < 4; i++) data.push_back((pressurePa >> (i * 8)) & 0xFF);
+    for (uint8_t i = 0; i < 4; i++) data.push_back((2000 >> (i * 8)) & 0xFF);
+    data.push_back(90);
+    data.push_back(0);
+    return data;
+}
+
+static uint64_t benchTpmsDecode(uint32_t rounds) {
+    std::vector<uint8_t> payload = tpmsAdvert(250000);
+    TpmsReading reading;
+    uint32_t decoded = 0;
+    for (uint32_t r = 0; r < rounds * 16; r++) {
+        payload[13] = r & 0xFF;
+        decoded += TpmsReceiver::decodePayload(payload.data(), payload.size(), reading);
+    }
+    sink = reading.pressurePa;
+    if (decoded != rounds * 16) {
+        fprintf(stderr, "tpms: zdekodowano %u z %u\n", decoded, rounds * 16);
+        exit(1);
+    }
+    return (uint64_t)rounds * 16;
+}
+
+// Ruch jak w mieście: na 16 rozgłoszeń jedno od skonfigurowanego czujnika.
+// onResult() dostaje urządzenie przez wartość - kopia w zaślepce BLEDevice.h
+// alokuje, więc alokacje tego benchmarku rosną z --rounds (na ESP32 kopiuje biblioteka BLE).
+static uint64_t benchTpmsOnResult(uint32_t rounds) {
+    static const uint8_t SENSOR_MAC[6] = { 0x80, 0xEA, 0xCA, 0x10, 0x20, 0x30 };
+    std::vector<uint8_t> payload = tpmsAdvert(250000);
+    std::vector<BLEAdvertisedDevice> devices;
+    for (uint8_t i = 0; i < 15; i++) {
+        uint8_t mac[6] = { 0x11, 0x22, 0x33, 0x44, 0x55, i };
+        devices.emplace_back(mac, payload.data(), payload.size());
+    }
+    devices.emplace_back(SENSOR_MAC, payload.data(), payload.size());
+
+    TpmsReceiver receiver;
+    receiver.setSensors("80:EA:CA:10:20:30", "");
+    TpmsReading reading;
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (BLEAdvertisedDevice& device : devices) {
+            receiver.onResult(device);
+        }
+        receiver.pop(reading);
+    }
+    if (receiver.getAdvertsAccepted() != rounds) {
+        fprintf(stderr, "tpms: przyjeto %u z %u\n", receiver.getAdvertsAccepted(), rounds);
+        exit(1);
+    }
+    return (uint64_t)rounds * devices.size();
+}
+
+// ---------------------------------------------------------------- statystyki
+
+static uint64_t benchRunningStats(uint32_t rounds) {
+    RunningStats<float> stats;
+    uint32_t samples = rounds * 16;
+    for (uint32_t i = 0; i < samples; i++) {
+        stats.add(20.0f + (i & 15), i * 100);
+    }
+    sink = stats.getTimeMean() + stats.getStdDev();
+    return samples;
+}
+
+// Wartości piłokształtne - kolejki min/max wymieniają elementy przy każdym spadku
+static uint64_t benchWindowedStats(uint32_t rounds) {
+    WindowedStats<float, 32> window;
+    uint32_t samples = rounds * 16;
+    for (uint32_t i = 0; i < samples; i++) {
+        window.add((float)(i % 37));
+    }
+    sink = window.getMean() + window.getMin() + window.getMax();
+    return samples;
+}
+
+// Próbka każdej metryki z ramki sterownika/kadencji
+static uint64_t benchTripMetrics(uint32_t rounds) {
+    TripMetrics metrics;
+    uint32_t samples = rounds * 16;
+    for (uint32_t i = 0; i < samples; i++) {
+        metrics.add((TripMetric)(i % TRIP_METRIC_COUNT), 100.0f + (i & 31), i * 33);
+    }
+    sink = metrics.getAverage(TRIP_SPEED);
+    return samples;
+}
+
+// ---------------------------------------------------------------- temperatury
+
+static uint64_t benchNtcTable(uint32_t rounds) {
+    int32_t sum = 0;
+    uint32_t samples = rounds * 16;
+    for (uint32_t i = 0; i < samples; i++) {
+        sum += TemperatureManager::ntcToDeciCelsius(i % 3300);
+    }
+    sink = sum;
+    return samples;
+}
+
+// Wywołanie update() z pętli co 10 ms czasu wirtualnego: krok automatu DS18B20
+// i 4 próbki NTC (zaślepki OneWire/ADC nie mają kosztu magistrali)
+static uint64_t benchTemperatureUpdate(uint32_t rounds) {
+    OneWire airBus(15);
+    OneWire controllerBus(4);
+    DallasTemperature air(&airBus);
+    DallasTemperature controller(&controllerBus);
+    TemperatureManager temperatures(air, controller, 34);
+    air.setTemperature(21.0f);
+    controller.setTemperature(30.0f);
+    FakeGpio::setMilliVolts(34, 1650);
+    temperatures.begin();
+
+    uint32_t calls = rounds * 4;
+    for (uint32_t i = 0; i < calls; i++) {
+        FakeClock::advanceMs(10);
+        temperatures.update();
+    }
+    sink = temperatures.get(TEMP_CHANNEL_AIR) + temperatures.get(TEMP_CHANNEL_MOTOR);
+    return calls;
+}
+
+// ---------------------------------------------------------------- przyciski
+
+static void noGesture() {}
+
+static const ButtonGesture BENCH_GESTURES[] = {
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP, GESTURE_CLICK, 0, 0, noGesture },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP, GESTURE_LONG_PRESS, 1000, 0, noGesture },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_DOWN, GESTURE_HOLD_REPEAT, 500, 200, noGesture },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET, GESTURE_CLICK, 0, 0, noGesture },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_SET, GESTURE_DOUBLE_CLICK, 300, 0, noGesture },
+    { BUTTON_CONTEXT_NORMAL, BUTTON_MASK_UP | BUTTON_MASK_DOWN, GESTURE_COMBO, 2000, 0, noGesture }
+};
+
+// Wywołanie timera przycisków (co 5 ms); co 2 s kliknięcie, przytrzymanie lub dwuklik
+static uint64_t benchButtonProcess(uint32_t rounds) {
+    ButtonManager buttons(BENCH_GESTURES, sizeof(BENCH_GESTURES) / sizeof(BENCH_GESTURES[0]));
+    buttons.setContext(BUTTON_CONTEXT_NORMAL);
+
+    static const struct { uint32_t atMs; uint8_t mask; } SCRIPT[] = {
+        { 100, BUTTON_MASK_UP }, { 180, 0 },
+        { 500, BUTTON_MASK_DOWN }, { 1300, 0 },
+        { 1500, BUTTON_MASK_SET }, { 1560, 0 }, { 1660, BUTTON_MASK_SET }, { 1720, 0 }
+    };
+    const uint32_t PERIOD_MS = 2000;
+    const uint32_t TICKS = PERIOD_MS * 1000 / BUTTON_TIMER_PERIOD_US;
+
+    uint32_t calls = rounds * 4;
+    uint32_t nowUs = 0;
+    uint32_t gestures = 0;
+    for (uint32_t i = 0; i < calls; i++) {
+        uint32_t tick = i % TICKS;
+        uint32_t cycleUs = nowUs - tick * BUTTON_TIMER_PERIOD_US;
+        for (const auto& step : SCRIPT) {
+            uint32_t atUs = step.atMs * 1000;
+            if (atUs >= tick * BUTTON_TIMER_PERIOD_US && atUs < (tick + 1) * BUTTON_TIMER_PERIOD_US) {
+                buttons.onEdge(step.mask, cycleUs + atUs);
+            }
+        }
+        nowUs += BUTTON_TIMER_PERIOD_US;
+        buttons.process(nowUs);
+
+        ButtonEvent event;
+        while (buttons.popEvent(event)) gestures++;
+    }
+    sink = gestures;
+    if (calls >= TICKS && gestures == 0) {
+        fprintf(stderr, "przyciski: brak rozpoznanych gestow\n");
+        exit(1);
+    }
+    return calls;
+}
+
+// ---------------------------------------------------------------- swiatla
+
+// Takt timera wzorów (co LIGHT_TICK_MS) z wirtualnego zegara; co 1000 taktów
+// nowy wzór tylnego światła - odczyt Seqlock i start od pierwszego kroku
+static uint64_t benchLightTick(uint32_t rounds) {
+    static const uint8_t REAR_PATTERNS[] = {
+        LIGHT_PATTERN_BLINK, LIGHT_PATTERN_DOUBLE_FLASH, LIGHT_PATTERN_TRIPLE_FLASH, LIGHT_PATTERN_PULSE
+    };
+
+    FakeClock::reset();
+    FakeGpio::reset();
+    LightManager lights;
+    lights.begin(19, 18, 23, 26);
+    lights.setMode(LightManager::DAY);
+
+    for (uint32_t i = 0; i < rounds; i++) {
+        if (i % 1000 == 999) {
+            lights.getPatternData()->dayPattern[LIGHT_OUTPUT_REAR] = REAR_PATTERNS[(i / 1000) % 4];
+            lights.refresh();
+        }
+        FakeClock::advanceMs(LIGHT_TICK_MS);
+    }
+    uint32_t writes = lights.getPwmWrites();
+    lights.shutdown();
+    sink = writes;
+    if (rounds >= 100 && writes == 0) {
+        fprintf(stderr, "swiatla: brak zapisow PWM\n");
+        exit(1);
+    }
+    return rounds;
+}
+
+// ---------------------------------------------------------------- KT
+
+// Strumień ramek KT z UART bajt po bajcie; co 64. ramka z przekłamanym bajtem
+// (dekoder wraca do synchronizacji), liczone są poprawnie zdekodowane ramki
+static uint64_t benchKtDecode(uint32_t rounds) {
+    const uint32_t FRAMES = 256;
+    std::vector<uint8_t> stream;
+    for (uint32_t n = 0; n < FRAMES; n++) {
+        uint8_t frame[KT_FRAME_SIZE] = {0};
+        frame[0] = KT_FRAME_HEADER;
+        frame[1] = 12;
+        frame[3] = (600 + n) >> 8;
+        frame[4] = (600 + n) & 0xFF;
+        frame[7] = KT_MODE_ASSIST;
+        frame[8] = n & 0x7F;
+        uint8_t crc = 0;
+        for (uint8_t i = 1; i < KT_FRAME_SIZE; i++) {
+            if (i != KT_CHECKSUM_INDEX) crc ^= frame[i];
+        }
+        frame[KT_CHECKSUM_INDEX] = crc;
+        if (n % 64 == 63) frame[8] ^= 0x10;
+        stream.insert(stream.end(), frame, frame + KT_FRAME_SIZE);
+    }
+
+    KtFrameDecoder decoder;
+    uint64_t frames = 0;
+    uint32_t passes = rounds / FRAMES + 1;
+    for (uint32_t r = 0; r < passes; r++) {
+        for (uint8_t byte : stream) {
+            if (decoder.feed(byte)) frames++;
+        }
+    }
+    sink = decoder.frame()[8];
+    if (frames != (uint64_t)passes * (FRAMES - FRAMES / 64) || decoder.getChecksumErrors() != passes * (FRAMES / 64)) {
+        fprintf(stderr, "kt: %llu ramek, %u bledow sumy\n", (unsigned long long)frames, decoder.getChecksumErrors());
+        exit(1);
+    }
+    return frames;
+}
+
+// ---------------------------------------------------------------- kadencja
+
+// Impuls czujnika kadencji: addPulse() + update() jak cadenceTask; tempo 60-120 RPM
+// z wahaniem, co 16. impuls z odbiciem styku, co 50. odstęp ze zgubionym impulsem
+static uint64_t benchPulseFilter(uint32_t rounds) {
+    PulseRateFilter filter(4000000UL);
+    uint32_t nowUs = 0;
+    uint32_t seed = 1;
+    filter.addPulse(nowUs);
+    for (uint32_t i = 0; i < rounds; i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t rpm = 60 + (i / 500) % 61;
+        uint32_t intervalUs = 60000000UL / rpm + (seed >> 8) % 20000;
+        nowUs += (i % 50 == 49) ? intervalUs * 2 : intervalUs;
+        filter.addPulse(nowUs);
+        if (i % 16 == 15) filter.addPulse(nowUs + 2000);
+        filter.update(nowUs);
+    }
+    sink = filter.getSmoothedMilliRpm();
+    if (rounds >= 100 && (filter.getRejectedPulses() == 0 || filter.getRpm() < 55 || filter.getRpm() > 125)) {
+        fprintf(stderr, "kadencja: %u RPM, %u odrzuconych\n", filter.getRpm(), filter.getRejectedPulses());
+        exit(1);
+    }
+    return rounds;
+}
+
+// ---------------------------------------------------------------- tabela
+
+static const ModuleBenchmark BENCHMARKS[] = {
+    { "jbd_feed_mtu20", "bajt", benchJbdFeed },
+    { "tpms_decode", "rozgloszenie", benchTpmsDecode },
+    { "tpms_on_result", "rozgloszenie", benchTpmsOnResult },
+    { "running_stats_add", "probka", benchRunningStats },
+    { "windowed_stats_add_32", "probka", benchWindowedStats },
+    { "trip_metrics_add", "probka", benchTripMetrics },
+    { "ntc_to_deci_celsius", "przeliczenie", benchNtcTable },
+    { "temperature_update", "wywolanie", benchTemperatureUpdate },
+    { "button_process", "takt timera", benchButtonProcess },
+    { "light_tick", "takt timera", benchLightTick },
+    { "kt_decode", "ramka", benchKtDecode },
+    { "pulse_filter_update", "impuls", benchPulseFilter },
+};
+
+int main(int argc, char** argv) {
+    uint32_t rounds = 200000;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            rounds = strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-') {
+            filter = argv[i];
+        } else {
+            fprintf(stderr, "Uzycie: %s [--rounds N] [filtr]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rounds == 0) {
+        fprintf(stderr, "Liczba powtorzen musi byc dodatnia\n");
+        return 2;
+    }
+
+    FakeClock::reset();
+    printf("%-24s %14s %10s %12s\n", "benchmark", "elementy/s", "ns/elem", "alokacje");
+    for (const ModuleBenchmark& bench : BENCHMARKS) {
+        if (filter && !strstr(bench.name, filter)) continue;
+
+        uint64_t startAllocations = AllocationCounter::count();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t items = bench.run(rounds);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t allocations = AllocationCounter::count() - startAllocations;
+
+        printf("%-24s %14.0f %10.2f %12llu  [%s]\n", bench.name, items / seconds,
+               seconds * 1e9 / items, (unsigned long long)allocations, bench.unit);
+    }
+    return 0;
+}
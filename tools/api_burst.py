@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Seria równoległych zapytań do REST API i zajętość sterty urządzenia.
+
+Zeruje liczniki (/api/perf?reset=1), wysyła zapytania GET do endpointów JSON
+z kilku wątków naraz, a potem czyta /api/perf: najmniej wolnej sterty
+i najmniejszy największy blok zmierzone przy wysyłaniu każdej odpowiedzi
+(ApiResponse.h) oraz najmniejszą wolną stertę od startu.
+
+Użycie:
+    api_burst.py                           # 192.168.4.1, 4 wątki, 10 serii
+    api_burst.py --host 192.168.4.1 --clients 8 --rounds 20
+    api_burst.py --endpoint /api/perf --endpoint /api/rides
+"""
+
+import argparse
+import json
+import sys
+import time
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+
+ENDPOINTS = [
+    "/api/status",
+    "/api/filesystem/status",
+    "/api/lights/config",
+    "/api/display/config",
+    "/get-bluetooth-config",
+    "/api/bms",
+    "/api/tpms",
+    "/api/scheduler",
+    "/api/perf",
+    "/api/rides",
+]
+
+
+def fetch(base, path, timeout):
+    start = time.monotonic()
+    try:
+        with urllib.request.urlopen(base + path, timeout=timeout) as response:
+            body = response.read()
+        json.loads(body)
+        return path, len(body), time.monotonic() - start, None
+    except Exception as error:  # noqa: BLE001 - każdy błąd liczony jako nieudane zapytanie
+        return path, 0, time.monotonic() - start, str(error)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="192.168.4.1", help="adres urządzenia")
+    parser.add_argument("--clients", type=int, default=4, help="równoległe połączenia")
+    parser.add_argument("--rounds", type=int, default=10, help="serie zapytań o wszystkie endpointy")
+    parser.add_argument("--endpoint", action="append", help="endpoint (można podać kilka razy)")
+    parser.add_argument("--timeout", type=float, default=10.0)
+    opts = parser.parse_args()
+
+    base = "http://" + opts.host
+    endpoints = opts.endpoint or ENDPOINTS
+    before = json.loads(urllib.request.urlopen(base + "/api/perf?reset=1", timeout=opts.timeout).read())
+
+    jobs = [path for _ in range(opts.rounds) for path in endpoints]
+    start = time.monotonic()
+    with ThreadPoolExecutor(max_workers=opts.clients) as pool:
+        results = list(pool.map(lambda path: fetch(base, path, opts.timeout), jobs))
+    elapsed = time.monotonic() - start
+
+    after = json.loads(urllib.request.urlopen(base + "/api/perf", timeout=opts.timeout).read())
+
+    print(f"{'endpoint':<26}{'zapytań':>8}{'błędów':>8}{'bajty':>8}{'max ms':>8}")
+    for path in endpoints:
+        rows = [r for r in results if r[0] == path]
+        errors = [r for r in rows if r[3]]
+        size = max((r[1] for r in rows), default=0)
+        worst = max((r[2] for r in rows), default=0) * 1000
+        print(f"{path:<26}{len(rows):>8}{len(errors):>8}{size:>8}{worst:>8.0f}")
+    failed = [r for r in results if r[3]]
+    for path, _, _, error in failed[:5]:
+        print(f"  {path}: {error}", file=sys.stderr)
+
+    api = after.get("api", {})
+    heap = after["heap"]
+    print(f"\n{len(results)} zapytań w {elapsed:.1f} s, {opts.clients} równolegle, {len(failed)} błędów")
+    print(f"sterta przed: {before['heap']['free']} B wolne, największy blok {before['heap']['largestBlock']} B")
+    print(f"w serii:      {api.get('minFreeHeap', 0)} B wolne, największy blok {api.get('minLargestBlock', 0)} B"
+          f" (przy wysyłaniu {api.get('responses', 0)} odpowiedzi, największa {api.get('maxBytes', 0)} B)")
+    print(f"po serii:     {heap['free']} B wolne, największy blok {heap['largestBlock']} B,"
+          f" min. od startu {heap['minFree']} B")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
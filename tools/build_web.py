@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+"""Budowa plików interfejsu WWW: web/ -> data/ (obraz LittleFS).
+
+Każdy plik jest minimalizowany (komentarze i wcięcia), kompresowany gzip
+i zapisywany jako <nazwa>.gz. Do data/assets.json trafia lista plików z typem
+MIME i ETagiem liczonym z treści - serwer (WebAssets.h) wysyła je z
+Content-Encoding: gzip i odpowiada 304 na If-None-Match.
+
+Domyślnie CSS i skrypty są wstawiane do index.html (jeden plik, jedno
+zapytanie przy pierwszym wczytaniu). Z --no-bundle zostają osobnymi plikami,
+a odnośniki w index.html dostają ?v=<hash>, więc mogą być buforowane na stałe.
+
+Użycie:
+    build_web.py                     # web/ -> data/
+    build_web.py --no-bundle
+    build_web.py --src web --out data
+
+Minimalizacja jest zachowawcza (bez zależności): usuwa komentarze, wcięcia
+i puste linie, nie zmienia napisów, szablonów `...` ani wyrażeń regularnych.
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+TEXT_TYPES = (".html", ".css", ".js", ".json", ".svg")
+
+# Znaki, po których "/" zaczyna wyrażenie regularne, a nie dzielenie
+REGEX_PREFIX = set("(,=:[!&|?{};+-*%<>~^")
+REGEX_KEYWORDS = ("return", "typeof", "case", "do", "else", "in", "of", "void", "yield", "await")
+
+
+def minify_js(src):
+    """Usuwa komentarze, wcięcia i puste linie poza napisami, szablonami i regex."""
+    out = []
+    i = 0
+    n = len(src)
+    stack = []          # Zagnieżdżenie: "`" (szablon) albo "{" (kod w ${...} lub blok)
+    last = ""           # Ostatni znaczący znak kodu (do rozpoznania regex)
+    word = ""           # Ostatnie słowo kodu
+
+    def in_template():
+        return stack and stack[-1] == "`"
+
+    def newline():
+        # Koniec linii kodu: bez spacji na końcu i bez pustych linii
+        while out and out[-1] in " \t":
+            out.pop()
+        if out and out[-1] != "\n":
+            out.append("\n")
+
+    while i < n:
+        c = src[i]
+
+        if in_template():
+            if c == "\\":
+                out.append(src[i:i + 2])
+                i += 2
+            elif c == "`":
+                stack.pop()
+                out.append(c)
+                last = "`"
+                i += 1
+            elif src.startswith("${", i):
+                stack.append("${")
+                out.append("${")
+                i += 2
+            else:
+                out.append(c)
+                i += 1
+            continue
+
+        if c in "'\"":
+            j = i + 1
+            while j < n and src[j] != c:
+                j += 2 if src[j] == "\\" else 1
+            out.append(src[i:j + 1])
+            last, word = c, ""
+            i = j + 1
+        elif c == "`":
+            stack.append("`")
+            out.append(c)
+            i += 1
+        elif src.startswith("//", i):
+            while i < n and src[i] != "\n":
+                i += 1
+        elif src.startswith("/*", i):
+            end = src.find("*/", i + 2)
+            i = n if end < 0 else end + 2
+            if out and out[-1] not in " \t\n":
+                out.append(" ")
+        elif c == "/" and (last == "" or last in REGEX_PREFIX or word in REGEX_KEYWORDS):
+            j = i + 1
+            in_class = False
+            while j < n and (in_class or src[j] != "/") and src[j] != "\n":
+                if src[j] == "\\":
+                    j += 1
+                elif src[j] == "[":
+                    in_class = True
+                elif src[j] == "]":
+                    in_class = False
+                j += 1
+            j += 1
+            while j < n and src[j].isalpha():
+                j += 1
+            out.append(src[i:j])
+            last, word = "/", ""
+            i = j
+        elif c == "\n":
+            newline()
+            i += 1
+            while i < n and src[i] in " \t":
+                i += 1
+        elif c in " \t":
+            if out and out[-1] not in " \t\n":
+                out.append(" ")
+            i += 1
+        else:
+            if c == "{":
+                stack.append("{")
+            elif c == "}" and stack:
+                stack.pop()
+            if c.isalnum() or c in "_$":
+                word = word + c if (last.isalnum() or last in "_$") else c
+            else:
+                word = ""
+            out.append(c)
+            last = c
+            i += 1
+
+    newline()
+    return "".join(out).lstrip("\n")
+
+
+def minify_css(src):
+    src = re.sub(r"/\*.*?\*/", "", src, flags=re.S)
+    src = re.sub(r"\s+", " ", src)
+    src = re.sub(r"\s*([{};,>])\s*", r"\1", src)
+    return src.replace(";}", "}").strip() + "\n"
+
+
+def minify_html(src):
+    src = re.sub(r"<!--(?!\[).*?-->", "", src, flags=re.S)
+
+    # Treść <script> i <style> osobnymi funkcjami
+    def script(m):
+        return m.group(1) + minify_js(m.group(2)) + m.group(3)
+
+    def style(m):
+        return m.group(1) + minify_css(m.group(2)) + m.group(3)
+
+    src = re.sub(r"(<script(?![^>]*\bsrc=)[^>]*>)(.*?)(</script>)", script, src, flags=re.S | re.I)
+    src = re.sub(r"(<style[^>]*>)(.*?)(</style>)", style, src, flags=re.S | re.I)
+
+    lines = (line.strip() for line in src.split("\n"))
+    return "\n".join(line for line in lines if line) + "\n"
+
+
+MINIFIERS = {".js": minify_js, ".css": minify_css, ".html": minify_html}
+
+
+def content_hash(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def bundle(index, sources):
+    """Wstawia lokalne arkusze i skrypty do index.html."""
+    def inline_css(m):
+        name = m.group(1)
+        if name not in sources:
+            return m.group(0)
+        return "<style>\n" + sources.pop(name) + "</style>"
+
+    def inline_js(m):
+        name = m.group(1)
+        if name not in sources:
+            return m.group(0)
+        code = sources.pop(name)
+        if "</script" in code.lower():
+            sys.exit(f"{name}: zawiera '</script' - nie można wstawić do index.html")
+        return "<script>\n" + code + "</script>"
+
+    index = re.sub(r'<link rel="stylesheet" href="([^":/]+)"\s*/?>', inline_css, index)
+    index = re.sub(r'<script src="([^":/]+)"></script>', inline_js, index)
+    return index
+
+
+def add_versions(index, hashes):
+    """Odnośniki do osobnych plików z ?v=<hash> - zmiana treści zmienia adres."""
+    def versioned(m):
+        name = m.group(2)
+        if name not in hashes:
+            return m.group(0)
+        return f'{m.group(1)}{name}?v={hashes[name][:8]}"'
+
+    return re.sub(r'((?:href|src)=")([^":/?]+)"', versioned, index)
+
+
+def build(src_dir, out_dir, bundled):
+    sources = {}
+    for name in sorted(os.listdir(src_dir)):
+        path = os.path.join(src_dir, name)
+        if not os.path.isfile(path):
+            continue
+        ext = os.path.splitext(name)[1].lower()
+        if ext in TEXT_TYPES:
+            with open(path, encoding="utf-8") as f:
+                text = f.read()
+            sources[name] = MINIFIERS.get(ext, lambda s: s)(text)
+        else:
+            with open(path, "rb") as f:
+                sources[name] = f.read()
+
+    raw_sizes = {name: os.path.getsize(os.path.join(src_dir, name)) for name in sources}
+
+    if "index.html" not in sources:
+        sys.exit(f"{src_dir}: brak index.html")
+
+    index = sources.pop("index.html")
+    if bundled:
+        index = bundle(index, sources)
+    else:
+        hashes = {name: content_hash(data.encode("utf-8") if isinstance(data, str) else data)
+                  for name, data in sources.items()}
+        index = add_versions(index, hashes)
+    sources["index.html"] = index
+
+    if os.path.isdir(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(out_dir)
+
+    assets = []
+    total_raw = total_min = total_gz = 0
+    print(f"{'plik':<16}{'źródło':>10}{'min':>10}{'gzip':>10}")
+    for name in sorted(sources):
+        data = sources[name]
+        data = data.encode("utf-8") if isinstance(data, str) else data
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        with open(os.path.join(out_dir, name + ".gz"), "wb") as f:
+            f.write(packed)
+
+        ext = os.path.splitext(name)[1].lower()
+        assets.append({
+            "path": "/" + name,
+            "type": CONTENT_TYPES.get(ext, "application/octet-stream"),
+            "etag": content_hash(data),
+            "size": len(packed),
+            # index.html zawsze sprawdzany (304), reszta ma adres z hashem
+            "immutable": name != "index.html",
+        })
+
+        raw = raw_sizes[name] if name != "index.html" or not bundled else sum(raw_sizes.values())
+        print(f"{name:<16}{raw:>10}{len(data):>10}{len(packed):>10}")
+        total_raw += raw
+        total_min += len(data)
+        total_gz += len(packed)
+
+    print(f"{'razem':<16}{total_raw:>10}{total_min:>10}{total_gz:>10}")
+
+    with open(os.path.join(out_dir, "assets.json"), "w", encoding="utf-8") as f:
+        json.dump({"assets": assets}, f, separators=(",", ":"))
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description="Budowa plików WWW do obrazu LittleFS")
+    parser.add_argument("--src", default=os.path.join(root, "web"), help="katalog źródeł (web/)")
+    parser.add_argument("--out", default=os.path.join(root, "data"), help="katalog wyjściowy (data/)")
+    parser.add_argument("--no-bundle", action="store_true", help="CSS i skrypty jako osobne pliki")
+    args = parser.parse_args()
+
+    build(args.src, args.out, not args.no_bundle)
+
+
+if __name__ == "__main__":
+    main()
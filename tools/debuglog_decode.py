@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""Dekoder binarnego logu DebugLog (DebugLog.h, wyjście OUTPUT_BINARY).
+
+Słownik formatów budowany jest ze źródeł: każde wywołanie DEBUG_*("...")
+daje identyfikator FNV-1a z bajtów tekstu formatu - ten sam, który liczy
+kompilator w DebugLog::formatId().
+
+Użycie:
+    debuglog_decode.py log.bin                 # zapis z terminala (surowe bajty)
+    debuglog_decode.py --port /dev/ttyUSB0     # na żywo (wymaga pyserial)
+    debuglog_decode.py --src ../ log.bin       # katalog ze źródłami szkicu
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+TAGS = ["ERROR", "WARN", "INFO", "LIGHT", "TEMP", "BLE", "DETAIL"]
+FORMAT_ID_DROPPED = 0
+DROPPED_FORMAT = b"Log: pominieto %u wpisow"
+
+SYNC = b"\xa5\x5a"
+MAX_PAYLOAD = 112
+
+CALL_RE = re.compile(r'\bDEBUG_(?:ERROR|WARN|INFO|LIGHT|TEMP|BLE|DETAIL)\s*\(\s*((?:"(?:\\.|[^"\\])*"\s*)+)')
+LITERAL_RE = re.compile(r'"((?:\\.|[^"\\])*)"')
+SPEC_RE = re.compile(rb"%(%|[-+ #0-9.]*)(hh|h|ll|l|z|j|t|L|q)?([diouxXcsfFeEgGp%])?")
+
+ESCAPES = {"n": 10, "t": 9, "r": 13, "\\": 92, '"': 34, "'": 39, "a": 7, "b": 8, "f": 12, "v": 11, "?": 63}
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def unescape(literal):
+    """Bajty literału C (UTF-8 jak w źródle, z rozwinięciem sekwencji ucieczki)."""
+    raw = literal.encode("utf-8")
+    out = bytearray()
+    i = 0
+    while i < len(raw):
+        c = raw[i]
+        if c != 0x5C or i + 1 >= len(raw):
+            out.append(c)
+            i += 1
+            continue
+        e = chr(raw[i + 1])
+        if e == "x":
+            j = i + 2
+            while j < len(raw) and chr(raw[j]) in "0123456789abcdefABCDEF":
+                j += 1
+            out.append(int(raw[i + 2:j], 16) & 0xFF)
+            i = j
+        elif e in "01234567":
+            j = i + 1
+            while j < len(raw) and j < i + 4 and chr(raw[j]) in "01234567":
+                j += 1
+            out.append(int(raw[i + 1:j], 8) & 0xFF)
+            i = j
+        else:
+            out.append(ESCAPES.get(e, ord(e)))
+            i += 2
+    return bytes(out)
+
+
+def build_dictionary(src_dir):
+    formats = {FORMAT_ID_DROPPED: DROPPED_FORMAT}
+    for name in sorted(os.listdir(src_dir)):
+        if not name.endswith((".ino", ".cpp", ".h")):
+            continue
+        with open(os.path.join(src_dir, name), encoding="utf-8") as f:
+            text = f.read()
+        for match in CALL_RE.finditer(text):
+            data = b"".join(unescape(lit) for lit in LITERAL_RE.findall(match.group(1)))
+            formats[fnv1a(data)] = data
+    return formats
+
+
+def read_args(payload):
+    args = []
+    i = 0
+    while i < len(payload):
+        t = chr(payload[i])
+        i += 1
+        if t == "i":
+            args.append(struct.unpack_from("<i", payload, i)[0]); i += 4
+        elif t == "u":
+            args.append(struct.unpack_from("<I", payload, i)[0]); i += 4
+        elif t == "q":
+            args.append(struct.unpack_from("<q", payload, i)[0]); i += 8
+        elif t == "Q":
+            args.append(struct.unpack_from("<Q", payload, i)[0]); i += 8
+        elif t == "f":
+            args.append(struct.unpack_from("<f", payload, i)[0]); i += 4
+        elif t == "d":
+            args.append(struct.unpack_from("<d", payload, i)[0]); i += 8
+        elif t == "s":
+            n = payload[i]
+            args.append(payload[i + 1:i + 1 + n].decode("utf-8", "replace")); i += 1 + n
+        else:
+            break
+    return args
+
+
+def format_message(fmt, args):
+    """printf w Pythonie: modyfikatory długości pomijane, jak w DebugLog::drain()."""
+    out = []
+    pos = 0
+    queue = list(args)
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[pos:m.start()].decode("utf-8", "replace"))
+        pos = m.end()
+        if m.group(1) == b"%":
+            out.append("%")
+            continue
+        conv = (m.group(3) or b"s").decode()
+        flags = m.group(1).decode()
+        if not queue:
+            out.append("<?>")
+            continue
+        value = queue.pop(0)
+        if conv in "diu":
+            conv = "d"
+        elif conv == "p":
+            conv = "x"
+        try:
+            if conv in "fFeEgG" and not isinstance(value, float):
+                value = float(value)
+            elif conv in "dxXoc" and isinstance(value, float):
+                value = int(value)
+            elif conv in "dxXoc" and isinstance(value, str):
+                conv = "s"
+            out.append(("%" + flags + conv) % value)
+        except (TypeError, ValueError, OverflowError):
+            out.append(str(value))
+    out.append(fmt[pos:].decode("utf-8", "replace"))
+    return "".join(out)
+
+
+def frames(stream):
+    """Ramki z bajtów; po błędnej sumie szukanie następnej synchronizacji."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buf.extend(chunk)
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                del buf[:-1]
+                break
+            if start:
+                del buf[:start]
+            if len(buf) < 3:
+                break
+            length = buf[2]
+            total = 2 + 1 + 1 + 4 + 4 + length + 1
+            if length > MAX_PAYLOAD:
+                del buf[:1]
+                continue
+            if len(buf) < total:
+                break
+            body = bytes(buf[2:total - 1])
+            if (sum(body) & 0xFF) != buf[total - 1]:
+                del buf[:1]
+                continue
+            del buf[:total]
+            tag = body[1]
+            fmt_id, stamp_us = struct.unpack_from("<II", body, 2)
+            yield tag, fmt_id, stamp_us, body[10:]
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="plik z surowym logiem (domyślnie stdin)")
+    parser.add_argument("--src", default=os.path.dirname(here), help="katalog ze źródłami szkicu")
+    parser.add_argument("--port", help="port szeregowy (pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    opts = parser.parse_args()
+
+    formats = build_dictionary(opts.src)
+
+    if opts.port:
+        import serial
+        stream = serial.Serial(opts.port, opts.baud, timeout=None)
+    elif opts.file:
+        stream = open(opts.file, "rb")
+    else:
+        stream = sys.stdin.buffer
+
+    for tag, fmt_id, stamp_us, payload in frames(stream):
+        name = TAGS[tag] if tag < len(TAGS) else "?"
+        fmt = formats.get(fmt_id)
+        args = read_args(payload)
+        if fmt is None:
+            text = "<format 0x%08X> %s" % (fmt_id, " ".join(str(a) for a in args))
+        else:
+            text = format_message(fmt, args).rstrip("\r\n")
+        print("%10.6f [%s] %s" % (stamp_us / 1e6, name, text), flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,177 @@
+/**
+ * e-Bike System PMW - Profiler (/api/perf)
+ * Histogramy czasu sekcji, sterta i zapas stosu zadań
+ */
+
+// Stan zapamiętany przyciskiem "Migawka" - kolejne odczyty pokazują przyrost
+let perfSnapshot = null;
+
+// Histogram jako tablica 32 przedziałów (API wysyła tylko niezerowy zakres)
+function perfBuckets(section) {
+    const buckets = new Array(32).fill(0);
+    section.buckets.forEach((count, i) => {
+        buckets[section.firstBucket + i] = count;
+    });
+    return buckets;
+}
+
+// Przyrost sekcji od migawki; maksimum zostaje bieżące
+function perfDelta(section, base) {
+    if (!base) {
+        return { count: section.count, avgUs: section.avgUs, maxUs: section.maxUs, buckets: perfBuckets(section) };
+    }
+    const count = section.count - base.count;
+    const totalUs = section.totalUs - base.totalUs;
+    const now = perfBuckets(section);
+    const before = perfBuckets(base);
+    return {
+        count: count,
+        avgUs: count > 0 ? Math.round(totalUs / count) : 0,
+        maxUs: section.maxUs,
+        buckets: now.map((value, i) => Math.max(0, value - before[i]))
+    };
+}
+
+function perfFormatUs(us) {
+    return us >= 1000 ? (us / 1000).toFixed(1) + ' ms' : us.toFixed(us < 10 ? 1 : 0) + ' µs';
+}
+
+function renderPerfHistogram(buckets, cpuMhz) {
+    let first = buckets.findIndex(v => v > 0);
+    if (first < 0) {
+        return '';
+    }
+    let last = buckets.length - 1;
+    while (buckets[last] === 0) last--;
+
+    const max = Math.max(...buckets);
+    let html = '<div class="perf-histogram">';
+    for (let i = first; i <= last; i++) {
+        const height = buckets[i] > 0 ? Math.max(2, Math.round(buckets[i] / max * 24)) : 0;
+        const fromUs = Math.pow(2, i) / cpuMhz;
+        const toUs = Math.pow(2, i + 1) / cpuMhz;
+        html += `<span style="height:${height}px" title="${perfFormatUs(fromUs)} - ${perfFormatUs(toUs)}: ${buckets[i]}"></span>`;
+    }
+    return html + '</div>';
+}
+
+function renderPerf(data) {
+    const base = perfSnapshot;
+    const baseSections = {};
+    if (base) {
+        base.sections.forEach(s => { baseSections[s.name] = s; });
+    }
+
+    const rows = data.sections.map(section => {
+        const d = perfDelta(section, baseSections[section.name]);
+        return `<tr>
+            <td>${section.name}</td>
+            <td>${d.count}</td>
+            <td>${d.avgUs}</td>
+            <td>${d.maxUs}</td>
+            <td>${renderPerfHistogram(d.buckets, data.cpuMhz)}</td>
+        </tr>`;
+    });
+    document.getElementById('perf-sections').innerHTML = rows.join('');
+
+    document.getElementById('perf-tasks').innerHTML = data.tasks.map(task =>
+        `<tr><td>${task.name}</td><td>${task.stackFree}</td></tr>`).join('');
+
+    const heap = data.heap;
+    const span = base ? `od migawki ${((data.uptimeMs - base.uptimeMs) / 1000).toFixed(0)} s`
+                        : `okno ${(data.windowMs / 1000).toFixed(0)} s`;
+    document.getElementById('perf-summary').textContent =
+        `${data.cpuMhz} MHz, ${span}` +
+        ` | sterta: ${heap.free} B wolne, min. ${heap.minFree} B, największy blok ${heap.largestBlock} B` +
+        (data.profiling ? '' : ' | profiler wyłączony (PROFILING 0)');
+
+    renderPerfBoot(data.boot);
+    renderPerfWeb(data.web);
+    renderPerfApi(data.api);
+}
+
+// Czasy ostatniego wybudzenia (us od uruchomienia programu)
+function renderPerfBoot(boot) {
+    const ms = us => (us / 1000).toFixed(0) + ' ms';
+    let text = `start ${boot.resumed ? `z kopii RTC (${boot.restoreUs} µs)` : 'z plików'}: ` +
+        `ustawienia ${ms(boot.settingsUs)}`;
+    if (boot.firstFrameUs > 0) {
+        text += `, pierwsza klatka ${ms(boot.firstFrameUs)}` +
+            ` (bez przytrzymania SET ${ms(boot.firstFrameUs - boot.holdUs)})`;
+    }
+    if (boot.deferredUs > 0) {
+        text += `, pliki i BLE ${ms(boot.deferredUs)}`;
+    }
+    document.getElementById('perf-boot').textContent = text;
+}
+
+// Wczytanie tej strony (Navigation/Resource Timing) i pliki wysłane przez serwer.
+// transferSize 0 - plik z pamięci przeglądarki; około 300 B - odpowiedź 304.
+function renderPerfWeb(web) {
+    const entries = performance.getEntriesByType('navigation').concat(performance.getEntriesByType('resource'))
+        .filter(e => !e.name.includes('/api/') && !e.name.startsWith('ws'));
+    const page = entries[0];
+    let text = '';
+    if (page) {
+        const bytes = entries.reduce((sum, e) => sum + (e.transferSize || 0), 0);
+        const cached = entries.filter(e => e.transferSize === 0).length;
+        text = `strona: ${(bytes / 1024).toFixed(1)} kB przesłane, ${entries.length} plików` +
+            ` (${cached} z pamięci przeglądarki), interaktywna po ${Math.round(page.domInteractive)} ms`;
+    }
+    if (web) {
+        text += `${text ? ' | ' : ''}serwer: ${web.requests} zapytań o pliki, ${web.notModified} × 304,` +
+            ` wysłane ${(web.bytesSent / 1024).toFixed(1)} kB`;
+    }
+    document.getElementById('perf-web').textContent = text;
+}
+
+// Odpowiedzi JSON API od ostatniego zerowania; sterta mierzona przy wysyłaniu każdej z nich
+function renderPerfApi(api) {
+    if (!api) {
+        return;
+    }
+    document.getElementById('perf-api').textContent =
+        `API: ${api.responses} odpowiedzi (${api.chunked} porcjami), ${(api.bytes / 1024).toFixed(1)} kB,` +
+        ` największa ${api.maxBytes} B | przy wysyłaniu min. ${api.minFreeHeap} B wolne,` +
+        ` największy blok ${api.minLargestBlock} B` +
+        (api.overflows > 0 ? ` | ${api.overflows} uciętych` : '');
+}
+
+async function fetchPerf(query = '') {
+    const response = await fetch('/api/perf' + query);
+    if (!response.ok) {
+        throw new Error('Błąd sieci: ' + response.status);
+    }
+    return response.json();
+}
+
+async function loadPerf() {
+    try {
+        renderPerf(await fetchPerf());
+    } catch (error) {
+        handleError(error, 'Błąd podczas pobierania danych wydajności');
+    }
+}
+
+async function takePerfSnapshot() {
+    try {
+        perfSnapshot = await fetchPerf();
+        renderPerf(perfSnapshot);
+    } catch (error) {
+        handleError(error, 'Błąd podczas pobierania danych wydajności');
+    }
+}
+
+async function resetPerf() {
+    try {
+        await fetchPerf('?reset=1');
+        perfSnapshot = null;
+        await loadPerf();
+    } catch (error) {
+        handleError(error, 'Błąd podczas zerowania liczników');
+    }
+}
+
+document.addEventListener('DOMContentLoaded', function() {
+    loadPerf();
+});
@@ -739,6 +739,12 @@ const infoContent = {
         description: `Wybierz rozmiar koła swojego roweru. Jest to ważne dla prawidłowego obliczania prędkości i dystansu.`
     },
 
+    // Zapis przejazdu
+    'ride-sample-rate-info': {
+        title: 'Zapis przejazdu',
+        description: `Jak często zapisywane są dane przejazdu (prędkość, kadencja, moc, bateria, temperatury). Wyższa częstotliwość daje dokładniejszy zapis, ale zajmuje więcej miejsca w pamięci.`
+    },
+
     // Sekcja Bluetooth
     'bluetooth-config-info': {
         title: '📶 Konfiguracja Bluetooth',
@@ -798,7 +804,39 @@ const infoContent = {
 		description: `Wprowadź adres MAC tylnego czujnika TPMS w formacie XX:XX:XX:XX:XX:XX.		
 		Możesz znaleźć adres MAC używając aplikacji do skanowania Bluetooth na telefonie podczas kalibracji czujników.		
 		Przykład: A1:B2:C3:D4:E5:F6`
-	}
+	},
+
+    // Sekcja wydajności //
+
+    'perf-info': {
+        title: '⏱️ Wydajność',
+        description: `Czas wykonania sekcji programu mierzony licznikiem cykli procesora
+
+    📊 Kolumny:
+      - Wywołania, średni i maksymalny czas [µs]
+      - Histogram: słupek to przedział czasu dwa razy dłuższy od poprzedniego
+
+    🔄 Przyciski:
+      - Odśwież - bieżące liczniki
+      - Migawka - zapamiętuje stan; kolejne odświeżenia pokazują przyrost od migawki
+      - Zeruj - zeruje liczniki w urządzeniu
+
+    💾 Pamięć:
+      - Wolna sterta, najmniejsza od startu i największy wolny blok
+      - Zapas stosu zadań (najmniejszy od startu)
+
+    🚀 Start:
+      - Czas od wybudzenia do pierwszej klatki ekranu, także bez czasu przytrzymania SET
+      - Po uśpieniu stan wraca z pamięci RTC; system plików i BLE startują po pierwszej klatce
+
+    🌐 Strona:
+      - Bajty przesłane przy wczytaniu tej strony i czas do interaktywności
+      - Pierwsze wczytanie: pełne pliki gzip; kolejne: 304 dla index.html, reszta z pamięci przeglądarki
+
+    🔌 API:
+      - Odpowiedzi JSON od zerowania, ich rozmiar i najmniej wolnej sterty przy wysyłaniu
+      - Seria równoległych zapytań: tools/api_burst.py`
+    }
 };
 
 // Główna inicjalizacja po załadowaniu DOM
@@ -1184,6 +1222,7 @@ async function fetchSystemVersion() {
 async function saveGeneralSettings() {
     try {
         const wheelSize = document.getElementById('wheel-size').value;
+        const rideSampleRate = parseInt(document.getElementById('ride-sample-rate').value);
         const odometer = document.getElementById('total-odometer').value;
         
         // Najpierw zapisz ustawienia ogólne
@@ -1193,7 +1232,8 @@ async function saveGeneralSettings() {
                 'Content-Type': 'application/json',
             },
             body: JSON.stringify({
-                wheelSize: wheelSize
+                wheelSize: wheelSize,
+                rideSampleRate: rideSampleRate
             })
         });
 
@@ -1244,6 +1284,7 @@ async function loadGeneralSettings() {
         if (data) {
             // Ustaw rozmiar koła
             updateElementValue('wheel-size', data.wheelSize);
+            updateElementValue('ride-sample-rate', data.rideSampleRate);
         }
         
         // Pobierz stan licznika
@@ -1494,22 +1535,160 @@ async function saveDisplayConfig() {
     }
 }
 
+// Pola telemetrii - kolejność i skala zgodne z TelemetryField (TelemetryChannel.h)
+const TELEMETRY_FIELDS = [
+    { name: 'speed', scale: 0.1 },
+    { name: 'cadence', scale: 1 },
+    { name: 'power', scale: 1 },
+    { name: 'voltage', scale: 0.1 },
+    { name: 'current', scale: 0.1 },
+    { name: 'battery', scale: 1 },
+    { name: 'temperature', scale: 0.1 },
+    { name: 'tempController', scale: 0.1 },
+    { name: 'tempMotor', scale: 0.1 },
+    { name: 'assist', scale: 1 },
+    { name: 'lightMode', scale: 1 },
+    { name: 'lightDay', scale: 1 },
+    { name: 'lightNight', scale: 1 },
+    { name: 'tripDistance', scale: 1 },
+    { name: 'odometer', scale: 1 }
+];
+const TELEMETRY_FRAME_KEY = 0x01;
+const TELEMETRY_FRAME_DELTA = 0x02;
+const TELEMETRY_NO_VALUE = -32768;  // Brak pomiaru (TelemetryChannel.h)
+const TELEMETRY_RATE_HZ = 10;
+const LIGHT_MODE_NAMES = ['WYLACZONE', 'DZIEN', 'NOC'];
+
+// Aktualny stan telemetrii (wartości w jednostkach fizycznych)
+const telemetry = {};
+window.telemetry = telemetry;
+
+// Surowe wartości z ostatniej ramki - podstawa dla ramek delta
+const telemetryRaw = new Array(TELEMETRY_FIELDS.length).fill(0);
+let telemetrySynced = false;
+let telemetrySequence = -1;
+
+function lightConfigName(flags) {
+    const parts = [];
+    if (flags & 1) parts.push('FRONT');
+    if (flags & 2) parts.push('DRL');
+    if (flags & 4) parts.push('REAR');
+    return parts.length ? parts.join('+') : 'NONE';
+}
+
+// Dekodowanie ramki binarnej; zwraca listę zmienionych pól lub null
+function decodeTelemetryFrame(buffer) {
+    const bytes = new Uint8Array(buffer);
+    if (bytes.length < 4) return null;
+
+    const type = bytes[0];
+    const sequence = bytes[1];
+    const bitmap = bytes[2] | (bytes[3] << 8);
+
+    if (type === TELEMETRY_FRAME_DELTA) {
+        // Delta ma sens tylko względem poprzedniej ramki - po zgubieniu czekamy na kluczową
+        if (!telemetrySynced || sequence !== ((telemetrySequence + 1) & 0xFF)) {
+            telemetrySynced = false;
+            return null;
+        }
+    } else if (type !== TELEMETRY_FRAME_KEY) {
+        return null;
+    }
+
+    const changed = [];
+    let pos = 4;
+    for (let field = 0; field < TELEMETRY_FIELDS.length; field++) {
+        if (!(bitmap & (1 << field))) continue;
+
+        // varint zigzag
+        let value = 0;
+        let shift = 0;
+        let byte;
+        do {
+            if (pos >= bytes.length) return null;
+            byte = bytes[pos++];
+            value += (byte & 0x7F) * Math.pow(2, shift);
+            shift += 7;
+        } while (byte & 0x80);
+        value = (value % 2) ? -(value + 1) / 2 : value / 2;
+
+        telemetryRaw[field] = (type === TELEMETRY_FRAME_KEY) ? value : telemetryRaw[field] + value;
+        changed.push(field);
+    }
+
+    telemetrySequence = sequence;
+    telemetrySynced = true;
+
+    for (const field of changed) {
+        const def = TELEMETRY_FIELDS[field];
+        telemetry[def.name] = (telemetryRaw[field] === TELEMETRY_NO_VALUE) ? null : telemetryRaw[field] * def.scale;
+    }
+    return changed;
+}
+
+// Wartość telemetrii do wyświetlenia; brak pomiaru (null) jako "--"
+function formatTelemetryValue(value, digits = 1) {
+    return (value === null || value === undefined) ? '--' : Number(value).toFixed(digits);
+}
+window.formatTelemetryValue = formatTelemetryValue;
+
+function applyTelemetry(lightsChanged) {
+    window.dispatchEvent(new CustomEvent('telemetry', { detail: telemetry }));
+
+    if (lightsChanged) {
+        const lights = {
+            mode: LIGHT_MODE_NAMES[telemetry.lightMode] || 'NIEZNANY',
+            dayConfig: lightConfigName(telemetry.lightDay),
+            nightConfig: lightConfigName(telemetry.lightNight)
+        };
+        updateLightStatus(lights);
+        updateLightForm(lights); // Aktualizuj też formularz
+    }
+}
+
 // Inicjalizacja WebSocket
 function setupWebSocket() {
     debug('Inicjalizacja WebSocket...');
     function connect() {
         ws = new WebSocket('ws://' + window.location.hostname + '/ws');
+        ws.binaryType = 'arraybuffer';
         
         ws.onopen = () => {
             debug('WebSocket połączony');
+            telemetrySynced = false;
+            // Telemetria binarna; bez tej wiadomości serwer wysyła JSON raz na sekundę
+            ws.send(JSON.stringify({
+                telemetry: { format: 'binary', rate: TELEMETRY_RATE_HZ, fields: (1 << TELEMETRY_FIELDS.length) - 1 }
+            }));
             // Pobierz aktualny stan po połączeniu
             fetchCurrentState();
         };
 
         ws.onmessage = (event) => {
             try {
+                if (event.data instanceof ArrayBuffer) {
+                    const changed = decodeTelemetryFrame(event.data);
+                    if (changed && changed.length) {
+                        // Pola świateł: lightMode, lightDay, lightNight (10-12)
+                        applyTelemetry(changed.some(field => field >= 10 && field <= 12));
+                    }
+                    return;
+                }
+
                 const data = JSON.parse(event.data);
+                if (data.telemetry) {
+                    debug('Telemetria wynegocjowana:', data.telemetry);
+                    return;
+                }
+
+                // Format JSON (zapasowy)
                 debug('Otrzymano dane WebSocket:', data);
+                if (data.speed !== undefined) telemetry.speed = data.speed;
+                if (data.temperature !== undefined) telemetry.temperature = data.temperature;
+                if (data.battery !== undefined) telemetry.battery = data.battery;
+                if (data.power !== undefined) telemetry.power = data.power;
+                window.dispatchEvent(new CustomEvent('telemetry', { detail: telemetry }));
+
                 if (data.lights) {
                     updateLightStatus(data.lights);
                     updateLightForm(data.lights); // Aktualizuj też formularz